@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+#include "jni.h"
+
+#include "base/logging.h"
+#include "class_linker.h"
+#include "class_table.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-inl.h"
+#include "utf.h"
+
+namespace art {
+namespace {
+
+static const char* const kPresentDescriptors[] = {
+  "Ljava/lang/Object;",
+  "Ljava/lang/String;",
+  "Ljava/lang/Class;",
+  "Ljava/lang/Integer;",
+  "Ljava/lang/Thread;",
+  "Ljava/util/ArrayList;",
+  "Ljava/util/HashMap;",
+  "[Ljava/lang/Object;",
+};
+
+struct LookupThreadArgs {
+  JavaVM* vm;
+  jint reps;
+  bool present;
+};
+
+static void* LookupThread(void* arg) {
+  LookupThreadArgs* args = reinterpret_cast<LookupThreadArgs*>(arg);
+  JNIEnv* env;
+  CHECK_EQ(args->vm->AttachCurrentThread(&env, nullptr), JNI_OK);
+  {
+    ScopedObjectAccess soa(env);
+    ClassTable* class_table =
+        Runtime::Current()->GetClassLinker()->ClassTableForClassLoader(nullptr);
+    std::vector<std::string> descriptors;
+    for (const char* descriptor : kPresentDescriptors) {
+      descriptors.push_back(args->present ? descriptor : "LClassTableBenchmark$Absent" +
+                                                         std::string(descriptor + 1));
+    }
+    std::vector<size_t> hashes;
+    for (const std::string& descriptor : descriptors) {
+      hashes.push_back(ComputeModifiedUtf8Hash(descriptor.c_str()));
+    }
+    const size_t count = descriptors.size();
+    for (jint i = 0; i < args->reps; ++i) {
+      const size_t index = static_cast<size_t>(i) % count;
+      mirror::Class* klass = class_table->Lookup(descriptors[index].c_str(), hashes[index]);
+      CHECK_EQ(klass != nullptr, args->present) << descriptors[index];
+      if (index == 0) {
+        soa.Self()->AllowThreadSuspension();
+      }
+    }
+  }
+  CHECK_EQ(args->vm->DetachCurrentThread(), JNI_OK);
+  return nullptr;
+}
+
+static void RunLookupThreads(JNIEnv* env, jint reps, jint num_threads, bool present) {
+  JavaVM* vm;
+  CHECK_EQ(env->GetJavaVM(&vm), JNI_OK);
+  std::vector<LookupThreadArgs> args(num_threads);
+  std::vector<pthread_t> threads(num_threads);
+  for (jint i = 0; i < num_threads; ++i) {
+    args[i] = { vm, reps, present };
+    CHECK_PTHREAD_CALL(pthread_create, (&threads[i], nullptr, LookupThread, &args[i]),
+                       "class table benchmark thread");
+  }
+  for (pthread_t thread : threads) {
+    CHECK_PTHREAD_CALL(pthread_join, (thread, nullptr), "class table benchmark thread");
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_ClassTableBenchmark_timeLookupPresent(
+    JNIEnv* env, jobject, jint reps, jint threads) {
+  RunLookupThreads(env, reps, threads, /* present */ true);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_ClassTableBenchmark_timeLookupAbsent(
+    JNIEnv* env, jobject, jint reps, jint threads) {
+  RunLookupThreads(env, reps, threads, /* present */ false);
+}
+
+}  // namespace
+}  // namespace art
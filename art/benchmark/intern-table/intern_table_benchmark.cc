@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+
+#include <string>
+#include <vector>
+
+#include "jni.h"
+
+#include "base/logging.h"
+#include "handle_scope-inl.h"
+#include "intern_table.h"
+#include "mirror/string.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-inl.h"
+
+namespace art {
+namespace {
+
+static constexpr size_t kStringsPerThread = 1024;
+
+enum InternKind {
+  kStrongShared,
+  kStrongDistinct,
+  kWeakDistinct,
+};
+
+struct InternThreadArgs {
+  JavaVM* vm;
+  jint reps;
+  size_t index;
+  InternKind kind;
+};
+
+static void* InternThread(void* arg) {
+  InternThreadArgs* args = reinterpret_cast<InternThreadArgs*>(arg);
+  JNIEnv* env;
+  CHECK_EQ(args->vm->AttachCurrentThread(&env, nullptr), JNI_OK);
+  {
+    ScopedObjectAccess soa(env);
+    InternTable* intern_table = Runtime::Current()->GetInternTable();
+    const std::string prefix = (args->kind == kStrongShared)
+        ? "InternTableBenchmark-"
+        : "InternTableBenchmark-" + std::to_string(args->index) + "-";
+    std::vector<std::string> utf8;
+    VariableSizedHandleScope hs(soa.Self());
+    std::vector<Handle<mirror::String>> strings;
+    for (size_t i = 0; i < kStringsPerThread; ++i) {
+      utf8.push_back(prefix + std::to_string(i));
+      if (args->kind == kWeakDistinct) {
+        strings.push_back(
+            hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), utf8.back().c_str())));
+      }
+    }
+    for (jint i = 0; i < args->reps; ++i) {
+      const size_t string_index = static_cast<size_t>(i) % kStringsPerThread;
+      if (args->kind == kWeakDistinct) {
+        ObjPtr<mirror::String> s = strings[string_index].Get();
+        CHECK(intern_table->InternWeak(s) == s);
+      } else {
+        const std::string& s = utf8[string_index];
+        CHECK(intern_table->InternStrong(s.length(), s.c_str()) != nullptr);
+      }
+      if (string_index == 0) {
+        soa.Self()->AllowThreadSuspension();
+      }
+    }
+  }
+  CHECK_EQ(args->vm->DetachCurrentThread(), JNI_OK);
+  return nullptr;
+}
+
+static void RunInternThreads(JNIEnv* env, jint reps, jint num_threads, InternKind kind) {
+  JavaVM* vm;
+  CHECK_EQ(env->GetJavaVM(&vm), JNI_OK);
+  std::vector<InternThreadArgs> args(num_threads);
+  std::vector<pthread_t> threads(num_threads);
+  for (jint i = 0; i < num_threads; ++i) {
+    args[i] = { vm, reps, static_cast<size_t>(i), kind };
+    CHECK_PTHREAD_CALL(pthread_create, (&threads[i], nullptr, InternThread, &args[i]),
+                       "intern benchmark thread");
+  }
+  for (pthread_t thread : threads) {
+    CHECK_PTHREAD_CALL(pthread_join, (thread, nullptr), "intern benchmark thread");
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL Java_InternTableBenchmark_timeInternStrongShared(
+    JNIEnv* env, jobject, jint reps, jint threads) {
+  RunInternThreads(env, reps, threads, kStrongShared);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_InternTableBenchmark_timeInternStrongDistinct(
+    JNIEnv* env, jobject, jint reps, jint threads) {
+  RunInternThreads(env, reps, threads, kStrongDistinct);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_InternTableBenchmark_timeInternWeakDistinct(
+    JNIEnv* env, jobject, jint reps, jint threads) {
+  RunInternThreads(env, reps, threads, kWeakDistinct);
+}
+
+}  // namespace
+}  // namespace art
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class InterpreterBenchmark {
+  private static final int LENGTH = 1024;
+
+  private final int[] ia = new int[LENGTH];
+  private final long[] la = new long[LENGTH];
+
+  private int field;
+  private static int staticField;
+
+  // Sink for results, so that kernels are not optimized away.
+  public long result;
+
+  public InterpreterBenchmark() {
+    for (int i = 0; i < LENGTH; i++) {
+      ia[i] = i * 31 - 1000;
+      la[i] = i * 1000000007L;
+    }
+  }
+
+  private static int arithmetic(int n) {
+    int x = 0;
+    int y = 1;
+    for (int i = 0; i < n; i++) {
+      x += i;
+      y ^= x;
+      x &= 0x7fff;
+    }
+    return x + y;
+  }
+
+  private static long longArithmetic(int n) {
+    long x = 0;
+    for (int i = 0; i < n; i++) {
+      x = x * 3 + i;
+      x >>= 1;
+    }
+    return x;
+  }
+
+  private static int arrays(int[] a) {
+    int sum = 0;
+    for (int i = 0; i < a.length; i++) {
+      sum += a[i];
+      a[i] = sum & 0xff;
+    }
+    return sum;
+  }
+
+  private static long longArrays(long[] a) {
+    long sum = 0;
+    for (int i = 0; i < a.length; i++) {
+      sum += a[i];
+    }
+    return sum;
+  }
+
+  private int fields(int n) {
+    for (int i = 0; i < n; i++) {
+      field += i;
+      staticField += field;
+    }
+    return field + staticField;
+  }
+
+  private static int add(int a, int b) {
+    return a + b;
+  }
+
+  private int virtualAdd(int a) {
+    return field + a;
+  }
+
+  private int calls(int n) {
+    int x = 0;
+    for (int i = 0; i < n; i++) {
+      x = add(x, i);
+      x = virtualAdd(x);
+    }
+    return x;
+  }
+
+  // Dex instructions executed by one iteration of each kernel loop as dx compiles it: the loop
+  // test, the body and the back branch, plus the callees for calls(). The few instructions
+  // around each loop are not counted. Re-count with "dexdump -d" when changing a kernel.
+  private static final int ARITHMETIC_INSNS = 6;
+  private static final int LONG_ARITHMETIC_INSNS = 9;
+  private static final int ARRAYS_INSNS = 8;
+  private static final int LONG_ARRAYS_INSNS = 6;
+  private static final int FIELDS_INSNS = 10;
+  private static final int CALLS_INSNS = 12;
+
+  private static void report(String kernel, int insnsPerIteration, int calls, long ns) {
+    double insns = (double) insnsPerIteration * LENGTH * calls;
+    System.out.println(kernel + ": " + (long) (insns * 1e9 / ns) + " instructions/s");
+  }
+
+  // Usage: InterpreterBenchmark [calls per kernel]
+  public static void main(String[] args) {
+    int calls = (args.length > 0) ? Integer.parseInt(args[0]) : 1000;
+    InterpreterBenchmark b = new InterpreterBenchmark();
+    long x = 0;
+
+    long start = System.nanoTime();
+    for (int c = 0; c < calls; c++) {
+      x += arithmetic(LENGTH);
+    }
+    report("Arithmetic", ARITHMETIC_INSNS, calls, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int c = 0; c < calls; c++) {
+      x += longArithmetic(LENGTH);
+    }
+    report("LongArithmetic", LONG_ARITHMETIC_INSNS, calls, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int c = 0; c < calls; c++) {
+      x += arrays(b.ia);
+    }
+    report("Arrays", ARRAYS_INSNS, calls, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int c = 0; c < calls; c++) {
+      x += longArrays(b.la);
+    }
+    report("LongArrays", LONG_ARRAYS_INSNS, calls, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int c = 0; c < calls; c++) {
+      x += b.fields(LENGTH);
+    }
+    report("Fields", FIELDS_INSNS, calls, System.nanoTime() - start);
+
+    start = System.nanoTime();
+    for (int c = 0; c < calls; c++) {
+      x += b.calls(LENGTH);
+    }
+    report("Calls", CALLS_INSNS, calls, System.nanoTime() - start);
+
+    b.result = x;
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class LoopInvariantLoadsBenchmark {
+  private static final int LENGTH = 1024;
+
+  private static int staticScale = 3;
+  private static int staticCount;
+
+  private final int[] values = new int[LENGTH];
+  private final int[] coefficients = { 7, -3 };
+  private int scale = 5;
+  private int offset = 11;
+  private int total;
+
+  // Sink for results, so that kernels are not optimized away.
+  public long result;
+
+  public LoopInvariantLoadsBenchmark() {
+    for (int i = 0; i < LENGTH; i++) {
+      values[i] = i * 31 - 1000;
+    }
+  }
+
+  // `scale` and `offset` are invariant, but the loop stores to `total` of the same type.
+  private void accumulateFields(int[] a) {
+    for (int i = 0; i < a.length; i++) {
+      total += a[i] * scale + offset;
+    }
+  }
+
+  // `staticScale` is invariant, but the loop stores to `staticCount` of the same type.
+  private static void accumulateStatics(int[] a) {
+    for (int i = 0; i < a.length; i++) {
+      staticCount += a[i] * staticScale;
+    }
+  }
+
+  // `c[0]` and `c[1]` are invariant: the only array stores are to the new array,
+  // which cannot alias `c`.
+  private static int[] polynomial(int[] a, int[] c) {
+    int[] out = new int[a.length];
+    for (int i = 0; i < a.length; i++) {
+      out[i] = c[0] * a[i] + c[1];
+    }
+    return out;
+  }
+
+  public void timeAccumulateFields(int reps) {
+    total = 0;
+    for (int r = 0; r < reps; r++) {
+      accumulateFields(values);
+    }
+    result = total;
+  }
+
+  public void timeAccumulateStatics(int reps) {
+    staticCount = 0;
+    for (int r = 0; r < reps; r++) {
+      accumulateStatics(values);
+    }
+    result = staticCount;
+  }
+
+  public void timePolynomial(int reps) {
+    long sum = 0;
+    for (int r = 0; r < reps; r++) {
+      sum += polynomial(values, coefficients)[LENGTH - 1];
+    }
+    result = sum;
+  }
+}
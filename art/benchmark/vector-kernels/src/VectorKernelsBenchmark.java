@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class VectorKernelsBenchmark {
+  // Odd length, so that the scalar cleanup loop runs too.
+  private static final int LENGTH = 1024 + 3;
+
+  private final int[] ia = new int[LENGTH];
+  private final int[] ib = new int[LENGTH];
+  private final int[] ic = new int[LENGTH];
+  private final long[] la = new long[LENGTH];
+  private final float[] fa = new float[LENGTH];
+  private final float[] fb = new float[LENGTH];
+
+  // Sink for results, so that kernels are not optimized away.
+  public long result;
+
+  public VectorKernelsBenchmark() {
+    for (int i = 0; i < LENGTH; i++) {
+      ia[i] = i * 31 - 1000;
+      ib[i] = 5000 - i * 17;
+      la[i] = i * 1000000007L;
+      fa[i] = i * 0.5f - 100.0f;
+      fb[i] = 300.0f - i * 0.25f;
+    }
+  }
+
+  private static void add(int[] a, int[] b, int[] c) {
+    for (int i = 0; i < a.length; i++) {
+      c[i] = a[i] + b[i];
+    }
+  }
+
+  private static void saxpy(float[] x, float[] y, float alpha) {
+    for (int i = 0; i < x.length; i++) {
+      y[i] += alpha * x[i];
+    }
+  }
+
+  private static void min(int[] a, int[] b, int[] c) {
+    for (int i = 0; i < a.length; i++) {
+      c[i] = Math.min(a[i], b[i]);
+    }
+  }
+
+  private static void max(int[] a, int[] b, int[] c) {
+    for (int i = 0; i < a.length; i++) {
+      c[i] = Math.max(a[i], b[i]);
+    }
+  }
+
+  private static int sumInt(int[] a) {
+    int sum = 0;
+    for (int i = 0; i < a.length; i++) {
+      sum += a[i];
+    }
+    return sum;
+  }
+
+  private static long sumLong(long[] a) {
+    long sum = 0;
+    for (int i = 0; i < a.length; i++) {
+      sum += a[i];
+    }
+    return sum;
+  }
+
+  private static int minReduceInt(int[] a) {
+    int min = Integer.MAX_VALUE;
+    for (int i = 0; i < a.length; i++) {
+      min = Math.min(min, a[i]);
+    }
+    return min;
+  }
+
+  private static int maxReduceInt(int[] a) {
+    int max = Integer.MIN_VALUE;
+    for (int i = 0; i < a.length; i++) {
+      max = Math.max(max, a[i]);
+    }
+    return max;
+  }
+
+  private static float minReduceFloat(float[] a) {
+    float min = Float.POSITIVE_INFINITY;
+    for (int i = 0; i < a.length; i++) {
+      min = Math.min(min, a[i]);
+    }
+    return min;
+  }
+
+  private static float maxReduceFloat(float[] a) {
+    float max = Float.NEGATIVE_INFINITY;
+    for (int i = 0; i < a.length; i++) {
+      max = Math.max(max, a[i]);
+    }
+    return max;
+  }
+
+  public void timeAdd(int reps) {
+    for (int r = 0; r < reps; r++) {
+      add(ia, ib, ic);
+    }
+    result = ic[LENGTH - 1];
+  }
+
+  public void timeSaxpy(int reps) {
+    for (int r = 0; r < reps; r++) {
+      saxpy(fa, fb, 0.001f);
+    }
+    result = (long) fb[LENGTH - 1];
+  }
+
+  public void timeMin(int reps) {
+    for (int r = 0; r < reps; r++) {
+      min(ia, ib, ic);
+    }
+    result = ic[LENGTH - 1];
+  }
+
+  public void timeMax(int reps) {
+    for (int r = 0; r < reps; r++) {
+      max(ia, ib, ic);
+    }
+    result = ic[LENGTH - 1];
+  }
+
+  public void timeSumInt(int reps) {
+    int sum = 0;
+    for (int r = 0; r < reps; r++) {
+      sum += sumInt(ia);
+    }
+    result = sum;
+  }
+
+  public void timeSumLong(int reps) {
+    long sum = 0;
+    for (int r = 0; r < reps; r++) {
+      sum += sumLong(la);
+    }
+    result = sum;
+  }
+
+  public void timeMinReduceInt(int reps) {
+    int min = 0;
+    for (int r = 0; r < reps; r++) {
+      min += minReduceInt(ia);
+    }
+    result = min;
+  }
+
+  public void timeMaxReduceInt(int reps) {
+    int max = 0;
+    for (int r = 0; r < reps; r++) {
+      max += maxReduceInt(ia);
+    }
+    result = max;
+  }
+
+  public void timeMinReduceFloat(int reps) {
+    float min = 0.0f;
+    for (int r = 0; r < reps; r++) {
+      min += minReduceFloat(fa);
+    }
+    result = (long) min;
+  }
+
+  public void timeMaxReduceFloat(int reps) {
+    float max = 0.0f;
+    for (int r = 0; r < reps; r++) {
+      max += maxReduceFloat(fa);
+    }
+    result = (long) max;
+  }
+}
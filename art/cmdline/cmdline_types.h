@@ -508,6 +508,11 @@ struct XGcOption {
   // Do no measurements for kUseTableLookupReadBarrier to avoid test timeouts. b/31679493
   bool measure_ = kIsDebugBuild && !kUseTableLookupReadBarrier;
   bool gcstress_ = false;
+  // Run young collections over the regions allocated since the last GC between full CC
+  // collections.
+  bool generational_cc_ = false;
+  // Process the CC mark stacks with ConcGCThreads heap thread pool workers.
+  bool parallel_cc_marking_ = false;
 };
 
 template <>
@@ -551,6 +556,14 @@ struct CmdlineType<XGcOption> : CmdlineTypeParser<XGcOption> {
         xgc.gcstress_ = false;
       } else if (gc_option == "measure") {
         xgc.measure_ = true;
+      } else if (gc_option == "generational_cc") {
+        xgc.generational_cc_ = true;
+      } else if (gc_option == "nogenerational_cc") {
+        xgc.generational_cc_ = false;
+      } else if (gc_option == "parallel_cc_marking") {
+        xgc.parallel_cc_marking_ = true;
+      } else if (gc_option == "noparallel_cc_marking") {
+        xgc.parallel_cc_marking_ = false;
       } else if ((gc_option == "precise") ||
                  (gc_option == "noprecise") ||
                  (gc_option == "verifycardtable") ||
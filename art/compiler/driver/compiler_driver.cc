@@ -16,6 +16,7 @@
 
 #include "compiler_driver.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <vector>
 #include <unistd.h>
@@ -48,6 +49,7 @@
 #include "dex/verification_results.h"
 #include "dex/verified_method.h"
 #include "driver/compiler_options.h"
+#include "driver/incremental_compilation_info.h"
 #include "intrinsics_enum.h"
 #include "jni_internal.h"
 #include "object_lock.h"
@@ -301,6 +303,7 @@ CompilerDriver::CompilerDriver(
       compiler_context_(nullptr),
       support_boot_image_fixup_(true),
       dex_files_for_oat_file_(nullptr),
+      incremental_compilation_info_(nullptr),
       compiled_method_storage_(swap_fd),
       profile_compilation_info_(profile_compilation_info),
       max_arena_alloc_(0),
@@ -613,7 +616,11 @@ static void CompileMethod(Thread* self,
         driver->IsMethodToCompile(method_ref) &&
         driver->ShouldCompileBasedOnProfile(method_ref);
 
-    if (compile) {
+    if (compile && driver->GetIncrementalCompilationInfo() != nullptr) {
+      compiled_method = driver->GetIncrementalCompilationInfo()->TryReuse(
+          driver, dex_file, method_idx, access_flags, code_item);
+    }
+    if (compile && compiled_method == nullptr) {
       // NOTE: if compiler declines to compile this method, it will return null.
       compiled_method = driver->GetCompiler()->Compile(code_item,
                                                        access_flags,
@@ -949,6 +956,13 @@ void CompilerDriver::PreCompile(jobject class_loader,
   }
 
   Verify(class_loader, dex_files, timings);
+  {
+    // The method verifiers return their arenas to the pool, which now holds as many arenas as
+    // the verifiers running in parallel needed at most.
+    const ArenaPool* const arena_pool = Runtime::Current()->GetArenaPool();
+    max_arena_alloc_ = std::max(arena_pool->GetBytesAllocated(), max_arena_alloc_);
+    Runtime::Current()->ReclaimArenaPoolMemory();
+  }
   VLOG(compiler) << "Verify: " << GetMemoryUsageString(false);
 
   if (had_hard_verifier_failure_ && GetCompilerOptions().AbortOnHardVerifierFailure()) {
@@ -1533,7 +1547,7 @@ class ParallelCompilationManager {
                              const DexFile* dex_file,
                              const std::vector<const DexFile*>& dex_files,
                              ThreadPool* thread_pool)
-    : index_(0),
+    : queues_size_(0u),
       class_linker_(class_linker),
       class_loader_(class_loader),
       compiler_(compiler),
@@ -1564,15 +1578,24 @@ class ParallelCompilationManager {
     return dex_files_;
   }
 
-  void ForAll(size_t begin, size_t end, CompilationVisitor* visitor, size_t work_units)
+  // Visits [begin, end) with work_units tasks. Each task owns a queue of indices and steals from
+  // the others once it is empty. Without costs, the queues are consecutive ranges of about the
+  // same length. With a cost estimate per index, the indices are dealt to the queues from the
+  // most expensive down, so the large items start first and the cheap ones fill in the tail.
+  void ForAll(size_t begin,
+              size_t end,
+              CompilationVisitor* visitor,
+              size_t work_units,
+              const std::vector<size_t>* costs = nullptr)
       REQUIRES(!*Locks::mutator_lock_) {
     Thread* self = Thread::Current();
     self->AssertNoPendingException();
     CHECK_GT(work_units, 0U);
+    CHECK_LE(begin, end);
 
-    index_.StoreRelaxed(begin);
+    SplitWork(begin, end, work_units, costs);
     for (size_t i = 0; i < work_units; ++i) {
-      thread_pool_->AddTask(self, new ForAllClosure(this, end, visitor));
+      thread_pool_->AddTask(self, new ForAllClosure(this, i, visitor));
     }
     thread_pool_->StartWorkers(self);
 
@@ -1587,24 +1610,116 @@ class ParallelCompilationManager {
     thread_pool_->StopWorkers(self);
   }
 
-  size_t NextIndex() {
-    return index_.FetchAndAddSequentiallyConsistent(1);
+  // Next index for the owner of the queue, stolen from another queue once it is empty. Returns
+  // false when all the queues are empty.
+  bool NextIndex(size_t queue_index, size_t* index) {
+    if (queues_[queue_index].PopFront(index)) {
+      return true;
+    }
+    for (size_t i = 1; i < queues_size_; ++i) {
+      if (queues_[(queue_index + i) % queues_size_].PopBack(index)) {
+        return true;
+      }
+    }
+    return false;
   }
 
  private:
+  // Indices to visit, the owner takes them from the front and thieves from the back. Both ends are
+  // packed in one word so that a single CAS claims an index.
+  class WorkQueue {
+   public:
+    WorkQueue() : bounds_(0u) {}
+
+    void Reset(std::vector<uint32_t>&& indices) {
+      indices_ = std::move(indices);
+      bounds_.StoreRelaxed(Pack(0u, indices_.size()));
+    }
+
+    bool PopFront(size_t* index) {
+      uint64_t bounds = bounds_.LoadRelaxed();
+      while (Front(bounds) < Back(bounds)) {
+        if (bounds_.CompareExchangeWeakRelaxed(bounds, Pack(Front(bounds) + 1u, Back(bounds)))) {
+          *index = indices_[Front(bounds)];
+          return true;
+        }
+        bounds = bounds_.LoadRelaxed();
+      }
+      return false;
+    }
+
+    bool PopBack(size_t* index) {
+      uint64_t bounds = bounds_.LoadRelaxed();
+      while (Front(bounds) < Back(bounds)) {
+        if (bounds_.CompareExchangeWeakRelaxed(bounds, Pack(Front(bounds), Back(bounds) - 1u))) {
+          *index = indices_[Back(bounds) - 1u];
+          return true;
+        }
+        bounds = bounds_.LoadRelaxed();
+      }
+      return false;
+    }
+
+   private:
+    static uint64_t Pack(uint32_t front, uint32_t back) {
+      return (static_cast<uint64_t>(front) << 32) | back;
+    }
+    static uint32_t Front(uint64_t bounds) {
+      return static_cast<uint32_t>(bounds >> 32);
+    }
+    static uint32_t Back(uint64_t bounds) {
+      return static_cast<uint32_t>(bounds);
+    }
+
+    // Written before the tasks are added to the thread pool, read-only while they run.
+    std::vector<uint32_t> indices_;
+    Atomic<uint64_t> bounds_;
+  };
+
+  void SplitWork(size_t begin, size_t end, size_t work_units, const std::vector<size_t>* costs) {
+    std::vector<std::vector<uint32_t>> split(work_units);
+    const size_t count = end - begin;
+    if (costs == nullptr) {
+      for (size_t i = 0; i < work_units; ++i) {
+        const size_t chunk_begin = begin + count * i / work_units;
+        const size_t chunk_end = begin + count * (i + 1) / work_units;
+        for (size_t index = chunk_begin; index != chunk_end; ++index) {
+          split[i].push_back(dchecked_integral_cast<uint32_t>(index));
+        }
+      }
+    } else {
+      CHECK_EQ(costs->size(), count);
+      std::vector<uint32_t> order;
+      order.reserve(count);
+      for (size_t index = begin; index != end; ++index) {
+        order.push_back(dchecked_integral_cast<uint32_t>(index));
+      }
+      std::stable_sort(order.begin(), order.end(), [costs, begin](uint32_t lhs, uint32_t rhs) {
+        return (*costs)[lhs - begin] > (*costs)[rhs - begin];
+      });
+      for (size_t i = 0; i != count; ++i) {
+        split[i % work_units].push_back(order[i]);
+      }
+    }
+    queues_.reset(new WorkQueue[work_units]);
+    queues_size_ = work_units;
+    for (size_t i = 0; i < work_units; ++i) {
+      queues_[i].Reset(std::move(split[i]));
+    }
+  }
+
   class ForAllClosure : public Task {
    public:
-    ForAllClosure(ParallelCompilationManager* manager, size_t end, CompilationVisitor* visitor)
+    ForAllClosure(ParallelCompilationManager* manager,
+                  size_t queue_index,
+                  CompilationVisitor* visitor)
         : manager_(manager),
-          end_(end),
+          queue_index_(queue_index),
           visitor_(visitor) {}
 
     virtual void Run(Thread* self) {
-      while (true) {
-        const size_t index = manager_->NextIndex();
-        if (UNLIKELY(index >= end_)) {
-          break;
-        }
+      size_t index;
+      while (manager_->NextIndex(queue_index_, &index)) {
         visitor_->Visit(index);
         self->AssertNoPendingException();
       }
@@ -1616,11 +1731,12 @@ class ParallelCompilationManager {
 
    private:
     ParallelCompilationManager* const manager_;
-    const size_t end_;
+    const size_t queue_index_;
     CompilationVisitor* const visitor_;
   };
 
-  AtomicInteger index_;
+  std::unique_ptr<WorkQueue[]> queues_;
+  size_t queues_size_;
   ClassLinker* const class_linker_;
   const jobject class_loader_;
   CompilerDriver* const compiler_;
@@ -2673,7 +2789,25 @@ void CompilerDriver::CompileDexFile(jobject class_loader,
   ParallelCompilationManager context(Runtime::Current()->GetClassLinker(), class_loader, this,
                                      &dex_file, dex_files, thread_pool);
   CompileClassVisitor visitor(&context);
-  context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count);
+  // Estimate the cost of each class by the size of its code so that the workers start with the
+  // largest classes instead of ending up waiting on one.
+  std::vector<size_t> costs(dex_file.NumClassDefs(), 0u);
+  for (size_t i = 0; i < dex_file.NumClassDefs(); ++i) {
+    const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(i));
+    if (class_data == nullptr) {
+      continue;
+    }
+    ClassDataItemIterator it(dex_file, class_data);
+    while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      it.Next();
+    }
+    for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+      const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+      // Count a fixed overhead per method on top of its instructions.
+      costs[i] += 16u + (code_item != nullptr ? code_item->insns_size_in_code_units_ : 0u);
+    }
+  }
+  context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count, &costs);
 }
 
 void CompilerDriver::AddCompiledMethod(const MethodReference& method_ref,
@@ -60,6 +60,7 @@ class CompiledClass;
 class CompiledMethod;
 class CompilerOptions;
 class DexCompilationUnit;
+class IncrementalCompilationInfo;
 struct InlineIGetIPutData;
 class InstructionSetFeatures;
 class ParallelCompilationManager;
@@ -116,6 +117,15 @@ class CompilerDriver {
         : ArrayRef<const DexFile* const>();
   }
 
+  // Set the compiled code of a previous compilation that unchanged methods can reuse.
+  void SetIncrementalCompilationInfo(const IncrementalCompilationInfo* info) {
+    incremental_compilation_info_ = info;
+  }
+
+  const IncrementalCompilationInfo* GetIncrementalCompilationInfo() const {
+    return incremental_compilation_info_;
+  }
+
   void CompileAll(jobject class_loader,
                   const std::vector<const DexFile*>& dex_files,
                   TimingLogger* timings)
@@ -527,6 +537,9 @@ class CompilerDriver {
   // List of dex files that will be stored in the oat file.
   const std::vector<const DexFile*>* dex_files_for_oat_file_;
 
+  // Previous compilation to reuse the code of unchanged methods from, or null.
+  const IncrementalCompilationInfo* incremental_compilation_info_;
+
   CompiledMethodStorage compiled_method_storage_;
 
   // Info for profile guided compilation.
@@ -17,6 +17,7 @@
 #include "compiler_options.h"
 
 #include <fstream>
+#include <sstream>
 
 namespace art {
 
@@ -47,6 +48,7 @@ CompilerOptions::CompilerOptions()
       dump_cfg_append_(false),
       force_determinism_(false),
       register_allocation_strategy_(RegisterAllocator::kRegisterAllocatorDefault),
+      graph_color_max_instructions_(kDefaultGraphColorMaxInstructions),
       passes_to_run_(nullptr) {
 }
 
@@ -104,6 +106,7 @@ CompilerOptions::CompilerOptions(CompilerFilter::Filter compiler_filter,
       dump_cfg_append_(dump_cfg_append),
       force_determinism_(force_determinism),
       register_allocation_strategy_(regalloc_strategy),
+      graph_color_max_instructions_(kDefaultGraphColorMaxInstructions),
       passes_to_run_(passes_to_run) {
 }
 
@@ -153,11 +156,31 @@ void CompilerOptions::ParseRegisterAllocationStrategy(const StringPiece& option,
     register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorLinearScan;
   } else if (choice == "graph-color") {
     register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorGraphColor;
+  } else if (choice == "adaptive") {
+    register_allocation_strategy_ = RegisterAllocator::Strategy::kRegisterAllocatorAdaptive;
   } else {
-    Usage("Unrecognized register allocation strategy. Try linear-scan, or graph-color.");
+    Usage("Unrecognized register allocation strategy. Try linear-scan, graph-color or adaptive.");
   }
 }
 
+void CompilerOptions::ParseGraphColorMaxInstructions(const StringPiece& option, UsageFn Usage) {
+  ParseUintOption(option, "--graph-color-max-instructions", &graph_color_max_instructions_, Usage);
+}
+
+std::string CompilerOptions::GetCodeGenerationOptions() const {
+  std::ostringstream oss;
+  oss << std::boolalpha
+      << "implicit-null-checks=" << implicit_null_checks_
+      << ",implicit-so-checks=" << implicit_so_checks_
+      << ",implicit-suspend-checks=" << implicit_suspend_checks_
+      << ",inline-max-code-units=" << inline_max_code_units_
+      << ",register-allocation-strategy=" << static_cast<int>(register_allocation_strategy_)
+      << ",graph-color-max-instructions=" << graph_color_max_instructions_
+      << ",boot-image=" << boot_image_
+      << ",custom-passes=" << (passes_to_run_ != nullptr);
+  return oss.str();
+}
+
 bool CompilerOptions::ParseCompilerOption(const StringPiece& option, UsageFn Usage) {
   if (option.starts_with("--compiler-filter=")) {
     const char* compiler_filter_string = option.substr(strlen("--compiler-filter=")).data();
@@ -204,6 +227,8 @@ bool CompilerOptions::ParseCompilerOption(const StringPiece& option, UsageFn Usa
     dump_cfg_append_ = true;
   } else if (option.starts_with("--register-allocation-strategy=")) {
     ParseRegisterAllocationStrategy(option, Usage);
+  } else if (option.starts_with("--graph-color-max-instructions=")) {
+    ParseGraphColorMaxInstructions(option, Usage);
   } else {
     // Option not recognized.
     return false;
@@ -48,6 +48,9 @@ class CompilerOptions FINAL {
   static const bool kDefaultGenerateMiniDebugInfo = false;
   static const size_t kDefaultInlineMaxCodeUnits = 32;
   static constexpr size_t kUnsetInlineMaxCodeUnits = -1;
+  // With the adaptive register allocation strategy, larger methods use linear scan
+  // to bound the compile time of graph coloring.
+  static const size_t kDefaultGraphColorMaxInstructions = 1000;
 
   CompilerOptions();
   ~CompilerOptions();
@@ -253,10 +256,19 @@ class CompilerOptions FINAL {
     return register_allocation_strategy_;
   }
 
+  size_t GetGraphColorMaxInstructions() const {
+    return graph_color_max_instructions_;
+  }
+
   const std::vector<std::string>* GetPassesToRun() const {
     return passes_to_run_;
   }
 
+  // Returns the options that change the code generated for a method, other than the ones the
+  // oat header already records on its own, as a "name=value" list. Two compilations produce the
+  // same code for the same method and dependencies only if these strings are equal.
+  std::string GetCodeGenerationOptions() const;
+
  private:
   void ParseDumpInitFailures(const StringPiece& option, UsageFn Usage);
   void ParseDumpCfgPasses(const StringPiece& option, UsageFn Usage);
@@ -267,6 +279,7 @@ class CompilerOptions FINAL {
   void ParseLargeMethodMax(const StringPiece& option, UsageFn Usage);
   void ParseHugeMethodMax(const StringPiece& option, UsageFn Usage);
   void ParseRegisterAllocationStrategy(const StringPiece& option, UsageFn Usage);
+  void ParseGraphColorMaxInstructions(const StringPiece& option, UsageFn Usage);
 
   CompilerFilter::Filter compiler_filter_;
   size_t huge_method_threshold_;
@@ -313,6 +326,9 @@ class CompilerOptions FINAL {
 
   RegisterAllocator::Strategy register_allocation_strategy_;
 
+  // Largest method, in code units, allocated with graph coloring by the adaptive strategy.
+  size_t graph_color_max_instructions_;
+
   // If not null, specifies optimization passes which will be run instead of defaults.
   // Note that passes_to_run_ is not checked for correctness and providing an incorrect
   // list of passes can lead to unexpected compiler behaviour. This is caused by dependencies
@@ -324,6 +340,7 @@ class CompilerOptions FINAL {
   friend class Dex2Oat;
   friend class DexToDexDecompilerTest;
   friend class CommonCompilerTest;
+  friend class RegisterAllocatorTest;
   friend class verifier::VerifierDepsTest;
 
   DISALLOW_COPY_AND_ASSIGN(CompilerOptions);
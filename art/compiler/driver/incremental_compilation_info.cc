@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "incremental_compilation_info.h"
+
+#include <string.h>
+
+#include "android-base/stringprintf.h"
+
+#include "arch/instruction_set_features.h"
+#include "base/array_ref.h"
+#include "base/logging.h"
+#include "compiled_method.h"
+#include "dex_instruction-inl.h"
+#include "driver/compiler_options.h"
+#include "globals.h"
+#include "method_info.h"
+#include "oat.h"
+#include "oat_file-inl.h"
+#include "oat_quick_method_header.h"
+#include "stack_map.h"
+
+namespace art {
+
+using android::base::StringPrintf;
+
+static size_t HashCodeItem(const DexFile::CodeItem* code_item) {
+  // The debug info offset is deliberately left out, it does not affect the compiled code.
+  uint32_t hash = 2166136261u;
+  auto add = [&hash](uint32_t value) {
+    hash = (hash ^ value) * 16777619u;
+  };
+  add(code_item->registers_size_);
+  add(code_item->ins_size_);
+  add(code_item->outs_size_);
+  add(code_item->tries_size_);
+  add(code_item->insns_size_in_code_units_);
+  for (uint32_t i = 0; i != code_item->insns_size_in_code_units_; ++i) {
+    add(code_item->insns_[i]);
+  }
+  return hash;
+}
+
+IncrementalCompilationInfo::IncrementalCompilationInfo(std::unique_ptr<OatFile> oat_file)
+    : oat_file_(std::move(oat_file)),
+      dex_files_(),
+      reusable_methods_(),
+      num_queried_methods_(0),
+      num_self_contained_methods_(0),
+      num_reused_methods_(0) {}
+
+IncrementalCompilationInfo::~IncrementalCompilationInfo() {}
+
+std::unique_ptr<IncrementalCompilationInfo> IncrementalCompilationInfo::Create(
+    const std::string& oat_filename,
+    InstructionSet instruction_set,
+    const InstructionSetFeatures* instruction_set_features,
+    const CompilerOptions& compiler_options,
+    std::string* error_msg) {
+  DCHECK(instruction_set_features != nullptr);
+  if (compiler_options.GenerateAnyDebugInfo()) {
+    // The previous oat file does not retain the CFI of the compiled methods.
+    *error_msg = "Incremental compilation is not supported with debug info generation";
+    return nullptr;
+  }
+  std::unique_ptr<OatFile> oat_file(OatFile::Open(oat_filename,
+                                                  oat_filename,
+                                                  /* requested_base */ nullptr,
+                                                  /* oat_file_begin */ nullptr,
+                                                  /* executable */ false,
+                                                  /* low_4gb */ false,
+                                                  /* abs_dex_location */ nullptr,
+                                                  error_msg));
+  if (oat_file == nullptr) {
+    return nullptr;
+  }
+  const OatHeader& header = oat_file->GetOatHeader();
+  if (header.GetInstructionSet() != instruction_set) {
+    *error_msg = StringPrintf("Instruction set mismatch in %s: %s vs. %s",
+                              oat_filename.c_str(),
+                              GetInstructionSetString(header.GetInstructionSet()),
+                              GetInstructionSetString(instruction_set));
+    return nullptr;
+  }
+  std::unique_ptr<const InstructionSetFeatures> old_features =
+      InstructionSetFeatures::FromBitmap(instruction_set, header.GetInstructionSetFeaturesBitmap());
+  if (!old_features->Equals(instruction_set_features)) {
+    *error_msg = StringPrintf("Instruction set features mismatch in %s: %s vs. %s",
+                              oat_filename.c_str(),
+                              old_features->GetFeatureString().c_str(),
+                              instruction_set_features->GetFeatureString().c_str());
+    return nullptr;
+  }
+  if (header.IsPic() != compiler_options.GetCompilePic() ||
+      header.IsDebuggable() != compiler_options.GetDebuggable() ||
+      header.IsNativeDebuggable() != compiler_options.GetNativeDebuggable() ||
+      header.IsConcurrentCopying() != kUseReadBarrier) {
+    *error_msg = StringPrintf("Compiler configuration mismatch in %s", oat_filename.c_str());
+    return nullptr;
+  }
+  // Oat files written before the options were recorded are rejected too.
+  const char* old_options = header.GetStoreValueByKey(OatHeader::kCodeGenerationOptionsKey);
+  std::string options = compiler_options.GetCodeGenerationOptions();
+  if (old_options == nullptr || options != old_options) {
+    *error_msg = StringPrintf("Code generation options mismatch in %s: %s vs. %s",
+                              oat_filename.c_str(),
+                              old_options != nullptr ? old_options : "(none)",
+                              options.c_str());
+    return nullptr;
+  }
+  std::unique_ptr<IncrementalCompilationInfo> info(
+      new IncrementalCompilationInfo(std::move(oat_file)));
+  if (!info->Init(error_msg)) {
+    return nullptr;
+  }
+  return info;
+}
+
+bool IncrementalCompilationInfo::IsSelfContained(const DexFile::CodeItem* code_item) {
+  if (code_item == nullptr || code_item->tries_size_ != 0u) {
+    // Catch handlers reference types by index.
+    return false;
+  }
+  const uint16_t* insns = code_item->insns_;
+  const uint16_t* end = insns + code_item->insns_size_in_code_units_;
+  while (insns < end) {
+    const Instruction* inst = Instruction::At(insns);
+    Instruction::Code opcode = inst->Opcode();
+    if (Instruction::IndexTypeOf(opcode) != Instruction::kIndexNone) {
+      return false;
+    }
+    // Reference array accesses may use read barrier thunks and type checks that are
+    // linked against other code in the oat file.
+    if (opcode == Instruction::AGET_OBJECT || opcode == Instruction::APUT_OBJECT) {
+      return false;
+    }
+    insns += inst->SizeInCodeUnits();
+  }
+  return true;
+}
+
+bool IncrementalCompilationInfo::Init(std::string* error_msg) {
+  for (const OatFile::OatDexFile* oat_dex_file : oat_file_->GetOatDexFiles()) {
+    std::unique_ptr<const DexFile> dex_file = oat_dex_file->OpenDexFile(error_msg);
+    if (dex_file == nullptr) {
+      return false;
+    }
+    for (uint32_t class_def_index = 0;
+         class_def_index != dex_file->NumClassDefs();
+         ++class_def_index) {
+      const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+      const uint8_t* class_data = dex_file->GetClassData(class_def);
+      if (class_data == nullptr) {
+        continue;
+      }
+      const OatFile::OatClass oat_class = oat_dex_file->GetOatClass(class_def_index);
+      ClassDataItemIterator it(*dex_file, class_data);
+      while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+        it.Next();
+      }
+      for (uint32_t class_method_index = 0;
+           it.HasNextDirectMethod() || it.HasNextVirtualMethod();
+           ++class_method_index, it.Next()) {
+        const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+        if (!IsSelfContained(code_item)) {
+          continue;
+        }
+        const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_method_index);
+        const OatQuickMethodHeader* method_header = oat_method.GetOatQuickMethodHeader();
+        if (method_header == nullptr || !method_header->IsOptimized()) {
+          continue;
+        }
+        ReusableMethod method = {
+            dex_file.get(),
+            it.GetMemberIndex(),
+            it.GetMethodAccessFlags(),
+            code_item,
+            method_header
+        };
+        reusable_methods_.emplace(HashCodeItem(code_item), method);
+      }
+    }
+    dex_files_.push_back(std::move(dex_file));
+  }
+  return true;
+}
+
+bool IncrementalCompilationInfo::Matches(const ReusableMethod& reusable_method,
+                                         const DexFile& dex_file,
+                                         uint32_t method_idx,
+                                         uint32_t access_flags,
+                                         const DexFile::CodeItem* code_item) const {
+  if (reusable_method.access_flags != access_flags) {
+    return false;
+  }
+  const DexFile::CodeItem* old_code_item = reusable_method.code_item;
+  if (old_code_item->registers_size_ != code_item->registers_size_ ||
+      old_code_item->ins_size_ != code_item->ins_size_ ||
+      old_code_item->outs_size_ != code_item->outs_size_ ||
+      old_code_item->tries_size_ != code_item->tries_size_ ||
+      old_code_item->insns_size_in_code_units_ != code_item->insns_size_in_code_units_ ||
+      memcmp(old_code_item->insns_,
+             code_item->insns_,
+             code_item->insns_size_in_code_units_ * sizeof(uint16_t)) != 0) {
+    return false;
+  }
+  const DexFile& old_dex_file = *reusable_method.dex_file;
+  const DexFile::MethodId& old_method_id = old_dex_file.GetMethodId(reusable_method.method_idx);
+  const DexFile::MethodId& method_id = dex_file.GetMethodId(method_idx);
+  return
+      strcmp(old_dex_file.GetMethodName(old_method_id), dex_file.GetMethodName(method_id)) == 0 &&
+      strcmp(old_dex_file.GetMethodDeclaringClassDescriptor(old_method_id),
+             dex_file.GetMethodDeclaringClassDescriptor(method_id)) == 0 &&
+      old_dex_file.GetMethodSignature(old_method_id) == dex_file.GetMethodSignature(method_id);
+}
+
+CompiledMethod* IncrementalCompilationInfo::TryReuse(CompilerDriver* driver,
+                                                     const DexFile& dex_file,
+                                                     uint32_t method_idx,
+                                                     uint32_t access_flags,
+                                                     const DexFile::CodeItem* code_item) const {
+  num_queried_methods_.FetchAndAddRelaxed(1);
+  if (!IsSelfContained(code_item)) {
+    return nullptr;
+  }
+  num_self_contained_methods_.FetchAndAddRelaxed(1);
+  auto range = reusable_methods_.equal_range(HashCodeItem(code_item));
+  for (auto it = range.first; it != range.second; ++it) {
+    const ReusableMethod& reusable_method = it->second;
+    if (!Matches(reusable_method, dex_file, method_idx, access_flags, code_item)) {
+      continue;
+    }
+    const OatQuickMethodHeader* method_header = reusable_method.method_header;
+    const uint8_t* code_info = reinterpret_cast<const uint8_t*>(
+        method_header->GetOptimizedCodeInfoPtr());
+    CodeInfoEncoding encoding(code_info);
+    ArrayRef<const uint8_t> vmap_table(code_info,
+                                       encoding.HeaderSize() + encoding.NonHeaderSize());
+    ArrayRef<const uint8_t> method_info;
+    if (method_header->GetMethodInfoOffset() != 0u) {
+      const uint8_t* method_info_ptr = reinterpret_cast<const uint8_t*>(
+          method_header->GetOptimizedMethodInfoPtr());
+      size_t num_method_indices = MethodInfo(method_info_ptr).NumMethodIndices();
+      method_info = ArrayRef<const uint8_t>(method_info_ptr,
+                                            MethodInfo::ComputeSize(num_method_indices));
+    }
+    const QuickMethodFrameInfo frame_info = method_header->GetFrameInfo();
+    num_reused_methods_.FetchAndAddRelaxed(1);
+    return CompiledMethod::SwapAllocCompiledMethod(
+        driver,
+        oat_file_->GetOatHeader().GetInstructionSet(),
+        ArrayRef<const uint8_t>(method_header->GetCode(), method_header->GetCodeSize()),
+        frame_info.FrameSizeInBytes(),
+        frame_info.CoreSpillMask(),
+        frame_info.FpSpillMask(),
+        method_info,
+        vmap_table,
+        ArrayRef<const uint8_t>(),  // cfi_info
+        ArrayRef<const LinkerPatch>());
+  }
+  return nullptr;
+}
+
+}  // namespace art
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_INCREMENTAL_COMPILATION_INFO_H_
+#define ART_COMPILER_DRIVER_INCREMENTAL_COMPILATION_INFO_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "arch/instruction_set.h"
+#include "atomic.h"
+#include "base/macros.h"
+#include "dex_file.h"
+
+namespace art {
+
+class CompiledMethod;
+class CompilerDriver;
+class CompilerOptions;
+class InstructionSetFeatures;
+class OatFile;
+class OatQuickMethodHeader;
+
+// Compiled code from a previous oat file of the same application, used by an incremental
+// compilation to copy the code of unchanged methods instead of compiling them again.
+//
+// A method is considered unchanged if its declaring class descriptor, name, signature,
+// access flags and code item match a method in the previous oat file. Only the code that
+// does not depend on anything outside of the code item is reused, i.e. the code of methods
+// that do not reference any type, string, field or method and therefore have no linker
+// patches and no resolution dependencies that could change between the two compilations.
+//
+// Methods with invokes, field accesses, const-string, const-class, new-instance, check-cast,
+// try blocks or reference array accesses are always compiled again. Reusing them would need
+// their linker patches and the resolved fields, methods, vtable indexes and inlined callees
+// they depend on, none of which the oat file records.
+//
+// The previous oat file must also have been compiled with the same instruction set, features
+// and code generation options, see CompilerOptions::GetCodeGenerationOptions().
+class IncrementalCompilationInfo {
+ public:
+  // Open the previous oat file. Returns null and sets `error_msg` if the oat file cannot be
+  // opened or it was compiled with a configuration that produces different code.
+  static std::unique_ptr<IncrementalCompilationInfo> Create(
+      const std::string& oat_filename,
+      InstructionSet instruction_set,
+      const InstructionSetFeatures* instruction_set_features,
+      const CompilerOptions& compiler_options,
+      std::string* error_msg);
+
+  ~IncrementalCompilationInfo();
+
+  // Returns a copy of the previously compiled code for the method if it can be reused,
+  // null otherwise. Thread-safe.
+  CompiledMethod* TryReuse(CompilerDriver* driver,
+                           const DexFile& dex_file,
+                           uint32_t method_idx,
+                           uint32_t access_flags,
+                           const DexFile::CodeItem* code_item) const;
+
+  size_t GetNumberOfReusableMethods() const {
+    return reusable_methods_.size();
+  }
+
+  size_t GetNumberOfReusedMethods() const {
+    return num_reused_methods_.LoadRelaxed();
+  }
+
+  // The number of methods TryReuse() was called for, i.e. the methods to compile.
+  size_t GetNumberOfQueriedMethods() const {
+    return num_queried_methods_.LoadRelaxed();
+  }
+
+  // The number of methods to compile that are self-contained, i.e. could be reused if they
+  // did not change. This measures how much of a recompilation the reuse can cover.
+  size_t GetNumberOfSelfContainedMethods() const {
+    return num_self_contained_methods_.LoadRelaxed();
+  }
+
+  // Whether the compiled code of the method depends only on its code item.
+  static bool IsSelfContained(const DexFile::CodeItem* code_item);
+
+ private:
+  struct ReusableMethod {
+    const DexFile* dex_file;
+    uint32_t method_idx;
+    uint32_t access_flags;
+    const DexFile::CodeItem* code_item;
+    const OatQuickMethodHeader* method_header;
+  };
+
+  explicit IncrementalCompilationInfo(std::unique_ptr<OatFile> oat_file);
+
+  bool Init(std::string* error_msg);
+  bool Matches(const ReusableMethod& reusable_method,
+               const DexFile& dex_file,
+               uint32_t method_idx,
+               uint32_t access_flags,
+               const DexFile::CodeItem* code_item) const;
+
+  std::unique_ptr<OatFile> oat_file_;
+  std::vector<std::unique_ptr<const DexFile>> dex_files_;
+
+  // The reusable methods of the previous oat file, keyed by the hash of their code item.
+  std::unordered_multimap<size_t, ReusableMethod> reusable_methods_;
+
+  mutable AtomicInteger num_queried_methods_;
+  mutable AtomicInteger num_self_contained_methods_;
+  mutable AtomicInteger num_reused_methods_;
+
+  DISALLOW_COPY_AND_ASSIGN(IncrementalCompilationInfo);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_INCREMENTAL_COMPILATION_INFO_H_
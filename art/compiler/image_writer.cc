@@ -869,12 +869,19 @@ class ImageWriter::PruneClassesVisitor : public ClassVisitor {
   size_t Prune() REQUIRES_SHARED(Locks::mutator_lock_) {
     ClassTable* class_table =
         Runtime::Current()->GetClassLinker()->ClassTableForClassLoader(class_loader_);
+    // Remove the classes in one batch, each removal copies the class set it erases from.
+    std::vector<std::string> storage(classes_to_prune_.size());
+    std::vector<const char*> descriptors;
+    descriptors.reserve(classes_to_prune_.size());
     for (mirror::Class* klass : classes_to_prune_) {
-      std::string storage;
-      const char* descriptor = klass->GetDescriptor(&storage);
-      bool result = class_table->Remove(descriptor);
-      DCHECK(result);
-      DCHECK(!class_table->Remove(descriptor)) << descriptor;
+      descriptors.push_back(klass->GetDescriptor(&storage[descriptors.size()]));
+    }
+    size_t removed = class_table->Remove(descriptors);
+    DCHECK_EQ(removed, descriptors.size());
+    if (kIsDebugBuild) {
+      for (const char* descriptor : descriptors) {
+        DCHECK(!class_table->Remove(descriptor)) << descriptor;
+      }
     }
     return defined_class_count_;
   }
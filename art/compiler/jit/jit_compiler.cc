@@ -59,11 +59,11 @@ extern "C" void jit_unload(void* handle) {
 }
 
 extern "C" bool jit_compile_method(
-    void* handle, ArtMethod* method, Thread* self, bool osr)
+    void* handle, ArtMethod* method, Thread* self, bool osr, bool baseline)
     REQUIRES_SHARED(Locks::mutator_lock_) {
   auto* jit_compiler = reinterpret_cast<JitCompiler*>(handle);
   DCHECK(jit_compiler != nullptr);
-  return jit_compiler->CompileMethod(self, method, osr);
+  return jit_compiler->CompileMethod(self, method, osr, baseline);
 }
 
 extern "C" void jit_types_loaded(void* handle, mirror::Class** types, size_t count)
@@ -89,7 +89,7 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   exit(EXIT_FAILURE);
 }
 
-JitCompiler::JitCompiler() {
+JitCompiler::JitCompiler() : jit_logger_lock_("JIT logger lock") {
   compiler_options_.reset(new CompilerOptions(
       CompilerFilter::kDefaultCompilerFilter,
       CompilerOptions::kDefaultHugeMethodThreshold,
@@ -184,7 +184,7 @@ JitCompiler::~JitCompiler() {
   }
 }
 
-bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method, bool osr) {
+bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method, bool osr, bool baseline) {
   DCHECK(!method->IsProxyMethod());
   DCHECK(method->GetDeclaringClass()->IsResolved());
 
@@ -197,8 +197,10 @@ bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method, bool osr) {
   {
     TimingLogger::ScopedTiming t2("Compiling", &logger);
     JitCodeCache* const code_cache = runtime->GetJit()->GetCodeCache();
-    success = compiler_driver_->GetCompiler()->JitCompile(self, code_cache, method, osr);
+    success =
+        compiler_driver_->GetCompiler()->JitCompile(self, code_cache, method, osr, baseline);
     if (success && (jit_logger_ != nullptr)) {
+      MutexLock mu(self, jit_logger_lock_);
       jit_logger_->WriteLog(code_cache, method, osr);
     }
   }
@@ -35,8 +35,9 @@ class JitCompiler {
   static JitCompiler* Create();
   virtual ~JitCompiler();
 
-  // Compilation entrypoint. Returns whether the compilation succeeded.
-  bool CompileMethod(Thread* self, ArtMethod* method, bool osr)
+  // Compilation entrypoint. Returns whether the compilation succeeded. A `baseline`
+  // compilation skips the optimization passes.
+  bool CompileMethod(Thread* self, ArtMethod* method, bool osr, bool baseline)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   CompilerOptions* GetCompilerOptions() const {
@@ -52,6 +53,8 @@ class JitCompiler {
   std::unique_ptr<CompilerDriver> compiler_driver_;
   std::unique_ptr<const InstructionSetFeatures> instruction_set_features_;
   std::unique_ptr<JitLogger> jit_logger_;
+  // The JIT may compile on several threads, serialize writing to the log files.
+  Mutex jit_logger_lock_;
 
   JitCompiler();
 
@@ -52,6 +52,7 @@
 #include "os.h"
 #include "safe_map.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_pool.h"
 #include "type_lookup_table.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 #include "vdex_file.h"
@@ -212,6 +213,9 @@ class OatWriter::OatClass {
   dchecked_vector<OatMethodOffsets> method_offsets_;
   dchecked_vector<OatQuickMethodHeader> method_headers_;
 
+  // Code layout cluster for each CompiledMethod present in the OatClass.
+  dchecked_vector<CodeLayoutCluster> method_clusters_;
+
  private:
   size_t GetMethodOffsetsRawSize() const {
     return method_offsets_.size() * sizeof(method_offsets_[0]);
@@ -220,6 +224,20 @@ class OatWriter::OatClass {
   DISALLOW_COPY_AND_ASSIGN(OatClass);
 };
 
+struct OatWriter::PatchedMethod {
+  PatchedMethod(const CompiledMethod* method, const DexFile* file)
+      : compiled_method(method), dex_file(file), code(), target_offsets() {}
+
+  const CompiledMethod* compiled_method;
+  const DexFile* dex_file;
+
+  // The code with the patches that do not need the relative patcher already applied.
+  std::vector<uint8_t> code;
+  // The target offsets of the patches applied by the relative patcher, indexed like
+  // CompiledMethod::GetPatches().
+  std::vector<uint32_t> target_offsets;
+};
+
 class OatWriter::OatDexFile {
  public:
   OatDexFile(const char* dex_file_location,
@@ -342,6 +360,7 @@ OatWriter::OatWriter(bool compiling_boot_image, TimingLogger* timings, ProfileCo
     size_oat_class_method_offsets_(0),
     relative_patcher_(nullptr),
     absolute_patch_locations_(),
+    patched_methods_(),
     profile_compilation_info_(info) {
 }
 
@@ -673,6 +692,38 @@ class OatWriter::OatDexMethodVisitor : public DexMethodVisitor {
   size_t method_offsets_index_;
 };
 
+class OatWriter::CodeLayoutMethodVisitor : public OatDexMethodVisitor {
+ public:
+  CodeLayoutMethodVisitor(OatWriter* writer, size_t offset)
+    : OatDexMethodVisitor(writer, offset),
+      cluster_(CodeLayoutCluster::kOther),
+      last_cluster_(true) {
+  }
+
+  // Prepare for a pass over all methods that deals only with the code in `cluster`.
+  virtual void StartCluster(CodeLayoutCluster cluster, bool last_cluster) {
+    oat_class_index_ = 0u;
+    cluster_ = cluster;
+    last_cluster_ = last_cluster;
+  }
+
+ protected:
+  // Check whether the compiled method at method_offsets_index_ is laid out in this pass.
+  bool IsInCurrentCluster(const OatClass* oat_class) const {
+    DCHECK_LT(method_offsets_index_, oat_class->method_clusters_.size());
+    return oat_class->method_clusters_[method_offsets_index_] == cluster_;
+  }
+
+  // Check whether we have just finished the last class of the last pass, i.e. we are at
+  // the end of the code and need to deal with the final thunks.
+  bool IsEndOfCode() const {
+    return last_cluster_ && oat_class_index_ == writer_->oat_classes_.size();
+  }
+
+  CodeLayoutCluster cluster_;
+  bool last_cluster_;
+};
+
 class OatWriter::InitOatClassesMethodVisitor : public DexMethodVisitor {
  public:
   InitOatClassesMethodVisitor(OatWriter* writer, size_t offset)
@@ -738,19 +789,81 @@ class OatWriter::InitOatClassesMethodVisitor : public DexMethodVisitor {
   size_t num_non_null_compiled_methods_;
 };
 
-class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
+class OatWriter::InitCodeLayoutMethodVisitor : public OatDexMethodVisitor {
+ public:
+  InitCodeLayoutMethodVisitor(OatWriter* writer, const ProfileCompilationInfo* profile)
+    : OatDexMethodVisitor(writer, /* offset */ 0u),
+      profile_(profile),
+      startup_class_(false),
+      num_startup_methods_(0u),
+      num_hot_methods_(0u) {
+  }
+
+  bool StartClass(const DexFile* dex_file, size_t class_def_index) {
+    OatDexMethodVisitor::StartClass(dex_file, class_def_index);
+    // The profile does not record when a method was executed, only which classes were
+    // resolved during startup, so treat all profiled methods of these classes as startup code.
+    const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+    startup_class_ = profile_->ContainsClass(*dex_file, class_def.class_idx_);
+    return true;
+  }
+
+  bool VisitMethod(size_t class_def_method_index, const ClassDataItemIterator& it) {
+    OatClass* oat_class = &writer_->oat_classes_[oat_class_index_];
+    CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
+
+    if (compiled_method != nullptr) {
+      if (profile_->ContainsMethod(MethodReference(dex_file_, it.GetMemberIndex()))) {
+        DCHECK_LT(method_offsets_index_, oat_class->method_clusters_.size());
+        if (startup_class_) {
+          oat_class->method_clusters_[method_offsets_index_] = CodeLayoutCluster::kStartup;
+          ++num_startup_methods_;
+        } else {
+          oat_class->method_clusters_[method_offsets_index_] = CodeLayoutCluster::kHot;
+          ++num_hot_methods_;
+        }
+      }
+      ++method_offsets_index_;
+    }
+
+    return true;
+  }
+
+  size_t GetNumStartupMethods() const {
+    return num_startup_methods_;
+  }
+
+  size_t GetNumHotMethods() const {
+    return num_hot_methods_;
+  }
+
+ private:
+  const ProfileCompilationInfo* const profile_;
+  bool startup_class_;
+  size_t num_startup_methods_;
+  size_t num_hot_methods_;
+};
+
+class OatWriter::InitCodeMethodVisitor : public CodeLayoutMethodVisitor {
  public:
   InitCodeMethodVisitor(OatWriter* writer, size_t offset, size_t quickening_info_offset)
-    : OatDexMethodVisitor(writer, offset),
+    : CodeLayoutMethodVisitor(writer, offset),
       debuggable_(writer->GetCompilerDriver()->GetCompilerOptions().GetDebuggable()),
+      quickening_info_offset_(quickening_info_offset),
       current_quickening_info_offset_(quickening_info_offset) {
     writer_->absolute_patch_locations_.reserve(
         writer_->compiler_driver_->GetNonRelativeLinkerPatchCount());
   }
 
+  void StartCluster(CodeLayoutCluster cluster, bool last_cluster) {
+    CodeLayoutMethodVisitor::StartCluster(cluster, last_cluster);
+    // The quickening info is written in class order, so each pass recalculates its offsets.
+    current_quickening_info_offset_ = quickening_info_offset_;
+  }
+
   bool EndClass() {
     OatDexMethodVisitor::EndClass();
-    if (oat_class_index_ == writer_->oat_classes_.size()) {
+    if (IsEndOfCode()) {
       offset_ = writer_->relative_patcher_->ReserveSpaceEnd(offset_);
     }
     return true;
@@ -765,6 +878,16 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
       current_quickening_info_offset_ += sizeof(uint32_t);
     }
     if (compiled_method != nullptr) {
+      uint32_t quickening_info_offset = current_quickening_info_offset_;
+      if (kIsVdexEnabled && compiled_method->GetQuickCode().empty()) {
+        ArrayRef<const uint8_t> vmap_table = compiled_method->GetVmapTable();
+        current_quickening_info_offset_ += vmap_table.size() * sizeof(vmap_table.front());
+      }
+      if (!IsInCurrentCluster(oat_class)) {
+        ++method_offsets_index_;
+        return true;
+      }
+
       // Derived from CompiledMethod.
       uint32_t quick_code_offset = 0;
 
@@ -829,9 +952,7 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
         if (kIsVdexEnabled) {
           // We write the offset in the .vdex file.
           DCHECK_EQ(vmap_table_offset, 0u);
-          vmap_table_offset = current_quickening_info_offset_;
-          ArrayRef<const uint8_t> vmap_table = compiled_method->GetVmapTable();
-          current_quickening_info_offset_ += vmap_table.size() * sizeof(vmap_table.front());
+          vmap_table_offset = quickening_info_offset;
         } else {
           // We write the offset of the quickening info relative to the code.
           vmap_table_offset += code_offset;
@@ -854,6 +975,7 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
         offset_ += code_size;
         // Record absolute patch locations.
         if (!compiled_method->GetPatches().empty()) {
+          writer_->patched_methods_.emplace_back(compiled_method, dex_file_);
           uintptr_t base_loc = offset_ - code_size - writer_->oat_header_->GetExecutableOffset();
           for (const LinkerPatch& patch : compiled_method->GetPatches()) {
             if (!patch.IsPcRelative()) {
@@ -945,6 +1067,7 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
   const bool debuggable_;
 
   // Offset in the vdex file for the quickening info.
+  const uint32_t quickening_info_offset_;
   uint32_t current_quickening_info_offset_;
 };
 
@@ -1179,216 +1302,102 @@ class OatWriter::InitImageMethodVisitor : public OatDexMethodVisitor {
   std::vector<std::pair<ArtMethod*, ArtMethod*>> methods_to_process_;
 };
 
-class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
+// Looks up the targets of linker patches and applies the absolute patches. The lookups
+// only read the state of the OatWriter, ImageWriter and runtime, so it is safe to use
+// a separate CodePatcher on each thread while the code is being written.
+class OatWriter::CodePatcher {
  public:
-  WriteCodeMethodVisitor(OatWriter* writer, OutputStream* out, const size_t file_offset,
-                         size_t relative_offset) SHARED_LOCK_FUNCTION(Locks::mutator_lock_)
-    : OatDexMethodVisitor(writer, relative_offset),
+  explicit CodePatcher(OatWriter* writer) REQUIRES_SHARED(Locks::mutator_lock_)
+    : writer_(writer),
       class_loader_(writer->HasImage() ? writer->image_writer_->GetClassLoader() : nullptr),
-      out_(out),
-      file_offset_(file_offset),
-      soa_(Thread::Current()),
-      no_thread_suspension_("OatWriter patching"),
       class_linker_(Runtime::Current()->GetClassLinker()),
+      dex_file_(nullptr),
       dex_cache_(nullptr) {
-    patched_code_.reserve(16 * KB);
-    if (writer_->HasBootImage()) {
-      // If we're creating the image, the address space must be ready so that we can apply patches.
-      CHECK(writer_->image_writer_->IsImageAddressSpaceReady());
-    }
   }
 
-  ~WriteCodeMethodVisitor() UNLOCK_FUNCTION(Locks::mutator_lock_) {
-  }
-
-  bool StartClass(const DexFile* dex_file, size_t class_def_index)
-      REQUIRES_SHARED(Locks::mutator_lock_) {
-    OatDexMethodVisitor::StartClass(dex_file, class_def_index);
-    if (dex_cache_ == nullptr || dex_cache_->GetDexFile() != dex_file) {
-      dex_cache_ = class_linker_->FindDexCache(Thread::Current(), *dex_file);
+  void Prepare(PatchedMethod* patched_method) REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (dex_cache_ == nullptr || dex_file_ != patched_method->dex_file) {
+      dex_file_ = patched_method->dex_file;
+      dex_cache_ = class_linker_->FindDexCache(Thread::Current(), *dex_file_);
       DCHECK(dex_cache_ != nullptr);
     }
-    return true;
-  }
 
-  bool EndClass() REQUIRES_SHARED(Locks::mutator_lock_) {
-    bool result = OatDexMethodVisitor::EndClass();
-    if (oat_class_index_ == writer_->oat_classes_.size()) {
-      DCHECK(result);  // OatDexMethodVisitor::EndClass() never fails.
-      offset_ = writer_->relative_patcher_->WriteThunks(out_, offset_);
-      if (UNLIKELY(offset_ == 0u)) {
-        PLOG(ERROR) << "Failed to write final relative call thunks";
-        result = false;
-      }
-    }
-    return result;
-  }
-
-  bool VisitMethod(size_t class_def_method_index, const ClassDataItemIterator& it)
-      REQUIRES_SHARED(Locks::mutator_lock_) {
-    OatClass* oat_class = &writer_->oat_classes_[oat_class_index_];
-    const CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
-
-    // No thread suspension since dex_cache_ that may get invalidated if that occurs.
-    ScopedAssertNoThreadSuspension tsc(__FUNCTION__);
-    if (compiled_method != nullptr) {  // ie. not an abstract method
-      size_t file_offset = file_offset_;
-      OutputStream* out = out_;
-
-      ArrayRef<const uint8_t> quick_code = compiled_method->GetQuickCode();
-      uint32_t code_size = quick_code.size() * sizeof(uint8_t);
-
-      // Deduplicate code arrays.
-      const OatMethodOffsets& method_offsets = oat_class->method_offsets_[method_offsets_index_];
-      if (method_offsets.code_offset_ > offset_) {
-        offset_ = writer_->relative_patcher_->WriteThunks(out, offset_);
-        if (offset_ == 0u) {
-          ReportWriteFailure("relative call thunk", it);
-          return false;
+    const CompiledMethod* compiled_method = patched_method->compiled_method;
+    ArrayRef<const uint8_t> quick_code = compiled_method->GetQuickCode();
+    ArrayRef<const LinkerPatch> patches = compiled_method->GetPatches();
+    std::vector<uint8_t>* code = &patched_method->code;
+    code->assign(quick_code.begin(), quick_code.end());
+    patched_method->target_offsets.assign(patches.size(), 0u);
+    for (size_t i = 0; i != patches.size(); ++i) {
+      const LinkerPatch& patch = patches[i];
+      uint32_t literal_offset = patch.LiteralOffset();
+      uint32_t* target_offset = &patched_method->target_offsets[i];
+      switch (patch.GetType()) {
+        case LinkerPatch::Type::kCallRelative: {
+          *target_offset = GetTargetOffset(patch);
+          break;
         }
-        uint32_t alignment_size = CodeAlignmentSize(offset_, *compiled_method);
-        if (alignment_size != 0) {
-          if (!writer_->WriteCodeAlignment(out, alignment_size)) {
-            ReportWriteFailure("code alignment padding", it);
-            return false;
-          }
-          offset_ += alignment_size;
-          DCHECK_OFFSET_();
+        case LinkerPatch::Type::kDexCacheArray: {
+          *target_offset = GetDexCacheOffset(patch);
+          break;
         }
-        DCHECK_ALIGNED_PARAM(offset_ + sizeof(OatQuickMethodHeader),
-                             GetInstructionSetAlignment(compiled_method->GetInstructionSet()));
-        DCHECK_EQ(method_offsets.code_offset_,
-                  offset_ + sizeof(OatQuickMethodHeader) + compiled_method->CodeDelta())
-            << dex_file_->PrettyMethod(it.GetMemberIndex());
-        const OatQuickMethodHeader& method_header =
-            oat_class->method_headers_[method_offsets_index_];
-        if (!out->WriteFully(&method_header, sizeof(method_header))) {
-          ReportWriteFailure("method header", it);
-          return false;
+        case LinkerPatch::Type::kStringRelative: {
+          *target_offset = GetTargetObjectOffset(GetTargetString(patch));
+          break;
         }
-        writer_->size_method_header_ += sizeof(method_header);
-        offset_ += sizeof(method_header);
-        DCHECK_OFFSET_();
-
-        if (!compiled_method->GetPatches().empty()) {
-          patched_code_.assign(quick_code.begin(), quick_code.end());
-          quick_code = ArrayRef<const uint8_t>(patched_code_);
-          for (const LinkerPatch& patch : compiled_method->GetPatches()) {
-            uint32_t literal_offset = patch.LiteralOffset();
-            switch (patch.GetType()) {
-              case LinkerPatch::Type::kCallRelative: {
-                // NOTE: Relative calls across oat files are not supported.
-                uint32_t target_offset = GetTargetOffset(patch);
-                writer_->relative_patcher_->PatchCall(&patched_code_,
-                                                      literal_offset,
-                                                      offset_ + literal_offset,
-                                                      target_offset);
-                break;
-              }
-              case LinkerPatch::Type::kDexCacheArray: {
-                uint32_t target_offset = GetDexCacheOffset(patch);
-                writer_->relative_patcher_->PatchPcRelativeReference(&patched_code_,
-                                                                     patch,
-                                                                     offset_ + literal_offset,
-                                                                     target_offset);
-                break;
-              }
-              case LinkerPatch::Type::kStringRelative: {
-                uint32_t target_offset = GetTargetObjectOffset(GetTargetString(patch));
-                writer_->relative_patcher_->PatchPcRelativeReference(&patched_code_,
-                                                                     patch,
-                                                                     offset_ + literal_offset,
-                                                                     target_offset);
-                break;
-              }
-              case LinkerPatch::Type::kStringBssEntry: {
-                StringReference ref(patch.TargetStringDexFile(), patch.TargetStringIndex());
-                uint32_t target_offset = writer_->bss_string_entries_.Get(ref);
-                writer_->relative_patcher_->PatchPcRelativeReference(&patched_code_,
-                                                                     patch,
-                                                                     offset_ + literal_offset,
-                                                                     target_offset);
-                break;
-              }
-              case LinkerPatch::Type::kTypeRelative: {
-                uint32_t target_offset = GetTargetObjectOffset(GetTargetType(patch));
-                writer_->relative_patcher_->PatchPcRelativeReference(&patched_code_,
-                                                                     patch,
-                                                                     offset_ + literal_offset,
-                                                                     target_offset);
-                break;
-              }
-              case LinkerPatch::Type::kTypeBssEntry: {
-                TypeReference ref(patch.TargetTypeDexFile(), patch.TargetTypeIndex());
-                uint32_t target_offset = writer_->bss_type_entries_.Get(ref);
-                writer_->relative_patcher_->PatchPcRelativeReference(&patched_code_,
-                                                                     patch,
-                                                                     offset_ + literal_offset,
-                                                                     target_offset);
-                break;
-              }
-              case LinkerPatch::Type::kCall: {
-                uint32_t target_offset = GetTargetOffset(patch);
-                PatchCodeAddress(&patched_code_, literal_offset, target_offset);
-                break;
-              }
-              case LinkerPatch::Type::kMethod: {
-                ArtMethod* method = GetTargetMethod(patch);
-                PatchMethodAddress(&patched_code_, literal_offset, method);
-                break;
-              }
-              case LinkerPatch::Type::kString: {
-                mirror::String* string = GetTargetString(patch);
-                PatchObjectAddress(&patched_code_, literal_offset, string);
-                break;
-              }
-              case LinkerPatch::Type::kType: {
-                mirror::Class* type = GetTargetType(patch);
-                PatchObjectAddress(&patched_code_, literal_offset, type);
-                break;
-              }
-              case LinkerPatch::Type::kBakerReadBarrierBranch: {
-                writer_->relative_patcher_->PatchBakerReadBarrierBranch(&patched_code_,
-                                                                        patch,
-                                                                        offset_ + literal_offset);
-                break;
-              }
-              default: {
-                DCHECK(false) << "Unexpected linker patch type: " << patch.GetType();
-                break;
-              }
-            }
-          }
+        case LinkerPatch::Type::kStringBssEntry: {
+          StringReference ref(patch.TargetStringDexFile(), patch.TargetStringIndex());
+          *target_offset = writer_->bss_string_entries_.Get(ref);
+          break;
         }
-
-        if (!out->WriteFully(quick_code.data(), code_size)) {
-          ReportWriteFailure("method code", it);
-          return false;
+        case LinkerPatch::Type::kTypeRelative: {
+          *target_offset = GetTargetObjectOffset(GetTargetType(patch));
+          break;
+        }
+        case LinkerPatch::Type::kTypeBssEntry: {
+          TypeReference ref(patch.TargetTypeDexFile(), patch.TargetTypeIndex());
+          *target_offset = writer_->bss_type_entries_.Get(ref);
+          break;
+        }
+        case LinkerPatch::Type::kCall: {
+          PatchCodeAddress(code, literal_offset, GetTargetOffset(patch));
+          break;
+        }
+        case LinkerPatch::Type::kMethod: {
+          ArtMethod* method = GetTargetMethod(patch);
+          PatchMethodAddress(code, literal_offset, method);
+          break;
+        }
+        case LinkerPatch::Type::kString: {
+          mirror::String* string = GetTargetString(patch);
+          PatchObjectAddress(code, literal_offset, string);
+          break;
+        }
+        case LinkerPatch::Type::kType: {
+          mirror::Class* type = GetTargetType(patch);
+          PatchObjectAddress(code, literal_offset, type);
+          break;
+        }
+        case LinkerPatch::Type::kBakerReadBarrierBranch: {
+          // Applied by the relative patcher, no target to look up.
+          break;
+        }
+        default: {
+          DCHECK(false) << "Unexpected linker patch type: " << patch.GetType();
+          break;
         }
-        writer_->size_code_ += code_size;
-        offset_ += code_size;
       }
-      DCHECK_OFFSET_();
-      ++method_offsets_index_;
     }
-
-    return true;
   }
 
  private:
+  OatWriter* const writer_;
   ObjPtr<mirror::ClassLoader> class_loader_;
-  OutputStream* const out_;
-  const size_t file_offset_;
-  const ScopedObjectAccess soa_;
-  const ScopedAssertNoThreadSuspension no_thread_suspension_;
   ClassLinker* const class_linker_;
-  ObjPtr<mirror::DexCache> dex_cache_;
-  std::vector<uint8_t> patched_code_;
 
-  void ReportWriteFailure(const char* what, const ClassDataItemIterator& it) {
-    PLOG(ERROR) << "Failed to write " << what << " for "
-        << dex_file_->PrettyMethod(it.GetMemberIndex()) << " to " << out_->GetLocation();
-  }
+  // The dex file and dex cache of the method being patched.
+  const DexFile* dex_file_;
+  ObjPtr<mirror::DexCache> dex_cache_;
 
   ArtMethod* GetTargetMethod(const LinkerPatch& patch)
       REQUIRES_SHARED(Locks::mutator_lock_) {
@@ -1546,6 +1555,242 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
   }
 };
 
+class OatWriter::PatchCodeTask : public SelfDeletingTask {
+ public:
+  PatchCodeTask(OatWriter* writer, ArrayRef<PatchedMethod> patched_methods)
+      : writer_(writer), patched_methods_(patched_methods) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    CodePatcher patcher(writer_);
+    for (PatchedMethod& patched_method : patched_methods_) {
+      patcher.Prepare(&patched_method);
+    }
+  }
+
+ private:
+  OatWriter* const writer_;
+  const ArrayRef<PatchedMethod> patched_methods_;
+};
+
+class OatWriter::WriteCodeMethodVisitor : public CodeLayoutMethodVisitor {
+ public:
+  WriteCodeMethodVisitor(OatWriter* writer,
+                         OutputStream* out,
+                         const size_t file_offset,
+                         size_t relative_offset,
+                         ThreadPool* thread_pool) SHARED_LOCK_FUNCTION(Locks::mutator_lock_)
+    : CodeLayoutMethodVisitor(writer, relative_offset),
+      out_(out),
+      file_offset_(file_offset),
+      soa_(Thread::Current()),
+      no_thread_suspension_("OatWriter patching"),
+      thread_pool_(thread_pool),
+      next_patched_method_(0u),
+      patched_methods_end_(0u) {
+    if (writer_->HasBootImage()) {
+      // If we're creating the image, the address space must be ready so that we can apply patches.
+      CHECK(writer_->image_writer_->IsImageAddressSpaceReady());
+    }
+  }
+
+  ~WriteCodeMethodVisitor() UNLOCK_FUNCTION(Locks::mutator_lock_) {
+  }
+
+  bool EndClass() REQUIRES_SHARED(Locks::mutator_lock_) {
+    bool result = OatDexMethodVisitor::EndClass();
+    if (IsEndOfCode()) {
+      DCHECK(result);  // OatDexMethodVisitor::EndClass() never fails.
+      DCHECK_EQ(next_patched_method_, writer_->patched_methods_.size());
+      offset_ = writer_->relative_patcher_->WriteThunks(out_, offset_);
+      if (UNLIKELY(offset_ == 0u)) {
+        PLOG(ERROR) << "Failed to write final relative call thunks";
+        result = false;
+      }
+    }
+    return result;
+  }
+
+  bool VisitMethod(size_t class_def_method_index, const ClassDataItemIterator& it)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    OatClass* oat_class = &writer_->oat_classes_[oat_class_index_];
+    const CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
+
+    // No thread suspension since the CodePatcher's dex cache may get invalidated if that occurs.
+    ScopedAssertNoThreadSuspension tsc(__FUNCTION__);
+    if (compiled_method != nullptr) {  // ie. not an abstract method
+      size_t file_offset = file_offset_;
+      OutputStream* out = out_;
+
+      ArrayRef<const uint8_t> quick_code = compiled_method->GetQuickCode();
+      uint32_t code_size = quick_code.size() * sizeof(uint8_t);
+
+      // Deduplicate code arrays. Code from other clusters is written in another pass.
+      const OatMethodOffsets& method_offsets = oat_class->method_offsets_[method_offsets_index_];
+      if (IsInCurrentCluster(oat_class) && method_offsets.code_offset_ > offset_) {
+        offset_ = writer_->relative_patcher_->WriteThunks(out, offset_);
+        if (offset_ == 0u) {
+          ReportWriteFailure("relative call thunk", it);
+          return false;
+        }
+        uint32_t alignment_size = CodeAlignmentSize(offset_, *compiled_method);
+        if (alignment_size != 0) {
+          if (!writer_->WriteCodeAlignment(out, alignment_size)) {
+            ReportWriteFailure("code alignment padding", it);
+            return false;
+          }
+          offset_ += alignment_size;
+          DCHECK_OFFSET_();
+        }
+        DCHECK_ALIGNED_PARAM(offset_ + sizeof(OatQuickMethodHeader),
+                             GetInstructionSetAlignment(compiled_method->GetInstructionSet()));
+        DCHECK_EQ(method_offsets.code_offset_,
+                  offset_ + sizeof(OatQuickMethodHeader) + compiled_method->CodeDelta())
+            << dex_file_->PrettyMethod(it.GetMemberIndex());
+        const OatQuickMethodHeader& method_header =
+            oat_class->method_headers_[method_offsets_index_];
+        if (!out->WriteFully(&method_header, sizeof(method_header))) {
+          ReportWriteFailure("method header", it);
+          return false;
+        }
+        writer_->size_method_header_ += sizeof(method_header);
+        offset_ += sizeof(method_header);
+        DCHECK_OFFSET_();
+
+        PatchedMethod* patched_method = nullptr;
+        if (!compiled_method->GetPatches().empty()) {
+          // The CodePatcher has already applied the patches that do not use the relative
+          // patcher and looked up the targets of the others, apply the rest in code order.
+          patched_method = GetPatchedMethod(compiled_method);
+          std::vector<uint8_t>* patched_code = &patched_method->code;
+          ArrayRef<const LinkerPatch> patches = compiled_method->GetPatches();
+          for (size_t i = 0; i != patches.size(); ++i) {
+            const LinkerPatch& patch = patches[i];
+            uint32_t literal_offset = patch.LiteralOffset();
+            uint32_t target_offset = patched_method->target_offsets[i];
+            switch (patch.GetType()) {
+              case LinkerPatch::Type::kCallRelative: {
+                // NOTE: Relative calls across oat files are not supported.
+                writer_->relative_patcher_->PatchCall(patched_code,
+                                                      literal_offset,
+                                                      offset_ + literal_offset,
+                                                      target_offset);
+                break;
+              }
+              case LinkerPatch::Type::kDexCacheArray:
+              case LinkerPatch::Type::kStringRelative:
+              case LinkerPatch::Type::kStringBssEntry:
+              case LinkerPatch::Type::kTypeRelative:
+              case LinkerPatch::Type::kTypeBssEntry: {
+                writer_->relative_patcher_->PatchPcRelativeReference(patched_code,
+                                                                     patch,
+                                                                     offset_ + literal_offset,
+                                                                     target_offset);
+                break;
+              }
+              case LinkerPatch::Type::kBakerReadBarrierBranch: {
+                writer_->relative_patcher_->PatchBakerReadBarrierBranch(patched_code,
+                                                                        patch,
+                                                                        offset_ + literal_offset);
+                break;
+              }
+              default: {
+                // Already applied by the CodePatcher.
+                break;
+              }
+            }
+          }
+          quick_code = ArrayRef<const uint8_t>(*patched_code);
+        }
+
+        if (!out->WriteFully(quick_code.data(), code_size)) {
+          ReportWriteFailure("method code", it);
+          return false;
+        }
+        writer_->size_code_ += code_size;
+        offset_ += code_size;
+        if (patched_method != nullptr) {
+          // Release the patched code, it is no longer needed.
+          std::vector<uint8_t>().swap(patched_method->code);
+          std::vector<uint32_t>().swap(patched_method->target_offsets);
+        }
+      }
+      DCHECK_OFFSET_();
+      ++method_offsets_index_;
+    }
+
+    return true;
+  }
+
+ private:
+  // Upper bound for the amount of code patched ahead of writing.
+  static constexpr size_t kPatchWindowSize = 16 * MB;
+  // Amount of code to patch in a single PatchCodeTask.
+  static constexpr size_t kPatchTaskSize = 256 * KB;
+
+  OutputStream* const out_;
+  const size_t file_offset_;
+  const ScopedObjectAccess soa_;
+  const ScopedAssertNoThreadSuspension no_thread_suspension_;
+  ThreadPool* const thread_pool_;
+
+  // The PatchedMethods in [next_patched_method_, patched_methods_end_) have been prepared
+  // by the CodePatcher but not yet written.
+  size_t next_patched_method_;
+  size_t patched_methods_end_;
+
+  PatchedMethod* GetPatchedMethod(const CompiledMethod* compiled_method)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (next_patched_method_ == patched_methods_end_) {
+      PatchNextWindow();
+    }
+    DCHECK_LT(next_patched_method_, patched_methods_end_);
+    PatchedMethod* patched_method = &writer_->patched_methods_[next_patched_method_];
+    ++next_patched_method_;
+    // The code is written in the order in which InitCodeMethodVisitor laid it out.
+    DCHECK_EQ(patched_method->compiled_method, compiled_method);
+    return patched_method;
+  }
+
+  // Prepare the code of the next PatchedMethods, up to kPatchWindowSize bytes, in parallel.
+  // Each task works on separate PatchedMethods and the result does not depend on which
+  // thread prepared it, so the output is deterministic.
+  void PatchNextWindow() REQUIRES_SHARED(Locks::mutator_lock_) {
+    TimingLogger::ScopedTiming split("PatchCode", writer_->timings_);
+    Thread* self = Thread::Current();
+    dchecked_vector<PatchedMethod>& patched_methods = writer_->patched_methods_;
+    size_t window_size = 0u;
+    size_t task_begin = next_patched_method_;
+    size_t task_size = 0u;
+    size_t end = next_patched_method_;
+    while (end != patched_methods.size() && window_size < kPatchWindowSize) {
+      size_t code_size = patched_methods[end].compiled_method->GetQuickCode().size();
+      window_size += code_size;
+      task_size += code_size;
+      ++end;
+      if (task_size >= kPatchTaskSize || end == patched_methods.size()) {
+        ArrayRef<PatchedMethod> task_methods =
+            ArrayRef<PatchedMethod>(patched_methods).SubArray(task_begin, end - task_begin);
+        thread_pool_->AddTask(self, new PatchCodeTask(writer_, task_methods));
+        task_begin = end;
+        task_size = 0u;
+      }
+    }
+    if (task_begin != end) {
+      ArrayRef<PatchedMethod> task_methods =
+          ArrayRef<PatchedMethod>(patched_methods).SubArray(task_begin, end - task_begin);
+      thread_pool_->AddTask(self, new PatchCodeTask(writer_, task_methods));
+    }
+    patched_methods_end_ = end;
+    thread_pool_->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  }
+
+  void ReportWriteFailure(const char* what, const ClassDataItemIterator& it) {
+    PLOG(ERROR) << "Failed to write " << what << " for "
+        << dex_file_->PrettyMethod(it.GetMemberIndex()) << " to " << out_->GetLocation();
+  }
+};
+
 class OatWriter::WriteMapMethodVisitor : public OatDexMethodVisitor {
  public:
   WriteMapMethodVisitor(OatWriter* writer,
@@ -1711,6 +1956,31 @@ bool OatWriter::VisitDexMethods(DexMethodVisitor* visitor) {
   return true;
 }
 
+bool OatWriter::VisitDexMethodsInCodeLayoutOrder(CodeLayoutMethodVisitor* visitor) {
+  ArrayRef<const CodeLayoutCluster> clusters = GetCodeLayoutClusters();
+  for (size_t i = 0; i != clusters.size(); ++i) {
+    visitor->StartCluster(clusters[i], /* last_cluster */ i + 1u == clusters.size());
+    if (UNLIKELY(!VisitDexMethods(visitor))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ArrayRef<const OatWriter::CodeLayoutCluster> OatWriter::GetCodeLayoutClusters() const {
+  static constexpr CodeLayoutCluster kClusters[] = {
+      CodeLayoutCluster::kStartup,
+      CodeLayoutCluster::kHot,
+      CodeLayoutCluster::kOther,
+  };
+  ArrayRef<const CodeLayoutCluster> clusters(kClusters);
+  if (compiler_driver_->GetProfileCompilationInfo() == nullptr) {
+    // Without a profile, everything is in the kOther cluster; avoid the extra passes.
+    return clusters.SubArray(/* pos */ arraysize(kClusters) - 1u);
+  }
+  return clusters;
+}
+
 size_t OatWriter::InitOatHeader(InstructionSet instruction_set,
                                 const InstructionSetFeatures* instruction_set_features,
                                 uint32_t num_dex_files,
@@ -1816,11 +2086,31 @@ size_t OatWriter::InitOatCodeDexFiles(size_t offset) {
   if (!compiler_driver_->GetCompilerOptions().IsAnyCompilationEnabled()) {
     return offset;
   }
+  const ProfileCompilationInfo* profile = compiler_driver_->GetProfileCompilationInfo();
+  if (profile != nullptr) {
+    InitCodeLayoutMethodVisitor layout_visitor(this, profile);
+    bool success = VisitDexMethods(&layout_visitor);
+    DCHECK(success);
+    VLOG(compiler) << "Code layout: " << layout_visitor.GetNumStartupMethods()
+        << " startup methods, " << layout_visitor.GetNumHotMethods() << " hot methods";
+  }
+
   InitCodeMethodVisitor code_visitor(this, offset, vdex_quickening_info_offset_);
-  bool success = VisitDexMethods(&code_visitor);
+  bool success = VisitDexMethodsInCodeLayoutOrder(&code_visitor);
   DCHECK(success);
   offset = code_visitor.GetOffset();
 
+  if (GetCodeLayoutClusters().size() != 1u) {
+    // The code was not laid out in definition order. Restore the address order
+    // expected by the .oat_patches encoding and the debug info writers.
+    std::sort(absolute_patch_locations_.begin(), absolute_patch_locations_.end());
+    std::stable_sort(method_info_.begin(),
+                     method_info_.end(),
+                     [](const debug::MethodDebugInfo& lhs, const debug::MethodDebugInfo& rhs) {
+                       return lhs.code_address < rhs.code_address;
+                     });
+  }
+
   if (HasImage()) {
     InitImageMethodVisitor image_visitor(this, offset, dex_files_);
     success = VisitDexMethods(&image_visitor);
@@ -2228,6 +2518,7 @@ bool OatWriter::WriteClasses(OutputStream* out) {
 }
 
 size_t OatWriter::WriteMaps(OutputStream* out, const size_t file_offset, size_t relative_offset) {
+  TimingLogger::ScopedTiming split("WriteMaps", timings_);
   {
     size_t vmap_tables_offset = relative_offset;
     WriteMapMethodVisitor visitor(this, out, file_offset, relative_offset);
@@ -2282,18 +2573,19 @@ size_t OatWriter::WriteCode(OutputStream* out, const size_t file_offset, size_t
 size_t OatWriter::WriteCodeDexFiles(OutputStream* out,
                                     const size_t file_offset,
                                     size_t relative_offset) {
-  #define VISIT(VisitorType)                                              \
-    do {                                                                  \
-      VisitorType visitor(this, out, file_offset, relative_offset);       \
-      if (UNLIKELY(!VisitDexMethods(&visitor))) {                         \
-        return 0;                                                         \
-      }                                                                   \
-      relative_offset = visitor.GetOffset();                              \
-    } while (false)
-
-  VISIT(WriteCodeMethodVisitor);
-
-  #undef VISIT
+  TimingLogger::ScopedTiming split("WriteCodeDexFiles", timings_);
+  // The pool must be created and destroyed without holding the mutator lock.
+  size_t thread_count = compiler_driver_->GetThreadCount();
+  ThreadPool thread_pool("Oat writer thread pool", thread_count > 0u ? thread_count - 1u : 0u);
+  thread_pool.StartWorkers(Thread::Current());
+  {
+    WriteCodeMethodVisitor visitor(this, out, file_offset, relative_offset, &thread_pool);
+    if (UNLIKELY(!VisitDexMethodsInCodeLayoutOrder(&visitor))) {
+      return 0;
+    }
+    relative_offset = visitor.GetOffset();
+  }
+  patched_methods_.clear();
 
   size_code_alignment_ += relative_patcher_->CodeAlignmentSize();
   size_relative_call_thunks_ += relative_patcher_->RelativeCallThunksSize();
@@ -3097,6 +3389,7 @@ OatWriter::OatClass::OatClass(size_t offset,
   status_ = status;
   method_offsets_.resize(num_non_null_compiled_methods);
   method_headers_.resize(num_non_null_compiled_methods);
+  method_clusters_.resize(num_non_null_compiled_methods, CodeLayoutCluster::kOther);
 
   uint32_t oat_method_offsets_offset_from_oat_class = sizeof(type_) + sizeof(status_);
   if (type_ == kOatClassSomeCompiled) {
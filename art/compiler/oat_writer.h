@@ -244,6 +244,15 @@ class OatWriter {
   class OatClass;
   class OatDexFile;
 
+  // Compiled code is laid out in .text in clusters so that the code needed during
+  // startup and the code that is hot according to the profile is densely packed.
+  // The clusters are emitted in declaration order.
+  enum class CodeLayoutCluster : uint8_t {
+    kStartup,  // Profiled methods of classes resolved during startup.
+    kHot,      // Other profiled methods.
+    kOther,    // Everything else.
+  };
+
   // The function VisitDexMethods() below iterates through all the methods in all
   // the compiled dex files in order of their definitions. The method visitor
   // classes provide individual bits of processing for each of the passes we need to
@@ -251,7 +260,9 @@ class OatWriter {
   // to actually write it.
   class DexMethodVisitor;
   class OatDexMethodVisitor;
+  class CodeLayoutMethodVisitor;
   class InitOatClassesMethodVisitor;
+  class InitCodeLayoutMethodVisitor;
   class InitCodeMethodVisitor;
   class InitMapMethodVisitor;
   class InitMethodInfoVisitor;
@@ -261,10 +272,20 @@ class OatWriter {
   class WriteMethodInfoVisitor;
   class WriteQuickeningInfoMethodVisitor;
 
+  // Helpers for preparing the patched code in parallel with the compiler's thread count.
+  struct PatchedMethod;
+  class CodePatcher;
+  class PatchCodeTask;
+
   // Visit all the methods in all the compiled dex files in their definition order
   // with a given DexMethodVisitor.
   bool VisitDexMethods(DexMethodVisitor* visitor);
 
+  // Visit all the methods once for each code layout cluster, in the order in which
+  // the clusters are laid out. Without a profile, all the code is in the kOther cluster.
+  bool VisitDexMethodsInCodeLayoutOrder(CodeLayoutMethodVisitor* visitor);
+  ArrayRef<const CodeLayoutCluster> GetCodeLayoutClusters() const;
+
   // If `update_input_vdex` is true, then this method won't actually write the dex files,
   // and the compiler will just re-use the existing vdex file.
   bool WriteDexFiles(OutputStream* out, File* file, bool update_input_vdex);
@@ -449,6 +470,9 @@ class OatWriter {
   // The locations of absolute patches relative to the start of the executable section.
   dchecked_vector<uintptr_t> absolute_patch_locations_;
 
+  // The compiled methods with linker patches, in the order in which the code is written.
+  dchecked_vector<PatchedMethod> patched_methods_;
+
   // Profile info used to generate new layout of files.
   ProfileCompilationInfo* profile_compilation_info_;
 
@@ -49,6 +49,7 @@
 #include "graph_visualizer.h"
 #include "intern_table.h"
 #include "intrinsics.h"
+#include "jit/jit.h"
 #include "leb128.h"
 #include "mirror/array-inl.h"
 #include "mirror/object_array-inl.h"
@@ -56,6 +57,7 @@
 #include "mirror/reference.h"
 #include "mirror/string.h"
 #include "parallel_move_resolver.h"
+#include "runtime.h"
 #include "ssa_liveness_analysis.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
@@ -298,6 +300,10 @@ void CodeGenerator::InitializeCodeGeneration(size_t number_of_spill_slots,
   block_order_ = &block_order;
   DCHECK(!block_order.empty());
   DCHECK(block_order[0] == GetGraph()->GetEntryBlock());
+  if (GetGraph()->IsCompilingBaseline()) {
+    // Baseline code calls the runtime from its frame entry once hot.
+    MarkNotLeaf();
+  }
   ComputeSpillMask();
   first_register_slot_in_slow_path_ = RoundUp(
       (number_of_out_slots + number_of_spill_slots) * kVRegSize, GetPreferredSlotsAlignment());
@@ -318,6 +324,13 @@ void CodeGenerator::InitializeCodeGeneration(size_t number_of_spill_slots,
   }
 }
 
+uint16_t CodeGenerator::GetBaselineTierUpThreshold() {
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  DCHECK(jit != nullptr);
+  // Counting starts from zero when the baseline code is installed.
+  return std::max<uint16_t>(static_cast<uint16_t>(jit->HotMethodThreshold()), 1u);
+}
+
 void CodeGenerator::CreateCommonInvokeLocationSummary(
     HInvoke* invoke, InvokeDexCallingConventionVisitor* visitor) {
   ArenaAllocator* allocator = invoke->GetBlock()->GetGraph()->GetArena();
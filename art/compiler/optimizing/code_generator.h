@@ -373,6 +373,10 @@ class CodeGenerator : public DeletableArenaObject<kArenaAllocCodeGenerator> {
     return requires_current_method_;
   }
 
+  // The hotness count at which baseline code asks the JIT to compile its method with the
+  // optimizing tier. Baseline code counts its invocations up to this value and stops there.
+  static uint16_t GetBaselineTierUpThreshold();
+
   // Clears the spill slots taken by loop phis in the `LocationSummary` of the
   // suspend check. This is called when the code generator generates code
   // for the suspend check at the back edge (instead of where the suspend check
@@ -326,6 +326,26 @@ class SuspendCheckSlowPathARM : public SlowPathCodeARM {
   DISALLOW_COPY_AND_ASSIGN(SuspendCheckSlowPathARM);
 };
 
+class CompileOptimizedSlowPathARM : public SlowPathCodeARM {
+ public:
+  CompileOptimizedSlowPathARM() : SlowPathCodeARM(/* instruction */ nullptr) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    CodeGeneratorARM* arm_codegen = down_cast<CodeGeneratorARM*>(codegen);
+    __ Bind(GetEntryLabel());
+    // The entrypoint saves every register, so the arguments of the method survive the call.
+    arm_codegen->GenerateInvokeRuntime(
+        GetThreadOffset<kArmPointerSize>(kQuickCompileOptimized).Int32Value());
+    CheckEntrypointTypes<kQuickCompileOptimized, void, void>();
+    __ b(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "CompileOptimizedSlowPathARM"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathARM);
+};
+
 class BoundsCheckSlowPathARM : public SlowPathCodeARM {
  public:
   explicit BoundsCheckSlowPathARM(HBoundsCheck* instruction)
@@ -2101,6 +2121,24 @@ void CodeGeneratorARM::GenerateFrameEntry() {
   if (RequiresCurrentMethod()) {
     __ StoreToOffset(kStoreWord, kMethodRegisterArgument, SP, 0);
   }
+
+  if (GetGraph()->IsCompilingBaseline()) {
+    // Count the invocations up to the tier-up threshold and ask the JIT to compile the method
+    // with the optimizing tier when reaching it. The count stays at the threshold afterwards.
+    // LR has been saved above and is free to hold the threshold.
+    SlowPathCodeARM* slow_path = new (GetGraph()->GetArena()) CompileOptimizedSlowPathARM();
+    AddSlowPath(slow_path);
+    int32_t hotness_offset = ArtMethod::HotnessCountOffset().Int32Value();
+    __ LoadFromOffset(kLoadUnsignedHalfword, IP, kMethodRegisterArgument, hotness_offset);
+    __ LoadImmediate(LR, GetBaselineTierUpThreshold());
+    __ cmp(IP, ShifterOperand(LR));
+    __ b(slow_path->GetExitLabel(), HS);
+    __ add(IP, IP, ShifterOperand(1));
+    __ StoreToOffset(kStoreHalfword, IP, kMethodRegisterArgument, hotness_offset);
+    __ cmp(IP, ShifterOperand(LR));
+    __ b(slow_path->GetEntryLabel(), EQ);
+    __ Bind(slow_path->GetExitLabel());
+  }
 }
 
 void CodeGeneratorARM::GenerateFrameExit() {
@@ -523,6 +523,27 @@ class SuspendCheckSlowPathARM64 : public SlowPathCodeARM64 {
   DISALLOW_COPY_AND_ASSIGN(SuspendCheckSlowPathARM64);
 };
 
+class CompileOptimizedSlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  CompileOptimizedSlowPathARM64() : SlowPathCodeARM64(/* instruction */ nullptr) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    __ Bind(GetEntryLabel());
+    // The entrypoint saves every register, so the arguments of the method survive the call.
+    int32_t entry_point_offset =
+        GetThreadOffset<kArm64PointerSize>(kQuickCompileOptimized).Int32Value();
+    __ Ldr(lr, MemOperand(tr, entry_point_offset));
+    __ Blr(lr);
+    CheckEntrypointTypes<kQuickCompileOptimized, void, void>();
+    __ B(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "CompileOptimizedSlowPathARM64"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathARM64);
+};
+
 class TypeCheckSlowPathARM64 : public SlowPathCodeARM64 {
  public:
   TypeCheckSlowPathARM64(HInstruction* instruction, bool is_fatal)
@@ -1575,6 +1596,26 @@ void CodeGeneratorARM64::GenerateFrameEntry() {
       __ Str(wzr, MemOperand(sp, GetStackOffsetOfShouldDeoptimizeFlag()));
     }
   }
+
+  if (GetGraph()->IsCompilingBaseline()) {
+    DCHECK(!HasEmptyFrame());
+    // Count the invocations up to the tier-up threshold and ask the JIT to compile the method
+    // with the optimizing tier when reaching it. The count stays at the threshold afterwards.
+    SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena()) CompileOptimizedSlowPathARM64();
+    AddSlowPath(slow_path);
+    UseScratchRegisterScope temps(masm);
+    Register counter = temps.AcquireW();
+    MemOperand hotness(kArtMethodRegister, ArtMethod::HotnessCountOffset().Int32Value());
+    uint16_t threshold = GetBaselineTierUpThreshold();
+    __ Ldrh(counter, hotness);
+    __ Cmp(counter, threshold);
+    __ B(hs, slow_path->GetExitLabel());
+    __ Add(counter, counter, 1);
+    __ Strh(counter, hotness);
+    __ Cmp(counter, threshold);
+    __ B(eq, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
 }
 
 void CodeGeneratorARM64::GenerateFrameExit() {
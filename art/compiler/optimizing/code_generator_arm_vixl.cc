@@ -353,6 +353,27 @@ class SuspendCheckSlowPathARMVIXL : public SlowPathCodeARMVIXL {
   DISALLOW_COPY_AND_ASSIGN(SuspendCheckSlowPathARMVIXL);
 };
 
+class CompileOptimizedSlowPathARMVIXL : public SlowPathCodeARMVIXL {
+ public:
+  CompileOptimizedSlowPathARMVIXL() : SlowPathCodeARMVIXL(/* instruction */ nullptr) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    __ Bind(GetEntryLabel());
+    // The entrypoint saves every register, so the arguments of the method survive the call.
+    int32_t entry_point_offset =
+        GetThreadOffset<kArmPointerSize>(kQuickCompileOptimized).Int32Value();
+    __ Ldr(lr, MemOperand(tr, entry_point_offset));
+    __ Blx(lr);
+    CheckEntrypointTypes<kQuickCompileOptimized, void, void>();
+    __ B(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "CompileOptimizedSlowPathARMVIXL"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathARMVIXL);
+};
+
 class BoundsCheckSlowPathARMVIXL : public SlowPathCodeARMVIXL {
  public:
   explicit BoundsCheckSlowPathARMVIXL(HBoundsCheck* instruction)
@@ -2188,6 +2209,27 @@ void CodeGeneratorARMVIXL::GenerateFrameEntry() {
   if (RequiresCurrentMethod()) {
     GetAssembler()->StoreToOffset(kStoreWord, kMethodRegister, sp, 0);
   }
+
+  if (GetGraph()->IsCompilingBaseline()) {
+    // Count the invocations up to the tier-up threshold and ask the JIT to compile the method
+    // with the optimizing tier when reaching it. The count stays at the threshold afterwards.
+    // LR has been saved above and is free to hold the threshold.
+    SlowPathCodeARMVIXL* slow_path =
+        new (GetGraph()->GetArena()) CompileOptimizedSlowPathARMVIXL();
+    AddSlowPath(slow_path);
+    UseScratchRegisterScope temps(GetVIXLAssembler());
+    vixl32::Register counter = temps.Acquire();
+    MemOperand hotness(kMethodRegister, ArtMethod::HotnessCountOffset().Int32Value());
+    __ Ldrh(counter, hotness);
+    __ Mov(lr, GetBaselineTierUpThreshold());
+    __ Cmp(counter, lr);
+    __ B(hs, slow_path->GetExitLabel());
+    __ Add(counter, counter, 1);
+    __ Strh(counter, hotness);
+    __ Cmp(counter, lr);
+    __ B(eq, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
 }
 
 void CodeGeneratorARMVIXL::GenerateFrameExit() {
@@ -30,6 +30,14 @@ void InstructionCodeGeneratorARM::VisitVecReplicateScalar(HVecReplicateScalar* i
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
 
+void LocationsBuilderARM::VisitVecExtractScalar(HVecExtractScalar* instruction) {
+  LOG(FATAL) << "No SIMD for " << instruction->GetId();
+}
+
+void InstructionCodeGeneratorARM::VisitVecExtractScalar(HVecExtractScalar* instruction) {
+  LOG(FATAL) << "No SIMD for " << instruction->GetId();
+}
+
 void LocationsBuilderARM::VisitVecSetScalars(HVecSetScalars* instruction) {
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
@@ -38,11 +46,11 @@ void InstructionCodeGeneratorARM::VisitVecSetScalars(HVecSetScalars* instruction
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
 
-void LocationsBuilderARM::VisitVecSumReduce(HVecSumReduce* instruction) {
+void LocationsBuilderARM::VisitVecReduce(HVecReduce* instruction) {
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
 
-void InstructionCodeGeneratorARM::VisitVecSumReduce(HVecSumReduce* instruction) {
+void InstructionCodeGeneratorARM::VisitVecReduce(HVecReduce* instruction) {
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
 
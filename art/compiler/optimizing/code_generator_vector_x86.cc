@@ -98,6 +98,14 @@ void InstructionCodeGeneratorX86::VisitVecReplicateScalar(HVecReplicateScalar* i
   }
 }
 
+void LocationsBuilderX86::VisitVecExtractScalar(HVecExtractScalar* instruction) {
+  LOG(FATAL) << "No SIMD for " << instruction->GetId();
+}
+
+void InstructionCodeGeneratorX86::VisitVecExtractScalar(HVecExtractScalar* instruction) {
+  LOG(FATAL) << "No SIMD for " << instruction->GetId();
+}
+
 void LocationsBuilderX86::VisitVecSetScalars(HVecSetScalars* instruction) {
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
@@ -106,11 +114,11 @@ void InstructionCodeGeneratorX86::VisitVecSetScalars(HVecSetScalars* instruction
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
 
-void LocationsBuilderX86::VisitVecSumReduce(HVecSumReduce* instruction) {
+void LocationsBuilderX86::VisitVecReduce(HVecReduce* instruction) {
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
 
-void InstructionCodeGeneratorX86::VisitVecSumReduce(HVecSumReduce* instruction) {
+void InstructionCodeGeneratorX86::VisitVecReduce(HVecReduce* instruction) {
   LOG(FATAL) << "No SIMD for " << instruction->GetId();
 }
 
@@ -215,6 +215,26 @@ class SuspendCheckSlowPathX86 : public SlowPathCode {
   DISALLOW_COPY_AND_ASSIGN(SuspendCheckSlowPathX86);
 };
 
+class CompileOptimizedSlowPathX86 : public SlowPathCode {
+ public:
+  CompileOptimizedSlowPathX86() : SlowPathCode(/* instruction */ nullptr) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    CodeGeneratorX86* x86_codegen = down_cast<CodeGeneratorX86*>(codegen);
+    __ Bind(GetEntryLabel());
+    // The entrypoint saves every register, so the arguments of the method survive the call.
+    x86_codegen->GenerateInvokeRuntime(
+        GetThreadOffset<kX86PointerSize>(kQuickCompileOptimized).Int32Value());
+    CheckEntrypointTypes<kQuickCompileOptimized, void, void>();
+    __ jmp(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "CompileOptimizedSlowPathX86"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathX86);
+};
+
 class LoadStringSlowPathX86 : public SlowPathCode {
  public:
   explicit LoadStringSlowPathX86(HLoadString* instruction): SlowPathCode(instruction) {}
@@ -1098,6 +1118,21 @@ void CodeGeneratorX86::GenerateFrameEntry() {
   if (RequiresCurrentMethod()) {
     __ movl(Address(ESP, kCurrentMethodStackOffset), kMethodRegisterArgument);
   }
+
+  if (GetGraph()->IsCompilingBaseline()) {
+    // Count the invocations up to the tier-up threshold and ask the JIT to compile the method
+    // with the optimizing tier when reaching it. The count stays at the threshold afterwards.
+    SlowPathCode* slow_path = new (GetGraph()->GetArena()) CompileOptimizedSlowPathX86();
+    AddSlowPath(slow_path);
+    Address hotness(kMethodRegisterArgument, ArtMethod::HotnessCountOffset().Int32Value());
+    Immediate threshold(GetBaselineTierUpThreshold());
+    __ cmpw(hotness, threshold);
+    __ j(kAboveEqual, slow_path->GetExitLabel());
+    __ addw(hotness, Immediate(1));
+    __ cmpw(hotness, threshold);
+    __ j(kEqual, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
 }
 
 void CodeGeneratorX86::GenerateFrameExit() {
@@ -172,6 +172,26 @@ class SuspendCheckSlowPathX86_64 : public SlowPathCode {
   DISALLOW_COPY_AND_ASSIGN(SuspendCheckSlowPathX86_64);
 };
 
+class CompileOptimizedSlowPathX86_64 : public SlowPathCode {
+ public:
+  CompileOptimizedSlowPathX86_64() : SlowPathCode(/* instruction */ nullptr) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    CodeGeneratorX86_64* x86_64_codegen = down_cast<CodeGeneratorX86_64*>(codegen);
+    __ Bind(GetEntryLabel());
+    // The entrypoint saves every register, so the arguments of the method survive the call.
+    x86_64_codegen->GenerateInvokeRuntime(
+        GetThreadOffset<kX86_64PointerSize>(kQuickCompileOptimized).Int32Value());
+    CheckEntrypointTypes<kQuickCompileOptimized, void, void>();
+    __ jmp(GetExitLabel());
+  }
+
+  const char* GetDescription() const OVERRIDE { return "CompileOptimizedSlowPathX86_64"; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CompileOptimizedSlowPathX86_64);
+};
+
 class BoundsCheckSlowPathX86_64 : public SlowPathCode {
  public:
   explicit BoundsCheckSlowPathX86_64(HBoundsCheck* instruction)
@@ -1316,6 +1336,22 @@ void CodeGeneratorX86_64::GenerateFrameEntry() {
     __ movq(Address(CpuRegister(RSP), kCurrentMethodStackOffset),
             CpuRegister(kMethodRegisterArgument));
   }
+
+  if (GetGraph()->IsCompilingBaseline()) {
+    // Count the invocations up to the tier-up threshold and ask the JIT to compile the method
+    // with the optimizing tier when reaching it. The count stays at the threshold afterwards.
+    SlowPathCode* slow_path = new (GetGraph()->GetArena()) CompileOptimizedSlowPathX86_64();
+    AddSlowPath(slow_path);
+    Address hotness(CpuRegister(kMethodRegisterArgument),
+                    ArtMethod::HotnessCountOffset().Int32Value());
+    Immediate threshold(GetBaselineTierUpThreshold());
+    __ cmpw(hotness, threshold);
+    __ j(kAboveEqual, slow_path->GetExitLabel());
+    __ addw(hotness, Immediate(1));
+    __ cmpw(hotness, threshold);
+    __ j(kEqual, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
 }
 
 void CodeGeneratorX86_64::GenerateFrameExit() {
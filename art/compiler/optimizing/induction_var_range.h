@@ -150,6 +150,15 @@ class InductionVarRange {
     return induction_analysis_->LookupCycle(phi);
   }
 
+  /**
+   * Checks if the given phi is classified by induction variable analysis, i.e. whether
+   * any induction information is associated with the phi in its loop.
+   */
+  bool IsClassified(HPhi* phi) const {
+    HLoopInformation* loop = phi->GetBlock()->GetLoopInformation();
+    return loop != nullptr && induction_analysis_->LookupInfo(loop, phi) != nullptr;
+  }
+
   /**
    * Checks if header logic of a loop terminates. Sets trip-count tc if known.
    */
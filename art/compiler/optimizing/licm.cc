@@ -16,6 +16,7 @@
 
 #include "licm.h"
 
+#include "load_store_analysis.h"
 #include "side_effects_analysis.h"
 
 namespace art {
@@ -78,8 +79,83 @@ static void UpdateLoopPhisIn(HEnvironment* environment, HLoopInformation* info)
   }
 }
 
+static bool IsHeapLoad(HInstruction* instruction) {
+  return instruction->IsInstanceFieldGet() ||
+         instruction->IsStaticFieldGet() ||
+         instruction->IsArrayGet();
+}
+
+/**
+ * Collects in `stored_locations` the heap locations written inside the loop `info`.
+ * Returns false if the loop has a write that is not a store to a known heap
+ * location, such as an invoke, a monitor operation or a volatile store.
+ */
+static bool CollectStoredLocations(HLoopInformation* info,
+                                   const HeapLocationCollector& heap_location_collector,
+                                   ArenaBitVector* stored_locations) {
+  stored_locations->ClearAllBits();
+  for (HBlocksInLoopIterator it_loop(*info); !it_loop.Done(); it_loop.Advance()) {
+    for (HInstructionIterator inst_it(it_loop.Current()->GetInstructions());
+         !inst_it.Done();
+         inst_it.Advance()) {
+      HInstruction* instruction = inst_it.Current();
+      if (!instruction->DoesAnyWrite()) {
+        continue;
+      }
+      if ((instruction->IsInstanceFieldSet() &&
+           !instruction->AsInstanceFieldSet()->GetFieldInfo().IsVolatile()) ||
+          (instruction->IsStaticFieldSet() &&
+           !instruction->AsStaticFieldSet()->GetFieldInfo().IsVolatile()) ||
+          instruction->IsArraySet()) {
+        size_t location = heap_location_collector.FindHeapLocationIndexOf(instruction);
+        if (location != HeapLocationCollector::kHeapLocationNotFound) {
+          stored_locations->SetBit(location);
+          continue;
+        }
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns whether the heap location read by `load` is not written by any of the
+ * `stored_locations`, i.e. whether `load` is invariant in the loop they were collected for.
+ */
+static bool IsLoadOfUnmodifiedLocation(HInstruction* load,
+                                       const HeapLocationCollector& heap_location_collector,
+                                       const ArenaBitVector* stored_locations) {
+  DCHECK(IsHeapLoad(load));
+  size_t location = heap_location_collector.FindHeapLocationIndexOf(load);
+  if (location == HeapLocationCollector::kHeapLocationNotFound) {
+    return false;
+  }
+  for (uint32_t stored_location : stored_locations->Indexes()) {
+    if (stored_location == location ||
+        heap_location_collector.MayAlias(stored_location, location)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void LICM::Run() {
   DCHECK(side_effects_.HasRun());
+  DCHECK(lsa_.HasRun());
+
+  // Loads that the side effects analysis considers killed by the loop can still be
+  // hoisted if the heap location analysis proves that no store of the loop writes
+  // their location.
+  const HeapLocationCollector& heap_location_collector = lsa_.GetHeapLocationCollector();
+  size_t number_of_heap_locations = heap_location_collector.GetNumberOfHeapLocations();
+  ArenaBitVector* stored_locations = nullptr;
+  if (number_of_heap_locations != 0) {
+    stored_locations = new (graph_->GetArena()) ArenaBitVector(graph_->GetArena(),
+                                                               number_of_heap_locations,
+                                                               false,
+                                                               kArenaAllocLICM);
+  }
 
   // Only used during debug.
   ArenaBitVector* visited = nullptr;
@@ -100,6 +176,10 @@ void LICM::Run() {
     HLoopInformation* loop_info = block->GetLoopInformation();
     SideEffects loop_effects = side_effects_.GetLoopEffects(block);
     HBasicBlock* pre_header = loop_info->GetPreHeader();
+    bool has_known_stores_only = stored_locations != nullptr &&
+        loop_effects.DoesAnyWrite() &&
+        !loop_info->ContainsIrreducibleLoop() &&
+        CollectStoredLocations(loop_info, heap_location_collector, stored_locations);
 
     for (HBlocksInLoopIterator it_loop(*loop_info); !it_loop.Done(); it_loop.Advance()) {
       HBasicBlock* inner = it_loop.Current();
@@ -129,9 +209,15 @@ void LICM::Run() {
            !inst_it.Done();
            inst_it.Advance()) {
         HInstruction* instruction = inst_it.Current();
+        bool is_heap_load = IsHeapLoad(instruction);
         if (instruction->CanBeMoved()
             && (!instruction->CanThrow() || !found_first_non_hoisted_visible_instruction_in_loop)
-            && !instruction->GetSideEffects().MayDependOn(loop_effects)
+            && (!instruction->GetSideEffects().MayDependOn(loop_effects)
+                || (is_heap_load
+                    && has_known_stores_only
+                    && IsLoadOfUnmodifiedLocation(instruction,
+                                                  heap_location_collector,
+                                                  stored_locations)))
             && InputsAreDefinedBeforeLoop(instruction)) {
           // We need to update the environment if the instruction has a loop header
           // phi in it.
@@ -142,6 +228,9 @@ void LICM::Run() {
           }
           instruction->MoveBefore(pre_header->GetLastInstruction());
           MaybeRecordStat(MethodCompilationStat::kLoopInvariantMoved);
+          if (is_heap_load) {
+            MaybeRecordStat(MethodCompilationStat::kLoopInvariantLoadMoved);
+          }
         } else if (instruction->CanThrow() || instruction->DoesAnyWrite()) {
           // If `instruction` can do something visible (throw or write),
           // we cannot move further instructions that can throw.
@@ -22,13 +22,18 @@
 
 namespace art {
 
+class LoadStoreAnalysis;
 class SideEffectsAnalysis;
 
 class LICM : public HOptimization {
  public:
-  LICM(HGraph* graph, const SideEffectsAnalysis& side_effects, OptimizingCompilerStats* stats)
+  LICM(HGraph* graph,
+       const SideEffectsAnalysis& side_effects,
+       const LoadStoreAnalysis& lsa,
+       OptimizingCompilerStats* stats)
       : HOptimization(graph, kLoopInvariantCodeMotionPassName, stats),
-        side_effects_(side_effects) {}
+        side_effects_(side_effects),
+        lsa_(lsa) {}
 
   void Run() OVERRIDE;
 
@@ -36,6 +41,7 @@ class LICM : public HOptimization {
 
  private:
   const SideEffectsAnalysis& side_effects_;
+  const LoadStoreAnalysis& lsa_;
 
   DISALLOW_COPY_AND_ASSIGN(LICM);
 };
@@ -17,6 +17,7 @@
 #include "base/arena_allocator.h"
 #include "builder.h"
 #include "licm.h"
+#include "load_store_analysis.h"
 #include "nodes.h"
 #include "optimizing_unit_test.h"
 #include "side_effects_analysis.h"
@@ -93,7 +94,9 @@ class LICMTest : public CommonCompilerTest {
     graph_->BuildDominatorTree();
     SideEffectsAnalysis side_effects(graph_);
     side_effects.Run();
-    LICM(graph_, side_effects, nullptr).Run();
+    LoadStoreAnalysis lsa(graph_);
+    lsa.Run();
+    LICM(graph_, side_effects, lsa, nullptr).Run();
   }
 
   // General building fields.
@@ -178,6 +181,78 @@ TEST_F(LICMTest, NoFieldHoisting) {
   EXPECT_EQ(set_field->GetBlock(), loop_body_);
 }
 
+TEST_F(LICMTest, FieldHoistingWithStoreToOtherField) {
+  BuildLoop();
+
+  // Populate the loop with instructions: set/get different fields with same types.
+  HInstruction* get_field = new (&allocator_) HInstanceFieldGet(parameter_,
+                                                                nullptr,
+                                                                Primitive::kPrimLong,
+                                                                MemberOffset(10),
+                                                                false,
+                                                                kUnknownFieldIndex,
+                                                                kUnknownClassDefIndex,
+                                                                graph_->GetDexFile(),
+                                                                0);
+  loop_body_->InsertInstructionBefore(get_field, loop_body_->GetLastInstruction());
+  HInstruction* set_field = new (&allocator_) HInstanceFieldSet(parameter_,
+                                                                get_field,
+                                                                nullptr,
+                                                                Primitive::kPrimLong,
+                                                                MemberOffset(20),
+                                                                false,
+                                                                kUnknownFieldIndex,
+                                                                kUnknownClassDefIndex,
+                                                                graph_->GetDexFile(),
+                                                                0);
+  loop_body_->InsertInstructionBefore(set_field, loop_body_->GetLastInstruction());
+
+  EXPECT_EQ(get_field->GetBlock(), loop_body_);
+  EXPECT_EQ(set_field->GetBlock(), loop_body_);
+  PerformLICM();
+  EXPECT_EQ(get_field->GetBlock(), loop_preheader_);
+  EXPECT_EQ(set_field->GetBlock(), loop_body_);
+}
+
+TEST_F(LICMTest, NoFieldHoistingWithInvoke) {
+  BuildLoop();
+
+  // Populate the loop with instructions: get field and an invoke that may write it.
+  HInstruction* get_field = new (&allocator_) HInstanceFieldGet(parameter_,
+                                                                nullptr,
+                                                                Primitive::kPrimLong,
+                                                                MemberOffset(10),
+                                                                false,
+                                                                kUnknownFieldIndex,
+                                                                kUnknownClassDefIndex,
+                                                                graph_->GetDexFile(),
+                                                                0);
+  loop_body_->InsertInstructionBefore(get_field, loop_body_->GetLastInstruction());
+  HInstruction* set_field = new (&allocator_) HInstanceFieldSet(parameter_,
+                                                                get_field,
+                                                                nullptr,
+                                                                Primitive::kPrimLong,
+                                                                MemberOffset(20),
+                                                                false,
+                                                                kUnknownFieldIndex,
+                                                                kUnknownClassDefIndex,
+                                                                graph_->GetDexFile(),
+                                                                0);
+  loop_body_->InsertInstructionBefore(set_field, loop_body_->GetLastInstruction());
+  HInstruction* invoke = new (&allocator_) HInvokeUnresolved(&allocator_,
+                                                             /* number_of_arguments */ 0,
+                                                             Primitive::kPrimVoid,
+                                                             /* dex_pc */ 0,
+                                                             /* dex_method_index */ 0,
+                                                             kVirtual);
+  loop_body_->InsertInstructionBefore(invoke, loop_body_->GetLastInstruction());
+
+  EXPECT_EQ(get_field->GetBlock(), loop_body_);
+  PerformLICM();
+  EXPECT_EQ(get_field->GetBlock(), loop_body_);
+  EXPECT_EQ(set_field->GetBlock(), loop_body_);
+}
+
 TEST_F(LICMTest, ArrayHoisting) {
   BuildLoop();
 
@@ -196,6 +271,24 @@ TEST_F(LICMTest, ArrayHoisting) {
   EXPECT_EQ(set_array->GetBlock(), loop_body_);
 }
 
+TEST_F(LICMTest, ArrayHoistingWithStoreToOtherElement) {
+  BuildLoop();
+
+  // Populate the loop with instructions: set/get different constant elements with same types.
+  HInstruction* get_array = new (&allocator_) HArrayGet(
+      parameter_, graph_->GetIntConstant(0), Primitive::kPrimFloat, 0);
+  loop_body_->InsertInstructionBefore(get_array, loop_body_->GetLastInstruction());
+  HInstruction* set_array = new (&allocator_) HArraySet(
+      parameter_, graph_->GetIntConstant(1), get_array, Primitive::kPrimFloat, 0);
+  loop_body_->InsertInstructionBefore(set_array, loop_body_->GetLastInstruction());
+
+  EXPECT_EQ(get_array->GetBlock(), loop_body_);
+  EXPECT_EQ(set_array->GetBlock(), loop_body_);
+  PerformLICM();
+  EXPECT_EQ(get_array->GetBlock(), loop_preheader_);
+  EXPECT_EQ(set_array->GetBlock(), loop_body_);
+}
+
 TEST_F(LICMTest, NoArrayHoisting) {
   BuildLoop();
 
@@ -46,6 +46,18 @@ void HGraph::InitializeInexactObjectRTI(VariableSizedHandleScope* handles) {
       /* is_exact */ false);
 }
 
+size_t HGraph::CountNumberOfInstructions() {
+  size_t number_of_instructions = 0;
+  for (HBasicBlock* block : GetReversePostOrderSkipEntryBlock()) {
+    for (HInstructionIterator instr_it(block->GetInstructions());
+         !instr_it.Done();
+         instr_it.Advance()) {
+      ++number_of_instructions;
+    }
+  }
+  return number_of_instructions;
+}
+
 void HGraph::AddBlock(HBasicBlock* block) {
   block->SetBlockId(blocks_.size());
   blocks_.push_back(block);
@@ -1338,6 +1350,20 @@ std::ostream& operator<<(std::ostream& os, const ComparisonBias& rhs) {
   }
 }
 
+std::ostream& operator<<(std::ostream& os, HVecReduce::ReductionKind rhs) {
+  switch (rhs) {
+    case HVecReduce::kSum:
+      return os << "sum";
+    case HVecReduce::kMin:
+      return os << "min";
+    case HVecReduce::kMax:
+      return os << "max";
+    default:
+      LOG(FATAL) << "Unknown ReductionKind: " << static_cast<int>(rhs);
+      UNREACHABLE();
+  }
+}
+
 bool HCondition::IsBeforeWhenDisregardMoves(HInstruction* instruction) const {
   return this == instruction->GetPreviousDisregardingMoves();
 }
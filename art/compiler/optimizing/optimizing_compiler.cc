@@ -81,8 +81,10 @@
 #include "jit/debugger_interface.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
+#include "jit/profile_compilation_info.h"
 #include "jni/quick/jni_compiler.h"
 #include "licm.h"
+#include "load_store_analysis.h"
 #include "load_store_elimination.h"
 #include "loop_optimization.h"
 #include "nodes.h"
@@ -338,7 +340,11 @@ class OptimizingCompiler FINAL : public Compiler {
     }
   }
 
-  bool JitCompile(Thread* self, jit::JitCodeCache* code_cache, ArtMethod* method, bool osr)
+  bool JitCompile(Thread* self,
+                  jit::JitCodeCache* code_cache,
+                  ArtMethod* method,
+                  bool osr,
+                  bool baseline)
       OVERRIDE
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -350,6 +356,14 @@ class OptimizingCompiler FINAL : public Compiler {
                         PassObserver* pass_observer,
                         VariableSizedHandleScope* handles) const;
 
+  // Run only the passes the code generators depend on, for the JIT baseline tier.
+  void RunBaselineOptimizations(HGraph* graph,
+                                CodeGenerator* codegen,
+                                CompilerDriver* driver,
+                                const DexCompilationUnit& dex_compilation_unit,
+                                PassObserver* pass_observer,
+                                VariableSizedHandleScope* handles) const;
+
   void RunOptimizations(HOptimization* optimizations[],
                         size_t length,
                         PassObserver* pass_observer) const;
@@ -367,7 +381,8 @@ class OptimizingCompiler FINAL : public Compiler {
   // This method:
   // 1) Builds the graph. Returns null if it failed to build it.
   // 2) Transforms the graph to SSA. Returns null if it failed.
-  // 3) Runs optimizations on the graph, including register allocator.
+  // 3) Runs optimizations on the graph, including register allocator. A `baseline`
+  //    compilation only runs the passes required by the code generator.
   // 4) Generates code with the `code_allocator` provided.
   CodeGenerator* TryCompile(ArenaAllocator* arena,
                             CodeVectorAllocator* code_allocator,
@@ -381,6 +396,7 @@ class OptimizingCompiler FINAL : public Compiler {
                             Handle<mirror::DexCache> dex_cache,
                             ArtMethod* method,
                             bool osr,
+                            bool baseline,
                             VariableSizedHandleScope* handles) const;
 
   void MaybeRunInliner(HGraph* graph,
@@ -390,10 +406,12 @@ class OptimizingCompiler FINAL : public Compiler {
                        PassObserver* pass_observer,
                        VariableSizedHandleScope* handles) const;
 
+  // With `baseline`, only the fixups the code generators rely on are run.
   void RunArchOptimizations(InstructionSet instruction_set,
                             HGraph* graph,
                             CodeGenerator* codegen,
-                            PassObserver* pass_observer) const;
+                            PassObserver* pass_observer,
+                            bool baseline) const;
 
   std::unique_ptr<OptimizingCompilerStats> compilation_stats_;
 
@@ -465,7 +483,8 @@ static HOptimization* BuildOptimization(
     const DexCompilationUnit& dex_compilation_unit,
     VariableSizedHandleScope* handles,
     SideEffectsAnalysis* most_recent_side_effects,
-    HInductionVarAnalysis* most_recent_induction) {
+    HInductionVarAnalysis* most_recent_induction,
+    LoadStoreAnalysis* most_recent_lsa) {
   std::string opt_name = ConvertPassNameToOptimizationName(pass_name);
   if (opt_name == BoundsCheckElimination::kBoundsCheckEliminationPassName) {
     CHECK(most_recent_side_effects != nullptr && most_recent_induction != nullptr);
@@ -503,11 +522,13 @@ static HOptimization* BuildOptimization(
   } else if (opt_name == IntrinsicsRecognizer::kIntrinsicsRecognizerPassName) {
     return new (arena) IntrinsicsRecognizer(graph, stats);
   } else if (opt_name == LICM::kLoopInvariantCodeMotionPassName) {
-    CHECK(most_recent_side_effects != nullptr);
-    return new (arena) LICM(graph, *most_recent_side_effects, stats);
+    CHECK(most_recent_side_effects != nullptr && most_recent_lsa != nullptr);
+    return new (arena) LICM(graph, *most_recent_side_effects, *most_recent_lsa, stats);
+  } else if (opt_name == LoadStoreAnalysis::kLoadStoreAnalysisPassName) {
+    return new (arena) LoadStoreAnalysis(graph);
   } else if (opt_name == LoadStoreElimination::kLoadStoreEliminationPassName) {
-    CHECK(most_recent_side_effects != nullptr);
-    return new (arena) LoadStoreElimination(graph, *most_recent_side_effects);
+    CHECK(most_recent_side_effects != nullptr && most_recent_lsa != nullptr);
+    return new (arena) LoadStoreElimination(graph, *most_recent_side_effects, *most_recent_lsa);
   } else if (opt_name == SideEffectsAnalysis::kSideEffectsAnalysisPassName) {
     return new (arena) SideEffectsAnalysis(graph);
   } else if (opt_name == HLoopOptimization::kLoopOptimizationPassName) {
@@ -551,11 +572,12 @@ static ArenaVector<HOptimization*> BuildOptimizations(
     CompilerDriver* driver,
     const DexCompilationUnit& dex_compilation_unit,
     VariableSizedHandleScope* handles) {
-  // Few HOptimizations constructors require SideEffectsAnalysis or HInductionVarAnalysis
-  // instances. This method assumes that each of them expects the nearest instance preceeding it
-  // in the pass name list.
+  // Few HOptimizations constructors require SideEffectsAnalysis, HInductionVarAnalysis or
+  // LoadStoreAnalysis instances. This method assumes that each of them expects the nearest
+  // instance preceeding it in the pass name list.
   SideEffectsAnalysis* most_recent_side_effects = nullptr;
   HInductionVarAnalysis* most_recent_induction = nullptr;
+  LoadStoreAnalysis* most_recent_lsa = nullptr;
   ArenaVector<HOptimization*> ret(arena->Adapter());
   for (const std::string& pass_name : pass_names) {
     HOptimization* opt = BuildOptimization(
@@ -568,7 +590,8 @@ static ArenaVector<HOptimization*> BuildOptimizations(
         dex_compilation_unit,
         handles,
         most_recent_side_effects,
-        most_recent_induction);
+        most_recent_induction,
+        most_recent_lsa);
     CHECK(opt != nullptr) << "Couldn't build optimization: \"" << pass_name << "\"";
     ret.push_back(opt);
 
@@ -577,6 +600,8 @@ static ArenaVector<HOptimization*> BuildOptimizations(
       most_recent_side_effects = down_cast<SideEffectsAnalysis*>(opt);
     } else if (opt_name == HInductionVarAnalysis::kInductionPassName) {
       most_recent_induction = down_cast<HInductionVarAnalysis*>(opt);
+    } else if (opt_name == LoadStoreAnalysis::kLoadStoreAnalysisPassName) {
+      most_recent_lsa = down_cast<LoadStoreAnalysis*>(opt);
     }
   }
   return ret;
@@ -624,7 +649,8 @@ void OptimizingCompiler::MaybeRunInliner(HGraph* graph,
 void OptimizingCompiler::RunArchOptimizations(InstructionSet instruction_set,
                                               HGraph* graph,
                                               CodeGenerator* codegen,
-                                              PassObserver* pass_observer) const {
+                                              PassObserver* pass_observer,
+                                              bool baseline) const {
   UNUSED(codegen);  // To avoid compilation error when compiling for svelte
   OptimizingCompilerStats* stats = compilation_stats_.get();
   ArenaAllocator* arena = graph->GetArena();
@@ -634,6 +660,13 @@ void OptimizingCompiler::RunArchOptimizations(InstructionSet instruction_set,
     case kArm: {
       arm::DexCacheArrayFixups* fixups =
           new (arena) arm::DexCacheArrayFixups(graph, codegen, stats);
+      if (baseline) {
+        HOptimization* arm_optimizations[] = {
+          fixups
+        };
+        RunOptimizations(arm_optimizations, arraysize(arm_optimizations), pass_observer);
+        break;
+      }
       arm::InstructionSimplifierArm* simplifier =
           new (arena) arm::InstructionSimplifierArm(graph, stats);
       SideEffectsAnalysis* side_effects = new (arena) SideEffectsAnalysis(graph);
@@ -650,6 +683,9 @@ void OptimizingCompiler::RunArchOptimizations(InstructionSet instruction_set,
 #endif
 #ifdef ART_ENABLE_CODEGEN_arm64
     case kArm64: {
+      if (baseline) {
+        break;
+      }
       arm64::InstructionSimplifierArm64* simplifier =
           new (arena) arm64::InstructionSimplifierArm64(graph, stats);
       SideEffectsAnalysis* side_effects = new (arena) SideEffectsAnalysis(graph);
@@ -684,6 +720,13 @@ void OptimizingCompiler::RunArchOptimizations(InstructionSet instruction_set,
     case kX86: {
       x86::PcRelativeFixups* pc_relative_fixups =
           new (arena) x86::PcRelativeFixups(graph, codegen, stats);
+      if (baseline) {
+        HOptimization* x86_optimizations[] = {
+            pc_relative_fixups
+        };
+        RunOptimizations(x86_optimizations, arraysize(x86_optimizations), pass_observer);
+        break;
+      }
       x86::X86MemoryOperandGeneration* memory_gen =
           new (arena) x86::X86MemoryOperandGeneration(graph, codegen, stats);
       HOptimization* x86_optimizations[] = {
@@ -696,6 +739,9 @@ void OptimizingCompiler::RunArchOptimizations(InstructionSet instruction_set,
 #endif
 #ifdef ART_ENABLE_CODEGEN_x86_64
     case kX86_64: {
+      if (baseline) {
+        break;
+      }
       x86::X86MemoryOperandGeneration* memory_gen =
           new (arena) x86::X86MemoryOperandGeneration(graph, codegen, stats);
       HOptimization* x86_64_optimizations[] = {
@@ -710,6 +756,13 @@ void OptimizingCompiler::RunArchOptimizations(InstructionSet instruction_set,
   }
 }
 
+// Without a profile (e.g. in the JIT, which only compiles hot methods) all methods are
+// considered hot by the adaptive register allocation strategy.
+static bool IsHotMethod(CompilerDriver* driver, MethodReference method_ref) {
+  const ProfileCompilationInfo* profile = driver->GetProfileCompilationInfo();
+  return profile == nullptr || profile->ContainsMethod(method_ref);
+}
+
 NO_INLINE  // Avoid increasing caller's frame size by large stack-allocated objects.
 static void AllocateRegisters(HGraph* graph,
                               CodeGenerator* codegen,
@@ -769,12 +822,16 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
       graph, "side_effects$before_gvn");
   SideEffectsAnalysis* side_effects2 = new (arena) SideEffectsAnalysis(
       graph, "side_effects$before_lse");
+  LoadStoreAnalysis* lsa1 = new (arena) LoadStoreAnalysis(
+      graph, "load_store_analysis$before_licm");
+  LoadStoreAnalysis* lsa2 = new (arena) LoadStoreAnalysis(
+      graph, "load_store_analysis$before_lse");
   GVNOptimization* gvn = new (arena) GVNOptimization(graph, *side_effects1);
-  LICM* licm = new (arena) LICM(graph, *side_effects1, stats);
+  LICM* licm = new (arena) LICM(graph, *side_effects1, *lsa1, stats);
   HInductionVarAnalysis* induction = new (arena) HInductionVarAnalysis(graph);
   BoundsCheckElimination* bce = new (arena) BoundsCheckElimination(graph, *side_effects1, induction);
   HLoopOptimization* loop = new (arena) HLoopOptimization(graph, driver, induction);
-  LoadStoreElimination* lse = new (arena) LoadStoreElimination(graph, *side_effects2);
+  LoadStoreElimination* lse = new (arena) LoadStoreElimination(graph, *side_effects2, *lsa2);
   HSharpening* sharpening = new (arena) HSharpening(
       graph, codegen, dex_compilation_unit, driver, handles);
   InstructionSimplifier* simplify2 = new (arena) InstructionSimplifier(
@@ -807,6 +864,7 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
     dce2,
     side_effects1,
     gvn,
+    lsa1,
     licm,
     induction,
     bce,
@@ -814,6 +872,7 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
     fold3,  // evaluates code generated by dynamic bce
     simplify3,
     side_effects2,
+    lsa2,
     lse,
     cha_guard,
     dce3,
@@ -825,7 +884,34 @@ void OptimizingCompiler::RunOptimizations(HGraph* graph,
   };
   RunOptimizations(optimizations2, arraysize(optimizations2), pass_observer);
 
-  RunArchOptimizations(driver->GetInstructionSet(), graph, codegen, pass_observer);
+  RunArchOptimizations(
+      driver->GetInstructionSet(), graph, codegen, pass_observer, /* baseline */ false);
+}
+
+void OptimizingCompiler::RunBaselineOptimizations(HGraph* graph,
+                                                  CodeGenerator* codegen,
+                                                  CompilerDriver* driver,
+                                                  const DexCompilationUnit& dex_compilation_unit,
+                                                  PassObserver* pass_observer,
+                                                  VariableSizedHandleScope* handles) const {
+  OptimizingCompilerStats* stats = compilation_stats_.get();
+  ArenaAllocator* arena = graph->GetArena();
+  // Sharpening is a single walk over the graph and lets the code generators use the
+  // JIT root table instead of the dex cache for classes and strings.
+  HSharpening* sharpening = new (arena) HSharpening(
+      graph, codegen, dex_compilation_unit, driver, handles);
+  // The codegen has a few assumptions that only the instruction simplifier can satisfy.
+  InstructionSimplifier* simplify = new (arena) InstructionSimplifier(
+      graph, codegen, stats, "instruction_simplifier$before_codegen");
+
+  HOptimization* optimizations[] = {
+    sharpening,
+    simplify,
+  };
+  RunOptimizations(optimizations, arraysize(optimizations), pass_observer);
+
+  RunArchOptimizations(
+      driver->GetInstructionSet(), graph, codegen, pass_observer, /* baseline */ true);
 }
 
 static ArenaVector<LinkerPatch> EmitAndSortLinkerPatches(CodeGenerator* codegen) {
@@ -888,6 +974,7 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
                                               Handle<mirror::DexCache> dex_cache,
                                               ArtMethod* method,
                                               bool osr,
+                                              bool baseline,
                                               VariableSizedHandleScope* handles) const {
   MaybeRecordStat(MethodCompilationStat::kAttemptCompilation);
   CompilerDriver* compiler_driver = GetCompilerDriver();
@@ -938,6 +1025,7 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
       kInvalidInvokeType,
       compiler_driver->GetCompilerOptions().GetDebuggable(),
       osr);
+  graph->SetCompilingBaseline(baseline);
 
   const uint8_t* interpreter_metadata = nullptr;
   if (method == nullptr) {
@@ -1010,15 +1098,32 @@ CodeGenerator* OptimizingCompiler::TryCompile(ArenaAllocator* arena,
     }
   }
 
-  RunOptimizations(graph,
-                   codegen.get(),
-                   compiler_driver,
-                   dex_compilation_unit,
-                   &pass_observer,
-                   handles);
+  if (baseline) {
+    RunBaselineOptimizations(graph,
+                             codegen.get(),
+                             compiler_driver,
+                             dex_compilation_unit,
+                             &pass_observer,
+                             handles);
+  } else {
+    RunOptimizations(graph,
+                     codegen.get(),
+                     compiler_driver,
+                     dex_compilation_unit,
+                     &pass_observer,
+                     handles);
+  }
 
-  RegisterAllocator::Strategy regalloc_strategy =
-    compiler_options.GetRegisterAllocationStrategy();
+  // Size the method after inlining and the other optimizations, it is what the
+  // register allocator sees.
+  RegisterAllocator::Strategy regalloc_strategy = RegisterAllocator::SelectStrategy(
+      compiler_options,
+      graph->CountNumberOfInstructions(),
+      IsHotMethod(compiler_driver, MethodReference(&dex_file, method_idx)),
+      baseline);
+  if (regalloc_strategy == RegisterAllocator::kRegisterAllocatorGraphColor) {
+    MaybeRecordStat(MethodCompilationStat::kGraphColorRegisterAllocation);
+  }
   AllocateRegisters(graph, codegen.get(), &pass_observer, regalloc_strategy);
 
   codegen->Compile(code_allocator);
@@ -1064,6 +1169,7 @@ CompiledMethod* OptimizingCompiler::Compile(const DexFile::CodeItem* code_item,
                      dex_cache,
                      nullptr,
                      /* osr */ false,
+                     /* baseline */ false,
                      &handles));
     }
     if (codegen.get() != nullptr) {
@@ -1136,7 +1242,8 @@ bool CanEncodeInlinedMethodInStackMap(const DexFile& caller_dex_file, ArtMethod*
 bool OptimizingCompiler::JitCompile(Thread* self,
                                     jit::JitCodeCache* code_cache,
                                     ArtMethod* method,
-                                    bool osr) {
+                                    bool osr,
+                                    bool baseline) {
   StackHandleScope<3> hs(self);
   Handle<mirror::ClassLoader> class_loader(hs.NewHandle(
       method->GetDeclaringClass()->GetClassLoader()));
@@ -1171,6 +1278,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
                    dex_cache,
                    method,
                    osr,
+                   baseline,
                    &handles));
     if (codegen.get() == nullptr) {
       return false;
@@ -1216,6 +1324,9 @@ bool OptimizingCompiler::JitCompile(Thread* self,
     return false;
   }
   MaybeRecordStat(MethodCompilationStat::kCompiled);
+  if (baseline) {
+    MaybeRecordStat(MethodCompilationStat::kCompiledBaseline);
+  }
   codegen->BuildStackMaps(MemoryRegion(stack_map_data, stack_map_size),
                           MemoryRegion(method_info_data, method_info_size),
                           *code_item);
@@ -1234,6 +1345,7 @@ bool OptimizingCompiler::JitCompile(Thread* self,
       code_allocator.GetSize(),
       data_size,
       osr,
+      baseline,
       roots,
       codegen->GetGraph()->HasShouldDeoptimizeFlag(),
       codegen->GetGraph()->GetCHASingleImplementationList());
@@ -30,6 +30,7 @@ enum MethodCompilationStat {
   kAttemptCompilation = 0,
   kCHAInline,
   kCompiled,
+  kCompiledBaseline,
   kInlinedInvoke,
   kReplacedInvokeWithSimplePattern,
   kInstructionSimplifications,
@@ -62,6 +63,7 @@ enum MethodCompilationStat {
   kBooleanSimplified,
   kIntrinsicRecognized,
   kLoopInvariantMoved,
+  kLoopInvariantLoadMoved,
   kSelectGenerated,
   kRemovedInstanceOf,
   kInlinedInvokeVirtualOrInterface,
@@ -86,6 +88,11 @@ enum MethodCompilationStat {
   kNotInlinedWont,
   kNotInlinedRecursiveBudget,
   kNotInlinedProxy,
+  kGraphColorRegisterAllocation,
+  kRegisterAllocatorSpill,
+  kRegisterAllocatorReload,
+  kRegisterAllocatorRematerialization,
+  kRegisterAllocatorConstantSpill,
   kLastStat
 };
 
@@ -146,6 +153,7 @@ class OptimizingCompilerStats {
       case kAttemptCompilation : name = "AttemptCompilation"; break;
       case kCHAInline : name = "CHAInline"; break;
       case kCompiled : name = "Compiled"; break;
+      case kCompiledBaseline : name = "CompiledBaseline"; break;
       case kInlinedInvoke : name = "InlinedInvoke"; break;
       case kReplacedInvokeWithSimplePattern: name = "ReplacedInvokeWithSimplePattern"; break;
       case kInstructionSimplifications: name = "InstructionSimplifications"; break;
@@ -178,6 +186,7 @@ class OptimizingCompilerStats {
       case kBooleanSimplified : name = "BooleanSimplified"; break;
       case kIntrinsicRecognized : name = "IntrinsicRecognized"; break;
       case kLoopInvariantMoved : name = "LoopInvariantMoved"; break;
+      case kLoopInvariantLoadMoved : name = "LoopInvariantLoadMoved"; break;
       case kSelectGenerated : name = "SelectGenerated"; break;
       case kRemovedInstanceOf: name = "RemovedInstanceOf"; break;
       case kInlinedInvokeVirtualOrInterface: name = "InlinedInvokeVirtualOrInterface"; break;
@@ -202,6 +211,11 @@ class OptimizingCompilerStats {
       case kNotInlinedWont: name = "NotInlinedWont"; break;
       case kNotInlinedRecursiveBudget: name = "NotInlinedRecursiveBudget"; break;
       case kNotInlinedProxy: name = "NotInlinedProxy"; break;
+      case kGraphColorRegisterAllocation: name = "GraphColorRegisterAllocation"; break;
+      case kRegisterAllocatorSpill: name = "RegisterAllocatorSpill"; break;
+      case kRegisterAllocatorReload: name = "RegisterAllocatorReload"; break;
+      case kRegisterAllocatorRematerialization: name = "RegisterAllocatorRematerialization"; break;
+      case kRegisterAllocatorConstantSpill: name = "RegisterAllocatorConstantSpill"; break;
 
       case kLastStat:
         LOG(FATAL) << "invalid stat "
@@ -502,11 +502,24 @@ static bool IsValidDestination(Location destination) {
       || destination.IsSIMDStackSlot();
 }
 
+static bool IsStackLocation(Location location) {
+  return location.IsStackSlot() || location.IsDoubleStackSlot() || location.IsSIMDStackSlot();
+}
+
 void RegisterAllocationResolver::AddMove(HParallelMove* move,
                                          Location source,
                                          Location destination,
                                          HInstruction* instruction,
                                          Primitive::Type type) const {
+  if (source.IsRegisterKind() && IsStackLocation(destination)) {
+    codegen_->MaybeRecordStat(kRegisterAllocatorSpill);
+  } else if (IsStackLocation(source) && destination.IsRegisterKind()) {
+    codegen_->MaybeRecordStat(kRegisterAllocatorReload);
+  } else if (source.IsConstant() && destination.IsRegisterKind()) {
+    codegen_->MaybeRecordStat(kRegisterAllocatorRematerialization);
+  } else if (source.IsConstant() && IsStackLocation(destination)) {
+    codegen_->MaybeRecordStat(kRegisterAllocatorConstantSpill);
+  }
   if (type == Primitive::kPrimLong
       && codegen_->ShouldSplitLongMoves()
       // The parallel move resolver knows how to deal with long constants.
@@ -21,6 +21,7 @@
 
 #include "base/bit_vector-inl.h"
 #include "code_generator.h"
+#include "driver/compiler_options.h"
 #include "register_allocator_graph_color.h"
 #include "register_allocator_linear_scan.h"
 #include "ssa_liveness_analysis.h"
@@ -50,6 +51,26 @@ RegisterAllocator* RegisterAllocator::Create(ArenaAllocator* allocator,
   }
 }
 
+// Graph coloring produces fewer spills and moves but takes longer, so the adaptive strategy
+// uses it for hot methods, as long as they are small enough for its compile time to stay
+// reasonable. The baseline tier always uses linear scan.
+RegisterAllocator::Strategy RegisterAllocator::SelectStrategy(
+    const CompilerOptions& compiler_options,
+    size_t number_of_instructions,
+    bool is_hot,
+    bool baseline) {
+  Strategy strategy = compiler_options.GetRegisterAllocationStrategy();
+  if (strategy != kRegisterAllocatorAdaptive) {
+    return strategy;
+  }
+  if (baseline ||
+      !is_hot ||
+      number_of_instructions > compiler_options.GetGraphColorMaxInstructions()) {
+    return kRegisterAllocatorLinearScan;
+  }
+  return kRegisterAllocatorGraphColor;
+}
+
 bool RegisterAllocator::CanAllocateRegistersFor(const HGraph& graph ATTRIBUTE_UNUSED,
                                                 InstructionSet instruction_set) {
   return instruction_set == kArm
@@ -26,6 +26,7 @@
 namespace art {
 
 class CodeGenerator;
+class CompilerOptions;
 class HBasicBlock;
 class HGraph;
 class HInstruction;
@@ -41,7 +42,10 @@ class RegisterAllocator : public ArenaObject<kArenaAllocRegisterAllocator> {
  public:
   enum Strategy {
     kRegisterAllocatorLinearScan,
-    kRegisterAllocatorGraphColor
+    kRegisterAllocatorGraphColor,
+    // Graph coloring for hot methods up to a size limit, linear scan for the others.
+    // Resolved for each method with SelectStrategy() before calling Create().
+    kRegisterAllocatorAdaptive
   };
 
   static constexpr Strategy kRegisterAllocatorDefault = kRegisterAllocatorLinearScan;
@@ -51,6 +55,14 @@ class RegisterAllocator : public ArenaObject<kArenaAllocRegisterAllocator> {
                                    const SsaLivenessAnalysis& analysis,
                                    Strategy strategy = kRegisterAllocatorDefault);
 
+  // Returns the strategy to use for a method whose optimized graph has `number_of_instructions`
+  // instructions, resolving kRegisterAllocatorAdaptive. `is_hot` tells whether the method is in
+  // the profile, and `baseline` whether it is compiled for the baseline JIT tier.
+  static Strategy SelectStrategy(const CompilerOptions& compiler_options,
+                                 size_t number_of_instructions,
+                                 bool is_hot,
+                                 bool baseline);
+
   virtual ~RegisterAllocator() = default;
 
   // Main entry point for the register allocator. Given the liveness analysis,
@@ -48,6 +48,10 @@ static constexpr size_t kSingleJumpBlockWeightMultiplier = 2;
 // be executed on every path through the method.
 static constexpr size_t kDominatesExitBlockWeightMultiplier = 2;
 
+// Spilled constants are rematerialized at their uses with an immediate move instead of
+// being stored to and reloaded from a stack slot, so spilling them is cheaper.
+static constexpr size_t kRematerializationWeightDivisor = 2;
+
 enum class CoalesceKind {
   kAdjacentSibling,       // Prevents moves at interval split points.
   kFixedOutputSibling,    // Prevents moves from a fixed output location.
@@ -159,8 +163,8 @@ std::ostream& operator<<(std::ostream& os, const NodeStage& stage) {
   return os << static_cast<typename std::underlying_type<NodeStage>::type>(stage);
 }
 
-// Returns the estimated cost of spilling a particular live interval.
-static float ComputeSpillWeight(LiveInterval* interval, const SsaLivenessAnalysis& liveness) {
+float RegisterAllocatorGraphColor::ComputeSpillWeight(LiveInterval* interval,
+                                                      const SsaLivenessAnalysis& liveness) {
   if (interval->HasRegister()) {
     // Intervals with a fixed register cannot be spilled.
     return std::numeric_limits<float>::min();
@@ -192,6 +196,11 @@ static float ComputeSpillWeight(LiveInterval* interval, const SsaLivenessAnalysi
     use = use->GetNext();
   }
 
+  HInstruction* defined_by = interval->GetParent()->GetDefinedBy();
+  if (defined_by != nullptr && defined_by->IsConstant()) {
+    use_weight /= kRematerializationWeightDivisor;
+  }
+
   // We divide by the length of the interval because we want to prioritize
   // short intervals; we do not benefit much if we split them further.
   return static_cast<float>(use_weight) / static_cast<float>(length);
@@ -227,7 +236,7 @@ class InterferenceNode : public ArenaObject<kArenaAllocRegisterAllocator> {
           coalesce_opportunities_(allocator->Adapter(kArenaAllocRegisterAllocator)),
           out_degree_(interval->HasRegister() ? std::numeric_limits<size_t>::max() : 0),
           alias_(this),
-          spill_weight_(ComputeSpillWeight(interval, liveness)),
+          spill_weight_(RegisterAllocatorGraphColor::ComputeSpillWeight(interval, liveness)),
           requires_color_(interval->RequiresRegister()),
           needs_spill_slot_(false) {
     DCHECK(!interval->IsHighInterval()) << "Pair nodes should be represented by the low interval";
@@ -398,8 +407,8 @@ class InterferenceNode : public ArenaObject<kArenaAllocRegisterAllocator> {
 // interference graph sparser.
 // To improve code quality, we prioritize intervals used frequently in deeply nested loops.
 // (This metric is secondary to the forward progress requirements above.)
+// Constants, which can be rematerialized, have a lower spill weight (see ComputeSpillWeight).
 // TODO: May also want to consider:
-// - Constants (since they can be rematerialized)
 // - Allocated spill slots
 static bool HasGreaterNodePriority(const InterferenceNode* lhs,
                                    const InterferenceNode* rhs) {
@@ -96,6 +96,9 @@ class RegisterAllocatorGraphColor : public RegisterAllocator {
 
   bool Validate(bool log_fatal_on_failure);
 
+  // Returns the estimated cost of spilling a particular live interval.
+  static float ComputeSpillWeight(LiveInterval* interval, const SsaLivenessAnalysis& liveness);
+
  private:
   // Collect all intervals and prepare for register allocation.
   void ProcessInstructions();
@@ -26,6 +26,7 @@
 #include "nodes.h"
 #include "optimizing_unit_test.h"
 #include "register_allocator.h"
+#include "register_allocator_graph_color.h"
 #include "register_allocator_linear_scan.h"
 #include "ssa_liveness_analysis.h"
 #include "ssa_phi_elimination.h"
@@ -43,6 +44,10 @@ class RegisterAllocatorTest : public CommonCompilerTest {
   // as a member of RegisterAllocatorTest, which we make a friend class.
   static void SameAsFirstInputHint(Strategy strategy);
   static void ExpectedInRegisterHint(Strategy strategy);
+
+  static void SetStrategy(CompilerOptions* options, Strategy strategy) {
+    options->register_allocation_strategy_ = strategy;
+  }
 };
 
 // This macro should include all register allocation strategies that should be tested.
@@ -980,4 +985,83 @@ TEST_F(RegisterAllocatorTest, SpillInactive) {
       intervals, 0, 0, codegen, &allocator, true, false));
 }
 
+TEST_F(RegisterAllocatorTest, SelectAdaptiveStrategy) {
+  CompilerOptions options;
+  const size_t max_instructions = options.GetGraphColorMaxInstructions();
+  auto select = [&options](size_t instructions, bool is_hot, bool baseline) {
+    return RegisterAllocator::SelectStrategy(options, instructions, is_hot, baseline);
+  };
+
+  // Explicit strategies are used as is.
+  SetStrategy(&options, Strategy::kRegisterAllocatorLinearScan);
+  ASSERT_EQ(Strategy::kRegisterAllocatorLinearScan, select(10, true, false));
+  SetStrategy(&options, Strategy::kRegisterAllocatorGraphColor);
+  ASSERT_EQ(Strategy::kRegisterAllocatorGraphColor, select(10, false, true));
+  ASSERT_EQ(Strategy::kRegisterAllocatorGraphColor, select(max_instructions + 1, false, false));
+
+  // The adaptive strategy only uses graph coloring for hot methods that are small enough,
+  // and never for the baseline tier.
+  SetStrategy(&options, Strategy::kRegisterAllocatorAdaptive);
+  ASSERT_EQ(Strategy::kRegisterAllocatorGraphColor, select(10, true, false));
+  ASSERT_EQ(Strategy::kRegisterAllocatorGraphColor, select(max_instructions, true, false));
+  ASSERT_EQ(Strategy::kRegisterAllocatorLinearScan, select(max_instructions + 1, true, false));
+  ASSERT_EQ(Strategy::kRegisterAllocatorLinearScan, select(10, false, false));
+  ASSERT_EQ(Strategy::kRegisterAllocatorLinearScan, select(10, true, true));
+}
+
+TEST_F(RegisterAllocatorTest, GraphColorConstantSpillWeight) {
+  /*
+   * Test the following snippet:
+   *  mul1 = param * constant
+   *  mul2 = constant * param
+   *  return mul1 + mul2
+   */
+  ArenaPool pool;
+  ArenaAllocator allocator(&pool);
+  HGraph* graph = CreateGraph(&allocator);
+  HBasicBlock* entry = new (&allocator) HBasicBlock(graph);
+  graph->AddBlock(entry);
+  graph->SetEntryBlock(entry);
+  HInstruction* parameter = new (&allocator) HParameterValue(
+      graph->GetDexFile(), dex::TypeIndex(0), 0, Primitive::kPrimInt);
+  entry->AddInstruction(parameter);
+  HInstruction* constant = graph->GetIntConstant(42);
+
+  HBasicBlock* block = new (&allocator) HBasicBlock(graph);
+  graph->AddBlock(block);
+  entry->AddSuccessor(block);
+  HInstruction* mul1 = new (&allocator) HMul(Primitive::kPrimInt, parameter, constant);
+  block->AddInstruction(mul1);
+  HInstruction* mul2 = new (&allocator) HMul(Primitive::kPrimInt, constant, parameter);
+  block->AddInstruction(mul2);
+  HInstruction* add = new (&allocator) HAdd(Primitive::kPrimInt, mul1, mul2);
+  block->AddInstruction(add);
+  block->AddInstruction(new (&allocator) HReturn(add));
+
+  HBasicBlock* exit = new (&allocator) HBasicBlock(graph);
+  graph->AddBlock(exit);
+  block->AddSuccessor(exit);
+  exit->AddInstruction(new (&allocator) HExit());
+  graph->SetExitBlock(exit);
+  graph->BuildDominatorTree();
+
+  std::unique_ptr<const X86InstructionSetFeatures> features_x86(
+      X86InstructionSetFeatures::FromCppDefines());
+  x86::CodeGeneratorX86 codegen(graph, *features_x86.get(), CompilerOptions());
+  SsaLivenessAnalysis liveness(graph, &codegen);
+  liveness.Analyze();
+
+  // Each move in `block` costs 2, since it dominates the exit block. `mul1` needs a
+  // register at its definition and at its use by `add`.
+  LiveInterval* mul1_interval = mul1->GetLiveInterval();
+  ASSERT_FLOAT_EQ(4.0f / mul1_interval->GetLength(),
+                  RegisterAllocatorGraphColor::ComputeSpillWeight(mul1_interval, liveness));
+
+  // The constant only needs a register at its use by `mul2`, and spilling it is cheaper
+  // since it is rematerialized instead of being reloaded.
+  LiveInterval* constant_interval = constant->GetLiveInterval();
+  ASSERT_FLOAT_EQ(1.0f / constant_interval->GetLength(),
+                  RegisterAllocatorGraphColor::ComputeSpillWeight(constant_interval, liveness));
+}
+
 }  // namespace art
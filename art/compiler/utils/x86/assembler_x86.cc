@@ -1622,8 +1622,17 @@ void X86Assembler::cmpb(const Address& address, const Immediate& imm) {
 
 void X86Assembler::cmpw(const Address& address, const Immediate& imm) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  CHECK(imm.is_int16() || imm.is_uint16()) << imm.value();
   EmitUint8(0x66);
-  EmitComplex(7, address, imm);
+  if (imm.is_int8()) {
+    EmitComplex(7, address, imm);
+  } else {
+    // With the operand size override the immediate is 16-bit, not the 32 EmitComplex emits.
+    EmitUint8(0x81);
+    EmitOperand(7, address);
+    EmitUint8(imm.value() & 0xFF);
+    EmitUint8(imm.value() >> 8);
+  }
 }
 
 
@@ -1809,6 +1818,15 @@ void X86Assembler::addl(const Address& address, const Immediate& imm) {
 }
 
 
+void X86Assembler::addw(const Address& address, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  // Only the sign-extended 8-bit immediate form has the same encoding with a 16-bit operand.
+  CHECK(imm.is_int8()) << imm.value();
+  EmitUint8(0x66);
+  EmitComplex(0, address, imm);
+}
+
+
 void X86Assembler::adcl(Register reg, const Immediate& imm) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   EmitComplex(2, Operand(reg), imm);
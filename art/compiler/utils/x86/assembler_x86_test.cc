@@ -763,4 +763,26 @@ TEST_F(AssemblerX86Test, Cmpb) {
   DriverStr(expected, "cmpb");
 }
 
+TEST_F(AssemblerX86Test, Cmpw) {
+  GetAssembler()->cmpw(x86::Address(x86::EDI, 128), x86::Immediate(0));
+  GetAssembler()->cmpw(x86::Address(x86::EAX, 18), x86::Immediate(-128));
+  GetAssembler()->cmpw(x86::Address(x86::EBX, 0), x86::Immediate(10000));
+  const char* expected =
+      "cmpw $0, 128(%EDI)\n"
+      "cmpw $-128, 18(%EAX)\n"
+      "cmpw $10000, 0(%EBX)\n";
+  DriverStr(expected, "cmpw");
+}
+
+TEST_F(AssemblerX86Test, Addw) {
+  GetAssembler()->addw(x86::Address(x86::EAX, 18), x86::Immediate(1));
+  GetAssembler()->addw(x86::Address(x86::EDI, 128), x86::Immediate(-1));
+  GetAssembler()->addw(x86::Address(x86::ESP, 0), x86::Immediate(127));
+  const char* expected =
+      "addw $1, 18(%EAX)\n"
+      "addw $-1, 128(%EDI)\n"
+      "addw $127, 0(%ESP)\n";
+  DriverStr(expected, "addw");
+}
+
 }  // namespace art
@@ -780,13 +780,27 @@ TEST_F(AssemblerX86_64Test, Cmpw) {
                        x86_64::Immediate(0));
   GetAssembler()->cmpw(x86_64::Address(x86_64::CpuRegister(x86_64::R14), 0),
                        x86_64::Immediate(0));
+  GetAssembler()->cmpw(x86_64::Address(x86_64::CpuRegister(x86_64::RDI), 18),
+                       x86_64::Immediate(10000));
   const char* expected =
       "cmpw $0, 0(%RAX)\n"
       "cmpw $0, 0(%R9)\n"
-      "cmpw $0, 0(%R14)\n";
+      "cmpw $0, 0(%R14)\n"
+      "cmpw $10000, 18(%RDI)\n";
   DriverStr(expected, "cmpw");
 }
 
+TEST_F(AssemblerX86_64Test, Addw) {
+  GetAssembler()->addw(x86_64::Address(x86_64::CpuRegister(x86_64::RDI), 18),
+                       x86_64::Immediate(1));
+  GetAssembler()->addw(x86_64::Address(x86_64::CpuRegister(x86_64::R9), 0),
+                       x86_64::Immediate(-1));
+  const char* expected =
+      "addw $1, 18(%RDI)\n"
+      "addw $-1, 0(%R9)\n";
+  DriverStr(expected, "addw");
+}
+
 TEST_F(AssemblerX86_64Test, MovqAddrImm) {
   GetAssembler()->movq(x86_64::Address(x86_64::CpuRegister(x86_64::RAX), 0),
                        x86_64::Immediate(-5));
@@ -1301,6 +1315,30 @@ TEST_F(AssemblerX86_64Test, Pavgw) {
   DriverStr(RepeatFF(&x86_64::X86_64Assembler::pavgw, "pavgw %{reg2}, %{reg1}"), "pavgw");
 }
 
+TEST_F(AssemblerX86_64Test, Pminsb) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pminsb, "pminsb %{reg2}, %{reg1}"), "pminsb");
+}
+
+TEST_F(AssemblerX86_64Test, Pmaxsb) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmaxsb, "pmaxsb %{reg2}, %{reg1}"), "pmaxsb");
+}
+
+TEST_F(AssemblerX86_64Test, Pminsw) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pminsw, "pminsw %{reg2}, %{reg1}"), "pminsw");
+}
+
+TEST_F(AssemblerX86_64Test, Pmaxsw) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmaxsw, "pmaxsw %{reg2}, %{reg1}"), "pmaxsw");
+}
+
+TEST_F(AssemblerX86_64Test, Pminsd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pminsd, "pminsd %{reg2}, %{reg1}"), "pminsd");
+}
+
+TEST_F(AssemblerX86_64Test, Pmaxsd) {
+  DriverStr(RepeatFF(&x86_64::X86_64Assembler::pmaxsd, "pmaxsd %{reg2}, %{reg1}"), "pmaxsd");
+}
+
 TEST_F(AssemblerX86_64Test, PCmpeqb) {
   DriverStr(RepeatFF(&x86_64::X86_64Assembler::pcmpeqb, "pcmpeqb %{reg2}, %{reg1}"), "pcmpeqb");
 }
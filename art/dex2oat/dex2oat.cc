@@ -58,6 +58,7 @@
 #include "dex_file-inl.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
+#include "driver/incremental_compilation_info.h"
 #include "elf_file.h"
 #include "elf_writer.h"
 #include "elf_writer_quick.h"
@@ -177,6 +178,18 @@ static std::string StrippedCommandLine() {
   return android::base::Join(command, ' ');
 }
 
+// Returns whether the two paths name the same file. If either file does not exist, the paths
+// themselves are compared.
+static bool IsSameFile(const std::string& path, const std::string& other_path) {
+  struct stat path_stat;
+  struct stat other_path_stat;
+  if (stat(path.c_str(), &path_stat) == 0 && stat(other_path.c_str(), &other_path_stat) == 0) {
+    return path_stat.st_dev == other_path_stat.st_dev &&
+        path_stat.st_ino == other_path_stat.st_ino;
+  }
+  return path == other_path;
+}
+
 static void UsageErrorV(const char* fmt, va_list ap) {
   std::string error;
   StringAppendV(&error, fmt, ap);
@@ -231,6 +244,12 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("      to the file descriptor specified by --oat-fd.");
   UsageError("      Example: --oat-location=/data/dalvik-cache/system@app@Calculator.apk.oat");
   UsageError("");
+  UsageError("  --input-oat=<file.odex>: specifies a previous oat file of the same dex files.");
+  UsageError("      The compiled code of methods that did not change is copied from it");
+  UsageError("      instead of being compiled again. Only methods that reference no type,");
+  UsageError("      string, field or method are reused. It must not be the output oat file.");
+  UsageError("      Example: --input-oat=/data/app/Calculator/oat/arm64/base.odex");
+  UsageError("");
   UsageError("  --oat-symbols=<file.oat>: specifies an oat output destination with full symbols.");
   UsageError("      Example: --oat-symbols=/symbols/system/framework/boot.oat");
   UsageError("");
@@ -325,6 +344,20 @@ NO_RETURN static void Usage(const char* fmt, ...) {
              CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("      Default: %d", CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("");
+  UsageError("  --register-allocation-strategy=(linear-scan|graph-color|adaptive): selects the");
+  UsageError("      register allocator. adaptive uses graph coloring for the methods in the");
+  UsageError("      profile (or all methods without a profile) with up to");
+  UsageError("      --graph-color-max-instructions instructions after inlining, and linear scan");
+  UsageError("      for the others.");
+  UsageError("      Default: linear-scan");
+  UsageError("");
+  UsageError("  --graph-color-max-instructions=<instruction-count>: the maximum number of");
+  UsageError("      instructions, counted after inlining and optimizations, that a method can");
+  UsageError("      have to be allocated with graph coloring by the adaptive strategy.");
+  UsageError("      Example: --graph-color-max-instructions=%zu",
+             CompilerOptions::kDefaultGraphColorMaxInstructions);
+  UsageError("      Default: %zu", CompilerOptions::kDefaultGraphColorMaxInstructions);
+  UsageError("");
   UsageError("  --dump-timing: display a breakdown of where time was spent");
   UsageError("");
   UsageError("  -g");
@@ -734,6 +767,29 @@ class Dex2Oat FINAL {
       Usage("--oat-file should not be used with --oat-fd");
     }
 
+    if (!input_oat_.empty()) {
+      // The output oat file is truncated before the input oat file is read.
+      for (const char* oat_filename : oat_filenames_) {
+        if (IsSameFile(input_oat_, oat_filename)) {
+          Usage("--input-oat should not be the output oat file %s", oat_filename);
+        }
+      }
+      for (const char* oat_symbols : parser_options->oat_symbols) {
+        if (IsSameFile(input_oat_, oat_symbols)) {
+          Usage("--input-oat should not be the output oat file %s", oat_symbols);
+        }
+      }
+      struct stat input_oat_stat;
+      struct stat oat_fd_stat;
+      if (oat_fd_ != -1 &&
+          stat(input_oat_.c_str(), &input_oat_stat) == 0 &&
+          fstat(oat_fd_, &oat_fd_stat) == 0 &&
+          input_oat_stat.st_dev == oat_fd_stat.st_dev &&
+          input_oat_stat.st_ino == oat_fd_stat.st_ino) {
+        Usage("--input-oat should not be the output oat file of --oat-fd");
+      }
+    }
+
     if ((output_vdex_fd_ == -1) != (oat_fd_ == -1)) {
       Usage("VDEX and OAT output must be specified either with one --oat-filename "
             "or with --oat-fd and --output-vdex-fd file descriptors");
@@ -1094,6 +1150,8 @@ class Dex2Oat FINAL {
         CompilerFilter::NameOfFilter(compiler_options_->GetCompilerFilter()));
     key_value_store_->Put(OatHeader::kConcurrentCopying,
                           kUseReadBarrier ? OatHeader::kTrueValue : OatHeader::kFalseValue);
+    key_value_store_->Put(OatHeader::kCodeGenerationOptionsKey,
+                          compiler_options_->GetCodeGenerationOptions());
   }
 
   // Parse the arguments from the command line. In case of an unrecognized option or impossible
@@ -1134,6 +1192,8 @@ class Dex2Oat FINAL {
         ParseInputVdexFd(option);
       } else if (option.starts_with("--input-vdex=")) {
         input_vdex_ = option.substr(strlen("--input-vdex=")).data();
+      } else if (option.starts_with("--input-oat=")) {
+        input_oat_ = option.substr(strlen("--input-oat=")).data();
       } else if (option.starts_with("--output-vdex=")) {
         output_vdex_ = option.substr(strlen("--output-vdex=")).data();
       } else if (option.starts_with("--output-vdex-fd=")) {
@@ -1749,7 +1809,32 @@ class Dex2Oat FINAL {
                                      swap_fd_,
                                      profile_compilation_info_.get()));
     driver_->SetDexFilesForOatFile(dex_files_);
+    if (!input_oat_.empty()) {
+      TimingLogger::ScopedTiming t_input("dex2oat Open input oat", timings_);
+      std::string error_msg;
+      incremental_compilation_info_ =
+          IncrementalCompilationInfo::Create(input_oat_,
+                                             instruction_set_,
+                                             instruction_set_features_.get(),
+                                             *compiler_options_,
+                                             &error_msg);
+      if (incremental_compilation_info_ == nullptr) {
+        LOG(WARNING) << "Ignoring --input-oat=" << input_oat_ << ": " << error_msg;
+      } else {
+        VLOG(compiler) << "Loaded " << incremental_compilation_info_->GetNumberOfReusableMethods()
+                       << " reusable methods from " << input_oat_;
+        driver_->SetIncrementalCompilationInfo(incremental_compilation_info_.get());
+      }
+    }
     driver_->CompileAll(class_loader_, dex_files_, input_vdex_file_.get(), timings_);
+    if (incremental_compilation_info_ != nullptr) {
+      LOG(INFO) << "Reused the code of "
+                << incremental_compilation_info_->GetNumberOfReusedMethods()
+                << " methods from " << input_oat_ << ", "
+                << incremental_compilation_info_->GetNumberOfSelfContainedMethods()
+                << " of the " << incremental_compilation_info_->GetNumberOfQueriedMethods()
+                << " methods to compile were self-contained";
+    }
   }
 
   // Notes on the interleaving of creating the images and oat files to
@@ -1944,21 +2029,27 @@ class Dex2Oat FINAL {
         // Therefore PrepareDebugInfo() relies on the SetLoadedSectionSizes() call further above.
         elf_writer->PrepareDebugInfo(oat_writer->GetMethodDebugInfo());
 
-        OutputStream*& rodata = rodata_[i];
-        DCHECK(rodata != nullptr);
-        if (!oat_writer->WriteRodata(rodata)) {
-          LOG(ERROR) << "Failed to write .rodata section to the ELF file " << oat_file->GetPath();
-          return false;
+        {
+          TimingLogger::ScopedTiming t3("dex2oat Write .rodata", timings_);
+          OutputStream*& rodata = rodata_[i];
+          DCHECK(rodata != nullptr);
+          if (!oat_writer->WriteRodata(rodata)) {
+            LOG(ERROR) << "Failed to write .rodata section to the ELF file " << oat_file->GetPath();
+            return false;
+          }
+          elf_writer->EndRoData(rodata);
+          rodata = nullptr;
         }
-        elf_writer->EndRoData(rodata);
-        rodata = nullptr;
 
-        OutputStream* text = elf_writer->StartText();
-        if (!oat_writer->WriteCode(text)) {
-          LOG(ERROR) << "Failed to write .text section to the ELF file " << oat_file->GetPath();
-          return false;
+        {
+          TimingLogger::ScopedTiming t3("dex2oat Write .text", timings_);
+          OutputStream* text = elf_writer->StartText();
+          if (!oat_writer->WriteCode(text)) {
+            LOG(ERROR) << "Failed to write .text section to the ELF file " << oat_file->GetPath();
+            return false;
+          }
+          elf_writer->EndText(text);
         }
-        elf_writer->EndText(text);
 
         if (!oat_writer->WriteHeader(elf_writer->GetStream(),
                                      image_file_location_oat_checksum_,
@@ -1976,7 +2067,10 @@ class Dex2Oat FINAL {
         }
 
         elf_writer->WriteDynamicSection();
-        elf_writer->WriteDebugInfo(oat_writer->GetMethodDebugInfo());
+        {
+          TimingLogger::ScopedTiming t3("dex2oat Write debug info", timings_);
+          elf_writer->WriteDebugInfo(oat_writer->GetMethodDebugInfo());
+        }
 
         if (!elf_writer->End()) {
           LOG(ERROR) << "Failed to write ELF file " << oat_file->GetPath();
@@ -2716,6 +2810,8 @@ class Dex2Oat FINAL {
   std::string input_vdex_;
   std::string output_vdex_;
   std::unique_ptr<VdexFile> input_vdex_file_;
+  std::string input_oat_;
+  std::unique_ptr<IncrementalCompilationInfo> incremental_compilation_info_;
   std::vector<const char*> dex_filenames_;
   std::vector<const char*> dex_locations_;
   int zip_fd_;
@@ -862,6 +862,71 @@ TEST_F(Dex2oatWatchdogTest, TestWatchdogTrigger) {
   RunTest(false, { "--watchdog-timeout=10" });
 }
 
+class Dex2oatInputOatTest : public Dex2oatTest {
+ protected:
+  // Compiles the test dex file a first time, then a second time with --input-oat pointing to
+  // the first oat file and `extra_args`.
+  void RunTest(const std::vector<std::string>& extra_args = {}) {
+    std::string dex_location = GetScratchDir() + "/Dex2OatInputOatTest.jar";
+    std::string input_odex_location = GetOdexDir() + "/Dex2OatInputOatTest.input.odex";
+    std::string odex_location = GetOdexDir() + "/Dex2OatInputOatTest.odex";
+
+    Copy(GetDexSrc1(), dex_location);
+
+    GenerateOdexForTest(dex_location, input_odex_location, CompilerFilter::kSpeed);
+    std::vector<std::string> args = extra_args;
+    args.push_back("--input-oat=" + input_odex_location);
+    GenerateOdexForTest(dex_location, odex_location, CompilerFilter::kSpeed, args);
+  }
+
+  // Returns the number of reused methods reported by dex2oat, or -1 if the input oat file
+  // was not used.
+  int GetNumberOfReusedMethods() {
+    std::smatch match;
+    if (!std::regex_search(output_, match, std::regex("Reused the code of ([0-9]+) methods"))) {
+      return -1;
+    }
+    return std::stoi(match[1].str());
+  }
+};
+
+TEST_F(Dex2oatInputOatTest, ReuseUnchangedMethods) {
+  RunTest();
+  EXPECT_EQ(output_.find("Ignoring --input-oat"), std::string::npos) << output_;
+  // Main.main() is empty, its code does not depend on anything else and is reused.
+  EXPECT_GE(GetNumberOfReusedMethods(), 1) << output_;
+}
+
+TEST_F(Dex2oatInputOatTest, RejectDifferentCodeGenerationOptions) {
+  RunTest({ "--inline-max-code-units=0" });
+  EXPECT_NE(output_.find("Code generation options mismatch"), std::string::npos) << output_;
+  EXPECT_EQ(GetNumberOfReusedMethods(), -1) << output_;
+}
+
+TEST_F(Dex2oatInputOatTest, RejectDifferentConfiguration) {
+  RunTest({ "--debuggable" });
+  EXPECT_NE(output_.find("Compiler configuration mismatch"), std::string::npos) << output_;
+  EXPECT_EQ(GetNumberOfReusedMethods(), -1) << output_;
+}
+
+TEST_F(Dex2oatInputOatTest, RejectOutputAsInput) {
+  std::string dex_location = GetScratchDir() + "/Dex2OatInputOatTest.jar";
+  std::string odex_location = GetOdexDir() + "/Dex2OatInputOatTest.odex";
+
+  Copy(GetDexSrc1(), dex_location);
+
+  GenerateOdexForTest(dex_location, odex_location, CompilerFilter::kSpeed);
+  std::string error_msg;
+  int status = GenerateOdexForTestWithStatus(dex_location,
+                                             odex_location,
+                                             CompilerFilter::kSpeed,
+                                             &error_msg,
+                                             { "--input-oat=" + odex_location });
+  EXPECT_NE(status, 0) << output_;
+  EXPECT_NE(output_.find("--input-oat should not be the output oat file"), std::string::npos)
+      << output_;
+}
+
 class Dex2oatReturnCodeTest : public Dex2oatTest {
  protected:
   int RunTest(const std::vector<std::string>& extra_args = {}) {
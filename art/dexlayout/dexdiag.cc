@@ -91,11 +91,29 @@ class PageCount {
   size_t Get(uint16_t type) const {
     return map_.at(type);
   }
+  size_t Total() const {
+    size_t total = 0;
+    for (const auto& pair : map_) {
+      total += pair.second;
+    }
+    return total;
+  }
+  void Add(const PageCount& other) {
+    for (const auto& pair : other.map_) {
+      map_[pair.first] += pair.second;
+    }
+  }
  private:
   std::map<uint16_t, size_t> map_;
   DISALLOW_COPY_AND_ASSIGN(PageCount);
 };
 
+// The resident and mapped pages of all the dex files mapped by a process.
+struct ProcessPageCount {
+  PageCount resident;
+  PageCount mapped;
+};
+
 class Printer {
  public:
   Printer() : section_header_width_(ComputeHeaderWidth()) {
@@ -221,7 +239,8 @@ static void DisplayDexStatistics(size_t start,
                                  size_t end,
                                  const PageCount& resident_pages,
                                  const std::vector<dex_ir::DexFileSection>& sections,
-                                 Printer* printer) {
+                                 Printer* printer,
+                                 ProcessPageCount* process_pages) {
   // Compute the total possible sizes for sections.
   PageCount mapped_pages;
   DCHECK_GE(end, start);
@@ -233,6 +252,8 @@ static void DisplayDexStatistics(size_t start,
     const size_t dex_page_offset = page - start;
     mapped_pages.Increment(FindSectionTypeForPage(dex_page_offset, sections));
   }
+  process_pages->resident.Add(resident_pages);
+  process_pages->mapped.Add(mapped_pages);
   size_t total_resident_pages = 0;
   printer->PrintHeader();
   for (size_t i = sections.size(); i > 0; --i) {
@@ -264,7 +285,8 @@ static void ProcessOneDexMapping(uint64_t* pagemap,
                                  uint64_t map_start,
                                  const DexFile* dex_file,
                                  uint64_t vdex_start,
-                                 Printer* printer) {
+                                 Printer* printer,
+                                 ProcessPageCount* process_pages) {
   uint64_t dex_file_start = reinterpret_cast<uint64_t>(dex_file->Begin());
   size_t dex_file_size = dex_file->Size();
   if (dex_file_start < vdex_start) {
@@ -293,10 +315,17 @@ static void ProcessOneDexMapping(uint64_t* pagemap,
   }
   PageCount section_resident_pages;
   ProcessPageMap(pagemap, start_page, end_page, sections, &section_resident_pages);
-  DisplayDexStatistics(start_page, end_page, section_resident_pages, sections, printer);
+  DisplayDexStatistics(start_page,
+                       end_page,
+                       section_resident_pages,
+                       sections,
+                       printer,
+                       process_pages);
 }
 
-static bool DisplayMappingIfFromVdexFile(pm_map_t* map, Printer* printer) {
+static bool DisplayMappingIfFromVdexFile(pm_map_t* map,
+                                         Printer* printer,
+                                         ProcessPageCount* process_pages) {
   // Confirm that the map is from a vdex file.
   static const char* suffixes[] = { ".vdex" };
   std::string vdex_name;
@@ -352,7 +381,8 @@ static bool DisplayMappingIfFromVdexFile(pm_map_t* map, Printer* printer) {
                          pm_map_start(map),
                          dex_file.get(),
                          reinterpret_cast<uint64_t>(vdex->Begin()),
-                         printer);
+                         printer,
+                         process_pages);
   }
   free(pagemap);
   return true;
@@ -430,11 +460,85 @@ static bool FilterByNameContains(const std::string& mapped_file_name,
   return false;
 }
 
+// Prints the resident dex pages of each section side by side for each process, e.g. to compare
+// a process running an app before and after its dex files were laid out by dexlayout.
+static void PrintProcessComparison(const std::vector<pid_t>& pids,
+                                   const std::vector<std::unique_ptr<ProcessPageCount>>& counts) {
+  const int section_header_width = Printer::ComputeHeaderWidth();
+  std::cout << "RESIDENT DEX PAGES" << std::endl;
+  std::cout << StringPrintf("%-*s", section_header_width, kSectionHeader);
+  for (pid_t pid : pids) {
+    std::cout << StringPrintf(" %*d", kPageCountWidth, pid);
+  }
+  std::cout << std::endl;
+  for (const auto& pair : kDexSectionInfoMap) {
+    std::cout << StringPrintf("%-*s", section_header_width, pair.second.name.c_str());
+    for (const std::unique_ptr<ProcessPageCount>& count : counts) {
+      std::cout << StringPrintf(" %*zd", kPageCountWidth, count->resident.Get(pair.first));
+    }
+    std::cout << std::endl;
+  }
+  std::cout << StringPrintf("%-*s", section_header_width, "GRAND TOTAL");
+  for (const std::unique_ptr<ProcessPageCount>& count : counts) {
+    std::cout << StringPrintf(" %*zd", kPageCountWidth, count->resident.Total());
+  }
+  std::cout << std::endl;
+  std::cout << StringPrintf("%-*s", section_header_width, "MAPPED");
+  for (const std::unique_ptr<ProcessPageCount>& count : counts) {
+    std::cout << StringPrintf(" %*zd", kPageCountWidth, count->mapped.Total());
+  }
+  std::cout << std::endl;
+}
+
+static bool ProcessPid(pm_kernel_t* ker,
+                       pid_t pid,
+                       const std::vector<std::string>& name_filters,
+                       Printer* printer,
+                       ProcessPageCount* process_pages) {
+  // get libpagemap process information.
+  pm_process_t* proc;
+  if (pm_process_create(ker, pid, &proc) != 0) {
+    std::cerr << "Error creating process interface -- does process "
+              << pid
+              << " really exist?"
+              << std::endl;
+    return false;
+  }
+
+  // Get the set of mappings by the specified process.
+  pm_map_t** maps;
+  size_t num_maps;
+  if (pm_process_maps(proc, &maps, &num_maps) != 0) {
+    std::cerr << "Error listing maps." << std::endl;
+    return false;
+  }
+
+  // Process the mappings that are due to DEX files.
+  std::cout << "PID " << pid << std::endl;
+  for (size_t i = 0; i < num_maps; ++i) {
+    std::string mapped_file_name = pm_map_name(maps[i]);
+    // Filter by name contains options (if any).
+    if (!FilterByNameContains(mapped_file_name, name_filters)) {
+      continue;
+    }
+    if (!DisplayMappingIfFromVdexFile(maps[i], printer, process_pages)) {
+      return false;
+    } else if (!DisplayMappingIfFromOatFile(maps[i], printer)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 static void Usage(const char* cmd) {
-  std::cerr << "Usage: " << cmd << " [options] pid" << std::endl
+  std::cerr << "Usage: " << cmd << " [options] pid..." << std::endl
             << "    --contains=<string>:  Display sections containing string." << std::endl
             << "    --help:               Shows this message." << std::endl
-            << "    --verbose:            Makes displays verbose." << std::endl;
+            << "    --verbose:            Makes displays verbose." << std::endl
+            << "  With several pids, the resident dex pages of the processes are compared,"
+            << std::endl
+            << "  e.g. for an app running before and after a dexlayout of its dex files."
+            << std::endl;
   PrintLetterKey();
 }
 
@@ -445,8 +549,9 @@ static int DexDiagMain(int argc, char* argv[]) {
   }
 
   std::vector<std::string> name_filters;
+  std::vector<pid_t> pids;
   // TODO: add option to track usage by class name, etc.
-  for (int i = 1; i < argc - 1; ++i) {
+  for (int i = 1; i < argc; ++i) {
     const StringPiece option(argv[i]);
     if (option == "--help") {
       Usage(argv[0]);
@@ -456,24 +561,28 @@ static int DexDiagMain(int argc, char* argv[]) {
     } else if (option.starts_with("--contains=")) {
       std::string contains(option.substr(strlen("--contains=")).data());
       name_filters.push_back(contains);
+    } else if (!option.starts_with("--")) {
+      char* endptr;
+      pid_t pid = (pid_t)strtol(argv[i], &endptr, 10);
+      if (*endptr != '\0' || kill(pid, 0) != 0) {
+        std::cerr << StringPrintf("Invalid PID \"%s\".\n", argv[i]) << std::endl;
+        return EXIT_FAILURE;
+      }
+      pids.push_back(pid);
     } else {
       Usage(argv[0]);
       return EXIT_FAILURE;
     }
   }
+  if (pids.empty()) {
+    Usage(argv[0]);
+    return EXIT_FAILURE;
+  }
 
   // Art specific set up.
   InitLogging(argv, Runtime::Aborter);
   MemMap::Init();
 
-  pid_t pid;
-  char* endptr;
-  pid = (pid_t)strtol(argv[argc - 1], &endptr, 10);
-  if (*endptr != '\0' || kill(pid, 0) != 0) {
-    std::cerr << StringPrintf("Invalid PID \"%s\".\n", argv[argc - 1]) << std::endl;
-    return EXIT_FAILURE;
-  }
-
   // get libpagemap kernel information.
   pm_kernel_t* ker;
   if (pm_kernel_create(&ker) != 0) {
@@ -481,38 +590,17 @@ static int DexDiagMain(int argc, char* argv[]) {
     return EXIT_FAILURE;
   }
 
-  // get libpagemap process information.
-  pm_process_t* proc;
-  if (pm_process_create(ker, pid, &proc) != 0) {
-    std::cerr << "Error creating process interface -- does process "
-              << pid
-              << " really exist?"
-              << std::endl;
-    return EXIT_FAILURE;
-  }
-
-  // Get the set of mappings by the specified process.
-  pm_map_t** maps;
-  size_t num_maps;
-  if (pm_process_maps(proc, &maps, &num_maps) != 0) {
-    std::cerr << "Error listing maps." << std::endl;
-    return EXIT_FAILURE;
-  }
-
-  // Process the mappings that are due to DEX files.
   Printer printer;
-  for (size_t i = 0; i < num_maps; ++i) {
-    std::string mapped_file_name = pm_map_name(maps[i]);
-    // Filter by name contains options (if any).
-    if (!FilterByNameContains(mapped_file_name, name_filters)) {
-      continue;
-    }
-    if (!DisplayMappingIfFromVdexFile(maps[i], &printer)) {
-      return EXIT_FAILURE;
-    } else if (!DisplayMappingIfFromOatFile(maps[i], &printer)) {
+  std::vector<std::unique_ptr<ProcessPageCount>> process_pages;
+  for (pid_t pid : pids) {
+    process_pages.emplace_back(new ProcessPageCount());
+    if (!ProcessPid(ker, pid, name_filters, &printer, process_pages.back().get())) {
       return EXIT_FAILURE;
     }
   }
+  if (pids.size() > 1) {
+    PrintProcessComparison(pids, process_pages);
+  }
 
   return EXIT_SUCCESS;
 }
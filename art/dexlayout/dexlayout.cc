@@ -1496,20 +1496,89 @@ void DexLayout::DumpDexFile() {
   }
 }
 
-std::vector<dex_ir::ClassData*> DexLayout::LayoutClassDefsAndClassData(const DexFile* dex_file) {
-  std::vector<dex_ir::ClassDef*> new_class_def_order;
-  for (std::unique_ptr<dex_ir::ClassDef>& class_def : header_->GetCollections().ClassDefs()) {
-    dex::TypeIndex type_idx(class_def->ClassType()->GetIndex());
-    if (info_->ContainsClass(*dex_file, type_idx)) {
-      new_class_def_order.push_back(class_def.get());
+// Returns, indexed by type index, whether the class defined in the dex file is loaded at startup:
+// the classes of the profile and, since loading a class loads its superclass and interfaces
+// first, the superclasses and interfaces of those that are defined in the same dex file.
+std::vector<bool> DexLayout::CollectStartupClasses(const DexFile* dex_file) {
+  dex_ir::Collections& collections = header_->GetCollections();
+  std::vector<dex_ir::ClassDef*> class_def_by_type(collections.TypeIdsSize(), nullptr);
+  for (std::unique_ptr<dex_ir::ClassDef>& class_def : collections.ClassDefs()) {
+    class_def_by_type[class_def->ClassType()->GetIndex()] = class_def.get();
+  }
+  std::vector<bool> startup_classes(collections.TypeIdsSize(), false);
+  std::vector<dex_ir::ClassDef*> worklist;
+  auto add_class = [&](const dex_ir::TypeId* type) {
+    if (type == nullptr || startup_classes[type->GetIndex()]) {
+      return;
+    }
+    dex_ir::ClassDef* class_def = class_def_by_type[type->GetIndex()];
+    if (class_def != nullptr) {
+      startup_classes[type->GetIndex()] = true;
+      worklist.push_back(class_def);
+    }
+  };
+  for (std::unique_ptr<dex_ir::ClassDef>& class_def : collections.ClassDefs()) {
+    const dex_ir::TypeId* type = class_def->ClassType();
+    if (info_->ContainsClass(*dex_file, dex::TypeIndex(type->GetIndex()))) {
+      add_class(type);
     }
   }
-  for (std::unique_ptr<dex_ir::ClassDef>& class_def : header_->GetCollections().ClassDefs()) {
-    dex::TypeIndex type_idx(class_def->ClassType()->GetIndex());
-    if (!info_->ContainsClass(*dex_file, type_idx)) {
-      new_class_def_order.push_back(class_def.get());
+  while (!worklist.empty()) {
+    dex_ir::ClassDef* class_def = worklist.back();
+    worklist.pop_back();
+    add_class(class_def->Superclass());
+    if (class_def->Interfaces() != nullptr) {
+      for (const dex_ir::TypeId* interface : *class_def->Interfaces()->GetTypeList()) {
+        add_class(interface);
+      }
     }
   }
+  return startup_classes;
+}
+
+// Appends `class_def` to `order` after its superclass and interfaces defined in the same dex file,
+// as the dex format requires.
+static void AddClassDefInOrder(dex_ir::ClassDef* class_def,
+                               const std::vector<dex_ir::ClassDef*>& class_def_by_type,
+                               std::vector<bool>* added,
+                               std::vector<dex_ir::ClassDef*>* order) {
+  if ((*added)[class_def->ClassType()->GetIndex()]) {
+    return;
+  }
+  (*added)[class_def->ClassType()->GetIndex()] = true;
+  auto add_super_type = [&](const dex_ir::TypeId* type) {
+    if (type != nullptr && class_def_by_type[type->GetIndex()] != nullptr) {
+      AddClassDefInOrder(class_def_by_type[type->GetIndex()], class_def_by_type, added, order);
+    }
+  };
+  add_super_type(class_def->Superclass());
+  if (class_def->Interfaces() != nullptr) {
+    for (const dex_ir::TypeId* interface : *class_def->Interfaces()->GetTypeList()) {
+      add_super_type(interface);
+    }
+  }
+  order->push_back(class_def);
+}
+
+std::vector<dex_ir::ClassData*> DexLayout::LayoutClassDefsAndClassData(
+    const std::vector<bool>& startup_classes) {
+  dex_ir::Collections& collections = header_->GetCollections();
+  std::vector<dex_ir::ClassDef*> class_def_by_type(collections.TypeIdsSize(), nullptr);
+  for (std::unique_ptr<dex_ir::ClassDef>& class_def : collections.ClassDefs()) {
+    class_def_by_type[class_def->ClassType()->GetIndex()] = class_def.get();
+  }
+  // Startup classes first. The startup classes include their superclasses and interfaces, so
+  // the ordering of superclasses before subclasses does not pull other classes forward.
+  std::vector<dex_ir::ClassDef*> new_class_def_order;
+  std::vector<bool> added(collections.TypeIdsSize(), false);
+  for (std::unique_ptr<dex_ir::ClassDef>& class_def : collections.ClassDefs()) {
+    if (startup_classes[class_def->ClassType()->GetIndex()]) {
+      AddClassDefInOrder(class_def.get(), class_def_by_type, &added, &new_class_def_order);
+    }
+  }
+  for (std::unique_ptr<dex_ir::ClassDef>& class_def : collections.ClassDefs()) {
+    AddClassDefInOrder(class_def.get(), class_def_by_type, &added, &new_class_def_order);
+  }
   uint32_t class_defs_offset = header_->GetCollections().ClassDefsOffset();
   uint32_t class_data_offset = header_->GetCollections().ClassDatasOffset();
   std::unordered_set<dex_ir::ClassData*> visited_class_data;
@@ -1530,22 +1599,43 @@ std::vector<dex_ir::ClassData*> DexLayout::LayoutClassDefsAndClassData(const Dex
   return new_class_data_order;
 }
 
-void DexLayout::LayoutStringData(const DexFile* dex_file) {
+void DexLayout::LayoutStringData(const DexFile* dex_file,
+                                 const std::vector<bool>& startup_classes) {
   const size_t num_strings = header_->GetCollections().StringIds().size();
   std::vector<bool> is_shorty(num_strings, false);
   std::vector<bool> from_hot_method(num_strings, false);
   for (std::unique_ptr<dex_ir::ClassDef>& class_def : header_->GetCollections().ClassDefs()) {
-    // A name of a profile class is probably going to get looked up by ClassTable::Lookup, mark it
+    // A name of a startup class is probably going to get looked up by ClassTable::Lookup, mark it
     // as hot.
-    const bool is_profile_class =
-        info_->ContainsClass(*dex_file, dex::TypeIndex(class_def->ClassType()->GetIndex()));
-    if (is_profile_class) {
+    const bool is_startup_class = startup_classes[class_def->ClassType()->GetIndex()];
+    if (is_startup_class) {
       from_hot_method[class_def->ClassType()->GetStringId()->GetIndex()] = true;
+      // Loading the class resolves its superclass and interfaces by descriptor.
+      if (class_def->Superclass() != nullptr) {
+        from_hot_method[class_def->Superclass()->GetStringId()->GetIndex()] = true;
+      }
+      if (class_def->Interfaces() != nullptr) {
+        for (const dex_ir::TypeId* interface : *class_def->Interfaces()->GetTypeList()) {
+          from_hot_method[interface->GetStringId()->GetIndex()] = true;
+        }
+      }
     }
     dex_ir::ClassData* data = class_def->GetClassData();
     if (data == nullptr) {
       continue;
     }
+    if (is_startup_class) {
+      // Linking the class reads the descriptors of its fields, to lay them out, and compares the
+      // names of its virtual methods with the methods they override.
+      for (size_t i = 0; i < 2; ++i) {
+        for (auto& field : *(i == 0 ? data->StaticFields() : data->InstanceFields())) {
+          from_hot_method[field->GetFieldId()->Type()->GetStringId()->GetIndex()] = true;
+        }
+      }
+      for (auto& method : *data->VirtualMethods()) {
+        from_hot_method[method->GetMethodId()->Name()->GetIndex()] = true;
+      }
+    }
     for (size_t i = 0; i < 2; ++i) {
       for (auto& method : *(i == 0 ? data->DirectMethods() : data->VirtualMethods())) {
         const dex_ir::MethodId* method_id = method->GetMethodId();
@@ -1553,7 +1643,7 @@ void DexLayout::LayoutStringData(const DexFile* dex_file) {
         if (code_item == nullptr) {
           continue;
         }
-        const bool is_clinit = is_profile_class &&
+        const bool is_clinit = is_startup_class &&
             (method->GetAccessFlags() & kAccConstructor) != 0 &&
             (method->GetAccessFlags() & kAccStatic) != 0;
         const bool method_executed = is_clinit ||
@@ -1572,6 +1662,19 @@ void DexLayout::LayoutStringData(const DexFile* dex_file) {
             from_hot_method[id->GetIndex()] = true;
           }
         }
+        if (fixups->TypeIds() != nullptr) {
+          // Add the descriptors of the types resolved by the method.
+          for (dex_ir::TypeId* id : *fixups->TypeIds()) {
+            from_hot_method[id->GetStringId()->GetIndex()] = true;
+          }
+        }
+        if (fixups->MethodIds() != nullptr) {
+          // Add the names and declaring classes of the invoked methods, compared by resolution.
+          for (dex_ir::MethodId* id : *fixups->MethodIds()) {
+            from_hot_method[id->Name()->GetIndex()] = true;
+            from_hot_method[id->Class()->GetStringId()->GetIndex()] = true;
+          }
+        }
         // TODO: Only visit field ids from static getters and setters.
         for (dex_ir::FieldId* id : *fixups->FieldIds()) {
           // Add the field names and types from getters and setters.
@@ -1843,8 +1946,10 @@ void DexLayout::FixupSections(uint32_t offset, uint32_t diff) {
 }
 
 void DexLayout::LayoutOutputFile(const DexFile* dex_file) {
-  LayoutStringData(dex_file);
-  std::vector<dex_ir::ClassData*> new_class_data_order = LayoutClassDefsAndClassData(dex_file);
+  const std::vector<bool> startup_classes = CollectStartupClasses(dex_file);
+  LayoutStringData(dex_file, startup_classes);
+  std::vector<dex_ir::ClassData*> new_class_data_order =
+      LayoutClassDefsAndClassData(startup_classes);
   int32_t diff = LayoutCodeItems(dex_file, new_class_data_order);
   // Move sections after ClassData by diff bytes.
   FixupSections(header_->GetCollections().ClassDatasOffset(), diff);
@@ -107,16 +107,18 @@ class DexLayout {
   void DumpSField(uint32_t idx, uint32_t flags, int i, dex_ir::EncodedValue* init);
   void DumpDexFile();
 
-  std::vector<dex_ir::ClassData*> LayoutClassDefsAndClassData(const DexFile* dex_file);
+  std::vector<bool> CollectStartupClasses(const DexFile* dex_file);
+  std::vector<dex_ir::ClassData*> LayoutClassDefsAndClassData(
+      const std::vector<bool>& startup_classes);
   int32_t LayoutCodeItems(const DexFile* dex_file,
                           std::vector<dex_ir::ClassData*> new_class_data_order);
-  void LayoutStringData(const DexFile* dex_file);
+  void LayoutStringData(const DexFile* dex_file, const std::vector<bool>& startup_classes);
   bool IsNextSectionCodeItemAligned(uint32_t offset);
   template<class T> void FixupSection(std::map<uint32_t, std::unique_ptr<T>>& map, uint32_t diff);
   void FixupSections(uint32_t offset, uint32_t diff);
 
   // Creates a new layout for the dex file based on profile info.
-  // Currently reorders ClassDefs, ClassDataItems, and CodeItems.
+  // Currently reorders ClassDefs, ClassDataItems, CodeItems and StringDataItems.
   void LayoutOutputFile(const DexFile* dex_file);
   void OutputDexFile(const DexFile* dex_file);
 
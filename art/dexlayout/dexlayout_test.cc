@@ -23,6 +23,7 @@
 
 #include "base/unix_file/fd_file.h"
 #include "common_runtime_test.h"
+#include "dex_file-inl.h"
 #include "exec_utils.h"
 #include "utils.h"
 
@@ -218,6 +219,21 @@ static const char kDuplicateCodeItemInputDex[] =
     "AHAAAAACAAAAAwAAAIwAAAADAAAAAQAAAJgAAAAFAAAABAAAAKQAAAAGAAAAAQAAAMQAAAABIAAA"
     "AwAAAOQAAAACIAAABwAAACQBAAADIAAAAwAAAFYBAAAAIAAAAQAAAGUBAAAAEAAAAQAAAHgBAAA=";
 
+// Dex file defining, in this order, classes Other, Base and Sub, where Sub extends Base. None of
+// them has class data. Constructed with a script writing the dex format.
+static const char kClassDefOrderInputDex[] =
+    "ZGV4CjAzNQByK34tDVrrt5kiucHeRaYwRX4A3ig0QEhoAQAAcAAAAHhWNBIAAAAAAAAAABwBAAAE"
+    "AAAAcAAAAAQAAACAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAwAAAJAAAAB4AAAA8AAAAPAA"
+    "AAD4AAAAAQEAAAgBAAAAAAAAAQAAAAIAAAADAAAAAQAAAAEAAAADAAAAAAAAAP////8AAAAAAAAA"
+    "AAAAAAAAAAAAAQAAAAMAAAAAAAAA/////wAAAAAAAAAAAAAAAAIAAAABAAAAAAAAAAAAAAD/////"
+    "AAAAAAAAAAAAAAAABkxCYXNlOwAHTE90aGVyOwAFTFN1YjsAEkxqYXZhL2xhbmcvT2JqZWN0OwAG"
+    "AAAAAAAAAAEAAAAAAAAAAQAAAAQAAABwAAAAAgAAAAQAAACAAAAABgAAAAMAAACQAAAAAiAAAAQA"
+    "AADwAAAAABAAAAEAAAAcAQAA";
+
+// Profile for kClassDefOrderInputDex listing Sub but not its superclass Base.
+static const char kClassDefOrderInputProfile[] =
+    "cHJvADAwNQABCwABAAAAAAByK34tY2xhc3Nlcy5kZXgCAA==";
+
 static void WriteBase64ToFile(const char* base64, File* file) {
   // Decode base64.
   CHECK(base64 != nullptr);
@@ -350,6 +366,57 @@ class DexLayoutTest : public CommonRuntimeTest {
     return true;
   }
 
+  // Runs ClassDefOrder test.
+  bool ClassDefOrderExec(std::string* error_msg) {
+    ScratchFile tmp_file;
+    std::string tmp_name = tmp_file.GetFilename();
+    size_t tmp_last_slash = tmp_name.rfind("/");
+    std::string tmp_dir = tmp_name.substr(0, tmp_last_slash + 1);
+
+    // Write inputs.
+    std::string dex_file = tmp_dir + "classes.dex";
+    WriteFileBase64(kClassDefOrderInputDex, dex_file.c_str());
+    std::string profile_file = tmp_dir + "primary.prof";
+    WriteFileBase64(kClassDefOrderInputProfile, profile_file.c_str());
+    std::string output_dex = tmp_dir + "classes.dex.new";
+
+    std::string dexlayout = GetTestAndroidRoot() + "/bin/dexlayout";
+    EXPECT_TRUE(OS::FileExists(dexlayout.c_str())) << dexlayout << " should be a valid file path";
+
+    std::vector<std::string> dexlayout_exec_argv =
+        { dexlayout, "-v", "-w", tmp_dir, "-o", tmp_name, "-p", profile_file, dex_file };
+    if (!::art::Exec(dexlayout_exec_argv, error_msg)) {
+      return false;
+    }
+
+    // Opening the output verifies it, which includes checking that superclasses are defined
+    // before their subclasses.
+    std::vector<std::unique_ptr<const DexFile>> dex_files;
+    if (!DexFile::Open(output_dex.c_str(),
+                       output_dex,
+                       /* verify_checksum */ false,
+                       error_msg,
+                       &dex_files)) {
+      return false;
+    }
+    EXPECT_EQ(dex_files.size(), 1u);
+    const DexFile& output = *dex_files[0];
+    std::vector<std::string> descriptors;
+    for (uint32_t i = 0; i != output.NumClassDefs(); ++i) {
+      descriptors.push_back(output.GetClassDescriptor(output.GetClassDef(i)));
+    }
+    // Sub is a startup class, and so is its superclass Base, which is loaded first. Other is not.
+    std::vector<std::string> expected_descriptors = { "LBase;", "LSub;", "LOther;" };
+    EXPECT_EQ(descriptors, expected_descriptors);
+
+    std::vector<std::string> rm_exec_argv =
+        { "/bin/rm", dex_file, profile_file, output_dex };
+    if (!::art::Exec(rm_exec_argv, error_msg)) {
+      return false;
+    }
+    return true;
+  }
+
   // Runs UnreferencedCatchHandlerTest & Unreferenced0SizeCatchHandlerTest.
   bool UnreferencedCatchHandlerExec(std::string* error_msg, const char* filename) {
     ScratchFile tmp_file;
@@ -427,6 +494,13 @@ TEST_F(DexLayoutTest, DexFileLayout) {
   ASSERT_TRUE(DexFileLayoutExec(&error_msg)) << error_msg;
 }
 
+TEST_F(DexLayoutTest, ClassDefOrder) {
+  // Disable test on target.
+  TEST_DISABLED_FOR_TARGET();
+  std::string error_msg;
+  ASSERT_TRUE(ClassDefOrderExec(&error_msg)) << error_msg;
+}
+
 TEST_F(DexLayoutTest, UnreferencedCatchHandler) {
   // Disable test on target.
   TEST_DISABLED_FOR_TARGET();
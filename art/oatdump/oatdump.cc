@@ -49,6 +49,7 @@
 #include "imtable-inl.h"
 #include "indenter.h"
 #include "interpreter/unstarted_runtime.h"
+#include "jit/profile_compilation_info.h"
 #include "linker/buffered_output_stream.h"
 #include "linker/file_output_stream.h"
 #include "mirror/array-inl.h"
@@ -308,7 +309,8 @@ class OatDumperOptions {
                    const char* export_dex_location,
                    const char* app_image,
                    const char* app_oat,
-                   uint32_t addr2instr)
+                   uint32_t addr2instr,
+                   const char* profile_file)
     : dump_vmap_(dump_vmap),
       dump_code_info_stack_maps_(dump_code_info_stack_maps),
       disassemble_code_(disassemble_code),
@@ -322,6 +324,7 @@ class OatDumperOptions {
       app_image_(app_image),
       app_oat_(app_oat),
       addr2instr_(addr2instr),
+      profile_file_(profile_file),
       class_loader_(nullptr) {}
 
   const bool dump_vmap_;
@@ -337,6 +340,7 @@ class OatDumperOptions {
   const char* const app_image_;
   const char* const app_oat_;
   uint32_t addr2instr_;
+  const char* const profile_file_;
   Handle<mirror::ClassLoader>* class_loader_;
 };
 
@@ -489,6 +493,13 @@ class OatDumper {
     cumulative.Dump(os);
     os << "\n";
 
+    // The code page touches are also compact enough to dump even if header only.
+    if (options_.profile_file_ != nullptr) {
+      if (!DumpCodePageTouches(os)) {
+        success = false;
+      }
+    }
+
     if (!options_.dump_header_only_) {
       VariableIndentationOutputStream vios(&os);
       VdexFile::Header vdex_header = oat_file_.GetVdexFile()->GetHeader();
@@ -774,6 +785,104 @@ class OatDumper {
     offsets_.insert(oat_file_.Size());
   }
 
+  // Pages of the oat file containing the compiled code of a set of methods.
+  class CodePageTouches {
+   public:
+    CodePageTouches() : num_methods_(0u), code_size_(0u) {}
+
+    void Add(uint32_t code_offset, uint32_t code_size) {
+      ++num_methods_;
+      if (!code_offsets_.insert(code_offset).second) {
+        return;  // Deduplicated code.
+      }
+      code_size_ += code_size;
+      for (size_t page = code_offset / kPageSize;
+           page <= (code_offset + code_size - 1u) / kPageSize;
+           ++page) {
+        pages_.insert(page);
+      }
+    }
+
+    void Dump(std::ostream& os, const char* what) const {
+      os << StringPrintf("%-16s %8zu methods %10zu code bytes %6zu pages touched"
+                             " %6zu pages minimum\n",
+                         what,
+                         num_methods_,
+                         code_size_,
+                         pages_.size(),
+                         RoundUp(code_size_, kPageSize) / kPageSize);
+    }
+
+   private:
+    size_t num_methods_;
+    size_t code_size_;
+    std::set<uint32_t> code_offsets_;
+    std::set<size_t> pages_;
+  };
+
+  // Report how many pages of compiled code are touched when executing the methods
+  // in the profile. Like dex2oat, consider the profiled methods of classes resolved
+  // during startup as startup methods and the other profiled methods as hot methods.
+  bool DumpCodePageTouches(std::ostream& os) {
+    os << "CODE PAGE TOUCHES:\n";
+    ProfileCompilationInfo profile;
+    std::unique_ptr<File> profile_file(OS::OpenFileForReading(options_.profile_file_));
+    if (profile_file == nullptr || !profile.Load(profile_file->Fd())) {
+      os << "Failed to load profile '" << options_.profile_file_ << "'\n\n";
+      return false;
+    }
+
+    CodePageTouches startup;
+    CodePageTouches hot;
+    CodePageTouches profiled;
+    CodePageTouches all;
+    for (const OatFile::OatDexFile* oat_dex_file : oat_dex_files_) {
+      CHECK(oat_dex_file != nullptr);
+      std::string error_msg;
+      const DexFile* const dex_file = OpenDexFile(oat_dex_file, &error_msg);
+      if (dex_file == nullptr) {
+        os << "Failed to open dex file '" << oat_dex_file->GetDexFileLocation() << "': "
+           << error_msg << "\n\n";
+        return false;
+      }
+      for (size_t class_def_index = 0;
+           class_def_index < dex_file->NumClassDefs();
+           class_def_index++) {
+        const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_index);
+        const OatFile::OatClass oat_class = oat_dex_file->GetOatClass(class_def_index);
+        const uint8_t* class_data = dex_file->GetClassData(class_def);
+        if (class_data == nullptr) {
+          continue;
+        }
+        bool startup_class = profile.ContainsClass(*dex_file, class_def.class_idx_);
+        ClassDataItemIterator it(*dex_file, class_data);
+        SkipAllFields(it);
+        for (uint32_t class_method_index = 0;
+             it.HasNextDirectMethod() || it.HasNextVirtualMethod();
+             ++class_method_index) {
+          const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_method_index);
+          uint32_t code_offset = AlignCodeOffset(oat_method.GetCodeOffset());
+          uint32_t code_size = oat_method.GetQuickCodeSize();
+          if (code_offset != 0u && code_size != 0u) {
+            all.Add(code_offset, code_size);
+            if (profile.ContainsMethod(MethodReference(dex_file, it.GetMemberIndex()))) {
+              profiled.Add(code_offset, code_size);
+              (startup_class ? startup : hot).Add(code_offset, code_size);
+            }
+          }
+          it.Next();
+        }
+      }
+    }
+
+    startup.Dump(os, "startup");
+    hot.Dump(os, "hot");
+    profiled.Dump(os, "profiled");
+    all.Dump(os, "all compiled");
+    os << "\n";
+    return true;
+  }
+
   static uint32_t AlignCodeOffset(uint32_t maybe_thumb_offset) {
     return maybe_thumb_offset & ~0x1;  // TODO: Make this Thumb2 specific.
   }
@@ -3367,6 +3476,8 @@ struct OatdumpArgs : public CmdlineArgs {
       imt_dump_ = option.substr(strlen("--dump-imt=")).data();
     } else if (option == "--dump-imt-stats") {
       imt_stat_dump_ = true;
+    } else if (option.starts_with("--profile-file=")) {
+      profile_file_ = option.substr(strlen("--profile-file=")).data();
     } else {
       return kParseUnknownArgument;
     }
@@ -3464,6 +3575,10 @@ struct OatdumpArgs : public CmdlineArgs {
         "                          address (e.g. PC from crash dump)\n"
         "      Example: --addr2instr=0x00001a3b\n"
         "\n"
+        "  --profile-file=<file.prof>: output the number of pages of compiled code touched\n"
+        "                              by the startup and hot methods of the given profile\n"
+        "      Example: --profile-file=/data/misc/profiles/cur/0/com.example/primary.prof\n"
+        "\n"
         "  --dump-imt=<file.txt>: output IMT collisions (if any) for the given receiver\n"
         "                         types and interface methods in the given file. The file\n"
         "                         is read line-wise, where each line should either be a class\n"
@@ -3498,6 +3613,7 @@ struct OatdumpArgs : public CmdlineArgs {
   const char* export_dex_location_ = nullptr;
   const char* app_image_ = nullptr;
   const char* app_oat_ = nullptr;
+  const char* profile_file_ = nullptr;
 };
 
 struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
@@ -3520,7 +3636,8 @@ struct OatdumpMain : public CmdlineMain<OatdumpArgs> {
         args_->export_dex_location_,
         args_->app_image_,
         args_->app_oat_,
-        args_->addr2instr_));
+        args_->addr2instr_,
+        args_->profile_file_));
 
     return (args_->boot_image_location_ != nullptr ||
             args_->image_location_ != nullptr ||
@@ -136,6 +136,9 @@ void InitEntryPoints(JniEntryPoints* jpoints, QuickEntryPoints* qpoints) {
   qpoints->pStringCompareTo = nullptr;
   qpoints->pMemcpy = memcpy;
 
+  // JIT, used by baseline code to request an optimized compile.
+  qpoints->pCompileOptimized = art_quick_compile_optimized;
+
   // Read barrier.
   qpoints->pReadBarrierJni = ReadBarrierJni;
   UpdateReadBarrierEntrypoints(qpoints, /*is_marking*/ false);
@@ -185,6 +185,9 @@ void InitEntryPoints(JniEntryPoints* jpoints, QuickEntryPoints* qpoints) {
   qpoints->pStringCompareTo = nullptr;
   qpoints->pMemcpy = memcpy;
 
+  // JIT, used by baseline code to request an optimized compile.
+  qpoints->pCompileOptimized = art_quick_compile_optimized;
+
   // Read barrier.
   qpoints->pReadBarrierJni = ReadBarrierJni;
   qpoints->pReadBarrierMarkReg16 = nullptr;  // IP0 is used as a temp by the asm stub.
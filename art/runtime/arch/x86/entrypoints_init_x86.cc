@@ -95,6 +95,9 @@ void InitEntryPoints(JniEntryPoints* jpoints, QuickEntryPoints* qpoints) {
   qpoints->pStringCompareTo = art_quick_string_compareto;
   qpoints->pMemcpy = art_quick_memcpy;
 
+  // JIT, used by baseline code to request an optimized compile.
+  qpoints->pCompileOptimized = art_quick_compile_optimized;
+
   // Read barrier.
   qpoints->pReadBarrierJni = ReadBarrierJni;
   UpdateReadBarrierEntrypoints(qpoints, /*is_marking*/ false);
@@ -325,6 +325,10 @@ class ArtMethod FINAL {
     return OFFSET_OF_OBJECT_MEMBER(ArtMethod, method_index_);
   }
 
+  static MemberOffset HotnessCountOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(ArtMethod, hotness_count_);
+  }
+
   uint32_t GetCodeItemOffset() {
     return dex_code_item_offset_;
   }
@@ -692,8 +696,9 @@ class ArtMethod FINAL {
   // ifTable.
   uint16_t method_index_;
 
-  // The hotness we measure for this method. Managed by the interpreter. Not atomic, as we allow
-  // missing increments: if the method is hot, we will see it eventually.
+  // The hotness we measure for this method. Managed by the interpreter, and incremented on entry
+  // by JIT baseline code. Not atomic, as we allow missing increments: if the method is hot, we
+  // will see it eventually.
   uint16_t hotness_count_;
 
   // Fake padding field gets inserted here.
@@ -109,6 +109,7 @@
 #include "trace.h"
 #include "utils.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
+#include "verifier/background_verifier.h"
 #include "verifier/method_verifier.h"
 #include "well_known_classes.h"
 
@@ -3500,6 +3501,10 @@ ObjPtr<mirror::DexCache> ClassLinker::RegisterDexFile(const DexFile& dex_file,
     // Since we added a strong root to the class table, do the write barrier as required for
     // remembered sets and generational GCs.
     Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(h_class_loader.Get());
+    verifier::BackgroundVerifier* background_verifier = Runtime::Current()->GetBackgroundVerifier();
+    if (background_verifier != nullptr) {
+      background_verifier->AddDexFile(self, dex_file, h_class_loader.Get());
+    }
   }
   return h_dex_cache.Get();
 }
@@ -8807,15 +8812,20 @@ void ClassLinker::InsertDexFileInToClassLoader(ObjPtr<mirror::Object> dex_file,
 void ClassLinker::CleanupClassLoaders() {
   Thread* const self = Thread::Current();
   std::vector<ClassLoaderData> to_delete;
+  // Class table sets and views retired before the oldest lock free lookup still running can be
+  // freed. The thread list lock is below the class table locks, so scan the threads first.
+  const uint64_t oldest_read_epoch = ClassTable::AdvanceReadEpoch(self);
   // Do the delete outside the lock to avoid lock violation in jit code cache.
   {
     WriterMutexLock mu(self, *Locks::classlinker_classes_lock_);
+    boot_class_table_.ReclaimRetired(oldest_read_epoch);
     for (auto it = class_loaders_.begin(); it != class_loaders_.end(); ) {
       const ClassLoaderData& data = *it;
       // Need to use DecodeJObject so that we get null for cleared JNI weak globals.
       ObjPtr<mirror::ClassLoader> class_loader =
           ObjPtr<mirror::ClassLoader>::DownCast(self->DecodeJObject(data.weak_root));
       if (class_loader != nullptr) {
+        data.class_table->ReclaimRetired(oldest_read_epoch);
         ++it;
       } else {
         VLOG(class_linker) << "Freeing class loader";
@@ -70,6 +70,10 @@ class Runtime;
 class ScopedObjectAccessAlreadyRunnable;
 template<size_t kNumReferences> class PACKED(4) StackHandleScope;
 
+namespace verifier {
+class BackgroundVerifier;
+}  // namespace verifier
+
 enum VisitRootFlags : uint8_t;
 
 class ClassVisitor {
@@ -1216,6 +1220,7 @@ class ClassLinker {
   friend class ImageDumper;  // for DexLock
   friend class ImageWriter;  // for GetClassRoots
   friend class VMClassLoader;  // for LookupClass and FindClassInBaseDexClassLoader.
+  friend class verifier::BackgroundVerifier;  // for FindClassInBaseDexClassLoader.
   friend class JniCompilerTest;  // for GetRuntimeQuickGenericJniStub
   friend class JniInternalTest;  // for GetRuntimeQuickGenericJniStub
   ART_FRIEND_TEST(ClassLinkerTest, RegisterDexFileName);  // for DexLock, and RegisterDexFileLocked
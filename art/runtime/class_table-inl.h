@@ -25,8 +25,8 @@ namespace art {
 template<class Visitor>
 void ClassTable::VisitRoots(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       table_slot.VisitRoot(visitor);
     }
   }
@@ -43,8 +43,8 @@ void ClassTable::VisitRoots(Visitor& visitor) {
 template<class Visitor>
 void ClassTable::VisitRoots(const Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       table_slot.VisitRoot(visitor);
     }
   }
@@ -61,8 +61,8 @@ void ClassTable::VisitRoots(const Visitor& visitor) {
 template <typename Visitor>
 bool ClassTable::Visit(Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       if (!visitor(table_slot.Read())) {
         return false;
       }
@@ -74,8 +74,8 @@ bool ClassTable::Visit(Visitor& visitor) {
 template <typename Visitor>
 bool ClassTable::Visit(const Visitor& visitor) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    for (TableSlot& table_slot : class_set) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (TableSlot& table_slot : *class_set) {
       if (!visitor(table_slot.Read())) {
         return false;
       }
@@ -18,26 +18,118 @@
 
 #include "mirror/class-inl.h"
 #include "oat_file.h"
+#include "thread-inl.h"
+#include "thread_list.h"
 
 namespace art {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+Atomic<uint64_t> ClassTable::read_epoch_(1u);
+
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock),
+      read_view_(nullptr) {
   Runtime* const runtime = Runtime::Current();
-  classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
-                              runtime->GetHashTableMaxLoadFactor()));
+  classes_.emplace_back(new ClassSet(runtime->GetHashTableMinLoadFactor(),
+                                     runtime->GetHashTableMaxLoadFactor()));
+  // No other thread can see the table yet.
+  PublishReadViewWithoutLocks();
+}
+
+template <typename Key>
+mirror::Class* ClassTable::LookupLockFree(const Key& key, size_t hash) {
+  Thread* const self = Thread::Current();
+  DCHECK_EQ(self->GetClassTableReadEpoch(), 0u);
+  // Record the epoch before loading the view, so that a reclaimer that sees no epoch, or a later
+  // one, knows we load a view published before it advanced the epoch.
+  self->SetClassTableReadEpoch(read_epoch_.LoadRelaxed());
+  QuasiAtomic::ThreadFenceSequentiallyConsistent();
+  const ReadView* const view = read_view_.LoadAcquire();
+  mirror::Class* result = nullptr;
+  for (const ClassSet* class_set : view->sets) {
+    auto it = class_set->FindWithHash(key, hash);
+    if (it != class_set->end()) {
+      result = it->Read();
+      break;
+    }
+  }
+  self->SetClassTableReadEpoch(0u);
+  return result;
+}
+
+void ClassTable::PublishReadView() {
+  PublishReadViewWithoutLocks();
+}
+
+void ClassTable::PublishReadViewWithoutLocks() {
+  std::unique_ptr<ReadView> view(new ReadView());
+  view->sets.reserve(classes_.size());
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    view->sets.push_back(class_set.get());
+  }
+  read_view_.StoreRelease(view.get());
+  if (view_ != nullptr) {
+    retired_.push_back({read_epoch_.LoadSequentiallyConsistent(), nullptr, std::move(view_)});
+  }
+  view_ = std::move(view);
+}
+
+void ClassTable::ReplaceClassSet(size_t index, std::unique_ptr<ClassSet> set) {
+  std::unique_ptr<ClassSet> replaced = std::move(classes_[index]);
+  classes_[index] = std::move(set);
+  PublishReadView();
+  // Tagged after the view that no longer lists it was published.
+  retired_.push_back({read_epoch_.LoadSequentiallyConsistent(), std::move(replaced), nullptr});
+}
+
+void ClassTable::InsertLocked(const TableSlot& slot, size_t hash) {
+  ClassSet* class_set = classes_.back().get();
+  if (class_set->Size() >= class_set->ElementsUntilExpand()) {
+    // Expanding in place would free the buckets under lock free readers. The copy expands on the
+    // insert below.
+    ReplaceClassSet(classes_.size() - 1u, std::unique_ptr<ClassSet>(new ClassSet(*class_set)));
+    class_set = classes_.back().get();
+  }
+  // Make the class visible before the slot that publishes it.
+  QuasiAtomic::ThreadFenceForConstructor();
+  class_set->InsertWithHash(slot, hash);
+}
+
+uint64_t ClassTable::AdvanceReadEpoch(Thread* self) {
+  // Lookups that record the new epoch, or start later, load views published before this point.
+  const uint64_t epoch = read_epoch_.FetchAndAddSequentiallyConsistent(1u) + 1u;
+  uint64_t oldest = epoch;
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+    const uint64_t thread_epoch = thread->GetClassTableReadEpoch();
+    if (thread_epoch != 0u && thread_epoch < oldest) {
+      oldest = thread_epoch;
+    }
+  }
+  return oldest;
+}
+
+void ClassTable::ReclaimRetired(uint64_t oldest_read_epoch) {
+  WriterMutexLock mu(Thread::Current(), lock_);
+  // Retired in epoch order.
+  size_t count = 0;
+  while (count != retired_.size() && retired_[count].epoch < oldest_read_epoch) {
+    ++count;
+  }
+  retired_.erase(retired_.begin(), retired_.begin() + count);
 }
 
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.push_back(ClassSet());
+  classes_.emplace_back(new ClassSet());
+  PublishReadView();
 }
 
 bool ClassTable::Contains(ObjPtr<mirror::Class> klass) {
   ReaderMutexLock mu(Thread::Current(), lock_);
   TableSlot slot(klass);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(slot);
-    if (it != class_set.end()) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    auto it = class_set->Find(slot);
+    if (it != class_set->end()) {
       return it->Read() == klass;
     }
   }
@@ -45,15 +137,9 @@ bool ClassTable::Contains(ObjPtr<mirror::Class> klass) {
 }
 
 mirror::Class* ClassTable::LookupByDescriptor(ObjPtr<mirror::Class> klass) {
-  ReaderMutexLock mu(Thread::Current(), lock_);
   TableSlot slot(klass);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(slot);
-    if (it != class_set.end()) {
-      return it->Read();
-    }
-  }
-  return nullptr;
+  const size_t hash = ClassDescriptorHashEquals()(slot);
+  return LookupLockFree(slot, hash);
 }
 
 // To take into account http://b/35845221
@@ -66,10 +152,10 @@ mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* kl
   WriterMutexLock mu(Thread::Current(), lock_);
   // Should only be updating latest table.
   DescriptorHashPair pair(descriptor, hash);
-  auto existing_it = classes_.back().FindWithHash(pair, hash);
-  if (kIsDebugBuild && existing_it == classes_.back().end()) {
-    for (const ClassSet& class_set : classes_) {
-      if (class_set.FindWithHash(pair, hash) != class_set.end()) {
+  auto existing_it = classes_.back()->FindWithHash(pair, hash);
+  if (kIsDebugBuild && existing_it == classes_.back()->end()) {
+    for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+      if (class_set->FindWithHash(pair, hash) != class_set->end()) {
         LOG(FATAL) << "Updating class found in frozen table " << descriptor;
       }
     }
@@ -82,7 +168,8 @@ mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* kl
   CHECK(!klass->IsTemp()) << descriptor;
   VerifyObject(klass);
   // Update the element in the hash set with the new class. This is safe to do since the descriptor
-  // doesn't change.
+  // doesn't change, lock free readers see either class.
+  QuasiAtomic::ThreadFenceForConstructor();
   *existing_it = TableSlot(klass, hash);
   return existing;
 }
@@ -104,95 +191,119 @@ size_t ClassTable::NumZygoteClasses(ObjPtr<mirror::ClassLoader> defining_loader)
   ReaderMutexLock mu(Thread::Current(), lock_);
   size_t sum = 0;
   for (size_t i = 0; i < classes_.size() - 1; ++i) {
-    sum += CountDefiningLoaderClasses(defining_loader, classes_[i]);
+    sum += CountDefiningLoaderClasses(defining_loader, *classes_[i]);
   }
   return sum;
 }
 
 size_t ClassTable::NumNonZygoteClasses(ObjPtr<mirror::ClassLoader> defining_loader) const {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  return CountDefiningLoaderClasses(defining_loader, classes_.back());
+  return CountDefiningLoaderClasses(defining_loader, *classes_.back());
 }
 
 size_t ClassTable::NumReferencedZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
   size_t sum = 0;
   for (size_t i = 0; i < classes_.size() - 1; ++i) {
-    sum += classes_[i].Size();
+    sum += classes_[i]->Size();
   }
   return sum;
 }
 
 size_t ClassTable::NumReferencedNonZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  return classes_.back().Size();
+  return classes_.back()->Size();
 }
 
 mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
   DescriptorHashPair pair(descriptor, hash);
-  ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.FindWithHash(pair, hash);
-    if (it != class_set.end()) {
-      return it->Read();
-    }
-  }
-  return nullptr;
+  return LookupLockFree(pair, hash);
 }
 
 ObjPtr<mirror::Class> ClassTable::TryInsert(ObjPtr<mirror::Class> klass) {
   TableSlot slot(klass);
   WriterMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(slot);
-    if (it != class_set.end()) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    auto it = class_set->Find(slot);
+    if (it != class_set->end()) {
       return it->Read();
     }
   }
-  classes_.back().Insert(slot);
+  InsertLocked(slot, ClassDescriptorHashEquals()(slot));
   return klass;
 }
 
 void ClassTable::Insert(ObjPtr<mirror::Class> klass) {
   const uint32_t hash = TableSlot::HashDescriptor(klass);
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  InsertLocked(TableSlot(klass, hash), hash);
 }
 
 void ClassTable::CopyWithoutLocks(const ClassTable& source_table) {
   if (kIsDebugBuild) {
-    for (ClassSet& class_set : classes_) {
-      CHECK(class_set.Empty());
+    for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+      CHECK(class_set->Empty());
     }
   }
-  for (const ClassSet& class_set : source_table.classes_) {
-    for (const TableSlot& slot : class_set) {
-      classes_.back().Insert(slot);
+  // No lock free readers yet, the newest set may expand in place.
+  for (const std::unique_ptr<ClassSet>& class_set : source_table.classes_) {
+    for (const TableSlot& slot : *class_set) {
+      classes_.back()->Insert(slot);
     }
   }
 }
 
 void ClassTable::InsertWithoutLocks(ObjPtr<mirror::Class> klass) {
   const uint32_t hash = TableSlot::HashDescriptor(klass);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  classes_.back()->InsertWithHash(TableSlot(klass, hash), hash);
 }
 
 void ClassTable::InsertWithHash(ObjPtr<mirror::Class> klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(TableSlot(klass, hash), hash);
+  InsertLocked(TableSlot(klass, hash), hash);
 }
 
 bool ClassTable::Remove(const char* descriptor) {
-  DescriptorHashPair pair(descriptor, ComputeModifiedUtf8Hash(descriptor));
-  WriterMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(pair);
-    if (it != class_set.end()) {
-      class_set.Erase(it);
-      return true;
+  return Remove(std::vector<const char*>{descriptor}) != 0u;
+}
+
+size_t ClassTable::Remove(const std::vector<const char*>& descriptors) {
+  Thread* const self = Thread::Current();
+  size_t removed = 0u;
+  {
+    WriterMutexLock mu(self, lock_);
+    // Erasing shifts the following slots, which a lock free reader could miss. Erase from copies,
+    // made once per set for the whole batch.
+    std::vector<std::unique_ptr<ClassSet>> copies(classes_.size());
+    for (const char* descriptor : descriptors) {
+      DescriptorHashPair pair(descriptor, ComputeModifiedUtf8Hash(descriptor));
+      for (size_t i = 0; i != classes_.size(); ++i) {
+        ClassSet* class_set = (copies[i] != nullptr) ? copies[i].get() : classes_[i].get();
+        auto it = class_set->Find(pair);
+        if (it != class_set->end()) {
+          if (copies[i] == nullptr) {
+            copies[i].reset(new ClassSet(*classes_[i]));
+            class_set = copies[i].get();
+            it = class_set->Find(pair);
+          }
+          class_set->Erase(it);
+          ++removed;
+          break;
+        }
+      }
+    }
+    for (size_t i = 0; i != copies.size(); ++i) {
+      if (copies[i] != nullptr) {
+        ReplaceClassSet(i, std::move(copies[i]));
+      }
     }
   }
-  return false;
+  if (removed != 0u) {
+    // The replaced sets are as large as the table. Free them as soon as no lookup can read them
+    // rather than after the next GC, which dex2oat may never run.
+    ReclaimRetired(AdvanceReadEpoch(self));
+  }
+  return removed;
 }
 
 uint32_t ClassTable::ClassDescriptorHashEquals::operator()(const TableSlot& slot)
@@ -265,8 +376,8 @@ size_t ClassTable::WriteToMemory(uint8_t* ptr) const {
   ClassSet combined;
   // Combine all the class sets in case there are multiple, also adjusts load factor back to
   // default in case classes were pruned.
-  for (const ClassSet& class_set : classes_) {
-    for (const TableSlot& root : class_set) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (const TableSlot& root : *class_set) {
       combined.Insert(root);
     }
   }
@@ -288,7 +399,8 @@ size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.insert(classes_.begin(), std::move(set));
+  classes_.insert(classes_.begin(), std::unique_ptr<ClassSet>(new ClassSet(std::move(set))));
+  PublishReadView();
 }
 
 void ClassTable::ClearStrongRoots() {
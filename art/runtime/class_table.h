@@ -17,10 +17,12 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "atomic.h"
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
@@ -192,12 +194,14 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  // Return the first class that matches the descriptor. Returns null if there are none.
+  // Return the first class that matches the descriptor. Returns null if there are none. Does not
+  // take lock_, see ReadView.
   mirror::Class* Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Return the first class that matches the descriptor of klass. Returns null if there are none.
+  // Does not take lock_.
   mirror::Class* LookupByDescriptor(ObjPtr<mirror::Class> klass)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -218,7 +222,13 @@ class ClassTable {
 
   // Returns true if the class was found and removed, false otherwise.
   bool Remove(const char* descriptor)
-      REQUIRES(!lock_)
+      REQUIRES(!lock_, !Locks::thread_list_lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Remove the classes with the given descriptors, copying each class set at most once. Returns
+  // the number of classes found and removed.
+  size_t Remove(const std::vector<const char*>& descriptors)
+      REQUIRES(!lock_, !Locks::thread_list_lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   // Return true if we inserted the strong root, false if it already exists.
@@ -251,11 +261,53 @@ class ClassTable {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Advance the lock free lookup epoch and return the oldest epoch a lookup in progress may have
+  // started at. Class sets retired before it are no longer read, see ReclaimRetired.
+  static uint64_t AdvanceReadEpoch(Thread* self) REQUIRES(!Locks::thread_list_lock_);
+
+  // Free the class sets and views retired before oldest_read_epoch.
+  void ReclaimRetired(uint64_t oldest_read_epoch) REQUIRES(!lock_);
+
   ReaderWriterMutex& GetLock() {
     return lock_;
   }
 
  private:
+  // Lock free lookups probe the class sets listed in the published ReadView (an RCU scheme) and
+  // only write thread local state: the lookup epoch recorded in the Thread while probing.
+  //
+  // A published ClassSet is only modified in place by filling an empty slot or by updating a
+  // slot, both single word stores that a concurrent probe sees either before or after. A writer
+  // that would resize a published set, erase from it, or change the list of sets instead publishes
+  // a new ReadView with a modified copy, and retires the replaced set and view tagged with the
+  // current epoch. Once every lookup in progress started at a later epoch, ReclaimRetired() frees
+  // them; the class linker does so after each GC.
+  struct ReadView {
+    std::vector<const ClassSet*> sets;
+  };
+
+  struct Retired {
+    uint64_t epoch;
+    std::unique_ptr<ClassSet> set;
+    std::unique_ptr<ReadView> view;
+  };
+
+  template <typename Key>
+  mirror::Class* LookupLockFree(const Key& key, size_t hash)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Publish a view of classes_ after the list of sets changed.
+  void PublishReadView() REQUIRES(lock_);
+  void PublishReadViewWithoutLocks() NO_THREAD_SAFETY_ANALYSIS;
+
+  // Replace a set in classes_, retiring the previous one, and publish the change.
+  void ReplaceClassSet(size_t index, std::unique_ptr<ClassSet> set) REQUIRES(lock_);
+
+  // Insert into the newest set, through a larger copy if the set is due to expand.
+  void InsertLocked(const TableSlot& slot, size_t hash)
+      REQUIRES(lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Only copies classes.
   void CopyWithoutLocks(const ClassTable& source_table) NO_THREAD_SAFETY_ANALYSIS;
   void InsertWithoutLocks(ObjPtr<mirror::Class> klass) NO_THREAD_SAFETY_ANALYSIS;
@@ -273,7 +325,8 @@ class ClassTable {
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
   // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // Sets are heap allocated so that the vector may grow under lock free readers.
+  std::vector<std::unique_ptr<ClassSet>> classes_ GUARDED_BY(lock_);
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
@@ -281,6 +334,14 @@ class ClassTable {
   // Keep track of oat files with GC roots associated with dex caches in `strong_roots_`.
   std::vector<const OatFile*> oat_files_ GUARDED_BY(lock_);
 
+  // The view of classes_ for lock free lookups.
+  std::unique_ptr<ReadView> view_ GUARDED_BY(lock_);
+  Atomic<const ReadView*> read_view_;
+  std::vector<Retired> retired_ GUARDED_BY(lock_);
+
+  // Current lock free lookup epoch.
+  static Atomic<uint64_t> read_epoch_;
+
   friend class ImageWriter;  // for InsertWithoutLocks.
 };
 
@@ -27,6 +27,7 @@
 #include "mirror/class-inl.h"
 #include "obj_ptr.h"
 #include "scoped_thread_state_change-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace mirror {
@@ -156,8 +157,71 @@ TEST_F(ClassTableTest, ClassTable) {
   EXPECT_TRUE(table2.Contains(h_X.Get()));
   EXPECT_TRUE(table2.Contains(h_Y.Get()));
 
+  // Test removing several classes at once, including one that is absent.
+  EXPECT_EQ(table.Remove(std::vector<const char*>{descriptor_x, descriptor_y, "LZ;"}), 2u);
+  EXPECT_FALSE(table.Contains(h_X.Get()));
+  EXPECT_FALSE(table.Contains(h_Y.Get()));
+
   // TODO: Add tests for UpdateClass, InsertOatFile.
 }
 
+class LookupTask : public Task {
+ public:
+  LookupTask(ClassTable* table, Handle<mirror::Class> klass, const char* descriptor)
+      : table_(table), klass_(klass), descriptor_(descriptor) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    const size_t hash = ComputeModifiedUtf8Hash(descriptor_);
+    for (size_t i = 0; i < kIterations; ++i) {
+      EXPECT_EQ(table_->Lookup(descriptor_, hash), klass_.Get());
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+  static constexpr size_t kIterations = 10000;
+
+ private:
+  ClassTable* const table_;
+  const Handle<mirror::Class> klass_;
+  const char* const descriptor_;
+};
+
+// Lock free lookups of an existing class must not miss it while other classes are inserted and
+// removed, which rehashes the class set and adds zygote snapshots under the readers.
+TEST_F(ClassTableTest, ConcurrentLookup) {
+  ScopedObjectAccess soa(Thread::Current());
+  jobject jclass_loader = LoadDex("XandY");
+  VariableSizedHandleScope hs(soa.Self());
+  Handle<ClassLoader> class_loader(hs.NewHandle(soa.Decode<ClassLoader>(jclass_loader)));
+  const char* descriptor_x = "LX;";
+  const char* descriptor_y = "LY;";
+  Handle<mirror::Class> h_X(
+      hs.NewHandle(class_linker_->FindClass(soa.Self(), descriptor_x, class_loader)));
+  Handle<mirror::Class> h_Y(
+      hs.NewHandle(class_linker_->FindClass(soa.Self(), descriptor_y, class_loader)));
+  ClassTable table;
+  table.Insert(h_X.Get());
+
+  static constexpr size_t kThreads = 4;
+  ThreadPool pool("Class table lookup pool", kThreads);
+  for (size_t i = 0; i < kThreads; ++i) {
+    pool.AddTask(soa.Self(), new LookupTask(&table, h_X, descriptor_x));
+  }
+  pool.StartWorkers(soa.Self());
+  for (size_t i = 0; i < 1000; ++i) {
+    table.Insert(h_Y.Get());
+    EXPECT_TRUE(table.Remove(descriptor_y));
+    if (i % 100 == 0) {
+      table.FreezeSnapshot();
+    }
+  }
+  pool.Wait(soa.Self(), /* do_work */ false, /* may_hold_locks */ true);
+  EXPECT_EQ(table.Lookup(descriptor_x, ComputeModifiedUtf8Hash(descriptor_x)), h_X.Get());
+}
+
 }  // namespace mirror
 }  // namespace art
@@ -61,6 +61,10 @@ bool EntrypointRequiresStackMap(QuickEntrypointEnum trampoline) {
     case kQuickUshrLong:
       return false;
 
+    /* Called by baseline JIT code from its frame entry, never suspends. */
+    case kQuickCompileOptimized:
+      return false;
+
     /* Used by mips for 64bit volatile load/stores. */
     case kQuickA64Load:
     case kQuickA64Store:
@@ -112,6 +116,10 @@ bool EntrypointCanTriggerGC(QuickEntrypointEnum entrypoint) {
     case kQuickUshrLong:
       return false;
 
+    /* Called by baseline JIT code from its frame entry, never suspends. */
+    case kQuickCompileOptimized:
+      return false;
+
     /* Used by mips for 64bit volatile load/stores. */
     case kQuickA64Load:
     case kQuickA64Store:
@@ -51,6 +51,18 @@ class HeapBitmap {
   void Walk(ObjectCallback* callback, void* arg)
       REQUIRES_SHARED(Locks::heap_bitmap_lock_);
 
+  const std::vector<ContinuousSpaceBitmap*,
+                    TrackingAllocator<ContinuousSpaceBitmap*, kAllocatorTagHeapBitmap>>&
+      GetContinuousSpaceBitmaps() const REQUIRES_SHARED(Locks::heap_bitmap_lock_) {
+    return continuous_space_bitmaps_;
+  }
+
+  const std::vector<LargeObjectBitmap*,
+                    TrackingAllocator<LargeObjectBitmap*, kAllocatorTagHeapBitmapLOS>>&
+      GetLargeObjectBitmaps() const REQUIRES_SHARED(Locks::heap_bitmap_lock_) {
+    return large_object_bitmaps_;
+  }
+
   template <typename Visitor>
   void Visit(const Visitor& visitor)
       REQUIRES(Locks::heap_bitmap_lock_)
@@ -73,7 +73,7 @@ inline mirror::Object* ConcurrentCopying::MarkImmuneSpace(mirror::Object* ref) {
     // true). Also, a mutator doesn't (need to) gray an immune object after GC has updated all
     // immune space objects (when updated_all_immune_objects_ is true).
     if (kIsDebugBuild) {
-      if (Thread::Current() == thread_running_gc_) {
+      if (Thread::Current() == thread_running_gc_ || parallel_marking_) {
         DCHECK(!kGrayImmuneObject ||
                updated_all_immune_objects_.LoadRelaxed() ||
                gc_grays_immune_objects_);
@@ -105,7 +105,7 @@ inline mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref,
   DCHECK(heap_->collector_type_ == kCollectorTypeCC);
   if (kFromGCThread) {
     DCHECK(is_active_);
-    DCHECK_EQ(Thread::Current(), thread_running_gc_);
+    DCHECK(Thread::Current() == thread_running_gc_ || parallel_marking_);
   } else if (UNLIKELY(kUseBakerReadBarrier && !is_active_)) {
     // In the lock word forward address state, the read barrier bits
     // in the lock word are part of the stored forwarding address and
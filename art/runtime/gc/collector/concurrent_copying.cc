@@ -40,6 +40,7 @@
 #include "scoped_thread_state_change-inl.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -59,22 +60,40 @@ static constexpr bool kDisallowReadBarrierDuringScan = kIsDebugBuild;
 static constexpr size_t kReadBarrierMarkStackSize = 512 * KB;
 // Verify that there are no missing card marks.
 static constexpr bool kVerifyNoMissingCardMarks = kIsDebugBuild;
+// Don't start the thread pool for less work than this.
+static constexpr size_t kMinimumParallelMarkStackSize = 128;
+// Busy markers hand off half of their mark stack to idle ones when it has at least this many refs.
+static constexpr size_t kMinimumParallelMarkShareSize = 32;
 
 ConcurrentCopying::ConcurrentCopying(Heap* heap,
+                                     bool young_gen,
+                                     bool use_generational_cc,
                                      const std::string& name_prefix,
-                                     bool measure_read_barrier_slow_path)
+                                     bool measure_read_barrier_slow_path,
+                                     ConcurrentCopying* mark_stacks_owner)
     : GarbageCollector(heap,
                        name_prefix + (name_prefix.empty() ? "" : " ") +
                        "concurrent copying"),
       region_space_(nullptr), gc_barrier_(new Barrier(0)),
-      gc_mark_stack_(accounting::ObjectStack::Create("concurrent copying gc mark stack",
-                                                     kDefaultGcMarkStackSize,
-                                                     kDefaultGcMarkStackSize)),
-      rb_mark_bit_stack_(accounting::ObjectStack::Create("rb copying gc mark stack",
-                                                         kReadBarrierMarkStackSize,
-                                                         kReadBarrierMarkStackSize)),
+      gc_mark_stack_(mark_stacks_owner != nullptr
+          ? mark_stacks_owner->gc_mark_stack_
+          : std::shared_ptr<accounting::ObjectStack>(
+                accounting::ObjectStack::Create("concurrent copying gc mark stack",
+                                                kDefaultGcMarkStackSize,
+                                                kDefaultGcMarkStackSize))),
+      rb_mark_bit_stack_(mark_stacks_owner != nullptr
+          ? mark_stacks_owner->rb_mark_bit_stack_
+          : std::shared_ptr<accounting::ObjectStack>(
+                accounting::ObjectStack::Create("rb copying gc mark stack",
+                                                kReadBarrierMarkStackSize,
+                                                kReadBarrierMarkStackSize))),
       rb_mark_bit_stack_full_(false),
       mark_stack_lock_("concurrent copying mark stack lock", kMarkSweepMarkStackLock),
+      parallel_marking_(false),
+      parallel_markers_(0),
+      idle_parallel_markers_(0),
+      parallel_mark_cond_("concurrent copying parallel mark condition", mark_stack_lock_),
+      parallel_marked_count_(0),
       thread_running_gc_(nullptr),
       is_marking_(false),
       is_active_(false),
@@ -98,11 +117,17 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap,
       rb_slow_path_count_gc_total_(0),
       rb_table_(heap_->GetReadBarrierTable()),
       force_evacuate_all_(false),
+      young_gen_(young_gen),
+      use_generational_cc_(use_generational_cc),
       gc_grays_immune_objects_(false),
       immune_gray_stack_lock_("concurrent copying immune gray stack lock",
                               kMarkSweepMarkStackLock) {
   static_assert(space::RegionSpace::kRegionSize == accounting::ReadBarrierTable::kRegionSize,
                 "The region space size and the read barrier table region size must match");
+  CHECK(!young_gen_ || use_generational_cc_);
+  // Young collections rely on the Baker read barrier to catch mutator reads through the old
+  // objects grayed in the flip.
+  CHECK(!use_generational_cc_ || kUseBakerReadBarrier);
   Thread* self = Thread::Current();
   {
     ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
@@ -202,10 +227,24 @@ void ConcurrentCopying::BindBitmaps() {
       CHECK(space->IsZygoteSpace() || space->IsImageSpace());
       immune_spaces_.AddSpace(space);
     } else if (space == region_space_) {
-      // It is OK to clear the bitmap with mutators running since the only place it is read is
-      // VisitObjects which has exclusion with CC.
       region_space_bitmap_ = region_space_->GetMarkBitmap();
-      region_space_bitmap_->Clear();
+      // A young collection has no unevacuated from-space and keeps the bits describing the
+      // partially live old regions, VisitOldObjectsOnDirtyCards needs them to skip dead objects.
+      if (!young_gen_) {
+        // It is OK to clear the bitmap with mutators running since the only place it is read is
+        // VisitObjects which has exclusion with CC.
+        region_space_bitmap_->Clear();
+      }
+    } else if (young_gen_ && space->IsContinuousMemMapAllocSpace()) {
+      // As in the sticky mark sweep, every object allocated before the last collection is
+      // considered marked, marking only adds the objects allocated since then.
+      space->AsContinuousMemMapAllocSpace()->BindLiveToMarkBitmap();
+    }
+  }
+  if (young_gen_) {
+    for (const auto& space : heap_->GetDiscontinuousSpaces()) {
+      CHECK(space->IsLargeObjectSpace());
+      space->AsLargeObjectSpace()->CopyLiveToMarked();
     }
   }
 }
@@ -354,12 +393,27 @@ class ConcurrentCopying::FlipCallback : public Closure {
     }
     CHECK(thread == self);
     Locks::mutator_lock_->AssertExclusiveHeld(self);
-    cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_);
+    space::RegionSpace::EvacMode evac_mode =
+        space::RegionSpace::EvacMode::kEvacModeLivePercentNewlyAllocated;
+    if (cc->young_gen_) {
+      evac_mode = space::RegionSpace::EvacMode::kEvacModeNewlyAllocated;
+    } else if (cc->force_evacuate_all_) {
+      evac_mode = space::RegionSpace::EvacMode::kEvacModeForceAll;
+    }
+    cc->region_space_->SetFromSpace(cc->rb_table_, evac_mode);
     cc->SwapStacks();
     if (ConcurrentCopying::kEnableFromSpaceAccountingCheck) {
       cc->RecordLiveStackFreezeSize(self);
-      cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
-      cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      if (cc->young_gen_) {
+        // The old generation stays in the to-space.
+        cc->from_space_num_objects_at_first_pause_ =
+            cc->region_space_->GetObjectsAllocatedInFromSpace();
+        cc->from_space_num_bytes_at_first_pause_ =
+            cc->region_space_->GetBytesAllocatedInFromSpace();
+      } else {
+        cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
+        cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      }
     }
     cc->is_marking_ = true;
     cc->mark_stack_mode_.StoreRelaxed(ConcurrentCopying::kMarkStackModeThreadLocal);
@@ -378,6 +432,13 @@ class ConcurrentCopying::FlipCallback : public Closure {
         cc->VerifyGrayImmuneObjects();
       }
     }
+    if (cc->young_gen_) {
+      cc->GrayAllDirtyOldObjects();
+    }
+    if (cc->use_generational_cc_) {
+      // References stored from now on dirty the cards again, for the next young collection.
+      cc->ClearNonImmuneCards();
+    }
     cc->java_lang_Object_ = down_cast<mirror::Class*>(cc->Mark(
         WellKnownClasses::ToClass(WellKnownClasses::java_lang_Object).Ptr()));
   }
@@ -627,6 +688,59 @@ void ConcurrentCopying::GrayAllDirtyImmuneObjects() {
   updated_all_immune_objects_.StoreRelaxed(true);
 }
 
+// Grays an old object on a dirty card and pushes it to be scanned like a newly marked one.
+class ConcurrentCopying::GrayOldObjectVisitor {
+ public:
+  explicit GrayOldObjectVisitor(ConcurrentCopying* cc) : collector_(cc) {}
+
+  ALWAYS_INLINE void operator()(mirror::Object* obj) const REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!collector_->mark_stack_lock_) {
+    if (kIsDebugBuild) {
+      Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+    }
+    if (obj->AtomicSetReadBarrierState(ReadBarrier::WhiteState(), ReadBarrier::GrayState())) {
+      collector_->PushOntoMarkStack(obj);
+    }
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+};
+
+// A young collection treats the old regions and the non-moving space as marked, so objects there
+// that may reference the young regions, those on dirty cards, are grayed during the pause. The
+// read barrier then catches mutator reads of their unscanned fields until the GC scans them.
+void ConcurrentCopying::GrayAllDirtyOldObjects() {
+  TimingLogger::ScopedTiming split(__FUNCTION__, GetTimings());
+  DCHECK(young_gen_);
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  GrayOldObjectVisitor visitor(this);
+  region_space_->VisitOldObjectsOnDirtyCards(card_table, visitor);
+  WriterMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (space == region_space_ ||
+        immune_spaces_.ContainsSpace(space) ||
+        !space->IsContinuousMemMapAllocSpace()) {
+      continue;
+    }
+    // Objects allocated since the last collection are not in the live bitmap, they are traced
+    // (or swept) like young objects.
+    card_table->Scan<false>(space->GetLiveBitmap(), space->Begin(), space->End(), visitor);
+  }
+}
+
+void ConcurrentCopying::ClearNonImmuneCards() {
+  TimingLogger::ScopedTiming split("(Paused)ClearCards", GetTimings());
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (immune_spaces_.ContainsSpace(space) || !space->IsContinuousMemMapAllocSpace()) {
+      continue;
+    }
+    card_table->ClearCardRange(space->Begin(),
+                               AlignUp(space->Limit(), accounting::CardTable::kCardSize));
+  }
+}
+
 void ConcurrentCopying::SwapStacks() {
   heap_->SwapStacks();
 }
@@ -1340,12 +1454,20 @@ bool ConcurrentCopying::ProcessMarkStackOnce() {
   size_t count = 0;
   MarkStackMode mark_stack_mode = mark_stack_mode_.LoadRelaxed();
   if (mark_stack_mode == kMarkStackModeThreadLocal) {
-    // Process the thread-local mark stacks and the GC mark stack.
-    count += ProcessThreadLocalMarkStacks(false, nullptr);
-    while (!gc_mark_stack_->IsEmpty()) {
-      mirror::Object* to_ref = gc_mark_stack_->PopBack();
-      ProcessMarkStackRef(to_ref);
-      ++count;
+    const size_t thread_count = GetParallelMarkThreadCount();
+    // With -Xgc:parallel_cc_marking, process the mark stacks with the heap thread pool.
+    if (heap_->GetUseParallelCCMarking() &&
+        thread_count > 1 &&
+        gc_mark_stack_->Size() >= kMinimumParallelMarkStackSize) {
+      count += ProcessMarkStackParallel(thread_count);
+    } else {
+      // Process the thread-local mark stacks and the GC mark stack.
+      count += ProcessThreadLocalMarkStacks(false, nullptr);
+      while (!gc_mark_stack_->IsEmpty()) {
+        mirror::Object* to_ref = gc_mark_stack_->PopBack();
+        ProcessMarkStackRef(to_ref);
+        ++count;
+      }
     }
     gc_mark_stack_->Reset();
   } else if (mark_stack_mode == kMarkStackModeShared) {
@@ -1430,6 +1552,147 @@ size_t ConcurrentCopying::ProcessThreadLocalMarkStacks(bool disable_weak_ref_acc
   return count;
 }
 
+class ConcurrentCopying::ParallelMarkTask : public SelfDeletingTask {
+ public:
+  explicit ParallelMarkTask(ConcurrentCopying* collector) : collector_(collector) {}
+
+  // Like the MarkSweep tasks, rely on the GC-running thread holding the mutator lock.
+  void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    collector_->ParallelMark(self);
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+};
+
+size_t ConcurrentCopying::GetParallelMarkThreadCount() const {
+  // As in MarkSweep::GetThreadCount(), leave the CPUs to the foreground apps when in the
+  // background.
+  if (heap_->GetThreadPool() == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return heap_->GetConcGCThreadCount() + 1;
+}
+
+size_t ConcurrentCopying::ProcessMarkStackParallel(size_t thread_count) {
+  TimingLogger::ScopedTiming split(__FUNCTION__, GetTimings());
+  Thread* self = Thread::Current();
+  // Collect the mutators' mark stacks first, the workers start by taking them.
+  RevokeThreadLocalMarkStacks(false, nullptr);
+  ThreadPool* thread_pool = heap_->GetThreadPool();
+  {
+    MutexLock mu(self, mark_stack_lock_);
+    parallel_markers_ = 0;
+  }
+  idle_parallel_markers_.StoreRelaxed(0);
+  parallel_marked_count_.StoreRelaxed(0);
+  parallel_marking_ = true;
+  for (size_t i = 1; i < thread_count; ++i) {
+    thread_pool->AddTask(self, new ParallelMarkTask(this));
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  // The GC-running thread marks too, off the GC mark stack.
+  ParallelMark(self);
+  thread_pool->Wait(self, /*do_work*/false, /*may_hold_locks*/true);
+  thread_pool->StopWorkers(self);
+  parallel_marking_ = false;
+  DCHECK(gc_mark_stack_->IsEmpty());
+  return parallel_marked_count_.LoadRelaxed();
+}
+
+void ConcurrentCopying::ParallelMark(Thread* self) {
+  {
+    MutexLock mu(self, mark_stack_lock_);
+    ++parallel_markers_;
+  }
+  size_t count = 0;
+  while (true) {
+    // The GC-running thread pushes onto the GC mark stack, the workers onto their thread-local
+    // mark stacks, which PushOntoMarkStack() may replace when they get full.
+    accounting::ObjectStack* mark_stack =
+        self == thread_running_gc_ ? gc_mark_stack_.get() : self->GetThreadLocalMarkStack();
+    if (mark_stack != nullptr && !mark_stack->IsEmpty()) {
+      if (idle_parallel_markers_.LoadRelaxed() != 0 &&
+          mark_stack->Size() >= kMinimumParallelMarkShareSize) {
+        ShareParallelMarkWork(self, mark_stack);
+      }
+      ProcessMarkStackRef(mark_stack->PopBack());
+      ++count;
+      continue;
+    }
+    accounting::ObjectStack* work = TakeParallelMarkWork(self);
+    if (work == nullptr) {
+      break;
+    }
+    for (StackReference<mirror::Object>* p = work->Begin(); p != work->End(); ++p) {
+      ProcessMarkStackRef(p->AsMirrorPtr());
+      ++count;
+    }
+    RecycleMarkStack(self, work);
+  }
+  parallel_marked_count_.FetchAndAddRelaxed(count);
+}
+
+void ConcurrentCopying::ShareParallelMarkWork(Thread* self, accounting::ObjectStack* mark_stack) {
+  accounting::ObjectStack* shared;
+  {
+    MutexLock mu(self, mark_stack_lock_);
+    if (!pooled_mark_stacks_.empty()) {
+      shared = pooled_mark_stacks_.back();
+      pooled_mark_stacks_.pop_back();
+    } else {
+      shared = accounting::ObjectStack::Create("thread local mark stack", 4 * KB, 4 * KB);
+    }
+  }
+  DCHECK(shared->IsEmpty());
+  const size_t num_refs = std::min(mark_stack->Size() / 2, shared->Capacity());
+  for (size_t i = 0; i < num_refs; ++i) {
+    shared->PushBack(mark_stack->PopBack());
+  }
+  MutexLock mu(self, mark_stack_lock_);
+  revoked_mark_stacks_.push_back(shared);
+  parallel_mark_cond_.Signal(self);
+}
+
+accounting::ObjectStack* ConcurrentCopying::TakeParallelMarkWork(Thread* self) {
+  MutexLock mu(self, mark_stack_lock_);
+  bool idle = false;
+  while (true) {
+    if (!revoked_mark_stacks_.empty()) {
+      accounting::ObjectStack* work = revoked_mark_stacks_.back();
+      revoked_mark_stacks_.pop_back();
+      if (idle) {
+        idle_parallel_markers_.FetchAndSubSequentiallyConsistent(1);
+      }
+      return work;
+    }
+    if (!idle) {
+      idle = true;
+      idle_parallel_markers_.FetchAndAddSequentiallyConsistent(1);
+    }
+    // Only a marker with work can share more, so once all of them are idle marking is done. A
+    // worker starting late finds nothing to do and leaves right away.
+    if (idle_parallel_markers_.LoadSequentiallyConsistent() == parallel_markers_) {
+      parallel_mark_cond_.Broadcast(self);
+      return nullptr;
+    }
+    parallel_mark_cond_.WaitHoldingLocks(self);
+  }
+}
+
+void ConcurrentCopying::RecycleMarkStack(Thread* self, accounting::ObjectStack* mark_stack) {
+  MutexLock mu(self, mark_stack_lock_);
+  if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
+    // The pool has enough. Delete it.
+    delete mark_stack;
+  } else {
+    // Otherwise, put it into the pool for later reuse.
+    mark_stack->Reset();
+    pooled_mark_stacks_.push_back(mark_stack);
+  }
+}
+
 inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
   DCHECK(!region_space_->IsInFromSpace(to_ref));
   if (kUseBakerReadBarrier) {
@@ -1439,8 +1702,11 @@ inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
   }
   bool add_to_live_bytes = false;
   if (region_space_->IsInUnevacFromSpace(to_ref)) {
-    // Mark the bitmap only in the GC thread here so that we don't need a CAS.
-    if (!kUseBakerReadBarrier || !region_space_bitmap_->Set(to_ref)) {
+    // Mark the bitmap only in the GC thread here so that we don't need a CAS, unless the pool
+    // workers are marking too.
+    bool already_marked = parallel_marking_ ? region_space_bitmap_->AtomicTestAndSet(to_ref)
+                                            : region_space_bitmap_->Set(to_ref);
+    if (!kUseBakerReadBarrier || !already_marked) {
       // It may be already marked if we accidentally pushed the same object twice due to the racy
       // bitmap read in MarkUnevacFromSpaceRegion.
       Scan(to_ref);
@@ -1480,12 +1746,16 @@ inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
 #endif
 
   if (add_to_live_bytes) {
-    // Add to the live bytes per unevacuated from space. Note this code is always run by the
-    // GC-running thread (no synchronization required).
+    // Add to the live bytes per unevacuated from space. Note this code is only run by the
+    // GC-running thread (no synchronization required) unless marking in parallel.
     DCHECK(region_space_bitmap_->Test(to_ref));
     size_t obj_size = to_ref->SizeOf<kDefaultVerifyFlags>();
     size_t alloc_size = RoundUp(obj_size, space::RegionSpace::kAlignment);
-    region_space_->AddLiveBytes(to_ref, alloc_size);
+    if (parallel_marking_) {
+      region_space_->AddLiveBytesAtomic(to_ref, alloc_size);
+    } else {
+      region_space_->AddLiveBytes(to_ref, alloc_size);
+    }
   }
   if (ReadBarrier::kEnableToSpaceInvariantChecks) {
     AssertToSpaceInvariantObjectVisitor visitor(this);
@@ -1584,6 +1854,16 @@ void ConcurrentCopying::SweepSystemWeaks(Thread* self) {
 }
 
 void ConcurrentCopying::Sweep(bool swap_bitmaps) {
+  if (young_gen_) {
+    // Old objects outside of the region space are all considered marked, only the objects
+    // allocated before the pause since the last collection can be freed.
+    accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+    if (kEnableFromSpaceAccountingCheck) {
+      CHECK_GE(live_stack_freeze_size_, live_stack->Size());
+    }
+    SweepYoungObjects(live_stack);
+    return;
+  }
   {
     TimingLogger::ScopedTiming t("MarkStackAsLive", GetTimings());
     accounting::ObjectStack* live_stack = heap_->GetLiveStack();
@@ -1632,6 +1912,50 @@ void ConcurrentCopying::MarkZygoteLargeObjects() {
   }
 }
 
+// Like MarkSweep::SweepArray for the sticky collector: the live bitmaps of the non-moving spaces
+// are bound to the mark bitmaps, so only unmarked objects on the live stack are garbage.
+void ConcurrentCopying::SweepYoungObjects(accounting::ObjectStack* live_stack) {
+  TimingLogger::ScopedTiming split(__FUNCTION__, GetTimings());
+  Thread* self = Thread::Current();
+  ObjectBytePair freed;
+  ObjectBytePair freed_los;
+  std::vector<mirror::Object*> free_list;
+  space::LargeObjectSpace* const large_object_space = heap_->GetLargeObjectsSpace();
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (space == region_space_ ||
+        immune_spaces_.ContainsSpace(space) ||
+        !space->IsContinuousMemMapAllocSpace()) {
+      continue;
+    }
+    accounting::ContinuousSpaceBitmap* mark_bitmap = space->GetMarkBitmap();
+    DCHECK_EQ(mark_bitmap, space->GetLiveBitmap());
+    for (StackReference<mirror::Object>* it = live_stack->Begin(); it != live_stack->End(); ++it) {
+      mirror::Object* const obj = it->AsMirrorPtr();
+      if (obj != nullptr && space->HasAddress(obj) && !mark_bitmap->Test(obj)) {
+        free_list.push_back(obj);
+      }
+    }
+    if (!free_list.empty()) {
+      freed.objects += free_list.size();
+      freed.bytes += space->AsAllocSpace()->FreeList(self, free_list.size(), free_list.data());
+      free_list.clear();
+    }
+  }
+  if (large_object_space != nullptr) {
+    accounting::LargeObjectBitmap* const mark_bitmap = large_object_space->GetMarkBitmap();
+    for (StackReference<mirror::Object>* it = live_stack->Begin(); it != live_stack->End(); ++it) {
+      mirror::Object* const obj = it->AsMirrorPtr();
+      if (obj != nullptr && large_object_space->Contains(obj) && !mark_bitmap->Test(obj)) {
+        ++freed_los.objects;
+        freed_los.bytes += large_object_space->Free(self, obj);
+      }
+    }
+  }
+  RecordFree(freed);
+  RecordFreeLOS(freed_los);
+  live_stack->Reset();
+}
+
 void ConcurrentCopying::SweepLargeObjects(bool swap_bitmaps) {
   TimingLogger::ScopedTiming split("SweepLargeObjects", GetTimings());
   if (heap_->GetLargeObjectsSpace() != nullptr) {
@@ -1944,7 +2268,7 @@ inline void ConcurrentCopying::Scan(mirror::Object* to_ref) {
     Thread::Current()->ModifyDebugDisallowReadBarrier(1);
   }
   DCHECK(!region_space_->IsInFromSpace(to_ref));
-  DCHECK_EQ(Thread::Current(), thread_running_gc_);
+  DCHECK(Thread::Current() == thread_running_gc_ || parallel_marking_);
   RefFieldsVisitor visitor(this);
   // Disable the read barrier for a performance reason.
   to_ref->VisitReferences</*kVisitNativeRoots*/true, kDefaultVerifyFlags, kWithoutReadBarrier>(
@@ -1956,7 +2280,7 @@ inline void ConcurrentCopying::Scan(mirror::Object* to_ref) {
 
 // Process a field.
 inline void ConcurrentCopying::Process(mirror::Object* obj, MemberOffset offset) {
-  DCHECK_EQ(Thread::Current(), thread_running_gc_);
+  DCHECK(Thread::Current() == thread_running_gc_ || parallel_marking_);
   mirror::Object* ref = obj->GetFieldObject<
       mirror::Object, kVerifyNone, kWithoutReadBarrier, false>(offset);
   mirror::Object* to_ref = Mark</*kGrayImmuneObject*/false, /*kFromGCThread*/true>(
@@ -2472,8 +2796,9 @@ void ConcurrentCopying::FinishPhase() {
     CHECK_EQ(pooled_mark_stacks_.size(), kMarkStackPoolSize);
   }
   // kVerifyNoMissingCardMarks relies on the region space cards not being cleared to avoid false
-  // positives.
-  if (!kVerifyNoMissingCardMarks) {
+  // positives. With generational CC the cards were cleared in the pause and have been dirtied
+  // since for the next young collection.
+  if (!kVerifyNoMissingCardMarks && !use_generational_cc_) {
     TimingLogger::ScopedTiming split("ClearRegionSpaceCards", GetTimings());
     // We do not currently use the region space cards at all, madvise them away to save ram.
     heap_->GetCardTable()->ClearCardRange(region_space_->Begin(), region_space_->Limit());
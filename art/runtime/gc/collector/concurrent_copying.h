@@ -28,6 +28,7 @@
 #include "mirror/object_reference.h"
 #include "safe_map.h"
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -63,9 +64,20 @@ class ConcurrentCopying : public GarbageCollector {
   // pages.
   static constexpr bool kGrayDirtyImmuneObjects = true;
 
+  // A young_gen collector only evacuates the regions allocated since the last collection and
+  // finds references into them from the rest of the heap through the card table. It requires
+  // use_generational_cc, which makes every collection keep the cards up to date.
+  //
+  // Collections never overlap, so a young_gen collector uses the gc and read barrier mark stacks
+  // of the full collector passed as mark_stacks_owner. Its pool of thread-local mark stacks is its
+  // own: kMarkStackPoolSize stacks of kMarkStackSize references, 4 MB of address space of which
+  // only the pages the young collections push to get dirty.
   explicit ConcurrentCopying(Heap* heap,
+                             bool young_gen = false,
+                             bool use_generational_cc = false,
                              const std::string& name_prefix = "",
-                             bool measure_read_barrier_slow_path = false);
+                             bool measure_read_barrier_slow_path = false,
+                             ConcurrentCopying* mark_stacks_owner = nullptr);
   ~ConcurrentCopying();
 
   virtual void RunPhases() OVERRIDE
@@ -85,7 +97,7 @@ class ConcurrentCopying : public GarbageCollector {
   void BindBitmaps() REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!Locks::heap_bitmap_lock_);
   virtual GcType GetGcType() const OVERRIDE {
-    return kGcTypePartial;
+    return young_gen_ ? kGcTypeSticky : kGcTypePartial;
   }
   virtual CollectorType GetCollectorType() const OVERRIDE {
     return kCollectorTypeCC;
@@ -165,12 +177,29 @@ class ConcurrentCopying : public GarbageCollector {
   bool ProcessMarkStackOnce() REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
   void ProcessMarkStackRef(mirror::Object* to_ref) REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
+  // Number of threads, including the GC-running thread, to process the mark stacks with.
+  size_t GetParallelMarkThreadCount() const;
+  // Drains the GC mark stack and the thread-local mark stacks with heap thread pool workers.
+  size_t ProcessMarkStackParallel(size_t thread_count) REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  // Run by the GC-running thread and each worker until all of them run out of work.
+  void ParallelMark(Thread* self) REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  void ShareParallelMarkWork(Thread* self, accounting::ObjectStack* mark_stack)
+      REQUIRES(!mark_stack_lock_);
+  accounting::ObjectStack* TakeParallelMarkWork(Thread* self) REQUIRES(!mark_stack_lock_);
+  void RecycleMarkStack(Thread* self, accounting::ObjectStack* mark_stack)
+      REQUIRES(!mark_stack_lock_);
   void GrayAllDirtyImmuneObjects()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
   void VerifyGrayImmuneObjects()
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
+  void GrayAllDirtyOldObjects()
+      REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!mark_stack_lock_);
+  void ClearNonImmuneCards() REQUIRES(Locks::mutator_lock_);
   static void VerifyNoMissingCardMarkCallback(mirror::Object* obj, void* arg)
       REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_);
@@ -206,6 +235,8 @@ class ConcurrentCopying : public GarbageCollector {
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_, !mark_stack_lock_);
   void SweepLargeObjects(bool swap_bitmaps)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_);
+  void SweepYoungObjects(accounting::ObjectStack* live_stack)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_);
   void MarkZygoteLargeObjects()
       REQUIRES_SHARED(Locks::mutator_lock_);
   void FillWithDummyObject(mirror::Object* dummy_obj, size_t byte_size)
@@ -256,8 +287,9 @@ class ConcurrentCopying : public GarbageCollector {
 
   space::RegionSpace* region_space_;      // The underlying region space.
   std::unique_ptr<Barrier> gc_barrier_;
-  std::unique_ptr<accounting::ObjectStack> gc_mark_stack_;
-  std::unique_ptr<accounting::ObjectStack> rb_mark_bit_stack_;
+  // Shared by the full and the young_gen collectors.
+  std::shared_ptr<accounting::ObjectStack> gc_mark_stack_;
+  std::shared_ptr<accounting::ObjectStack> rb_mark_bit_stack_;
   bool rb_mark_bit_stack_full_;
   std::vector<mirror::Object*> false_gray_stack_ GUARDED_BY(mark_stack_lock_);
   Mutex mark_stack_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
@@ -267,6 +299,14 @@ class ConcurrentCopying : public GarbageCollector {
   static constexpr size_t kMarkStackPoolSize = 256;
   std::vector<accounting::ObjectStack*> pooled_mark_stacks_
       GUARDED_BY(mark_stack_lock_);
+  // Parallel marking state. While parallel_marking_ is set, heap thread pool workers act as the
+  // GC-running thread but push onto their thread-local mark stacks. Full thread-local stacks and
+  // work shared by busy markers go to revoked_mark_stacks_, idle markers take them from there.
+  bool parallel_marking_;
+  size_t parallel_markers_ GUARDED_BY(mark_stack_lock_);
+  Atomic<size_t> idle_parallel_markers_;
+  ConditionVariable parallel_mark_cond_ GUARDED_BY(mark_stack_lock_);
+  Atomic<size_t> parallel_marked_count_;
   Thread* thread_running_gc_;
   bool is_marking_;                       // True while marking is ongoing.
   bool is_active_;                        // True while the collection is ongoing.
@@ -321,6 +361,10 @@ class ConcurrentCopying : public GarbageCollector {
 
   accounting::ReadBarrierTable* rb_table_;
   bool force_evacuate_all_;  // True if all regions are evacuated.
+  // True if this collector only collects the young generation, see the constructor.
+  const bool young_gen_;
+  // True if the cards of the region and non-moving spaces are kept for young collections.
+  const bool use_generational_cc_;
   Atomic<bool> updated_all_immune_objects_;
   bool gc_grays_immune_objects_;
   Mutex immune_gray_stack_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
@@ -341,8 +385,10 @@ class ConcurrentCopying : public GarbageCollector {
   class DisableWeakRefAccessCallback;
   class FlipCallback;
   class GrayImmuneObjectVisitor;
+  class GrayOldObjectVisitor;
   class ImmuneSpaceScanObjVisitor;
   class LostCopyVisitor;
+  class ParallelMarkTask;
   class RefFieldsVisitor;
   class RevokeThreadLocalMarkStackCheckpoint;
   class ScopedGcGraysImmuneObjects;
@@ -187,6 +187,8 @@ Heap::Heap(size_t initial_size,
            bool verify_post_gc_rosalloc,
            bool gc_stress_mode,
            bool measure_gc_performance,
+           bool use_generational_cc,
+           bool use_parallel_cc_marking,
            bool use_homogeneous_space_compaction_for_oom,
            uint64_t min_interval_homogeneous_space_compaction_by_oom)
     : non_moving_space_(nullptr),
@@ -257,8 +259,12 @@ Heap::Heap(size_t initial_size,
       semi_space_collector_(nullptr),
       mark_compact_collector_(nullptr),
       concurrent_copying_collector_(nullptr),
+      young_concurrent_copying_collector_(nullptr),
+      active_concurrent_copying_collector_(nullptr),
       is_running_on_memory_tool_(Runtime::Current()->IsRunningOnMemoryTool()),
       use_tlab_(use_tlab),
+      use_generational_cc_(use_generational_cc && kUseBakerReadBarrier),
+      use_parallel_cc_marking_(use_parallel_cc_marking),
       main_space_backup_(nullptr),
       min_interval_homogeneous_space_compaction_by_oom_(
           min_interval_homogeneous_space_compaction_by_oom),
@@ -594,11 +600,25 @@ Heap::Heap(size_t initial_size,
     }
     if (MayUseCollector(kCollectorTypeCC)) {
       concurrent_copying_collector_ = new collector::ConcurrentCopying(this,
+                                                                       /*young_gen*/false,
+                                                                       use_generational_cc_,
                                                                        "",
                                                                        measure_gc_performance);
       DCHECK(region_space_ != nullptr);
       concurrent_copying_collector_->SetRegionSpace(region_space_);
       garbage_collectors_.push_back(concurrent_copying_collector_);
+      if (use_generational_cc_) {
+        young_concurrent_copying_collector_ = new collector::ConcurrentCopying(
+            this,
+            /*young_gen*/true,
+            use_generational_cc_,
+            "young",
+            measure_gc_performance,
+            /*mark_stacks_owner*/concurrent_copying_collector_);
+        young_concurrent_copying_collector_->SetRegionSpace(region_space_);
+        garbage_collectors_.push_back(young_concurrent_copying_collector_);
+      }
+      active_concurrent_copying_collector_ = concurrent_copying_collector_;
     }
     if (MayUseCollector(kCollectorTypeMC)) {
       mark_compact_collector_ = new collector::MarkCompact(this);
@@ -942,6 +962,63 @@ void Heap::VisitObjectsPaused(ObjectCallback callback, void* arg) {
   VisitObjectsInternal(callback, arg);
 }
 
+// Number of regions of the region space in one part of VisitObjectsPausedPart().
+static constexpr size_t kRegionsPerObjectVisitPart = 64;
+
+// Parts of the heap, in order: the bump pointer space and the allocation stack, ranges of regions
+// of the region space, the live bitmaps of continuous spaces and the large object bitmaps.
+size_t Heap::GetNumberOfObjectVisitParts() {
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  size_t num_parts = 1u;
+  if (region_space_ != nullptr) {
+    num_parts += RoundUp(region_space_->GetNumberOfRegions(), kRegionsPerObjectVisitPart) /
+        kRegionsPerObjectVisitPart;
+  }
+  ReaderMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  num_parts += GetLiveBitmap()->GetContinuousSpaceBitmaps().size();
+  num_parts += GetLiveBitmap()->GetLargeObjectBitmaps().size();
+  return num_parts;
+}
+
+void Heap::VisitObjectsPausedPart(size_t part, ObjectCallback callback, void* arg) {
+  if (part == 0u) {
+    if (bump_pointer_space_ != nullptr) {
+      bump_pointer_space_->Walk(callback, arg);
+    }
+    for (auto* it = allocation_stack_->Begin(), *end = allocation_stack_->End(); it < end; ++it) {
+      mirror::Object* const obj = it->AsMirrorPtr();
+      if (obj != nullptr && obj->GetClass() != nullptr) {
+        // See VisitObjectsInternal().
+        callback(obj, arg);
+      }
+    }
+    return;
+  }
+  --part;
+  if (region_space_ != nullptr) {
+    const size_t num_regions = region_space_->GetNumberOfRegions();
+    const size_t num_region_parts =
+        RoundUp(num_regions, kRegionsPerObjectVisitPart) / kRegionsPerObjectVisitPart;
+    if (part < num_region_parts) {
+      size_t first_region = part * kRegionsPerObjectVisitPart;
+      size_t last_region = std::min(first_region + kRegionsPerObjectVisitPart, num_regions);
+      region_space_->WalkRegions(first_region, last_region, callback, arg);
+      return;
+    }
+    part -= num_region_parts;
+  }
+  ReaderMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  const auto& continuous_space_bitmaps = GetLiveBitmap()->GetContinuousSpaceBitmaps();
+  if (part < continuous_space_bitmaps.size()) {
+    continuous_space_bitmaps[part]->Walk(callback, arg);
+    return;
+  }
+  part -= continuous_space_bitmaps.size();
+  const auto& large_object_bitmaps = GetLiveBitmap()->GetLargeObjectBitmaps();
+  DCHECK_LT(part, large_object_bitmaps.size());
+  large_object_bitmaps[part]->Walk(callback, arg);
+}
+
 // Visit objects in the region spaces.
 void Heap::VisitObjectsInternalRegionSpace(ObjectCallback callback, void* arg) {
   Thread* self = Thread::Current();
@@ -2255,6 +2332,9 @@ void Heap::ChangeCollector(CollectorType collector_type) {
     gc_plan_.clear();
     switch (collector_type_) {
       case kCollectorTypeCC: {
+        if (use_generational_cc_) {
+          gc_plan_.push_back(collector::kGcTypeSticky);
+        }
         gc_plan_.push_back(collector::kGcTypeFull);
         if (use_tlab_) {
           ChangeAllocator(kAllocatorTypeRegionTLAB);
@@ -2710,7 +2790,13 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
         collector = semi_space_collector_;
         break;
       case kCollectorTypeCC:
-        collector = concurrent_copying_collector_;
+        if (young_concurrent_copying_collector_ != nullptr &&
+            gc_type == collector::kGcTypeSticky) {
+          collector = young_concurrent_copying_collector_;
+        } else {
+          collector = concurrent_copying_collector_;
+        }
+        active_concurrent_copying_collector_ = down_cast<collector::ConcurrentCopying*>(collector);
         break;
       case kCollectorTypeMC:
         mark_compact_collector_->SetSpace(bump_pointer_space_);
@@ -2719,7 +2805,9 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       default:
         LOG(FATAL) << "Invalid collector type " << static_cast<size_t>(collector_type_);
     }
-    if (collector != mark_compact_collector_ && collector != concurrent_copying_collector_) {
+    if (collector != mark_compact_collector_ &&
+        collector != concurrent_copying_collector_ &&
+        collector != young_concurrent_copying_collector_) {
       temp_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
       if (kIsDebugBuild) {
         // Try to read each page of the memory map in case mprotect didn't work properly b/19894268.
@@ -2727,7 +2815,9 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       }
       CHECK(temp_space_->IsEmpty());
     }
-    gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    if (collector != young_concurrent_copying_collector_) {
+      gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    }
   } else if (current_allocator_ == kAllocatorTypeRosAlloc ||
       current_allocator_ == kAllocatorTypeDlMalloc) {
     collector = FindCollectorByGcType(gc_type);
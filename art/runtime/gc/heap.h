@@ -190,6 +190,8 @@ class Heap {
        bool verify_post_gc_rosalloc,
        bool gc_stress_mode,
        bool measure_gc_performance,
+       bool use_generational_cc,
+       bool use_parallel_cc_marking,
        bool use_homogeneous_space_compaction,
        uint64_t min_interval_homogeneous_space_compaction_by_oom);
 
@@ -257,6 +259,15 @@ class Heap {
   void VisitObjectsPaused(ObjectCallback callback, void* arg)
       REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_, !*gc_complete_lock_);
 
+  // Split the heap into parts for visiting the objects with threads already suspended. Visiting
+  // all the parts visits the same objects as VisitObjectsPaused().
+  size_t GetNumberOfObjectVisitParts()
+      REQUIRES(Locks::mutator_lock_, !Locks::heap_bitmap_lock_);
+  // Visit the objects of one part. While the calling thread keeps the other threads suspended,
+  // distinct parts may be visited concurrently by the threads of the GC thread pool.
+  void VisitObjectsPausedPart(size_t part, ObjectCallback callback, void* arg)
+      REQUIRES(!Locks::heap_bitmap_lock_) NO_THREAD_SAFETY_ANALYSIS;
+
   void CheckPreconditionsForAllocObject(ObjPtr<mirror::Class> c, size_t byte_count)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -718,8 +729,17 @@ class Heap {
     return zygote_space_ != nullptr;
   }
 
+  // Returns the CC collector that is running or ran last, the young one for young collections.
   collector::ConcurrentCopying* ConcurrentCopyingCollector() {
-    return concurrent_copying_collector_;
+    return active_concurrent_copying_collector_;
+  }
+
+  bool GetUseGenerationalCC() const {
+    return use_generational_cc_;
+  }
+
+  bool GetUseParallelCCMarking() const {
+    return use_parallel_cc_marking_;
   }
 
   CollectorType CurrentCollectorType() {
@@ -1066,6 +1086,10 @@ class Heap {
       REQUIRES(!*gc_complete_lock_, !*pending_task_lock_, !*backtrace_lock_);
 
   collector::GcType NonStickyGcType() const {
+    if (collector_type_ == kCollectorTypeCC) {
+      // The full CC collection reports itself as partial since it leaves the immune spaces alone.
+      return collector::kGcTypePartial;
+    }
     return HasZygoteSpace() ? collector::kGcTypePartial : collector::kGcTypeFull;
   }
 
@@ -1354,9 +1378,17 @@ class Heap {
   collector::SemiSpace* semi_space_collector_;
   collector::MarkCompact* mark_compact_collector_;
   collector::ConcurrentCopying* concurrent_copying_collector_;
+  // Only created with use_generational_cc_.
+  collector::ConcurrentCopying* young_concurrent_copying_collector_;
+  // One of the above two, the one ConcurrentCopyingCollector() returns to the read barrier.
+  collector::ConcurrentCopying* active_concurrent_copying_collector_;
 
   const bool is_running_on_memory_tool_;
   const bool use_tlab_;
+  // Whether CC alternates young collections of the newly allocated regions with full ones.
+  const bool use_generational_cc_;
+  // Whether CC processes its mark stacks with the heap thread pool.
+  const bool use_parallel_cc_marking_;
 
   // Pointer to the space which becomes the new main space when we do homogeneous space compaction.
   // Use unique_ptr since the space is only added during the homogeneous compaction phase.
@@ -1439,6 +1471,7 @@ class Heap {
   std::unique_ptr<Verification> verification_;
 
   friend class CollectorTransitionTask;
+  friend class GenerationalCCTest;  // For CollectGarbageInternal.
   friend class collector::GarbageCollector;
   friend class collector::MarkCompact;
   friend class collector::ConcurrentCopying;
@@ -89,5 +89,134 @@ TEST_F(ZygoteHeapTest, PreZygoteFork) {
   Runtime::Current()->GetHeap()->PreZygoteFork();
 }
 
+class GenerationalCCTest : public CommonRuntimeTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions* options) OVERRIDE {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-Xgc:generational_cc", nullptr));
+  }
+
+  collector::GcType CollectYoung(Heap* heap) {
+    return heap->CollectGarbageInternal(collector::kGcTypeSticky,
+                                        kGcCauseExplicit,
+                                        /* clear_soft_references */ false);
+  }
+};
+
+TEST_F(GenerationalCCTest, YoungCollectionKeepsOldToYoungReferences) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  if (heap->CurrentCollectorType() != kCollectorTypeCC || !heap->GetUseGenerationalCC()) {
+    // Young collections need CC with the Baker read barrier.
+    return;
+  }
+  Thread* self = Thread::Current();
+  static constexpr size_t kLength = 1024;
+  jobject old_array;
+  {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::Class> c(
+        hs.NewHandle(class_linker_->FindSystemClass(self, "[Ljava/lang/Object;")));
+    old_array = soa.AddLocalReference<jobject>(
+        mirror::ObjectArray<mirror::Object>::Alloc(self, c.Get(), kLength));
+  }
+  // The array moves to an old region.
+  heap->CollectGarbage(/* clear_soft_references */ false);
+  {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::ObjectArray<mirror::Object>> array(
+        hs.NewHandle(soa.Decode<mirror::ObjectArray<mirror::Object>>(old_array)));
+    for (size_t i = 0; i != kLength; ++i) {
+      // Only reachable through the card of the old array, with garbage around it.
+      array->Set<false>(i, mirror::String::AllocFromModifiedUtf8(self, "young"));
+      mirror::String::AllocFromModifiedUtf8(self, "garbage");
+    }
+  }
+  EXPECT_EQ(CollectYoung(heap), collector::kGcTypeSticky);
+  EXPECT_EQ(CollectYoung(heap), collector::kGcTypeSticky);
+  {
+    ScopedObjectAccess soa(self);
+    ObjPtr<mirror::ObjectArray<mirror::Object>> array =
+        soa.Decode<mirror::ObjectArray<mirror::Object>>(old_array);
+    for (size_t i = 0; i != kLength; ++i) {
+      ObjPtr<mirror::Object> element = array->Get(i);
+      ASSERT_TRUE(element != nullptr) << i;
+      ASSERT_TRUE(heap->IsValidObjectAddress(element.Ptr())) << i;
+      EXPECT_TRUE(element->AsString()->Equals("young")) << i;
+    }
+  }
+  // A full collection after young ones still finds everything.
+  heap->CollectGarbage(/* clear_soft_references */ false);
+  ScopedObjectAccess soa(self);
+  ObjPtr<mirror::ObjectArray<mirror::Object>> array =
+      soa.Decode<mirror::ObjectArray<mirror::Object>>(old_array);
+  for (size_t i = 0; i != kLength; ++i) {
+    EXPECT_TRUE(array->Get(i)->AsString()->Equals("young")) << i;
+  }
+}
+
+class ParallelCCMarkingTest : public CommonRuntimeTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions* options) OVERRIDE {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-Xgc:parallel_cc_marking", nullptr));
+    options->push_back(std::make_pair("-XX:ConcGCThreads=4", nullptr));
+  }
+};
+
+TEST_F(ParallelCCMarkingTest, MarksWideAndDeepGraphs) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  if (heap->CurrentCollectorType() != kCollectorTypeCC) {
+    return;
+  }
+  ASSERT_TRUE(heap->GetUseParallelCCMarking());
+  Thread* self = Thread::Current();
+  // Wide arrays give the markers work to share, the chains through element 0 of each array keep
+  // one marker busy while the others steal from it.
+  static constexpr size_t kWidth = 1024;
+  static constexpr size_t kDepth = 64;
+  jobject root;
+  {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<3> hs(self);
+    Handle<mirror::Class> c(
+        hs.NewHandle(class_linker_->FindSystemClass(self, "[Ljava/lang/Object;")));
+    Handle<mirror::ObjectArray<mirror::Object>> head(
+        hs.NewHandle(mirror::ObjectArray<mirror::Object>::Alloc(self, c.Get(), kWidth)));
+    MutableHandle<mirror::ObjectArray<mirror::Object>> array(hs.NewHandle(head.Get()));
+    for (size_t depth = 0; depth != kDepth; ++depth) {
+      for (size_t i = 1; i != kWidth; ++i) {
+        array->Set<false>(i, mirror::String::AllocFromModifiedUtf8(self, "parallel"));
+      }
+      if (depth + 1 != kDepth) {
+        ObjPtr<mirror::ObjectArray<mirror::Object>> next =
+            mirror::ObjectArray<mirror::Object>::Alloc(self, c.Get(), kWidth);
+        array->Set<false>(0, next);
+        array.Assign(next);
+      }
+    }
+    root = soa.AddLocalReference<jobject>(head.Get());
+  }
+  for (size_t i = 0; i != 4; ++i) {
+    heap->CollectGarbage(/* clear_soft_references */ false);
+  }
+  ScopedObjectAccess soa(self);
+  ObjPtr<mirror::ObjectArray<mirror::Object>> array =
+      soa.Decode<mirror::ObjectArray<mirror::Object>>(root);
+  for (size_t depth = 0; depth != kDepth; ++depth) {
+    for (size_t i = 1; i != kWidth; ++i) {
+      ObjPtr<mirror::Object> element = array->Get(i);
+      ASSERT_TRUE(element != nullptr) << depth << " " << i;
+      ASSERT_TRUE(heap->IsValidObjectAddress(element.Ptr())) << depth << " " << i;
+      ASSERT_TRUE(element->AsString()->Equals("parallel")) << depth << " " << i;
+    }
+    if (depth + 1 != kDepth) {
+      array = array->Get(0)->AsObjectArray<mirror::Object>();
+      ASSERT_TRUE(array != nullptr) << depth;
+    }
+  }
+}
+
 }  // namespace gc
 }  // namespace art
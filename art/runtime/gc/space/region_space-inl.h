@@ -18,6 +18,10 @@
 #define ART_RUNTIME_GC_SPACE_REGION_SPACE_INL_H_
 
 #include "region_space.h"
+
+#include <algorithm>
+
+#include "gc/accounting/card_table-inl.h"
 #include "thread-inl.h"
 
 namespace art {
@@ -228,7 +232,17 @@ void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg) {
   // issues (the classloader classes lock and the monitor lock). We
   // call this with threads suspended.
   Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
-  for (size_t i = 0; i < num_regions_; ++i) {
+  WalkRegionsInternal<kToSpaceOnly>(0u, num_regions_, callback, arg);
+}
+
+template<bool kToSpaceOnly>
+void RegionSpace::WalkRegionsInternal(size_t first_region,
+                                      size_t last_region,
+                                      ObjectCallback* callback,
+                                      void* arg) {
+  DCHECK_LE(first_region, last_region);
+  DCHECK_LE(last_region, num_regions_);
+  for (size_t i = first_region; i < last_region; ++i) {
     Region* r = &regions_[i];
     if (r->IsFree() || (kToSpaceOnly && !r->IsInToSpace())) {
       continue;
@@ -271,6 +285,64 @@ void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg) {
   }
 }
 
+template <typename Visitor>
+void RegionSpace::VisitOldObjectsOnDirtyCards(accounting::CardTable* card_table,
+                                              const Visitor& visitor) {
+  // Called with threads suspended, which keeps the regions stable without region_lock_. The
+  // lock cannot be taken here because of the lock order issues described in WalkInternal.
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  for (size_t i = 0; i < std::min(num_regions_, non_free_region_index_limit_); ++i) {
+    Region* r = &regions_[i];
+    if (r->IsFree() || !r->IsInToSpace() || r->IsNewlyAllocated() || r->IsLargeTail()) {
+      continue;
+    }
+    // The write barrier dirties the card of the object's first byte, so only the first card of a
+    // large object matters.
+    if (r->IsLarge()) {
+      mirror::Object* obj = reinterpret_cast<mirror::Object*>(r->Begin());
+      if (card_table->IsDirty(obj)) {
+        visitor(obj);
+      }
+      continue;
+    }
+    uint8_t* pos = r->Begin();
+    uint8_t* top = r->Top();
+    if (pos == top) {
+      continue;
+    }
+    uint8_t* const card_end = card_table->CardFromAddr(top - 1) + 1;
+    if (std::find(card_table->CardFromAddr(pos), card_end, accounting::CardTable::kCardDirty) ==
+        card_end) {
+      continue;
+    }
+    auto visit = [card_table, &visitor](mirror::Object* obj)
+        REQUIRES_SHARED(Locks::mutator_lock_) {
+      if (card_table->IsDirty(obj)) {
+        visitor(obj);
+      }
+    };
+    // Same as WalkInternal, partially live regions left over from an unevacuated from-space still
+    // have dead objects that can only be skipped with the bitmap.
+    const bool need_bitmap =
+        r->LiveBytes() != static_cast<size_t>(-1) &&
+        r->LiveBytes() != static_cast<size_t>(top - pos);
+    if (need_bitmap) {
+      GetLiveBitmap()->VisitMarkedRange(reinterpret_cast<uintptr_t>(pos),
+                                        reinterpret_cast<uintptr_t>(top),
+                                        visit);
+    } else {
+      while (pos < top) {
+        mirror::Object* obj = reinterpret_cast<mirror::Object*>(pos);
+        if (obj->GetClass<kDefaultVerifyFlags, kWithoutReadBarrier>() == nullptr) {
+          break;
+        }
+        visit(obj);
+        pos = reinterpret_cast<uint8_t*>(GetNextObject(obj));
+      }
+    }
+  }
+}
+
 inline mirror::Object* RegionSpace::GetNextObject(mirror::Object* obj) {
   const uintptr_t position = reinterpret_cast<uintptr_t>(obj) + obj->SizeOf();
   return reinterpret_cast<mirror::Object*>(RoundUp(position, kAlignment));
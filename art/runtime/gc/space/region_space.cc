@@ -183,8 +183,9 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
 }
 
 // Determine which regions to evacuate and mark them as
-// from-space. Mark the rest as unevacuated from-space.
-void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all) {
+// from-space. Mark the rest as unevacuated from-space, or leave them
+// in the to-space for kEvacModeNewlyAllocated.
+void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, EvacMode evac_mode) {
   ++time_;
   if (kUseTableLookupReadBarrier) {
     DCHECK(rb_table->IsAllCleared());
@@ -203,11 +204,19 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
     RegionType type = r->Type();
     if (!r->IsFree()) {
       DCHECK(r->IsInToSpace());
+      if (evac_mode == EvacMode::kEvacModeNewlyAllocated && !r->IsNewlyAllocated()) {
+        // Old generation. Large regions are never newly allocated, so neither are their tails.
+        DCHECK_EQ(num_expected_large_tails, 0U);
+        if (kUseTableLookupReadBarrier) {
+          rb_table->Clear(r->Begin(), r->End());
+        }
+        continue;
+      }
       if (LIKELY(num_expected_large_tails == 0U)) {
         DCHECK((state == RegionState::kRegionStateAllocated ||
                 state == RegionState::kRegionStateLarge) &&
                type == RegionType::kRegionTypeToSpace);
-        bool should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+        bool should_evacuate = evac_mode == EvacMode::kEvacModeForceAll || r->ShouldBeEvacuated();
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
@@ -17,6 +17,7 @@
 #ifndef ART_RUNTIME_GC_SPACE_REGION_SPACE_H_
 #define ART_RUNTIME_GC_SPACE_REGION_SPACE_H_
 
+#include "gc/accounting/card_table.h"
 #include "gc/accounting/read_barrier_table.h"
 #include "object_callbacks.h"
 #include "space.h"
@@ -158,6 +159,25 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     WalkInternal<true>(callback, arg);
   }
 
+  size_t GetNumberOfRegions() const {
+    return num_regions_;
+  }
+
+  // Visit the continuous objects of the regions [first_region, last_region). The caller must
+  // keep the threads suspended, disjoint ranges may then be walked concurrently by GC worker
+  // threads.
+  void WalkRegions(size_t first_region, size_t last_region, ObjectCallback* callback, void* arg)
+      NO_THREAD_SAFETY_ANALYSIS {
+    WalkRegionsInternal<false>(first_region, last_region, callback, arg);
+  }
+
+  // Visit the objects of the to-space regions that were not allocated since the last collection
+  // (the old generation) and whose cards are dirty. Regions without any dirty card are skipped
+  // without walking their objects. Called with threads suspended.
+  template <typename Visitor>
+  void VisitOldObjectsOnDirtyCards(accounting::CardTable* card_table, const Visitor& visitor)
+      REQUIRES(Locks::mutator_lock_);
+
   accounting::ContinuousSpaceBitmap::SweepCallback* GetSweepCallback() OVERRIDE {
     return nullptr;
   }
@@ -209,7 +229,19 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return RegionType::kRegionTypeNone;
   }
 
-  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all)
+  // Which regions SetFromSpace() turns into from-space.
+  enum class EvacMode {
+    // Only the regions allocated since the last collection, the rest are left in the to-space.
+    // Used by young generation collections.
+    kEvacModeNewlyAllocated,
+    // Newly allocated regions and regions with a low live ratio, the rest become unevacuated
+    // from-space.
+    kEvacModeLivePercentNewlyAllocated,
+    // All regions.
+    kEvacModeForceAll,
+  };
+
+  void SetFromSpace(accounting::ReadBarrierTable* rb_table, EvacMode evac_mode)
       REQUIRES(!region_lock_);
 
   size_t FromSpaceSize() REQUIRES(!region_lock_);
@@ -222,11 +254,21 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     reg->AddLiveBytes(alloc_size);
   }
 
+  // AddLiveBytes for the parallel marking workers.
+  void AddLiveBytesAtomic(mirror::Object* ref, size_t alloc_size) {
+    Region* reg = RefToRegionUnlocked(ref);
+    reg->AddLiveBytesAtomic(alloc_size);
+  }
+
   void AssertAllRegionLiveBytesZeroOrCleared() REQUIRES(!region_lock_) {
     if (kIsDebugBuild) {
       MutexLock mu(Thread::Current(), region_lock_);
       for (size_t i = 0; i < num_regions_; ++i) {
         Region* r = &regions_[i];
+        if (r->IsInToSpace()) {
+          // Old generation regions left alone by a young collection keep their live bytes.
+          continue;
+        }
         size_t live_bytes = r->LiveBytes();
         CHECK(live_bytes == 0U || live_bytes == static_cast<size_t>(-1)) << live_bytes;
       }
@@ -245,6 +287,11 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
 
   template<bool kToSpaceOnly>
   void WalkInternal(ObjectCallback* callback, void* arg) NO_THREAD_SAFETY_ANALYSIS;
+  template<bool kToSpaceOnly>
+  void WalkRegionsInternal(size_t first_region,
+                           size_t last_region,
+                           ObjectCallback* callback,
+                           void* arg) NO_THREAD_SAFETY_ANALYSIS;
 
   class Region {
    public:
@@ -415,6 +462,12 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       DCHECK_LE(live_bytes_, BytesAllocated());
     }
 
+    void AddLiveBytesAtomic(size_t live_bytes) {
+      DCHECK(IsInUnevacFromSpace());
+      DCHECK(!IsLargeTail());
+      reinterpret_cast<Atomic<size_t>*>(&live_bytes_)->FetchAndAddRelaxed(live_bytes);
+    }
+
     size_t LiveBytes() const {
       return live_bytes_;
     }
@@ -15,11 +15,15 @@
  */
 
 /*
- * Preparation and completion of hprof data generation.  The output is
- * written into two files and then combined.  This is necessary because
- * we generate some of the data (strings and classes) while we dump the
- * heap, and some analysis tools require that the class and string data
- * appear first.
+ * Preparation and completion of hprof data generation.  Some of the data
+ * (strings and classes) is generated while we dump the heap, and some
+ * analysis tools require that the class and string data appear first.
+ * When the output size must be known in advance (DDMS), the heap is
+ * visited twice: once to measure the dump and collect the strings and
+ * classes, then again to write them ahead of the heap data.  Dumps to a
+ * file are streamed instead: the heap is visited once, in parallel, and a
+ * string or class record is written as soon as the string or class is
+ * first seen, before any record that references it.
  */
 
 #include "hprof.h"
@@ -35,6 +39,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <memory>
 #include <set>
 
 #include "android-base/stringprintf.h"
@@ -64,6 +69,7 @@
 #include "safe_map.h"
 #include "scoped_thread_state_change-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -385,50 +391,78 @@ class EndianOutputBuffered : public EndianOutput {
   std::vector<uint8_t> buffer_;
 };
 
-class FileEndianOutput FINAL : public EndianOutputBuffered {
+class NetStateEndianOutput FINAL : public EndianOutputBuffered {
  public:
-  FileEndianOutput(File* fp, size_t reserved_size)
-      : EndianOutputBuffered(reserved_size), fp_(fp), errors_(false) {
-    DCHECK(fp != nullptr);
+  NetStateEndianOutput(JDWP::JdwpNetStateBase* net_state, size_t reserved_size)
+      : EndianOutputBuffered(reserved_size), net_state_(net_state) {
+    DCHECK(net_state != nullptr);
   }
-  ~FileEndianOutput() {
+  ~NetStateEndianOutput() {}
+
+ protected:
+  void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
+    std::vector<iovec> iov;
+    iov.push_back(iovec());
+    iov[0].iov_base = const_cast<void*>(reinterpret_cast<const void*>(buffer));
+    iov[0].iov_len = length;
+    net_state_->WriteBufferedPacketLocked(iov);
   }
 
-  bool Errors() {
-    return errors_;
+ private:
+  JDWP::JdwpNetStateBase* net_state_;
+};
+
+// File written by concurrent streaming outputs. Records are written whole, so that records
+// of different outputs do not interleave.
+class StreamedFile {
+ public:
+  explicit StreamedFile(File* fp)
+      : fp_(fp), lock_("hprof output lock", kHprofOutputLock), length_(0), errors_(false) {
+    DCHECK(fp != nullptr);
   }
 
- protected:
-  void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
+  void Write(const uint8_t* buffer, size_t length) REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
     if (!errors_) {
       errors_ = !fp_->WriteFully(buffer, length);
     }
+    length_ += length;
+  }
+
+  size_t Length() REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    return length_;
+  }
+
+  bool Errors() REQUIRES(!lock_) {
+    MutexLock mu(Thread::Current(), lock_);
+    return errors_;
   }
 
  private:
-  File* fp_;
-  bool errors_;
+  File* const fp_;
+  Mutex lock_;
+  size_t length_ GUARDED_BY(lock_);
+  bool errors_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(StreamedFile);
 };
 
-class NetStateEndianOutput FINAL : public EndianOutputBuffered {
+class StreamingEndianOutput FINAL : public EndianOutputBuffered {
  public:
-  NetStateEndianOutput(JDWP::JdwpNetStateBase* net_state, size_t reserved_size)
-      : EndianOutputBuffered(reserved_size), net_state_(net_state) {
-    DCHECK(net_state != nullptr);
+  StreamingEndianOutput(StreamedFile* file, size_t reserved_size)
+      : EndianOutputBuffered(reserved_size), file_(file) {
+    DCHECK(file != nullptr);
   }
-  ~NetStateEndianOutput() {}
+  ~StreamingEndianOutput() {}
 
  protected:
   void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
-    std::vector<iovec> iov;
-    iov.push_back(iovec());
-    iov[0].iov_base = const_cast<void*>(reinterpret_cast<const void*>(buffer));
-    iov[0].iov_len = length;
-    net_state_->WriteBufferedPacketLocked(iov);
+    file_->Write(buffer, length);
   }
 
  private:
-  JDWP::JdwpNetStateBase* net_state_;
+  StreamedFile* const file_;
 };
 
 #define __ output_->
@@ -438,7 +472,8 @@ class Hprof : public SingleRootVisitor {
   Hprof(const char* output_filename, int fd, bool direct_to_ddms)
       : filename_(output_filename),
         fd_(fd),
-        direct_to_ddms_(direct_to_ddms) {
+        direct_to_ddms_(direct_to_ddms),
+        parent_(nullptr) {
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
   }
 
@@ -452,28 +487,28 @@ class Hprof : public SingleRootVisitor {
       }
     }
 
-    // First pass to measure the size of the dump.
     size_t overall_size;
-    size_t max_length;
-    {
-      EndianOutput count_output;
-      output_ = &count_output;
-      ProcessHeap(false);
-      overall_size = count_output.SumLength();
-      max_length = count_output.MaxLength();
-      output_ = nullptr;
-    }
-
     bool okay;
-    visited_objects_.clear();
-    if (direct_to_ddms_) {
+    if (!direct_to_ddms_) {
+      okay = StreamToFile(&overall_size);
+    } else {
+      // First pass to measure the size of the dump, which DDMS needs in the chunk header.
+      size_t max_length;
+      {
+        EndianOutput count_output;
+        output_ = &count_output;
+        ProcessHeap(false);
+        overall_size = count_output.SumLength();
+        max_length = count_output.MaxLength();
+        output_ = nullptr;
+      }
+
+      visited_objects_.clear();
       if (kDirectStream) {
         okay = DumpToDdmsDirect(overall_size, max_length, CHUNK_TYPE("HPDS"));
       } else {
         okay = DumpToDdmsBuffered(overall_size, max_length);
       }
-    } else {
-      okay = DumpToFile(overall_size, max_length);
     }
 
     if (okay) {
@@ -555,36 +590,44 @@ class Hprof : public SingleRootVisitor {
 
   void WriteClassTable() REQUIRES_SHARED(Locks::mutator_lock_) {
     for (const auto& p : classes_) {
-      mirror::Class* c = p.first;
-      HprofClassSerialNumber sn = p.second;
-      CHECK(c != nullptr);
-      output_->StartNewRecord(HPROF_TAG_LOAD_CLASS, kHprofTime);
-      // LOAD CLASS format:
-      // U4: class serial number (always > 0)
-      // ID: class object ID. We use the address of the class object structure as its ID.
-      // U4: stack trace serial number
-      // ID: class name string ID
-      __ AddU4(sn);
-      __ AddObjectId(c);
-      __ AddStackTraceSerialNumber(LookupStackTraceSerialNumber(c));
-      __ AddStringId(LookupClassNameId(c));
+      WriteLoadClassRecord(output_, p.first, p.second);
     }
   }
 
+  void WriteLoadClassRecord(EndianOutput* output, mirror::Class* c, HprofClassSerialNumber sn)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    CHECK(c != nullptr);
+    // Look up the name first, a streamed dump writes the string record of a new name.
+    HprofStringId name_id = LookupClassNameId(c);
+    output->StartNewRecord(HPROF_TAG_LOAD_CLASS, kHprofTime);
+    // LOAD CLASS format:
+    // U4: class serial number (always > 0)
+    // ID: class object ID. We use the address of the class object structure as its ID.
+    // U4: stack trace serial number
+    // ID: class name string ID
+    output->AddU4(sn);
+    output->AddObjectId(c);
+    output->AddStackTraceSerialNumber(LookupStackTraceSerialNumber(c));
+    output->AddStringId(name_id);
+  }
+
   void WriteStringTable() {
     for (const auto& p : strings_) {
-      const std::string& string = p.first;
-      const HprofStringId id = p.second;
+      WriteStringRecord(output_, p.first, p.second);
+    }
+  }
 
-      output_->StartNewRecord(HPROF_TAG_STRING, kHprofTime);
+  static void WriteStringRecord(EndianOutput* output,
+                                const std::string& string,
+                                HprofStringId id) {
+    output->StartNewRecord(HPROF_TAG_STRING, kHprofTime);
 
-      // STRING format:
-      // ID:  ID for this string
-      // U1*: UTF8 characters for string (NOT null terminated)
-      //      (the record format encodes the length)
-      __ AddU4(id);
-      __ AddUtf8String(string.c_str());
-    }
+    // STRING format:
+    // ID:  ID for this string
+    // U1*: UTF8 characters for string (NOT null terminated)
+    //      (the record format encodes the length)
+    output->AddU4(id);
+    output->AddUtf8String(string.c_str());
   }
 
   void StartNewHeapDumpSegment() {
@@ -610,18 +653,51 @@ class Hprof : public SingleRootVisitor {
     if (c != nullptr) {
       auto it = classes_.find(c);
       if (it == classes_.end()) {
-        // first time to see this class
-        HprofClassSerialNumber sn = next_class_serial_number_++;
-        classes_.Put(c, sn);
-        // Make sure that we've assigned a string ID for this class' name
-        LookupClassNameId(c);
+        if (parent_ != nullptr) {
+          // First time this worker sees the class, remember the serial number of the parent.
+          classes_.Put(c, parent_->LookupClassSerialNumberShared(c));
+        } else {
+          // first time to see this class
+          HprofClassSerialNumber sn = next_class_serial_number_++;
+          classes_.Put(c, sn);
+          // Make sure that we've assigned a string ID for this class' name
+          LookupClassNameId(c);
+          if (table_output_ != nullptr) {
+            WriteLoadClassRecord(table_output_, c, sn);
+            table_output_->EndRecord();
+          }
+        }
       }
     }
     return PointerToLowMemUInt32(c);
   }
 
+  // Look up the class serial number and string ID for a worker. The workers keep their own
+  // copy of the IDs they have seen, so that the lock is only taken for new ones.
+  HprofClassSerialNumber LookupClassSerialNumberShared(mirror::Class* c)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!tables_lock_) {
+    MutexLock mu(Thread::Current(), tables_lock_);
+    LookupClassId(c);
+    return classes_.Get(c);
+  }
+
+  HprofStringId LookupStringIdShared(const std::string& string) REQUIRES(!tables_lock_) {
+    MutexLock mu(Thread::Current(), tables_lock_);
+    return LookupStringId(string);
+  }
+
+  // Whether a simple root record was not written yet by any worker.
+  bool InsertSimpleRootShared(uint64_t key) REQUIRES(!tables_lock_) {
+    MutexLock mu(Thread::Current(), tables_lock_);
+    return simple_roots_.insert(key).second;
+  }
+
   HprofStackTraceSerialNumber LookupStackTraceSerialNumber(const mirror::Object* obj)
       REQUIRES_SHARED(Locks::mutator_lock_) {
+    if (parent_ != nullptr) {
+      // The allocation records are not modified while dumping the heap.
+      return parent_->LookupStackTraceSerialNumber(obj);
+    }
     auto r = allocation_records_.find(obj);
     if (r == allocation_records_.end()) {
       return kHprofNullStackTrace;
@@ -646,7 +722,16 @@ class Hprof : public SingleRootVisitor {
     if (it != strings_.end()) {
       return it->second;
     }
-    HprofStringId id = next_string_id_++;
+    HprofStringId id;
+    if (parent_ != nullptr) {
+      id = parent_->LookupStringIdShared(string);
+    } else {
+      id = next_string_id_++;
+      if (table_output_ != nullptr) {
+        WriteStringRecord(table_output_, string, id);
+        table_output_->EndRecord();
+      }
+    }
     strings_.Put(string, id);
     return id;
   }
@@ -716,9 +801,10 @@ class Hprof : public SingleRootVisitor {
           source_file = "";
         }
         __ AddStringId(LookupStringId(source_file));
-        auto class_result = classes_.find(method->GetDeclaringClass());
-        CHECK(class_result != classes_.end());
-        __ AddU4(class_result->second);
+        // A streamed dump writes the stack traces before it sees any class.
+        mirror::Class* declaring_class = method->GetDeclaringClass();
+        LookupClassId(declaring_class);
+        __ AddU4(classes_.Get(declaring_class));
         __ AddU4(frame->ComputeLineNumber());
       }
 
@@ -754,41 +840,27 @@ class Hprof : public SingleRootVisitor {
     //        Dbg::DdmSendChunkV(CHUNK_TYPE("HPDS"), iov, 2);
   }
 
-  bool DumpToFile(size_t overall_size, size_t max_length)
-      REQUIRES(Locks::mutator_lock_) {
+  std::unique_ptr<File> OpenFile() REQUIRES(Locks::mutator_lock_) {
     // Where exactly are we writing to?
     int out_fd;
     if (fd_ >= 0) {
       out_fd = dup(fd_);
       if (out_fd < 0) {
         ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
-        return false;
+        return nullptr;
       }
     } else {
       out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
       if (out_fd < 0) {
         ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
                               strerror(errno));
-        return false;
+        return nullptr;
       }
     }
+    return std::unique_ptr<File>(new File(out_fd, filename_, true));
+  }
 
-    std::unique_ptr<File> file(new File(out_fd, filename_, true));
-    bool okay;
-    {
-      FileEndianOutput file_output(file.get(), max_length);
-      output_ = &file_output;
-      ProcessHeap(true);
-      okay = !file_output.Errors();
-
-      if (okay) {
-        // Check for expected size. Output is expected to be less-or-equal than first phase, see
-        // b/23521263.
-        DCHECK_LE(file_output.SumLength(), overall_size);
-      }
-      output_ = nullptr;
-    }
-
+  bool CloseFile(File* file, bool okay) REQUIRES(Locks::mutator_lock_) {
     if (okay) {
       okay = file->FlushCloseOrErase() == 0;
     } else {
@@ -801,10 +873,117 @@ class Hprof : public SingleRootVisitor {
       ThrowRuntimeException("%s", msg.c_str());
       LOG(ERROR) << msg;
     }
-
     return okay;
   }
 
+  // Dump to the file in a single visit of the heap. The records are written as they are
+  // produced, the memory used does not depend on the size of the heap.
+  bool StreamToFile(size_t* overall_size) REQUIRES(Locks::mutator_lock_) {
+    std::unique_ptr<File> file = OpenFile();
+    if (file == nullptr) {
+      return false;
+    }
+    bool okay;
+    {
+      StreamedFile streamed_file(file.get());
+      StreamingEndianOutput output(&streamed_file, kMaxBytesPerSegment);
+      StreamingEndianOutput table_output(&streamed_file, kMaxBytesPerSegment);
+      output_ = &output;
+      table_output_ = &table_output;
+
+      WriteFixedHeader();
+      output_->EndRecord();
+      WriteStackTraces();
+
+      // The roots are visited by this thread, the heap objects by the GC thread pool.
+      Runtime* const runtime = Runtime::Current();
+      current_heap_ = HPROF_HEAP_DEFAULT;
+      objects_in_segment_ = 0;
+      output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_SEGMENT, kHprofTime);
+      simple_roots_.clear();
+      runtime->VisitRoots(this);
+      runtime->VisitImageRoots(this);
+      output_->EndRecord();
+      DumpHeapParts(&streamed_file);
+
+      output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_END, kHprofTime);
+      output_->EndRecord();
+
+      okay = !streamed_file.Errors();
+      *overall_size = streamed_file.Length();
+      output_ = nullptr;
+      table_output_ = nullptr;
+    }
+    return CloseFile(file.get(), okay);
+  }
+
+  // Dumps one part of the heap with a worker of its own.
+  class DumpHeapPartTask FINAL : public Task {
+   public:
+    DumpHeapPartTask(Hprof* hprof, StreamedFile* streamed_file, size_t part)
+        : hprof_(hprof), streamed_file_(streamed_file), part_(part), num_objects_(0u) {}
+
+    void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+      StreamingEndianOutput output(streamed_file_, kMaxBytesPerSegment);
+      Hprof worker(hprof_, &output);
+      worker.DumpHeapPart(part_);
+      num_objects_ = worker.total_objects_;
+    }
+
+    size_t GetNumberOfObjects() const {
+      return num_objects_;
+    }
+
+   private:
+    Hprof* const hprof_;
+    StreamedFile* const streamed_file_;
+    const size_t part_;
+    size_t num_objects_;
+  };
+
+  void DumpHeapParts(StreamedFile* streamed_file) REQUIRES(Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    gc::Heap* const heap = Runtime::Current()->GetHeap();
+    std::vector<std::unique_ptr<DumpHeapPartTask>> tasks;
+    for (size_t part = 0, num_parts = heap->GetNumberOfObjectVisitParts(); part != num_parts;
+         ++part) {
+      tasks.emplace_back(new DumpHeapPartTask(this, streamed_file, part));
+    }
+    ThreadPool* thread_pool = heap->GetThreadPool();
+    if (thread_pool != nullptr && heap->GetParallelGCThreadCount() != 0u) {
+      // The GC is not running, its threads are idle.
+      for (const std::unique_ptr<DumpHeapPartTask>& task : tasks) {
+        thread_pool->AddTask(self, task.get());
+      }
+      thread_pool->SetMaxActiveWorkers(heap->GetParallelGCThreadCount());
+      thread_pool->StartWorkers(self);
+      thread_pool->Wait(self, true, true);
+      thread_pool->StopWorkers(self);
+    } else {
+      for (const std::unique_ptr<DumpHeapPartTask>& task : tasks) {
+        task->Run(self);
+      }
+    }
+    for (const std::unique_ptr<DumpHeapPartTask>& task : tasks) {
+      total_objects_ += task->GetNumberOfObjects();
+    }
+  }
+
+  // A worker dumping a part of the heap for `parent`. The parent assigns the string and class
+  // IDs and writes their records, the worker writes heap dump segments to `output`.
+  Hprof(Hprof* parent, EndianOutput* output)
+      : filename_(parent->filename_),
+        fd_(-1),
+        direct_to_ddms_(false),
+        parent_(parent),
+        output_(output) {}
+
+  void DumpHeapPart(size_t part) REQUIRES_SHARED(Locks::mutator_lock_) {
+    output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_SEGMENT, kHprofTime);
+    Runtime::Current()->GetHeap()->VisitObjectsPausedPart(part, VisitObjectCallback, this);
+    output_->EndRecord();
+  }
+
   bool DumpToDdmsDirect(size_t overall_size, size_t max_length, uint32_t chunk_type)
       REQUIRES(Locks::mutator_lock_) {
     CHECK(direct_to_ddms_);
@@ -829,7 +1008,8 @@ class Hprof : public SingleRootVisitor {
     // Write the dump.
     ProcessHeap(true);
 
-    // Check for expected size. See DumpToFile for comment.
+    // Check for expected size. Output is expected to be less-or-equal than first phase, see
+    // b/23521263.
     DCHECK_LE(net_output.SumLength(), overall_size + kChunkHeaderSize);
     output_ = nullptr;
 
@@ -883,10 +1063,19 @@ class Hprof : public SingleRootVisitor {
   int fd_;
   bool direct_to_ddms_;
 
+  // The dump this worker belongs to, null if this is not a worker.
+  Hprof* const parent_;
+
   uint64_t start_ns_ = NanoTime();
 
   EndianOutput* output_ = nullptr;
 
+  // Output for the string and class records of a streamed dump, written when they are created.
+  EndianOutput* table_output_ = nullptr;
+
+  // Guards the string and class tables and the simple roots while workers dump the heap.
+  Mutex tables_lock_ {"hprof tables lock", kHprofTablesLock};
+
   HprofHeapId current_heap_ = HPROF_HEAP_DEFAULT;  // Which heap we're currently dumping.
   size_t objects_in_segment_ = 0;
 
@@ -997,7 +1186,8 @@ void Hprof::MarkRootObject(const mirror::Object* obj, jobject jni_obj, HprofHeap
     case HPROF_ROOT_DEBUGGER:
     case HPROF_ROOT_VM_INTERNAL: {
       uint64_t key = (static_cast<uint64_t>(heap_tag) << 32) | PointerToLowMemUInt32(obj);
-      if (simple_roots_.insert(key).second) {
+      if (simple_roots_.insert(key).second &&
+          (parent_ == nullptr || parent_->InsertSimpleRootShared(key))) {
         __ AddU1(heap_tag);
         __ AddObjectId(obj);
       }
@@ -35,7 +35,23 @@ namespace art {
 InternTable::InternTable()
     : log_new_roots_(false),
       weak_intern_condition_("New intern condition", *Locks::intern_table_lock_),
+      strong_interns_(stripe_locks_),
+      weak_interns_(stripe_locks_),
       weak_root_state_(gc::kWeakRootStateNormal) {
+  for (std::unique_ptr<Mutex>& lock : stripe_locks_) {
+    lock.reset(new Mutex("InternTable stripe lock", kInternTableStripeLock));
+  }
+}
+
+Mutex* InternTable::GetStripeLock(ObjPtr<mirror::String> s) const {
+  return stripe_locks_[StripeForHash(s->GetHashCode())].get();
+}
+
+bool InternTable::IsWeakAccessible(Thread* self) const {
+  if (kUseReadBarrier) {
+    return self->GetWeakRefAccessEnabled();
+  }
+  return weak_root_state_.LoadRelaxed() != gc::kWeakRootStateNoReadsOrWrites;
 }
 
 size_t InternTable::Size() const {
@@ -58,7 +74,13 @@ void InternTable::DumpForSigQuit(std::ostream& os) const {
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
+    // Start logging before the stripes are visited one by one, an insertion into an already
+    // visited stripe must be logged. Inserters check the flag under the stripe lock.
+    log_new_roots_.StoreRelaxed(true);
+  }
   if ((flags & kVisitRootFlagAllRoots) != 0) {
     strong_interns_.VisitRoots(visitor);
   } else if ((flags & kVisitRootFlagNewRoots) != 0) {
@@ -70,6 +92,7 @@ void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
         // The GC moved a root in the log. Need to search the strong interns and update the
         // corresponding object. This is slow, but luckily for us, this may only happen with a
         // concurrent moving GC.
+        MutexLock stripe_mu(self, *GetStripeLock(new_ref));
         strong_interns_.Remove(old_ref);
         strong_interns_.Insert(new_ref);
       }
@@ -78,22 +101,22 @@ void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
   if ((flags & kVisitRootFlagClearRootLog) != 0) {
     new_strong_intern_roots_.clear();
   }
-  if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
-    log_new_roots_ = true;
-  } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
-    log_new_roots_ = false;
+  if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
+    log_new_roots_.StoreRelaxed(false);
   }
   // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
 }
 
 ObjPtr<mirror::String> InternTable::LookupWeak(Thread* self, ObjPtr<mirror::String> s) {
+  // Not on any hot path, serialize with sweeping to only ever see swept weak interns.
   MutexLock mu(self, *Locks::intern_table_lock_);
+  MutexLock stripe_mu(self, *GetStripeLock(s));
   return LookupWeakLocked(s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self, ObjPtr<mirror::String> s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupStrongLocked(s);
+  MutexLock mu(self, *GetStripeLock(s));
+  return strong_interns_.Find(s);
 }
 
 ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
@@ -103,7 +126,7 @@ ObjPtr<mirror::String> InternTable::LookupStrong(Thread* self,
   Utf8String string(utf16_length,
                     utf8_data,
                     ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length));
-  MutexLock mu(self, *Locks::intern_table_lock_);
+  MutexLock mu(self, *GetStripeLock(string));
   return strong_interns_.Find(string);
 }
 
@@ -126,7 +149,7 @@ ObjPtr<mirror::String> InternTable::InsertStrong(ObjPtr<mirror::String> s) {
   if (runtime->IsActiveTransaction()) {
     runtime->RecordStrongStringInsertion(s);
   }
-  if (log_new_roots_) {
+  if (log_new_roots_.LoadRelaxed()) {
     new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
   }
   strong_interns_.Insert(s);
@@ -157,21 +180,25 @@ void InternTable::RemoveWeak(ObjPtr<mirror::String> s) {
 // Insert/remove methods used to undo changes made during an aborted transaction.
 ObjPtr<mirror::String> InternTable::InsertStrongFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
+  MutexLock mu(Thread::Current(), *GetStripeLock(s));
   return InsertStrong(s);
 }
 
 ObjPtr<mirror::String> InternTable::InsertWeakFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
+  MutexLock mu(Thread::Current(), *GetStripeLock(s));
   return InsertWeak(s);
 }
 
 void InternTable::RemoveStrongFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
+  MutexLock mu(Thread::Current(), *GetStripeLock(s));
   RemoveStrong(s);
 }
 
 void InternTable::RemoveWeakFromTransaction(ObjPtr<mirror::String> s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
+  MutexLock mu(Thread::Current(), *GetStripeLock(s));
   RemoveWeak(s);
 }
 
@@ -198,14 +225,32 @@ void InternTable::WaitUntilAccessible(Thread* self) {
   {
     ScopedThreadSuspension sts(self, kWaitingWeakGcRootRead);
     MutexLock mu(self, *Locks::intern_table_lock_);
-    while ((!kUseReadBarrier && weak_root_state_ == gc::kWeakRootStateNoReadsOrWrites) ||
-           (kUseReadBarrier && !self->GetWeakRefAccessEnabled())) {
+    while (!IsWeakAccessible(self)) {
       weak_intern_condition_.Wait(self);
     }
   }
   Locks::intern_table_lock_->ExclusiveLock(self);
 }
 
+ObjPtr<mirror::String> InternTable::InsertStripeLocked(ObjPtr<mirror::String> s,
+                                                       bool is_strong) {
+  ObjPtr<mirror::String> weak = weak_interns_.Find(s);
+  if (weak != nullptr) {
+    if (is_strong) {
+      // A match was found in the weak table. Promote to the strong table.
+      weak_interns_.Remove(weak);
+      strong_interns_.Insert(weak);
+    }
+    return weak;
+  }
+  if (is_strong) {
+    strong_interns_.Insert(s);
+  } else {
+    weak_interns_.Insert(s);
+  }
+  return s;
+}
+
 ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
                                            bool is_strong,
                                            bool holding_locks) {
@@ -213,28 +258,45 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     return nullptr;
   }
   Thread* const self = Thread::Current();
-  MutexLock mu(self, *Locks::intern_table_lock_);
   if (kDebugLocking && !holding_locks) {
     Locks::mutator_lock_->AssertSharedHeld(self);
-    CHECK_EQ(2u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
+    CHECK_EQ(1u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
   }
+  Mutex* const stripe_lock = GetStripeLock(s);
+  {
+    // Fast path, only the stripe lock is needed unless the insertion has to be recorded by a
+    // transaction or logged as a new root, or we have to wait for weak interns to be accessible.
+    MutexLock stripe_mu(self, *stripe_lock);
+    ObjPtr<mirror::String> strong = strong_interns_.Find(s);
+    if (strong != nullptr) {
+      return strong;
+    }
+    if (!log_new_roots_.LoadRelaxed() &&
+        !Runtime::Current()->IsActiveTransaction() &&
+        IsWeakAccessible(self)) {
+      return InsertStripeLocked(s, is_strong);
+    }
+  }
+  MutexLock mu(self, *Locks::intern_table_lock_);
   while (true) {
     if (holding_locks) {
       if (!kUseReadBarrier) {
-        CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+        CHECK_EQ(weak_root_state_.LoadRelaxed(), gc::kWeakRootStateNormal);
       } else {
         CHECK(self->GetWeakRefAccessEnabled());
       }
     }
-    // Check the strong table for a match.
-    ObjPtr<mirror::String> strong = LookupStrongLocked(s);
-    if (strong != nullptr) {
-      return strong;
-    }
-    if ((!kUseReadBarrier && weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites) ||
-        (kUseReadBarrier && self->GetWeakRefAccessEnabled())) {
+    if (IsWeakAccessible(self)) {
       break;
     }
+    // Check the strong table for a match.
+    {
+      MutexLock stripe_mu(self, *stripe_lock);
+      ObjPtr<mirror::String> strong = LookupStrongLocked(s);
+      if (strong != nullptr) {
+        return strong;
+      }
+    }
     // weak_root_state_ is set to gc::kWeakRootStateNoReadsOrWrites in the GC pause but is only
     // cleared after SweepSystemWeaks has completed. This is why we need to wait until it is
     // cleared.
@@ -244,10 +306,16 @@ ObjPtr<mirror::String> InternTable::Insert(ObjPtr<mirror::String> s,
     WaitUntilAccessible(self);
   }
   if (!kUseReadBarrier) {
-    CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+    CHECK_EQ(weak_root_state_.LoadRelaxed(), gc::kWeakRootStateNormal);
   } else {
     CHECK(self->GetWeakRefAccessEnabled());
   }
+  MutexLock stripe_mu(self, *stripe_lock);
+  // Check the strong table for a match, it may have been inserted since the fast path.
+  ObjPtr<mirror::String> strong = LookupStrongLocked(s);
+  if (strong != nullptr) {
+    return strong;
+  }
   // There is no match in the strong table, check the weak table.
   ObjPtr<mirror::String> weak = LookupWeakLocked(s);
   if (weak != nullptr) {
@@ -368,39 +436,58 @@ size_t InternTable::Table::AddTableFromMemory(const uint8_t* ptr) {
     // Avoid inserting empty sets.
     return read_count;
   }
+  Thread* const self = Thread::Current();
   // TODO: Disable this for app images if app images have intern tables.
   static constexpr bool kCheckDuplicates = true;
   if (kCheckDuplicates) {
     for (GcRoot<mirror::String>& string : set) {
+      const int32_t hash = string.Read()->GetHashCode();
+      MutexLock mu(self, *stripe_locks_[StripeForHash(hash)]);
       CHECK(Find(string.Read()) == nullptr) << "Already found " << string.Read()->ToModifiedUtf8();
     }
   }
-  // Insert at the front since we add new interns into the back.
-  tables_.insert(tables_.begin(), std::move(set));
+  image_tables_.push_back(std::move(set));
+  UnorderedSet* const image_table = &image_tables_.back();
+  for (size_t i = 0; i < kStripes; ++i) {
+    MutexLock mu(self, *stripe_locks_[i]);
+    // Insert at the front since we add new interns into the back.
+    stripes_[i].image_tables.insert(stripes_[i].image_tables.begin(), image_table);
+  }
   return read_count;
 }
 
 size_t InternTable::Table::WriteToMemory(uint8_t* ptr) {
-  if (tables_.empty()) {
-    return 0;
-  }
-  UnorderedSet* table_to_write;
+  Thread* const self = Thread::Current();
   UnorderedSet combined;
-  if (tables_.size() > 1) {
-    table_to_write = &combined;
-    for (UnorderedSet& table : tables_) {
+  for (const UnorderedSet& table : image_tables_) {
+    for (const GcRoot<mirror::String>& string : table) {
+      combined.Insert(string);
+    }
+  }
+  for (size_t i = 0; i < kStripes; ++i) {
+    MutexLock mu(self, *stripe_locks_[i]);
+    for (UnorderedSet& table : stripes_[i].tables) {
       for (GcRoot<mirror::String>& string : table) {
         combined.Insert(string);
       }
     }
-  } else {
-    table_to_write = &tables_.back();
   }
-  return table_to_write->WriteToMemory(ptr);
+  return combined.WriteToMemory(ptr);
 }
 
 void InternTable::Table::Remove(ObjPtr<mirror::String> s) {
-  for (UnorderedSet& table : tables_) {
+  Stripe& stripe = GetStripe(s->GetHashCode());
+  // The image tables are shared by all stripes and read under any stripe lock, so they are never
+  // written. Only strings inserted at runtime are removed: a promoted weak intern, which images do
+  // not hold, or a strong intern inserted by an aborted transaction, which was not found in the
+  // image tables when inserted.
+  if (kIsDebugBuild) {
+    for (UnorderedSet* table : stripe.image_tables) {
+      DCHECK(table->Find(GcRoot<mirror::String>(s)) == table->end())
+          << "Attempting to remove image string " << s->ToModifiedUtf8();
+    }
+  }
+  for (UnorderedSet& table : stripe.tables) {
     auto it = table.Find(GcRoot<mirror::String>(s));
     if (it != table.end()) {
       table.Erase(it);
@@ -411,8 +498,16 @@ void InternTable::Table::Remove(ObjPtr<mirror::String> s) {
 }
 
 ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
-  for (UnorderedSet& table : tables_) {
+  const int32_t hash = s->GetHashCode();
+  stripe_locks_[StripeForHash(hash)]->AssertHeld(Thread::Current());
+  Stripe& stripe = GetStripe(hash);
+  for (UnorderedSet* table : stripe.image_tables) {
+    auto it = table->Find(GcRoot<mirror::String>(s));
+    if (it != table->end()) {
+      return it->Read();
+    }
+  }
+  for (UnorderedSet& table : stripe.tables) {
     auto it = table.Find(GcRoot<mirror::String>(s));
     if (it != table.end()) {
       return it->Read();
@@ -422,8 +517,15 @@ ObjPtr<mirror::String> InternTable::Table::Find(ObjPtr<mirror::String> s) {
 }
 
 ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
-  for (UnorderedSet& table : tables_) {
+  stripe_locks_[StripeForHash(string.GetHash())]->AssertHeld(Thread::Current());
+  Stripe& stripe = GetStripe(string.GetHash());
+  for (UnorderedSet* table : stripe.image_tables) {
+    auto it = table->Find(string);
+    if (it != table->end()) {
+      return it->Read();
+    }
+  }
+  for (UnorderedSet& table : stripe.tables) {
     auto it = table.Find(string);
     if (it != table.end()) {
       return it->Read();
@@ -433,29 +535,52 @@ ObjPtr<mirror::String> InternTable::Table::Find(const Utf8String& string) {
 }
 
 void InternTable::Table::AddNewTable() {
-  tables_.push_back(UnorderedSet());
+  Thread* const self = Thread::Current();
+  for (size_t i = 0; i < kStripes; ++i) {
+    MutexLock mu(self, *stripe_locks_[i]);
+    stripes_[i].tables.push_back(UnorderedSet());
+  }
 }
 
 void InternTable::Table::Insert(ObjPtr<mirror::String> s) {
   // Always insert the last table, the image tables are before and we avoid inserting into these
   // to prevent dirty pages.
-  DCHECK(!tables_.empty());
-  tables_.back().Insert(GcRoot<mirror::String>(s));
+  Stripe& stripe = GetStripe(s->GetHashCode());
+  DCHECK(!stripe.tables.empty());
+  stripe.tables.back().Insert(GcRoot<mirror::String>(s));
 }
 
 void InternTable::Table::VisitRoots(RootVisitor* visitor) {
+  Thread* const self = Thread::Current();
   BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(
       visitor, RootInfo(kRootInternedString));
-  for (UnorderedSet& table : tables_) {
+  // Image tables are not modified after being added, and image strings do not move.
+  for (UnorderedSet& table : image_tables_) {
     for (auto& intern : table) {
       buffered_visitor.VisitRoot(intern);
     }
   }
+  for (size_t i = 0; i < kStripes; ++i) {
+    MutexLock mu(self, *stripe_locks_[i]);
+    for (UnorderedSet& table : stripes_[i].tables) {
+      for (auto& intern : table) {
+        buffered_visitor.VisitRoot(intern);
+      }
+    }
+    // Flush while the stripe is locked, the visitor may update the roots.
+    buffered_visitor.Flush();
+  }
 }
 
 void InternTable::Table::SweepWeaks(IsMarkedVisitor* visitor) {
-  for (UnorderedSet& table : tables_) {
-    SweepWeaks(&table, visitor);
+  // Only strong interns are read from images.
+  DCHECK(image_tables_.empty());
+  Thread* const self = Thread::Current();
+  for (size_t i = 0; i < kStripes; ++i) {
+    MutexLock mu(self, *stripe_locks_[i]);
+    for (UnorderedSet& table : stripes_[i].tables) {
+      SweepWeaks(&table, visitor);
+    }
   }
 }
 
@@ -474,12 +599,16 @@ void InternTable::Table::SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
 }
 
 size_t InternTable::Table::Size() const {
-  return std::accumulate(tables_.begin(),
-                         tables_.end(),
-                         0U,
-                         [](size_t sum, const UnorderedSet& set) {
-                           return sum + set.Size();
-                         });
+  Thread* const self = Thread::Current();
+  auto sum_sizes = [](size_t sum, const UnorderedSet& set) {
+    return sum + set.Size();
+  };
+  size_t size = std::accumulate(image_tables_.begin(), image_tables_.end(), 0U, sum_sizes);
+  for (size_t i = 0; i < kStripes; ++i) {
+    MutexLock mu(self, *stripe_locks_[i]);
+    size = std::accumulate(stripes_[i].tables.begin(), stripes_[i].tables.end(), size, sum_sizes);
+  }
+  return size;
 }
 
 void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
@@ -489,18 +618,21 @@ void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
 
 void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
   CHECK(!kUseReadBarrier);
-  weak_root_state_ = new_state;
+  weak_root_state_.StoreRelaxed(new_state);
   if (new_state != gc::kWeakRootStateNoReadsOrWrites) {
     weak_intern_condition_.Broadcast(Thread::Current());
   }
 }
 
-InternTable::Table::Table() {
+InternTable::Table::Table(const std::unique_ptr<Mutex>* stripe_locks)
+    : stripe_locks_(stripe_locks) {
   Runtime* const runtime = Runtime::Current();
-  // Initial table.
-  tables_.push_back(UnorderedSet());
-  tables_.back().SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
-                               runtime->GetHashTableMaxLoadFactor());
+  // Initial tables.
+  for (Stripe& stripe : stripes_) {
+    stripe.tables.push_back(UnorderedSet());
+    stripe.tables.back().SetLoadFactor(runtime->GetHashTableMinLoadFactor(),
+                                       runtime->GetHashTableMaxLoadFactor());
+  }
 }
 
 }  // namespace art
@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <deque>
+#include <memory>
 #include <unordered_set>
 
 #include "atomic.h"
@@ -51,6 +53,12 @@ class Transaction;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * Both tables are split by string hash into stripes, each with its own lock, so that threads
+ * interning unrelated strings do not serialize. Lookups and the common insertion path only take
+ * the lock of the string's stripe. Locks::intern_table_lock_ is still taken for whole-table
+ * operations (root visiting, sweeping, images), for transactions, and while new roots are logged
+ * or weak references are inaccessible.
  */
 class InternTable {
  public:
@@ -181,19 +189,32 @@ class InternTable {
     }
   };
 
+  static constexpr size_t kStripeBits = 4;
+  static constexpr size_t kStripes = 1u << kStripeBits;
+
+  static size_t StripeForHash(int32_t hash) {
+    // The hash sets index buckets with the low bits, pick the stripe from the high ones of a
+    // multiplicative hash so each stripe still spreads over all buckets.
+    return (static_cast<uint32_t>(hash) * 0x9e3779b1u) >> (32 - kStripeBits);
+  }
+
+  Mutex* GetStripeLock(ObjPtr<mirror::String> s) const REQUIRES_SHARED(Locks::mutator_lock_);
+  Mutex* GetStripeLock(const Utf8String& string) const {
+    return stripe_locks_[StripeForHash(string.GetHash())].get();
+  }
+
   // Table which holds pre zygote and post zygote interned strings. There is one instance for
-  // weak interns and strong interns.
+  // weak interns and strong interns. Each stripe is guarded by the InternTable stripe lock of the
+  // same index, shared by both instances.
   class Table {
    public:
-    Table();
-    ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    ObjPtr<mirror::String> Find(const Utf8String& string) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Insert(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Remove(ObjPtr<mirror::String> s)
-        REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    explicit Table(const std::unique_ptr<Mutex>* stripe_locks);
+    // Find, Insert and Remove only touch the stripe of the string, the caller must hold its lock.
+    ObjPtr<mirror::String> Find(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    ObjPtr<mirror::String> Find(const Utf8String& string) REQUIRES_SHARED(Locks::mutator_lock_);
+    void Insert(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    void Remove(ObjPtr<mirror::String> s) REQUIRES_SHARED(Locks::mutator_lock_);
+    // The remaining methods span all stripes, taking each stripe lock in turn.
     void VisitRoots(RootVisitor* visitor)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
     void SweepWeaks(IsMarkedVisitor* visitor)
@@ -215,14 +236,32 @@ class InternTable {
     typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
         TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
 
+    struct Stripe {
+      // Tables read from images, owned by image_tables_ and shared by all stripes. Searched
+      // before the stripe's own tables.
+      std::vector<UnorderedSet*> image_tables;
+      // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
+      // modifying the zygote intern table. The back of table is modified when strings are
+      // interned.
+      std::vector<UnorderedSet> tables;
+    };
+
+    Stripe& GetStripe(int32_t hash) {
+      return stripes_[StripeForHash(hash)];
+    }
+
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
         REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
 
-    // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
-    // modifying the zygote intern table. The back of table is modified when strings are interned.
-    std::vector<UnorderedSet> tables_;
+    const std::unique_ptr<Mutex>* const stripe_locks_;
+    // Image tables are never written after being added, so a string is found through any stripe
+    // without locking the others. A deque so that the stripes' pointers stay valid as images are
+    // added.
+    std::deque<UnorderedSet> image_tables_;
+    Stripe stripes_[kStripes];
 
     ART_FRIEND_TEST(InternTableTest, CrossHash);
+    ART_FRIEND_TEST(InternTableTest, Stripes);
   };
 
   // Insert if non null, otherwise return null. Must be called holding the mutator lock.
@@ -231,6 +270,14 @@ class InternTable {
   ObjPtr<mirror::String> Insert(ObjPtr<mirror::String> s, bool is_strong, bool holding_locks)
       REQUIRES(!Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Insert without transaction recording or new root logging, the caller must hold the stripe
+  // lock of s and have checked that neither is needed and that weak interns are accessible.
+  ObjPtr<mirror::String> InsertStripeLocked(ObjPtr<mirror::String> s, bool is_strong)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Whether self may currently read and write weak interns.
+  bool IsWeakAccessible(Thread* self) const;
+
   ObjPtr<mirror::String> LookupStrongLocked(ObjPtr<mirror::String> s)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
   ObjPtr<mirror::String> LookupWeakLocked(ObjPtr<mirror::String> s)
@@ -265,24 +312,29 @@ class InternTable {
   void WaitUntilAccessible(Thread* self)
       REQUIRES(Locks::intern_table_lock_) REQUIRES_SHARED(Locks::mutator_lock_);
 
-  bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
+  // Only written with Locks::intern_table_lock_ held, read with either that or a stripe lock.
+  Atomic<bool> log_new_roots_;
   ConditionVariable weak_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
+  // One lock per stripe of the tables, acquired after Locks::intern_table_lock_.
+  std::unique_ptr<Mutex> stripe_locks_[kStripes];
   // Since this contains (strong) roots, they need a read barrier to
   // enable concurrent intern table (strong) root scan. Do not
   // directly access the strings in it. Use functions that contain
   // read barriers.
-  Table strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
+  Table strong_interns_;
   std::vector<GcRoot<mirror::String>> new_strong_intern_roots_
       GUARDED_BY(Locks::intern_table_lock_);
   // Since this contains (weak) roots, they need a read barrier. Do
   // not directly access the strings in it. Use functions that contain
   // read barriers.
-  Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  // Weak root state, used for concurrent system weak processing and more.
-  gc::WeakRootState weak_root_state_ GUARDED_BY(Locks::intern_table_lock_);
+  Table weak_interns_;
+  // Weak root state, used for concurrent system weak processing and more. Only written with
+  // Locks::intern_table_lock_ held.
+  Atomic<gc::WeakRootState> weak_root_state_;
 
   friend class Transaction;
   ART_FRIEND_TEST(InternTableTest, CrossHash);
+  ART_FRIEND_TEST(InternTableTest, Stripes);
   DISALLOW_COPY_AND_ASSIGN(InternTable);
 };
 
@@ -77,9 +77,11 @@ TEST_F(InternTableTest, CrossHash) {
   GcRoot<mirror::String> str(mirror::String::AllocFromModifiedUtf8(soa.Self(), "00000000"));
 
   MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  for (InternTable::Table::UnorderedSet& table : t.strong_interns_.tables_) {
-    // The negative hash value shall be 32-bit wide on every host.
-    ASSERT_TRUE(IsUint<32>(table.hashfn_(str)));
+  for (InternTable::Table::Stripe& stripe : t.strong_interns_.stripes_) {
+    for (InternTable::Table::UnorderedSet& table : stripe.tables) {
+      // The negative hash value shall be 32-bit wide on every host.
+      ASSERT_TRUE(IsUint<32>(table.hashfn_(str)));
+    }
   }
 }
 
@@ -233,4 +235,42 @@ TEST_F(InternTableTest, LookupStrong) {
   EXPECT_TRUE(lookup_foobbS == nullptr);
 }
 
+TEST_F(InternTableTest, Stripes) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable t;
+  static constexpr size_t kStrings = 128;
+  StackHandleScope<kStrings> hs(soa.Self());
+  std::vector<Handle<mirror::String>> weak;
+  for (size_t i = 0; i != kStrings; ++i) {
+    std::string str = "string" + std::to_string(i);
+    weak.push_back(hs.NewHandle(mirror::String::AllocFromModifiedUtf8(soa.Self(), str.c_str())));
+    ASSERT_OBJ_PTR_EQ(weak.back().Get(), t.InternWeak(weak.back().Get()));
+    // The tables added for the zygote must be searched as well.
+    if (i == kStrings / 2) {
+      t.AddNewTable();
+    }
+  }
+  EXPECT_EQ(kStrings, t.WeakSize());
+  {
+    // Every stripe should have been used.
+    MutexLock mu(soa.Self(), *Locks::intern_table_lock_);
+    for (size_t i = 0; i != InternTable::kStripes; ++i) {
+      size_t size = 0;
+      for (InternTable::Table::UnorderedSet& table : t.weak_interns_.stripes_[i].tables) {
+        size += table.Size();
+      }
+      EXPECT_NE(0u, size) << "stripe " << i;
+    }
+  }
+  // Promote every weak intern.
+  for (size_t i = 0; i != kStrings; ++i) {
+    std::string str = "string" + std::to_string(i);
+    ObjPtr<mirror::String> strong = t.InternStrong(str.length(), str.c_str());
+    EXPECT_OBJ_PTR_EQ(weak[i].Get(), strong);
+    EXPECT_OBJ_PTR_EQ(strong, t.LookupStrong(soa.Self(), str.length(), str.c_str()));
+  }
+  EXPECT_EQ(kStrings, t.StrongSize());
+  EXPECT_EQ(0u, t.WeakSize());
+}
+
 }  // namespace art
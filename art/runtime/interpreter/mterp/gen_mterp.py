@@ -41,6 +41,9 @@ label_prefix = ".L"         # use ".L" to hide labels from gdb
 alt_label_prefix = ".L_ALT" # use ".L" to hide labels from gdb
 style = None                # interpreter style
 generate_alt_table = False
+fused_stub_text = []
+fused_dispatch_macro = None
+fused_pairs = {}            # first opcode -> opcode fused after it
 function_type_format = ".type   %s, %%function"
 function_size_format = ".size   %s, .-%s"
 global_name_format = "%s"
@@ -142,6 +145,90 @@ def setFallbackStub(tokens):
     stub_fp.close()
 #
 # Parse arch config file --
+# Load the superinstruction stub, which replaces the dispatch macro at the end
+# of the first handler of a fused pair.
+#
+def setSuperinstructionStub(tokens):
+    global fused_stub_text, fused_dispatch_macro
+    if len(tokens) != 3:
+        raise DataParseError("superinstruction-stub requires two arguments")
+    try:
+        stub_fp = open(tokens[1])
+        fused_stub_text = stub_fp.readlines()
+    except IOError, err:
+        stub_fp.close()
+        raise DataParseError("unable to load superinstruction-stub: %s" % str(err))
+    stub_fp.close()
+    fused_dispatch_macro = tokens[2]
+
+#
+# Parse arch config file --
+# Fuse a single opcode pair.
+#
+def fuseEntry(tokens):
+    if len(tokens) != 3:
+        raise DataParseError("fuse requires exactly two arguments")
+    if in_op_start != 1:
+        raise DataParseError("fuse statements must be between opStart/opEnd")
+    if fused_dispatch_macro == None:
+        raise DataParseError("fuse requires a superinstruction-stub")
+    for op in tokens[1:]:
+        if op not in opcodes:
+            raise DataParseError("unknown opcode %s" % op)
+    if fused_pairs.has_key(tokens[1]):
+        print "Note: fuse overrides earlier %s (%s -> %s)" \
+                % (tokens[1], fused_pairs[tokens[1]], tokens[2])
+    fused_pairs[tokens[1]] = tokens[2]
+
+#
+# Parse arch config file --
+# Fuse the most frequent opcode pairs of a bigram profile.  Each line of the
+# profile is "<opcode> <next-opcode> <count>", using either the dex names
+# ("add-int/lit8") or the handler names ("op_add_int_lit8").  Lines that do
+# not look like that are ignored, so a whole SIGQUIT dump can be used.
+#
+def loadSuperinstructions(tokens):
+    if len(tokens) != 3:
+        raise DataParseError("superinstructions requires two arguments")
+    if in_op_start != 1:
+        raise DataParseError("superinstructions must be between opStart/opEnd")
+    if fused_dispatch_macro == None:
+        raise DataParseError("superinstructions requires a superinstruction-stub")
+    max_pairs = int(tokens[2])
+    bigram_re = re.compile(r"^\s*([\w/-]+)\s+([\w/-]+)\s+(\d+)\s*$")
+    bigrams = []
+    try:
+        profile_fp = open(tokens[1])
+    except IOError, err:
+        raise DataParseError("unable to load bigram profile: %s" % str(err))
+    for line in profile_fp:
+        match = bigram_re.match(line)
+        if not match:
+            continue
+        ops = []
+        for name in match.group(1, 2):
+            if not name.startswith("op_"):
+                name = "op_" + re.sub(r"[-/]", "_", name.lower())
+            ops.append(name)
+        if ops[0] in opcodes and ops[1] in opcodes:
+            bigrams.append((int(match.group(3)), ops[0], ops[1]))
+    profile_fp.close()
+
+    # A handler can only predict one successor, so keep the most frequent one.
+    bigrams.sort(reverse=True)
+    num_pairs = 0
+    for count, op, next_op in bigrams:
+        if num_pairs == max_pairs:
+            break
+        if fused_pairs.has_key(op):
+            continue
+        if verbose:
+            print " fuse %s %s (%d)" % (op, next_op, count)
+        fused_pairs[op] = next_op
+        num_pairs += 1
+
+#
+# Parse arch config file --
 # Record location of default alt stub
 #
 def setAsmAltStub(tokens):
@@ -298,6 +385,9 @@ def loadAndEmitOpcodes():
 
         if location == "FALLBACK":
             emitFallback(i)
+        elif fused_pairs.has_key(op) and \
+                getOpcodeLocation(fused_pairs[op]) != "FALLBACK":
+            loadAndEmitFusedAsm(location, i, sister_list)
         else:
             loadAndEmitAsm(location, i, sister_list)
 
@@ -382,6 +472,94 @@ def loadAndEmitAsm(location, opindex, sister_list):
     emitAsmHeader(asm_fp, dict, label_prefix)
     appendSourceFile(source, dict, asm_fp, sister_list)
 
+#
+# Return the directory an opcode's source file is loaded from.
+#
+def getOpcodeLocation(op):
+    if opcode_locations.has_key(op):
+        return opcode_locations[op]
+    return default_op_dir
+
+#
+# Collects output lines instead of writing them to a file.
+#
+class LineBuffer:
+    def __init__(self):
+        self.lines = []
+    def write(self, text):
+        self.lines.append(text)
+
+#
+# Load an assembly fragment and emit it as the first half of a superinstruction.
+# The dispatch macro at the end of the handler is replaced with the
+# superinstruction stub, which continues in an inlined copy of the handler of
+# the fused opcode when that opcode comes next.  The inlined copy gets its own
+# "opcode" name so that its labels do not clash with the original handler.
+#
+def loadAndEmitFusedAsm(location, opindex, sister_list):
+    op = opcodes[opindex]
+    next_op = fused_pairs[op]
+    next_opindex = opcodes.index(next_op)
+    source = "%s/%s.S" % (location, op)
+    dict = getGlobalSubDict()
+    dict.update({ "opcode":op, "opnum":opindex })
+    if verbose:
+        print " emit %s + %s --> asm" % (source, next_op)
+
+    handler = LineBuffer()
+    handler_sister_list = []
+    appendSourceFile(source, dict, handler, handler_sister_list)
+
+    # Find the dispatch to the next instruction ending the handler.
+    dispatch_re = re.compile(r"^\s*%s\s+(\d+)\s*$" % fused_dispatch_macro)
+    tail = len(handler.lines) - 1
+    while tail >= 0 and (handler.lines[tail].strip() == "" or
+                         handler.lines[tail].lstrip().startswith("/*")):
+        tail -= 1
+    match = dispatch_re.match(handler.lines[tail]) if tail >= 0 else None
+    emitAsmHeader(asm_fp, dict, label_prefix)
+    if not match:
+        print "Note: %s does not end with %s, not fused with %s" \
+                % (op, fused_dispatch_macro, next_op)
+        asm_fp.writelines(handler.lines)
+        sister_list.extend(handler_sister_list)
+        return
+
+    stub_dict = getGlobalSubDict()
+    stub_dict.update({ "opcode":op, "opnum":opindex,
+                       "next_opcode":next_op, "next_opnum":next_opindex,
+                       "count":match.group(1),
+                       "fused_label":"%s_fused_%s_%s" % (label_prefix, op, next_op) })
+    stub_handler = []
+    stub_sister = []
+    in_sister = False
+    for line in fused_stub_text:
+        if line.startswith("%break"):
+            in_sister = True
+        elif line.startswith("%fused"):
+            if not in_sister:
+                raise DataParseError("%fused must follow %break in superinstruction-stub")
+            next_dict = getGlobalSubDict()
+            next_dict.update({ "opcode":"%s_after_%s" % (next_op, op),
+                               "opnum":next_opindex })
+            inlined = LineBuffer()
+            appendSourceFile("%s/%s.S" % (getOpcodeLocation(next_op), next_op),
+                             next_dict, inlined, handler_sister_list)
+            stub_sister.extend(inlined.lines)
+        else:
+            subline = Template(line).substitute(stub_dict)
+            if in_sister:
+                stub_sister.append(subline)
+            else:
+                stub_handler.append(subline)
+
+    asm_fp.writelines(handler.lines[:tail])
+    asm_fp.writelines(stub_handler)
+    asm_fp.writelines(handler.lines[tail + 1:])
+    sister_list.append("\n/* superinstruction %s + %s */\n" % (op, next_op))
+    sister_list.extend(stub_sister)
+    sister_list.extend(handler_sister_list)
+
 #
 # Emit fallback fragment
 #
@@ -593,6 +771,12 @@ try:
                 altEntry(tokens)
             elif tokens[0] == "op":
                 opEntry(tokens)
+            elif tokens[0] == "superinstruction-stub":
+                setSuperinstructionStub(tokens)
+            elif tokens[0] == "superinstructions":
+                loadSuperinstructions(tokens)
+            elif tokens[0] == "fuse":
+                fuseEntry(tokens)
             elif tokens[0] == "handler-style":
                 setHandlerStyle(tokens)
             elif tokens[0] == "alt-ops":
@@ -47,11 +47,45 @@ void CheckMterpAsmConstants() {
 void InitMterpTls(Thread* self) {
   self->SetMterpDefaultIBase(artMterpAsmInstructionStart);
   self->SetMterpAltIBase(artMterpAsmAltInstructionStart);
-  self->SetMterpCurrentIBase((kTraceExecutionEnabled || kTestExportPC) ?
+  self->SetMterpCurrentIBase((kTraceExecutionEnabled || kTestExportPC || kMterpProfileBigrams) ?
                              artMterpAsmAltInstructionStart :
                              artMterpAsmInstructionStart);
 }
 
+/*
+ * Fall-through opcode pair counts, indexed by (opcode << 8) | next_opcode.
+ * Only pairs where the first instruction can continue to the next one are
+ * counted, as those are the only ones a fused handler can take advantage of.
+ */
+static constexpr size_t kNumBigrams =
+    kMterpProfileBigrams ? kNumPackedOpcodes * kNumPackedOpcodes : 1u;
+static Atomic<uint64_t> bigram_counts[kNumBigrams];
+
+static void RecordBigram(const Instruction* inst) {
+  Instruction::Code opcode = inst->Opcode();
+  if ((Instruction::FlagsOf(opcode) & Instruction::kContinue) == 0 ||
+      (Instruction::FlagsOf(opcode) & (Instruction::kBranch | Instruction::kSwitch)) != 0) {
+    return;
+  }
+  Instruction::Code next_opcode = inst->Next()->Opcode();
+  bigram_counts[(static_cast<size_t>(opcode) << 8) | next_opcode].FetchAndAddRelaxed(1u);
+}
+
+void DumpMterpBigramProfile(std::ostream& os) {
+  if (!kMterpProfileBigrams) {
+    return;
+  }
+  os << "Mterp bigram profile:\n";
+  for (size_t i = 0; i != kNumBigrams; ++i) {
+    uint64_t count = bigram_counts[i].LoadRelaxed();
+    if (count != 0u) {
+      os << "  " << Instruction::Name(static_cast<Instruction::Code>(i >> 8))
+         << " " << Instruction::Name(static_cast<Instruction::Code>(i & 0xff))
+         << " " << count << "\n";
+    }
+  }
+}
+
 /*
  * Find the matching case.  Returns the offset to the handler instructions.
  *
@@ -515,6 +549,9 @@ extern "C" void MterpCheckBefore(Thread* self, ShadowFrame* shadow_frame, uint16
     uint32_t dex_pc = dex_pc_ptr - shadow_frame->GetCodeItem()->insns_;
     TraceExecution(*shadow_frame, inst, dex_pc);
   }
+  if (kMterpProfileBigrams) {
+    RecordBigram(inst);
+  }
   if (kTestExportPC) {
     // Save invalid dex pc to force segfault if improperly used.
     shadow_frame->SetDexPCPtr(reinterpret_cast<uint16_t*>(kExportPCPoison));
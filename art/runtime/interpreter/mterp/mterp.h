@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_INTERPRETER_MTERP_MTERP_H_
 #define ART_RUNTIME_INTERPRETER_MTERP_MTERP_H_
 
+#include <iosfwd>
+
 /*
  * Mterp assembly handler bases
  */
@@ -30,6 +32,7 @@ namespace interpreter {
 
 void InitMterpTls(Thread* self);
 void CheckMterpAsmConstants();
+void DumpMterpBigramProfile(std::ostream& os);
 
 // The return type should be 'bool' but our assembly stubs expect 'bool'
 // to be zero-extended to the whole register and that's broken on x86-64
@@ -43,6 +46,10 @@ extern "C" size_t MterpShouldSwitchInterpreters();
 constexpr uintptr_t kExportPCPoison = 0xdead00ff;
 // Set true to enable poison testing of ExportPC.  Uses Alt interpreter.
 constexpr bool kTestExportPC = false;
+// Set true to count how often each opcode falls through to each other opcode. The counts are
+// dumped on SIGQUIT in the format read by the "superinstructions" command of gen_mterp.py.
+// Uses Alt interpreter.
+constexpr bool kMterpProfileBigrams = false;
 
 }  // namespace interpreter
 }  // namespace art
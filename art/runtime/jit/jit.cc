@@ -20,6 +20,7 @@
 
 #include "art_method-inl.h"
 #include "base/enums.h"
+#include "base/time_utils.h"
 #include "debugger.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
 #include "interpreter/interpreter.h"
@@ -47,13 +48,14 @@ void* Jit::jit_library_handle_= nullptr;
 void* Jit::jit_compiler_handle_ = nullptr;
 void* (*Jit::jit_load_)(bool*) = nullptr;
 void (*Jit::jit_unload_)(void*) = nullptr;
-bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool) = nullptr;
+bool (*Jit::jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool) = nullptr;
 void (*Jit::jit_types_loaded_)(void*, mirror::Class**, size_t count) = nullptr;
 bool Jit::generate_debug_info_ = false;
 
 JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& options) {
   auto* jit_options = new JitOptions;
   jit_options->use_jit_compilation_ = options.GetOrDefault(RuntimeArgumentMap::UseJitCompilation);
+  jit_options->use_baseline_compiler_ = options.GetOrDefault(RuntimeArgumentMap::JITBaseline);
 
   jit_options->code_cache_initial_capacity_ =
       options.GetOrDefault(RuntimeArgumentMap::JITCodeCacheInitialCapacity);
@@ -118,6 +120,11 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
         static_cast<size_t>(1));
   }
 
+  jit_options->thread_pool_size_ = options.GetOrDefault(RuntimeArgumentMap::JITPoolThreads);
+  if (jit_options->thread_pool_size_ == 0) {
+    LOG(FATAL) << "The JIT needs at least one thread.";
+  }
+
   return jit_options;
 }
 
@@ -126,11 +133,25 @@ bool Jit::ShouldUsePriorityThreadWeight() {
       && Thread::Current()->IsJitSensitiveThread();
 }
 
+static void DumpInstallLatency(std::ostream& os, const Histogram<uint64_t>& histogram) {
+  if (histogram.SampleSize() == 0) {
+    os << histogram.Name() << ": <no data>\n";
+    return;
+  }
+  Histogram<uint64_t>::CumulativeData cumulative_data;
+  histogram.CreateHistogram(&cumulative_data);
+  histogram.PrintConfidenceIntervals(os, 0.99, cumulative_data);
+}
+
 void Jit::DumpInfo(std::ostream& os) {
   code_cache_->Dump(os);
   cumulative_timings_.Dump(os);
   MutexLock mu(Thread::Current(), lock_);
   memory_use_.PrintMemoryUse(os);
+  DumpInstallLatency(os, osr_install_latency_);
+  DumpInstallLatency(os, hot_install_latency_);
+  DumpInstallLatency(os, warm_install_latency_);
+  os << "Stale JIT tasks dropped: " << stale_tasks_ << "\n";
 }
 
 void Jit::DumpForSigQuit(std::ostream& os) {
@@ -145,13 +166,19 @@ void Jit::AddTimingLogger(const TimingLogger& logger) {
 Jit::Jit() : dump_info_on_shutdown_(false),
              cumulative_timings_("JIT timings"),
              memory_use_("Memory used for compilation", 16),
+             osr_install_latency_("JIT osr install latency", 100),
+             hot_install_latency_("JIT hot install latency", 100),
+             warm_install_latency_("JIT warm install latency", 100),
+             stale_tasks_(0),
              lock_("JIT memory use lock"),
              use_jit_compilation_(true),
+             use_baseline_compiler_(false),
              hot_method_threshold_(0),
              warm_method_threshold_(0),
              osr_method_threshold_(0),
              priority_thread_weight_(0),
-             invoke_transition_weight_(0) {}
+             invoke_transition_weight_(0),
+             thread_pool_size_(0) {}
 
 Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   DCHECK(options->UseJitCompilation() || options->GetProfileSaverOptions().IsEnabled());
@@ -169,11 +196,18 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
     return nullptr;
   }
   jit->use_jit_compilation_ = options->UseJitCompilation();
+  // Only these code generators count the invocations of baseline code and call
+  // EnqueueOptimizedCompilation() once hot.
+  jit->use_baseline_compiler_ = options->UseBaselineCompiler() &&
+      (kRuntimeISA == kArm || kRuntimeISA == kThumb2 || kRuntimeISA == kArm64 ||
+       kRuntimeISA == kX86 || kRuntimeISA == kX86_64);
   jit->profile_saver_options_ = options->GetProfileSaverOptions();
   VLOG(jit) << "JIT created with initial_capacity="
       << PrettySize(options->GetCodeCacheInitialCapacity())
       << ", max_capacity=" << PrettySize(options->GetCodeCacheMaxCapacity())
       << ", compile_threshold=" << options->GetCompileThreshold()
+      << ", baseline=" << std::boolalpha << jit->use_baseline_compiler_
+      << ", threads=" << options->GetThreadPoolSize()
       << ", profile_saver_options=" << options->GetProfileSaverOptions();
 
 
@@ -182,6 +216,7 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   jit->osr_method_threshold_ = options->GetOsrThreshold();
   jit->priority_thread_weight_ = options->GetPriorityThreadWeight();
   jit->invoke_transition_weight_ = options->GetInvokeTransitionWeight();
+  jit->thread_pool_size_ = options->GetThreadPoolSize();
 
   jit->CreateThreadPool();
 
@@ -212,7 +247,7 @@ bool Jit::LoadCompilerLibrary(std::string* error_msg) {
     *error_msg = "JIT couldn't find jit_unload entry point";
     return false;
   }
-  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool)>(
+  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool, bool)>(
       dlsym(jit_library_handle_, "jit_compile_method"));
   if (jit_compile_method_ == nullptr) {
     dlclose(jit_library_handle_);
@@ -246,7 +281,7 @@ bool Jit::LoadCompiler(std::string* error_msg) {
   return true;
 }
 
-bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
+bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr, bool baseline) {
   DCHECK(Runtime::Current()->UseJitCompilation());
   DCHECK(!method->IsRuntimeMethod());
 
@@ -266,14 +301,16 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self, bool osr) {
   // If we get a request to compile a proxy method, we pass the actual Java method
   // of that proxy method, as the compiler does not expect a proxy method.
   ArtMethod* method_to_compile = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
-  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr)) {
+  if (!code_cache_->NotifyCompilationOf(method_to_compile, self, osr, baseline)) {
     return false;
   }
 
   VLOG(jit) << "Compiling method "
             << ArtMethod::PrettyMethod(method_to_compile)
-            << " osr=" << std::boolalpha << osr;
-  bool success = jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr);
+            << " osr=" << std::boolalpha << osr
+            << " baseline=" << baseline;
+  bool success =
+      jit_compile_method_(jit_compiler_handle_, method_to_compile, self, osr, baseline);
   code_cache_->DoneCompiling(method_to_compile, self, osr);
   if (!success) {
     VLOG(jit) << "Failed to compile method "
@@ -298,7 +335,7 @@ void Jit::CreateThreadPool() {
 
   // We need peers as we may report the JIT thread, e.g., in the debugger.
   constexpr bool kJitPoolNeedsPeers = true;
-  thread_pool_.reset(new ThreadPool("Jit thread pool", 1, kJitPoolNeedsPeers));
+  thread_pool_.reset(new ThreadPool("Jit thread pool", thread_pool_size_, kJitPoolNeedsPeers));
 
   thread_pool_->SetPthreadPriority(kJitPoolThreadPthreadPriority);
   Start();
@@ -561,15 +598,33 @@ void Jit::AddMemoryUsage(ArtMethod* method, size_t bytes) {
   memory_use_.AddValue(bytes);
 }
 
+void Jit::AddInstallLatency(uint64_t latency_ns, bool osr, bool baseline) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (osr) {
+    osr_install_latency_.AdjustAndAddValue(latency_ns);
+  } else if (baseline) {
+    warm_install_latency_.AdjustAndAddValue(latency_ns);
+  } else {
+    hot_install_latency_.AdjustAndAddValue(latency_ns);
+  }
+}
+
+void Jit::AddStaleTask() {
+  MutexLock mu(Thread::Current(), lock_);
+  ++stale_tasks_;
+}
+
 class JitCompileTask FINAL : public Task {
  public:
   enum TaskKind {
     kAllocateProfile,
     kCompile,
+    kCompileBaseline,
     kCompileOsr
   };
 
-  JitCompileTask(ArtMethod* method, TaskKind kind) : method_(method), kind_(kind) {
+  JitCompileTask(ArtMethod* method, TaskKind kind)
+      : method_(method), kind_(kind), queued_ns_(NanoTime()) {
     ScopedObjectAccess soa(Thread::Current());
     // Add a global ref to the class to prevent class unloading until compilation is done.
     klass_ = soa.Vm()->AddGlobalRef(soa.Self(), method_->GetDeclaringClass());
@@ -583,19 +638,38 @@ class JitCompileTask FINAL : public Task {
 
   void Run(Thread* self) OVERRIDE {
     ScopedObjectAccess soa(self);
-    if (kind_ == kCompile) {
-      Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ false);
-    } else if (kind_ == kCompileOsr) {
-      Runtime::Current()->GetJit()->CompileMethod(method_, self, /* osr */ true);
-    } else {
-      DCHECK(kind_ == kAllocateProfile);
+    Jit* jit = Runtime::Current()->GetJit();
+    if (kind_ == kAllocateProfile) {
       if (ProfilingInfo::Create(self, method_, /* retry_allocation */ true)) {
         VLOG(jit) << "Start profiling " << ArtMethod::PrettyMethod(method_);
       }
+    } else if (IsStale(jit)) {
+      VLOG(jit) << "Dropping stale compilation of " << ArtMethod::PrettyMethod(method_);
+      jit->AddStaleTask();
+    } else {
+      const bool osr = (kind_ == kCompileOsr);
+      const bool baseline = (kind_ == kCompileBaseline);
+      if (jit->CompileMethod(method_, self, osr, baseline)) {
+        jit->AddInstallLatency(NanoTime() - queued_ns_, osr, baseline);
+      }
     }
     ProfileSaver::NotifyJitActivity();
   }
 
+  // OSR compilations come first, as a thread is looping in the interpreter waiting for them,
+  // then hot methods. Profile allocations and baseline compilations of methods that just
+  // became hot run last.
+  int32_t GetPriority() const OVERRIDE {
+    switch (kind_) {
+      case kCompileOsr:
+        return 2;
+      case kCompile:
+        return 1;
+      default:
+        return 0;
+    }
+  }
+
   void Finalize() OVERRIDE {
     delete this;
   }
@@ -603,11 +677,38 @@ class JitCompileTask FINAL : public Task {
  private:
   ArtMethod* const method_;
   const TaskKind kind_;
+  const uint64_t queued_ns_;
   jobject klass_;
 
+  // Whether the code this task would produce was installed while the task was queued, by an
+  // earlier task for the same method on another worker.
+  bool IsStale(Jit* jit) const REQUIRES_SHARED(Locks::mutator_lock_) {
+    JitCodeCache* code_cache = jit->GetCodeCache();
+    if (kind_ == kCompileOsr) {
+      return code_cache->IsOsrCompiled(method_);
+    }
+    const void* entry_point = method_->GetEntryPointFromQuickCompiledCode();
+    if (!code_cache->ContainsPc(entry_point)) {
+      return false;
+    }
+    return (kind_ == kCompileBaseline) || !code_cache->IsBaselineCode(entry_point);
+  }
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCompileTask);
 };
 
+void Jit::EnqueueOptimizedCompilation(ArtMethod* method, Thread* self) {
+  DCHECK(use_baseline_compiler_);
+  if (thread_pool_ == nullptr) {
+    // Should only see this when shutting down.
+    return;
+  }
+  if (code_cache_->MarkBaselineCodeForTierUp(self, method)) {
+    VLOG(jit) << "Tiering up " << method->PrettyMethod();
+    thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompile));
+  }
+}
+
 void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_backedges) {
   if (thread_pool_ == nullptr) {
     // Should only see this when shutting down.
@@ -659,7 +760,10 @@ void Jit::AddSamples(Thread* self, ArtMethod* method, uint16_t count, bool with_
       if ((new_count >= hot_method_threshold_) &&
           !code_cache_->ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
         DCHECK(thread_pool_ != nullptr);
-        thread_pool_->AddTask(self, new JitCompileTask(method, JitCompileTask::kCompile));
+        JitCompileTask::TaskKind kind = use_baseline_compiler_
+            ? JitCompileTask::kCompileBaseline
+            : JitCompileTask::kCompile;
+        thread_pool_->AddTask(self, new JitCompileTask(method, kind));
       }
       // Avoid jumping more than one state at a time.
       new_count = std::min(new_count, osr_method_threshold_ - 1);
@@ -694,6 +798,7 @@ void Jit::MethodEntered(Thread* thread, ArtMethod* method) {
   if ((profiling_info != nullptr) && (profiling_info->GetSavedEntryPoint() != nullptr)) {
     Runtime::Current()->GetInstrumentation()->UpdateMethodsCode(
         method, profiling_info->GetSavedEntryPoint());
+    code_cache_->AddSavedEntryPointHit();
   } else {
     AddSamples(thread, method, 1, /* with_backedges */false);
   }
@@ -59,7 +59,7 @@ class Jit {
 
   virtual ~Jit();
   static Jit* Create(JitOptions* options, std::string* error_msg);
-  bool CompileMethod(ArtMethod* method, Thread* self, bool osr)
+  bool CompileMethod(ArtMethod* method, Thread* self, bool osr, bool baseline = false)
       REQUIRES_SHARED(Locks::mutator_lock_);
   void CreateThreadPool();
 
@@ -82,6 +82,12 @@ class Jit {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
+  // Record the time between queuing a compilation and installing its code.
+  void AddInstallLatency(uint64_t latency_ns, bool osr, bool baseline) REQUIRES(!lock_);
+
+  // Record a compilation dropped because its code was installed while it was queued.
+  void AddStaleTask() REQUIRES(!lock_);
+
   size_t OSRMethodThreshold() const {
     return osr_method_threshold_;
   }
@@ -107,6 +113,18 @@ class Jit {
     return profile_saver_options_.IsEnabled();
   }
 
+  // Returns whether hot methods are first compiled with the baseline tier and only later
+  // recompiled with the optimizing tier.
+  bool UseBaselineCompiler() const {
+    return use_baseline_compiler_;
+  }
+
+  // Queue the optimizing compilation of `method`, whose baseline code was invoked as many times
+  // as the hot threshold since it was installed. Called by that baseline code, which counts
+  // invocations but does not fill inline caches. Must not suspend.
+  void EnqueueOptimizedCompilation(ArtMethod* method, Thread* self)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   // Wait until there is no more pending compilation tasks.
   void WaitForCompilationToFinish(Thread* self);
 
@@ -191,18 +209,24 @@ class Jit {
   static void* jit_compiler_handle_;
   static void* (*jit_load_)(bool*);
   static void (*jit_unload_)(void*);
-  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool);
+  static bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool, bool);
   static void (*jit_types_loaded_)(void*, mirror::Class**, size_t count);
 
   // Performance monitoring.
   bool dump_info_on_shutdown_;
   CumulativeLogger cumulative_timings_;
   Histogram<uint64_t> memory_use_ GUARDED_BY(lock_);
+  // Install latencies by priority class of the compilation, in microseconds.
+  Histogram<uint64_t> osr_install_latency_ GUARDED_BY(lock_);
+  Histogram<uint64_t> hot_install_latency_ GUARDED_BY(lock_);
+  Histogram<uint64_t> warm_install_latency_ GUARDED_BY(lock_);
+  size_t stale_tasks_ GUARDED_BY(lock_);
   Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
 
   std::unique_ptr<jit::JitCodeCache> code_cache_;
 
   bool use_jit_compilation_;
+  bool use_baseline_compiler_;
   ProfileSaverOptions profile_saver_options_;
   static bool generate_debug_info_;
   uint16_t hot_method_threshold_;
@@ -210,6 +234,7 @@ class Jit {
   uint16_t osr_method_threshold_;
   uint16_t priority_thread_weight_;
   uint16_t invoke_transition_weight_;
+  size_t thread_pool_size_;
   std::unique_ptr<ThreadPool> thread_pool_;
 
   DISALLOW_COPY_AND_ASSIGN(Jit);
@@ -233,6 +258,9 @@ class JitOptions {
   size_t GetInvokeTransitionWeight() const {
     return invoke_transition_weight_;
   }
+  size_t GetThreadPoolSize() const {
+    return thread_pool_size_;
+  }
   size_t GetCodeCacheInitialCapacity() const {
     return code_cache_initial_capacity_;
   }
@@ -254,6 +282,9 @@ class JitOptions {
   void SetUseJitCompilation(bool b) {
     use_jit_compilation_ = b;
   }
+  bool UseBaselineCompiler() const {
+    return use_baseline_compiler_;
+  }
   void SetSaveProfilingInfo(bool save_profiling_info) {
     profile_saver_options_.SetEnabled(save_profiling_info);
   }
@@ -264,6 +295,7 @@ class JitOptions {
 
  private:
   bool use_jit_compilation_;
+  bool use_baseline_compiler_;
   size_t code_cache_initial_capacity_;
   size_t code_cache_max_capacity_;
   size_t compile_threshold_;
@@ -271,11 +303,13 @@ class JitOptions {
   size_t osr_threshold_;
   uint16_t priority_thread_weight_;
   size_t invoke_transition_weight_;
+  size_t thread_pool_size_;
   bool dump_info_on_shutdown_;
   ProfileSaverOptions profile_saver_options_;
 
   JitOptions()
       : use_jit_compilation_(false),
+        use_baseline_compiler_(false),
         code_cache_initial_capacity_(0),
         code_cache_max_capacity_(0),
         compile_threshold_(0),
@@ -283,6 +317,7 @@ class JitOptions {
         osr_threshold_(0),
         priority_thread_weight_(0),
         invoke_transition_weight_(0),
+        thread_pool_size_(0),
         dump_info_on_shutdown_(false) {}
 
   DISALLOW_COPY_AND_ASSIGN(JitOptions);
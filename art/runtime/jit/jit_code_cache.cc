@@ -123,8 +123,23 @@ JitCodeCache* JitCodeCache::Create(size_t initial_capacity,
   data_size = initial_capacity / 2;
   code_size = initial_capacity - data_size;
   DCHECK_EQ(code_size + data_size, initial_capacity);
-  return new JitCodeCache(
-      code_map, data_map, code_size, data_size, max_capacity, garbage_collect_code);
+
+  // The nursery takes at most a quarter of the code map, and is only worth having if
+  // code is collected.
+  size_t nursery_size =
+      RoundDown(std::min<size_t>(kMaxNurseryCapacity, code_map->Size() / 4), kPageSize);
+  if (!garbage_collect_code ||
+      nursery_size < 4 * kPageSize ||
+      code_map->Size() - nursery_size < code_size) {
+    nursery_size = 0;
+  }
+  return new JitCodeCache(code_map,
+                          data_map,
+                          code_size,
+                          data_size,
+                          max_capacity,
+                          nursery_size,
+                          garbage_collect_code);
 }
 
 JitCodeCache::JitCodeCache(MemMap* code_map,
@@ -132,24 +147,39 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
                            size_t initial_code_capacity,
                            size_t initial_data_capacity,
                            size_t max_capacity,
+                           size_t nursery_capacity,
                            bool garbage_collect_code)
     : lock_("Jit code cache", kJitCodeCacheLock),
       lock_cond_("Jit code cache condition variable", lock_),
       collection_in_progress_(false),
       code_map_(code_map),
       data_map_(data_map),
+      nursery_mspace_(nullptr),
+      nursery_capacity_(nursery_capacity),
       max_capacity_(max_capacity),
       current_capacity_(initial_code_capacity + initial_data_capacity),
-      code_end_(initial_code_capacity),
+      code_end_(nursery_capacity + initial_code_capacity),
+      nursery_end_(std::min(initial_code_capacity, nursery_capacity)),
       data_end_(initial_data_capacity),
       last_collection_increased_code_cache_(false),
       last_update_time_ns_(0),
       garbage_collect_code_(garbage_collect_code),
       used_memory_for_data_(0),
       used_memory_for_code_(0),
+      used_memory_for_nursery_(0),
       number_of_compilations_(0),
       number_of_osr_compilations_(0),
       number_of_collections_(0),
+      number_of_nursery_collections_(0),
+      number_of_nursery_survivors_(0),
+      number_of_nursery_frees_(0),
+      number_of_nursery_overflows_(0),
+      nursery_collection_requested_(false),
+      number_of_saved_entry_point_hits_(0),
+      number_of_saved_entry_point_misses_(0),
+      histogram_collection_time_("JIT code cache collection time (us)", 16),
+      histogram_nursery_collection_time_("JIT code cache nursery collection time (us)", 16),
+      histogram_checkpoint_time_("JIT code cache thread stacks checkpoint time (us)", 16),
       histogram_stack_map_memory_use_("Memory used for stack maps", 16),
       histogram_code_memory_use_("Memory used for compiled code", 16),
       histogram_profiling_info_memory_use_("Memory used for profiling info", 16),
@@ -157,13 +187,21 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
       inline_cache_cond_("Jit inline cache condition variable", lock_) {
 
   DCHECK_GE(max_capacity, initial_code_capacity + initial_data_capacity);
-  code_mspace_ = create_mspace_with_base(code_map_->Begin(), code_end_, false /*locked*/);
+  code_mspace_ = create_mspace_with_base(
+      code_map_->Begin() + nursery_capacity_, initial_code_capacity, false /*locked*/);
   data_mspace_ = create_mspace_with_base(data_map_->Begin(), data_end_, false /*locked*/);
 
   if (code_mspace_ == nullptr || data_mspace_ == nullptr) {
     PLOG(FATAL) << "create_mspace_with_base failed";
   }
 
+  if (nursery_capacity_ != 0) {
+    nursery_mspace_ = create_mspace_with_base(code_map_->Begin(), nursery_end_, false /*locked*/);
+    if (nursery_mspace_ == nullptr) {
+      PLOG(FATAL) << "create_mspace_with_base failed";
+    }
+  }
+
   SetFootprintLimit(current_capacity_);
 
   CHECKED_MPROTECT(code_map_->Begin(), code_map_->Size(), kProtCode);
@@ -172,7 +210,9 @@ JitCodeCache::JitCodeCache(MemMap* code_map,
   VLOG(jit) << "Created jit code cache: initial data size="
             << PrettySize(initial_data_capacity)
             << ", initial code size="
-            << PrettySize(initial_code_capacity);
+            << PrettySize(initial_code_capacity)
+            << ", nursery size="
+            << PrettySize(nursery_capacity_);
 }
 
 bool JitCodeCache::ContainsPc(const void* ptr) const {
@@ -226,9 +266,21 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                   size_t code_size,
                                   size_t data_size,
                                   bool osr,
+                                  bool baseline,
                                   Handle<mirror::ObjectArray<mirror::Object>> roots,
                                   bool has_should_deoptimize_flag,
                                   const ArenaSet<ArtMethod*>& cha_single_implementation_list) {
+  // OSR code and baseline code are expected to be short lived, put them in the nursery.
+  bool in_nursery = osr || baseline;
+  bool collect_nursery = false;
+  if (in_nursery) {
+    MutexLock mu(self, lock_);
+    collect_nursery = nursery_collection_requested_;
+  }
+  if (collect_nursery) {
+    // The nursery overflowed last time, collect it so that this code fits again.
+    GarbageCollectNursery(self);
+  }
   uint8_t* result = CommitCodeInternal(self,
                                        method,
                                        stack_map,
@@ -241,6 +293,8 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                        code_size,
                                        data_size,
                                        osr,
+                                       baseline,
+                                       in_nursery,
                                        roots,
                                        has_should_deoptimize_flag,
                                        cha_single_implementation_list);
@@ -259,6 +313,8 @@ uint8_t* JitCodeCache::CommitCode(Thread* self,
                                 code_size,
                                 data_size,
                                 osr,
+                                baseline,
+                                in_nursery,
                                 roots,
                                 has_should_deoptimize_flag,
                                 cha_single_implementation_list);
@@ -406,6 +462,7 @@ void JitCodeCache::FreeCode(const void* code_ptr) {
   // Notify native debugger that we are about to remove the code.
   // It does nothing if we are not using native debugger.
   DeleteJITCodeEntryForAddress(reinterpret_cast<uintptr_t>(code_ptr));
+  baseline_code_.erase(code_ptr);
   FreeData(GetRootTable(code_ptr));
   FreeCode(reinterpret_cast<uint8_t*>(allocation));
 }
@@ -536,6 +593,8 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
                                           size_t code_size,
                                           size_t data_size,
                                           bool osr,
+                                          bool baseline,
+                                          bool in_nursery,
                                           Handle<mirror::ObjectArray<mirror::Object>> roots,
                                           bool has_should_deoptimize_flag,
                                           const ArenaSet<ArtMethod*>&
@@ -555,7 +614,7 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
     WaitForPotentialCollectionToComplete(self);
     {
       ScopedCodeCacheWrite scc(code_map_.get());
-      memory = AllocateCode(total_size);
+      memory = AllocateCode(total_size, in_nursery);
       if (memory == nullptr) {
         return nullptr;
       }
@@ -633,6 +692,11 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
                      reinterpret_cast<char*>(roots_data + data_size));
     }
     method_code_map_.Put(code_ptr, method);
+    if (baseline) {
+      baseline_code_.emplace(code_ptr, false);
+      // The baseline code counts its invocations from here, see MarkBaselineCodeForTierUp.
+      method->ClearCounter();
+    }
     if (osr) {
       number_of_osr_compilations_++;
       osr_code_map_.Put(method, code_ptr);
@@ -647,7 +711,9 @@ uint8_t* JitCodeCache::CommitCodeInternal(Thread* self,
     }
     last_update_time_ns_.StoreRelease(NanoTime());
     VLOG(jit)
-        << "JIT added (osr=" << std::boolalpha << osr << std::noboolalpha << ") "
+        << "JIT added (osr=" << std::boolalpha << osr
+        << ", baseline=" << baseline
+        << ", nursery=" << IsInNursery(code_ptr) << std::noboolalpha << ") "
         << ArtMethod::PrettyMethod(method) << "@" << method
         << " ccache_size=" << PrettySize(CodeCacheSizeLocked()) << ": "
         << " dcache_size=" << PrettySize(DataCacheSizeLocked()) << ": "
@@ -881,7 +947,13 @@ void JitCodeCache::SetFootprintLimit(size_t new_footprint) {
   mspace_set_footprint_limit(data_mspace_, per_space_footprint);
   {
     ScopedCodeCacheWrite scc(code_map_.get());
-    mspace_set_footprint_limit(code_mspace_, per_space_footprint);
+    // The tenured space starts after the nursery, make sure it stays within the code map.
+    mspace_set_footprint_limit(
+        code_mspace_, std::min(per_space_footprint, code_map_->Size() - nursery_capacity_));
+    if (nursery_mspace_ != nullptr) {
+      // Let the nursery grow with the code cache, up to its fixed capacity.
+      mspace_set_footprint_limit(nursery_mspace_, std::min(per_space_footprint, nursery_capacity_));
+    }
   }
 }
 
@@ -911,6 +983,7 @@ bool JitCodeCache::IncreaseCodeCacheCapacity() {
 }
 
 void JitCodeCache::MarkCompiledCodeOnThreadStacks(Thread* self) {
+  uint64_t start_time = NanoTime();
   Barrier barrier(0);
   size_t threads_running_checkpoint = 0;
   MarkCodeClosure closure(this, &barrier);
@@ -921,6 +994,8 @@ void JitCodeCache::MarkCompiledCodeOnThreadStacks(Thread* self) {
   if (threads_running_checkpoint != 0) {
     barrier.Increment(self, threads_running_checkpoint);
   }
+  MutexLock mu(self, lock_);
+  histogram_checkpoint_time_.AddValue(NsToUs(NanoTime() - start_time));
 }
 
 bool JitCodeCache::ShouldDoFullCollection() {
@@ -956,14 +1031,13 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
       return;
     } else {
       number_of_collections_++;
-      live_bitmap_.reset(CodeCacheBitmap::Create(
-          "code-cache-bitmap",
-          reinterpret_cast<uintptr_t>(code_map_->Begin()),
-          reinterpret_cast<uintptr_t>(code_map_->Begin() + current_capacity_ / 2)));
+      CreateLiveBitmap();
       collection_in_progress_ = true;
     }
   }
 
+  uint64_t start_time = NanoTime();
+
   TimingLogger logger("JIT code cache timing logger", true, VLOG_IS_ON(jit));
   {
     TimingLogger::ScopedTiming st("Code cache collection", &logger);
@@ -1023,6 +1097,9 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
 
         DCHECK(CheckLiveCompiledCodeHasProfilingInfo());
       }
+      // A full collection also collects the nursery.
+      nursery_collection_requested_ = false;
+      histogram_collection_time_.AddValue(NsToUs(NanoTime() - start_time));
       live_bitmap_.reset(nullptr);
       NotifyCollectionDone(self);
     }
@@ -1030,7 +1107,85 @@ void JitCodeCache::GarbageCollectCache(Thread* self) {
   Runtime::Current()->GetJit()->AddTimingLogger(logger);
 }
 
-void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
+void JitCodeCache::GarbageCollectNursery(Thread* self) {
+  ScopedTrace trace(__FUNCTION__);
+  // Wait for an existing collection, or let everyone know we are starting one.
+  {
+    ScopedThreadSuspension sts(self, kSuspended);
+    MutexLock mu(self, lock_);
+    if (WaitForPotentialCollectionToComplete(self) || !nursery_collection_requested_) {
+      // Another collection already took care of the nursery.
+      return;
+    }
+    number_of_nursery_collections_++;
+    nursery_collection_requested_ = false;
+    CreateLiveBitmap();
+    collection_in_progress_ = true;
+  }
+
+  uint64_t start_time = NanoTime();
+  size_t number_of_marked_entry_points = 0;
+  bool has_unmarked_code = false;
+  {
+    MutexLock mu(self, lock_);
+    // Mark nursery code that is an entry point, or that will become one again once
+    // the polling for the next full collection is done.
+    for (const auto& it : method_code_map_) {
+      const void* code_ptr = it.first;
+      if (!IsInNursery(code_ptr)) {
+        continue;
+      }
+      ArtMethod* method = it.second;
+      const OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
+      const void* entry_point = method_header->GetEntryPoint();
+      ProfilingInfo* info = method->GetProfilingInfo(kRuntimePointerSize);
+      if (entry_point == method->GetEntryPointFromQuickCompiledCode() ||
+          (info != nullptr && entry_point == info->GetSavedEntryPoint())) {
+        GetLiveBitmap()->AtomicTestAndSet(FromCodeToAllocation(code_ptr));
+        number_of_marked_entry_points++;
+      } else {
+        has_unmarked_code = true;
+      }
+    }
+
+    // Like full collections, drop the osr code, except the ones on thread stacks.
+    for (auto it = osr_code_map_.begin(); it != osr_code_map_.end();) {
+      if (IsInNursery(it->second)) {
+        it = osr_code_map_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Only code that is not an entry point may be freed, but it may still be running, e.g. OSR
+  // code or baseline code replaced by optimized code. The thread stacks checkpoint is needed
+  // to know, and skipped when the whole nursery is live anyway.
+  if (has_unmarked_code) {
+    MarkCompiledCodeOnThreadStacks(self);
+    RemoveUnmarkedCode(self, /* nursery_only */ true);
+  }
+
+  MutexLock mu(self, lock_);
+  if (!has_unmarked_code) {
+    number_of_nursery_survivors_ += number_of_marked_entry_points;
+  }
+  histogram_nursery_collection_time_.AddValue(NsToUs(NanoTime() - start_time));
+  live_bitmap_.reset(nullptr);
+  NotifyCollectionDone(self);
+  VLOG(jit) << "After nursery collection, nursery=" << PrettySize(used_memory_for_nursery_)
+            << ", code=" << PrettySize(CodeCacheSizeLocked());
+}
+
+void JitCodeCache::CreateLiveBitmap() {
+  // No code is allocated during a collection, so `code_end_` bounds the code to look at.
+  live_bitmap_.reset(CodeCacheBitmap::Create(
+      "code-cache-bitmap",
+      reinterpret_cast<uintptr_t>(code_map_->Begin()),
+      reinterpret_cast<uintptr_t>(code_map_->Begin() + code_end_)));
+}
+
+void JitCodeCache::RemoveUnmarkedCode(Thread* self, bool nursery_only) {
   ScopedTrace trace(__FUNCTION__);
   std::unordered_set<OatQuickMethodHeader*> method_headers;
   {
@@ -1039,10 +1194,20 @@ void JitCodeCache::RemoveUnmarkedCode(Thread* self) {
     // Iterate over all compiled code and remove entries that are not marked.
     for (auto it = method_code_map_.begin(); it != method_code_map_.end();) {
       const void* code_ptr = it->first;
+      if (nursery_only && !IsInNursery(code_ptr)) {
+        ++it;
+        continue;
+      }
       uintptr_t allocation = FromCodeToAllocation(code_ptr);
       if (GetLiveBitmap()->Test(allocation)) {
+        if (nursery_only) {
+          number_of_nursery_survivors_++;
+        }
         ++it;
       } else {
+        if (nursery_only) {
+          number_of_nursery_frees_++;
+        }
         method_headers.insert(OatQuickMethodHeader::FromCodePointer(it->first));
         it = method_code_map_.erase(it);
       }
@@ -1066,6 +1231,7 @@ void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
 
         if (info->GetSavedEntryPoint() != nullptr) {
           info->SetSavedEntryPoint(nullptr);
+          number_of_saved_entry_point_misses_++;
           // We are going to move this method back to interpreter. Clear the counter now to
           // give it a chance to be hot again.
           info->GetMethod()->ClearCounter();
@@ -1102,7 +1268,7 @@ void JitCodeCache::DoCollection(Thread* self, bool collect_profiling_info) {
   // At this point, mutator threads are still running, and entrypoints of methods can
   // change. We do know they cannot change to a code cache entry that is not marked,
   // therefore we can safely remove those entries.
-  RemoveUnmarkedCode(self);
+  RemoveUnmarkedCode(self, /* nursery_only */ false);
 
   if (collect_profiling_info) {
     ScopedThreadSuspension sts(self, kSuspended);
@@ -1264,6 +1430,12 @@ void* JitCodeCache::MoreCore(const void* mspace, intptr_t increment) NO_THREAD_S
   if (code_mspace_ == mspace) {
     size_t result = code_end_;
     code_end_ += increment;
+    DCHECK_LE(code_end_, code_map_->Size());
+    return reinterpret_cast<void*>(result + code_map_->Begin());
+  } else if (nursery_mspace_ != nullptr && nursery_mspace_ == mspace) {
+    size_t result = nursery_end_;
+    nursery_end_ += increment;
+    DCHECK_LE(nursery_end_, nursery_capacity_);
     return reinterpret_cast<void*>(result + code_map_->Begin());
   } else {
     DCHECK_EQ(data_mspace_, mspace);
@@ -1362,12 +1534,45 @@ bool JitCodeCache::IsOsrCompiled(ArtMethod* method) {
   return osr_code_map_.find(method) != osr_code_map_.end();
 }
 
-bool JitCodeCache::NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr) {
-  if (!osr && ContainsPc(method->GetEntryPointFromQuickCompiledCode())) {
+bool JitCodeCache::IsBaselineCode(const void* entry_point) {
+  MutexLock mu(Thread::Current(), lock_);
+  return IsBaselineCodeLocked(entry_point);
+}
+
+bool JitCodeCache::MarkBaselineCodeForTierUp(Thread* self, ArtMethod* method) {
+  MutexLock mu(self, lock_);
+  const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
+  if (!ContainsPc(entry_point)) {
+    return false;
+  }
+  const void* code_ptr = OatQuickMethodHeader::FromEntryPoint(entry_point)->GetCode();
+  auto it = baseline_code_.find(code_ptr);
+  if (it == baseline_code_.end() || it->second) {
     return false;
   }
+  it->second = true;
+  return true;
+}
 
+bool JitCodeCache::IsBaselineCodeLocked(const void* entry_point) {
+  DCHECK(ContainsPc(entry_point));
+  const void* code_ptr = OatQuickMethodHeader::FromEntryPoint(entry_point)->GetCode();
+  return baseline_code_.find(code_ptr) != baseline_code_.end();
+}
+
+bool JitCodeCache::NotifyCompilationOf(ArtMethod* method,
+                                       Thread* self,
+                                       bool osr,
+                                       bool baseline) {
+  const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
   MutexLock mu(self, lock_);
+  if (!osr && ContainsPc(entry_point)) {
+    // Baseline code is only a stepping stone, let the optimizing tier replace it.
+    if (baseline || !IsBaselineCodeLocked(entry_point)) {
+      return false;
+    }
+  }
+
   if (osr && (osr_code_map_.find(method) != osr_code_map_.end())) {
     return false;
   }
@@ -1446,10 +1651,26 @@ void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
   }
 }
 
-uint8_t* JitCodeCache::AllocateCode(size_t code_size) {
+uint8_t* JitCodeCache::AllocateCode(size_t code_size, bool in_nursery) {
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
-  uint8_t* result = reinterpret_cast<uint8_t*>(
-      mspace_memalign(code_mspace_, alignment, code_size));
+  uint8_t* result = nullptr;
+  if (in_nursery && nursery_mspace_ != nullptr) {
+    result = reinterpret_cast<uint8_t*>(mspace_memalign(nursery_mspace_, alignment, code_size));
+    if (result == nullptr) {
+      // Put the code in the tenured space, and collect the nursery before the next
+      // short lived code gets committed.
+      number_of_nursery_overflows_++;
+      nursery_collection_requested_ = true;
+    } else {
+      used_memory_for_nursery_ += mspace_usable_size(result);
+    }
+  }
+  if (result == nullptr) {
+    result = reinterpret_cast<uint8_t*>(mspace_memalign(code_mspace_, alignment, code_size));
+  }
+  if (result == nullptr) {
+    return nullptr;
+  }
   size_t header_size = RoundUp(sizeof(OatQuickMethodHeader), alignment);
   // Ensure the header ends up at expected instruction alignment.
   DCHECK_ALIGNED_PARAM(reinterpret_cast<uintptr_t>(result + header_size), alignment);
@@ -1458,8 +1679,14 @@ uint8_t* JitCodeCache::AllocateCode(size_t code_size) {
 }
 
 void JitCodeCache::FreeCode(uint8_t* code) {
-  used_memory_for_code_ -= mspace_usable_size(code);
-  mspace_free(code_mspace_, code);
+  size_t size = mspace_usable_size(code);
+  used_memory_for_code_ -= size;
+  if (IsInNursery(code)) {
+    used_memory_for_nursery_ -= size;
+    mspace_free(nursery_mspace_, code);
+  } else {
+    mspace_free(code_mspace_, code);
+  }
 }
 
 uint8_t* JitCodeCache::AllocateData(size_t data_size) {
@@ -1473,6 +1700,16 @@ void JitCodeCache::FreeData(uint8_t* data) {
   mspace_free(data_mspace_, data);
 }
 
+static void DumpCollectionTime(std::ostream& os, const Histogram<uint64_t>& histogram) {
+  if (histogram.SampleSize() == 0) {
+    os << histogram.Name() << ": <no data>\n";
+    return;
+  }
+  Histogram<uint64_t>::CumulativeData cumulative_data;
+  histogram.CreateHistogram(&cumulative_data);
+  histogram.PrintConfidenceIntervals(os, 0.99, cumulative_data);
+}
+
 void JitCodeCache::Dump(std::ostream& os) {
   MutexLock mu(Thread::Current(), lock_);
   os << "Current JIT code cache size: " << PrettySize(used_memory_for_code_) << "\n"
@@ -1482,7 +1719,25 @@ void JitCodeCache::Dump(std::ostream& os) {
      << "Total number of JIT compilations: " << number_of_compilations_ << "\n"
      << "Total number of JIT compilations for on stack replacement: "
         << number_of_osr_compilations_ << "\n"
-     << "Total number of JIT code cache collections: " << number_of_collections_ << std::endl;
+     << "Total number of JIT code cache collections: " << number_of_collections_ << "\n"
+     << "Current JIT nursery size: " << PrettySize(used_memory_for_nursery_)
+        << " / " << PrettySize(nursery_capacity_) << "\n"
+     << "Current JIT tenured code footprint: "
+        << PrettySize(used_memory_for_code_ - used_memory_for_nursery_)
+        << " / " << PrettySize(code_end_ - nursery_capacity_) << "\n"
+     << "Total number of JIT nursery collections: " << number_of_nursery_collections_ << "\n"
+     << "Total number of JIT nursery survivors: " << number_of_nursery_survivors_
+        << ", frees: " << number_of_nursery_frees_ << "\n"
+     << "Total number of JIT nursery overflows to the tenured space: "
+        << number_of_nursery_overflows_ << "\n";
+  size_t hits = number_of_saved_entry_point_hits_.LoadRelaxed();
+  size_t lookups = hits + number_of_saved_entry_point_misses_;
+  os << "Total number of JIT code cache hits after a collection: " << hits
+     << ", misses: " << number_of_saved_entry_point_misses_
+     << ", hit rate: " << (lookups == 0u ? 0u : hits * 100u / lookups) << "%" << std::endl;
+  DumpCollectionTime(os, histogram_collection_time_);
+  DumpCollectionTime(os, histogram_nursery_collection_time_);
+  DumpCollectionTime(os, histogram_checkpoint_time_);
   histogram_stack_map_memory_use_.PrintMemoryUse(os);
   histogram_code_memory_use_.PrintMemoryUse(os);
   histogram_profiling_info_memory_use_.PrintMemoryUse(os);
@@ -59,6 +59,9 @@ class JitCodeCache {
   // By default, do not GC until reaching 256KB.
   static constexpr size_t kReservedCapacity = kInitialCapacity * 4;
 
+  // Upper bound of the nursery, the part of the code map reserved for short lived code.
+  static constexpr size_t kMaxNurseryCapacity = 1 * MB;
+
   // Create the code cache with a code + data capacity equal to "capacity", error message is passed
   // in the out arg error_msg.
   static JitCodeCache* Create(size_t initial_capacity,
@@ -72,7 +75,7 @@ class JitCodeCache {
   // Number of bytes allocated in the data cache.
   size_t DataCacheSize() REQUIRES(!lock_);
 
-  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr)
+  bool NotifyCompilationOf(ArtMethod* method, Thread* self, bool osr, bool baseline)
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
@@ -96,7 +99,8 @@ class JitCodeCache {
       REQUIRES_SHARED(Locks::mutator_lock_)
       REQUIRES(!lock_);
 
-  // Allocate and write code and its metadata to the code cache.
+  // Allocate and write code and its metadata to the code cache. Code compiled with `baseline`
+  // stays eligible for a recompilation with the optimizing tier.
   // `cha_single_implementation_list` needs to be registered via CHA (if it's
   // still valid), since the compiled code still needs to be invalidated if the
   // single-implementation assumptions are violated later. This needs to be done
@@ -114,6 +118,7 @@ class JitCodeCache {
                       size_t code_size,
                       size_t data_size,
                       bool osr,
+                      bool baseline,
                       Handle<mirror::ObjectArray<mirror::Object>> roots,
                       bool has_should_deoptimize_flag,
                       const ArenaSet<ArtMethod*>& cha_single_implementation_list)
@@ -189,7 +194,8 @@ class JitCodeCache {
       REQUIRES_SHARED(Locks::mutator_lock_);
 
   bool OwnsSpace(const void* mspace) const NO_THREAD_SAFETY_ANALYSIS {
-    return mspace == code_mspace_ || mspace == data_mspace_;
+    return mspace == code_mspace_ || mspace == data_mspace_ ||
+        (nursery_mspace_ != nullptr && mspace == nursery_mspace_);
   }
 
   void* MoreCore(const void* mspace, intptr_t increment);
@@ -215,8 +221,23 @@ class JitCodeCache {
 
   void Dump(std::ostream& os) REQUIRES(!lock_);
 
+  // Record that a method moved to the interpreter by a collection got its JIT code back when it
+  // was invoked again, and did not need to be compiled again.
+  void AddSavedEntryPointHit() {
+    number_of_saved_entry_point_hits_.FetchAndAddRelaxed(1);
+  }
+
   bool IsOsrCompiled(ArtMethod* method) REQUIRES(!lock_);
 
+  // Return whether `entry_point` is code of this cache compiled by the baseline tier.
+  bool IsBaselineCode(const void* entry_point) REQUIRES(!lock_);
+
+  // Record that the optimizing compilation of `method` is requested, if its entry point is
+  // baseline code of this cache. Returns false if it is not, or if it was already requested.
+  bool MarkBaselineCodeForTierUp(Thread* self, ArtMethod* method)
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
   void SweepRootTables(IsMarkedVisitor* visitor)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
@@ -245,8 +266,11 @@ class JitCodeCache {
                size_t initial_code_capacity,
                size_t initial_data_capacity,
                size_t max_capacity,
+               size_t nursery_capacity,
                bool garbage_collect_code);
 
+  bool IsBaselineCodeLocked(const void* entry_point) REQUIRES(lock_);
+
   // Internal version of 'CommitCode' that will not retry if the
   // allocation fails. Return null if the allocation fails.
   uint8_t* CommitCodeInternal(Thread* self,
@@ -261,6 +285,8 @@ class JitCodeCache {
                               size_t code_size,
                               size_t data_size,
                               bool osr,
+                              bool baseline,
+                              bool in_nursery,
                               Handle<mirror::ObjectArray<mirror::Object>> roots,
                               bool has_should_deoptimize_flag,
                               const ArenaSet<ArtMethod*>& cha_single_implementation_list)
@@ -306,7 +332,17 @@ class JitCodeCache {
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
-  void RemoveUnmarkedCode(Thread* self)
+  // Collect only the nursery. Its code is either OSR code, which is dropped at every
+  // collection, or baseline code, which is garbage once the optimizing tier replaced it.
+  void GarbageCollectNursery(Thread* self)
+      REQUIRES(!lock_)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Create `live_bitmap_` covering the nursery and the current footprint of the tenured code.
+  void CreateLiveBitmap() REQUIRES(lock_);
+
+  // Free the code that is not marked in the live bitmap, only in the nursery if `nursery_only`.
+  void RemoveUnmarkedCode(Thread* self, bool nursery_only)
       REQUIRES(!lock_)
       REQUIRES_SHARED(Locks::mutator_lock_);
 
@@ -317,8 +353,13 @@ class JitCodeCache {
   bool CheckLiveCompiledCodeHasProfilingInfo()
       REQUIRES(lock_);
 
+  bool IsInNursery(const void* ptr) const {
+    return code_map_->Begin() <= ptr && ptr < code_map_->Begin() + nursery_capacity_;
+  }
+
   void FreeCode(uint8_t* code) REQUIRES(lock_);
-  uint8_t* AllocateCode(size_t code_size) REQUIRES(lock_);
+  // Allocate from the nursery if `in_nursery` and it has room, from the tenured space otherwise.
+  uint8_t* AllocateCode(size_t code_size, bool in_nursery) REQUIRES(lock_);
   void FreeData(uint8_t* data) REQUIRES(lock_);
   uint8_t* AllocateData(size_t data_size) REQUIRES(lock_);
 
@@ -337,8 +378,13 @@ class JitCodeCache {
   std::unique_ptr<MemMap> code_map_;
   // Mem map which holds data (stack maps and profiling info).
   std::unique_ptr<MemMap> data_map_;
-  // The opaque mspace for allocating code.
+  // The opaque mspace for allocating code that is expected to stay, the tenured space.
   void* code_mspace_ GUARDED_BY(lock_);
+  // The opaque mspace for allocating OSR and baseline code, the nursery. It lives in the
+  // first `nursery_capacity_` bytes of `code_map_`, and is null if there is no nursery.
+  void* nursery_mspace_ GUARDED_BY(lock_);
+  // Size in bytes of the nursery, the tenured space starts right after it.
+  size_t nursery_capacity_;
   // The opaque mspace for allocating data.
   void* data_mspace_ GUARDED_BY(lock_);
   // Bitmap for collecting code and data.
@@ -347,6 +393,9 @@ class JitCodeCache {
   SafeMap<const void*, ArtMethod*> method_code_map_ GUARDED_BY(lock_);
   // Holds osr compiled code associated to the ArtMethod.
   SafeMap<ArtMethod*, const void*> osr_code_map_ GUARDED_BY(lock_);
+  // Code pointers in `method_code_map_` compiled by the baseline tier, and whether the
+  // optimizing compilation of their method was requested.
+  std::unordered_map<const void*, bool> baseline_code_ GUARDED_BY(lock_);
   // ProfilingInfo objects we have allocated.
   std::vector<ProfilingInfo*> profiling_infos_ GUARDED_BY(lock_);
 
@@ -356,9 +405,12 @@ class JitCodeCache {
   // The current capacity in bytes of the code cache.
   size_t current_capacity_ GUARDED_BY(lock_);
 
-  // The current footprint in bytes of the code portion of the code cache.
+  // The current end of the tenured space, as an offset from the start of `code_map_`.
   size_t code_end_ GUARDED_BY(lock_);
 
+  // The current end of the nursery, as an offset from the start of `code_map_`.
+  size_t nursery_end_ GUARDED_BY(lock_);
+
   // The current footprint in bytes of the data portion of the code cache.
   size_t data_end_ GUARDED_BY(lock_);
 
@@ -378,6 +430,9 @@ class JitCodeCache {
   // The size in bytes of used memory for the code portion of the code cache.
   size_t used_memory_for_code_ GUARDED_BY(lock_);
 
+  // The part of `used_memory_for_code_` in the nursery.
+  size_t used_memory_for_nursery_ GUARDED_BY(lock_);
+
   // Number of compilations done throughout the lifetime of the JIT.
   size_t number_of_compilations_ GUARDED_BY(lock_);
 
@@ -387,6 +442,30 @@ class JitCodeCache {
   // Number of code cache collections done throughout the lifetime of the JIT.
   size_t number_of_collections_ GUARDED_BY(lock_);
 
+  // Number of nursery only collections done throughout the lifetime of the JIT.
+  size_t number_of_nursery_collections_ GUARDED_BY(lock_);
+
+  // Code found live and dead by the nursery collections.
+  size_t number_of_nursery_survivors_ GUARDED_BY(lock_);
+  size_t number_of_nursery_frees_ GUARDED_BY(lock_);
+
+  // Number of nursery allocations that did not fit and went to the tenured space.
+  size_t number_of_nursery_overflows_ GUARDED_BY(lock_);
+
+  // Whether the nursery overflowed since it was last collected.
+  bool nursery_collection_requested_ GUARDED_BY(lock_);
+
+  // Methods moved to the interpreter by a collection that were invoked again before the next
+  // full collection, and got their code back, and the ones that were not and lost it.
+  Atomic<size_t> number_of_saved_entry_point_hits_;
+  size_t number_of_saved_entry_point_misses_ GUARDED_BY(lock_);
+
+  // Durations of collections, in microseconds. The thread stack checkpoint is
+  // the part that pauses the mutators.
+  Histogram<uint64_t> histogram_collection_time_ GUARDED_BY(lock_);
+  Histogram<uint64_t> histogram_nursery_collection_time_ GUARDED_BY(lock_);
+  Histogram<uint64_t> histogram_checkpoint_time_ GUARDED_BY(lock_);
+
   // Histograms for keeping track of stack map size statistics.
   Histogram<uint64_t> histogram_stack_map_memory_use_ GUARDED_BY(lock_);
 
@@ -404,6 +483,7 @@ class JitCodeCache {
   // Condition to wait on for accessing inline caches.
   ConditionVariable inline_cache_cond_ GUARDED_BY(lock_);
 
+  friend class JitCodeCacheTest;  // For the nursery.
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCodeCache);
 };
 
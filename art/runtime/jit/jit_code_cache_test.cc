@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "jit/jit_code_cache.h"
+
+#include <memory>
+#include <vector>
+
+#include "art_method-inl.h"
+#include "base/arena_allocator.h"
+#include "base/arena_containers.h"
+#include "class_linker-inl.h"
+#include "common_runtime_test.h"
+#include "handle_scope-inl.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/object_array-inl.h"
+#include "oat_quick_method_header.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+namespace jit {
+
+class JitCodeCacheTest : public CommonRuntimeTest {
+ protected:
+  // Commit a few bytes of code that is never run for `method`, and return its code pointer.
+  const void* CommitCode(JitCodeCache* code_cache, ArtMethod* method, bool osr, bool baseline)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    StackHandleScope<1> hs(self);
+    Handle<mirror::ObjectArray<mirror::Object>> roots(
+        hs.NewHandle(mirror::ObjectArray<mirror::Object>::Alloc(
+            self, class_linker_->GetClassRoot(ClassLinker::kObjectArrayClass), 0)));
+    uint8_t* stack_map_data = nullptr;
+    uint8_t* method_info_data = nullptr;
+    uint8_t* roots_data = nullptr;
+    size_t data_size = code_cache->ReserveData(self,
+                                               /* stack_map_size */ 0,
+                                               /* method_info_size */ 0,
+                                               /* number_of_roots */ 0,
+                                               method,
+                                               &stack_map_data,
+                                               &method_info_data,
+                                               &roots_data);
+    EXPECT_TRUE(stack_map_data != nullptr);
+    ArenaPool pool;
+    ArenaAllocator arena(&pool);
+    ArenaSet<ArtMethod*> cha_single_implementation_list(arena.Adapter(kArenaAllocCHA));
+    std::vector<uint8_t> code(64u, 0u);
+    uint8_t* method_header = code_cache->CommitCode(self,
+                                                    method,
+                                                    stack_map_data,
+                                                    method_info_data,
+                                                    roots_data,
+                                                    /* frame_size_in_bytes */ 0,
+                                                    /* core_spill_mask */ 0,
+                                                    /* fp_spill_mask */ 0,
+                                                    code.data(),
+                                                    code.size(),
+                                                    data_size,
+                                                    osr,
+                                                    baseline,
+                                                    roots,
+                                                    /* has_should_deoptimize_flag */ false,
+                                                    cha_single_implementation_list);
+    EXPECT_TRUE(method_header != nullptr);
+    return reinterpret_cast<OatQuickMethodHeader*>(method_header)->GetCode();
+  }
+
+  bool HasNursery(JitCodeCache* code_cache) {
+    return code_cache->nursery_capacity_ != 0u;
+  }
+
+  bool IsInNursery(JitCodeCache* code_cache, const void* code_ptr) {
+    return code_cache->IsInNursery(code_ptr);
+  }
+
+  bool HasCode(JitCodeCache* code_cache, const void* code_ptr) {
+    MutexLock mu(Thread::Current(), code_cache->lock_);
+    return code_cache->method_code_map_.find(code_ptr) != code_cache->method_code_map_.end();
+  }
+
+  void CollectNursery(JitCodeCache* code_cache) REQUIRES_SHARED(Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    {
+      MutexLock mu(self, code_cache->lock_);
+      code_cache->nursery_collection_requested_ = true;
+    }
+    code_cache->GarbageCollectNursery(self);
+  }
+
+  size_t GetNumberOfNurseryFrees(JitCodeCache* code_cache) {
+    MutexLock mu(Thread::Current(), code_cache->lock_);
+    return code_cache->number_of_nursery_frees_;
+  }
+};
+
+TEST_F(JitCodeCacheTest, NurseryCollection) {
+  std::string error_msg;
+  std::unique_ptr<JitCodeCache> code_cache(JitCodeCache::Create(JitCodeCache::kInitialCapacity,
+                                                                JitCodeCache::kMaxCapacity,
+                                                                /* generate_debug_info */ false,
+                                                                &error_msg));
+  ASSERT_TRUE(code_cache != nullptr) << error_msg;
+  ASSERT_TRUE(HasNursery(code_cache.get()));
+
+  ScopedObjectAccess soa(Thread::Current());
+  jobject jclass_loader = LoadDex("XandY");
+  StackHandleScope<3> hs(soa.Self());
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader>(jclass_loader)));
+  Handle<mirror::Class> h_X(
+      hs.NewHandle(class_linker_->FindClass(soa.Self(), "LX;", class_loader)));
+  Handle<mirror::Class> h_Y(
+      hs.NewHandle(class_linker_->FindClass(soa.Self(), "LY;", class_loader)));
+  ASSERT_TRUE(h_X != nullptr);
+  ASSERT_TRUE(h_Y != nullptr);
+  // The methods are never invoked, their code is only looked at by the collections.
+  ArtMethod* method_x = h_X->FindDeclaredDirectMethod("<init>", "()V", kRuntimePointerSize);
+  ArtMethod* method_y = h_Y->FindDeclaredDirectMethod("<init>", "()V", kRuntimePointerSize);
+  ASSERT_TRUE(method_x != nullptr);
+  ASSERT_TRUE(method_y != nullptr);
+  const void* entry_point_x = method_x->GetEntryPointFromQuickCompiledCode();
+  const void* entry_point_y = method_y->GetEntryPointFromQuickCompiledCode();
+
+  // Baseline and OSR code go to the nursery, optimized code to the tenured space.
+  JitCodeCache* cache = code_cache.get();
+  const void* baseline_x = CommitCode(cache, method_x, /* osr */ false, /* baseline */ true);
+  const void* osr_y = CommitCode(cache, method_y, /* osr */ true, /* baseline */ false);
+  const void* baseline_y = CommitCode(cache, method_y, /* osr */ false, /* baseline */ true);
+  EXPECT_TRUE(IsInNursery(cache, baseline_x));
+  EXPECT_TRUE(IsInNursery(cache, osr_y));
+  EXPECT_TRUE(IsInNursery(cache, baseline_y));
+  const void* optimized_x = CommitCode(cache, method_x, /* osr */ false, /* baseline */ false);
+  EXPECT_FALSE(IsInNursery(cache, optimized_x));
+
+  // The baseline code replaced by optimized code and the OSR code are freed. The baseline
+  // code still used as entry point survives, and the tenured space is left alone.
+  CollectNursery(cache);
+  EXPECT_FALSE(HasCode(cache, baseline_x));
+  EXPECT_FALSE(HasCode(cache, osr_y));
+  EXPECT_TRUE(HasCode(cache, baseline_y));
+  EXPECT_TRUE(HasCode(cache, optimized_x));
+  EXPECT_EQ(GetNumberOfNurseryFrees(cache), 2u);
+
+  // With only live code in the nursery, the collection frees nothing.
+  CollectNursery(cache);
+  EXPECT_TRUE(HasCode(cache, baseline_y));
+  EXPECT_EQ(GetNumberOfNurseryFrees(cache), 2u);
+
+  // Do not leave the methods pointing into the code cache.
+  method_x->SetEntryPointFromQuickCompiledCode(entry_point_x);
+  method_y->SetEntryPointFromQuickCompiledCode(entry_point_y);
+}
+
+}  // namespace jit
+}  // namespace art
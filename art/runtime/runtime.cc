@@ -83,6 +83,7 @@
 #include "instrumentation.h"
 #include "intern_table.h"
 #include "interpreter/interpreter.h"
+#include "interpreter/mterp/mterp.h"
 #include "java_vm_ext.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
@@ -153,6 +154,7 @@
 #include "transaction.h"
 #include "utils.h"
 #include "vdex_file.h"
+#include "verifier/background_verifier.h"
 #include "verifier/method_verifier.h"
 #include "well_known_classes.h"
 
@@ -237,6 +239,8 @@ Runtime::Runtime()
       dump_gc_performance_on_shutdown_(false),
       preinitialization_transaction_(nullptr),
       verify_(verifier::VerifyMode::kNone),
+      background_verification_threads_(0u),
+      background_verify_all_classes_(false),
       allow_dex_file_fallback_(true),
       target_sdk_version_(0),
       implicit_null_checks_(false),
@@ -338,6 +342,11 @@ Runtime::~Runtime() {
     // JIT compiler threads.
     jit_->DeleteThreadPool();
   }
+  if (background_verifier_ != nullptr) {
+    ScopedTrace trace2("Delete background verifier");
+    // Stop verifying before the thread list and the class linker go away.
+    background_verifier_.reset();
+  }
 
   // TODO Maybe do some locking.
   for (auto& agent : agents_) {
@@ -820,6 +829,16 @@ void Runtime::InitNonZygoteOrPostFork(
     CreateJit();
   }
 
+  // Verify the classes of the application in the background. The boot class path is verified
+  // at compile time, only the dex files registered from now on are verified. Without
+  // -Xbackgroundverifyallclasses, only the classes of the application profile are verified.
+  if (background_verification_threads_ != 0u &&
+      IsVerificationEnabled() &&
+      background_verifier_ == nullptr) {
+    background_verifier_.reset(new verifier::BackgroundVerifier(background_verification_threads_,
+                                                                background_verify_all_classes_));
+  }
+
   StartSignalCatcher();
 
   // Start the JDWP thread. If the command-line debugger flags specified "suspend=y",
@@ -1062,6 +1081,9 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   intern_table_ = new InternTable;
 
   verify_ = runtime_options.GetOrDefault(Opt::Verify);
+  background_verification_threads_ =
+      runtime_options.GetOrDefault(Opt::BackgroundVerificationThreads);
+  background_verify_all_classes_ = runtime_options.GetOrDefault(Opt::BackgroundVerifyAllClasses);
   allow_dex_file_fallback_ = !runtime_options.Exists(Opt::NoDexFileFallback);
 
   no_sig_chain_ = runtime_options.Exists(Opt::NoSigChain);
@@ -1118,6 +1140,8 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
                        xgc_option.verify_post_gc_rosalloc_,
                        xgc_option.gcstress_,
                        xgc_option.measure_,
+                       xgc_option.generational_cc_,
+                       xgc_option.parallel_cc_marking_,
                        runtime_options.GetOrDefault(Opt::EnableHSpaceCompactForOOM),
                        runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs));
 
@@ -1597,6 +1621,7 @@ void Runtime::DumpForSigQuit(std::ostream& os) {
   }
   DumpDeoptimizations(os);
   TrackedAllocators::Dump(os);
+  interpreter::DumpMterpBigramProfile(os);
   os << "\n";
 
   thread_list_->DumpForSigQuit(os);
@@ -1996,6 +2021,10 @@ void Runtime::ClearCalleeSaveMethods() {
 
 void Runtime::RegisterAppInfo(const std::vector<std::string>& code_paths,
                               const std::string& profile_output_filename) {
+  if (background_verifier_ != nullptr && !profile_output_filename.empty()) {
+    // The classes resolved during previous runs are verified first.
+    background_verifier_->SetProfileFilename(profile_output_filename);
+  }
   if (jit_.get() == nullptr) {
     // We are not JITing. Nothing to do.
     return;
@@ -72,6 +72,7 @@ namespace ti {
   class Agent;
 }  // namespace ti
 namespace verifier {
+  class BackgroundVerifier;
   class MethodVerifier;
   enum class VerifyMode : int8_t;
 }  // namespace verifier
@@ -456,6 +457,11 @@ class Runtime {
   // Returns true if JIT compilations are enabled. GetJit() will be not null in this case.
   bool UseJitCompilation() const;
 
+  // Returns the verifier of application classes, or null if background verification is off.
+  verifier::BackgroundVerifier* GetBackgroundVerifier() const {
+    return background_verifier_.get();
+  }
+
   void PreZygoteFork();
   void InitNonZygoteOrPostFork(
       JNIEnv* env, bool is_system_server, NativeBridgeAction action, const char* isa);
@@ -859,6 +865,14 @@ class Runtime {
   // If kNone, verification is disabled. kEnable by default.
   verifier::VerifyMode verify_;
 
+  // Number of threads verifying the classes of application dex files in the background, 0 if
+  // classes are only verified when first initialized.
+  unsigned int background_verification_threads_;
+  // Whether the background verification also loads and verifies the classes that are not in the
+  // profile of the application.
+  bool background_verify_all_classes_;
+  std::unique_ptr<verifier::BackgroundVerifier> background_verifier_;
+
   // If true, the runtime may use dex files directly with the interpreter if an oat file is not
   // available/usable.
   bool allow_dex_file_fallback_;
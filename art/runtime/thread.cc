@@ -81,6 +81,7 @@
 #include "stack_map.h"
 #include "thread_list.h"
 #include "thread-inl.h"
+#include "trace.h"
 #include "utils.h"
 #include "verifier/method_verifier.h"
 #include "verify_object.h"
@@ -1965,7 +1966,8 @@ Thread::Thread(bool daemon)
       wait_monitor_(nullptr),
       interrupted_(false),
       custom_tls_(nullptr),
-      can_call_into_java_(true) {
+      can_call_into_java_(true),
+      class_table_read_epoch_(0u) {
   wait_mutex_ = new Mutex("a thread wait mutex");
   wait_cond_ = new ConditionVariable("a thread wait condition variable", *wait_mutex_);
   tlsPtr_.instrumentation_stack = new std::deque<instrumentation::InstrumentationStackFrame>;
@@ -2152,7 +2154,7 @@ Thread::~Thread() {
   }
   delete tlsPtr_.instrumentation_stack;
   delete tlsPtr_.name;
-  delete tlsPtr_.deps_or_stack_trace_sample.stack_trace_sample;
+  delete tlsPtr_.deps_or_stack_trace_sample.trace_sample_ring;
 
   Runtime::Current()->GetHeap()->AssertThreadLocalBuffersAreRevoked(this);
 
@@ -2917,6 +2919,7 @@ void Thread::DumpThreadOffset(std::ostream& os, uint32_t offset) {
   QUICK_ENTRY_POINT_INFO(pInvokeVirtualTrampolineWithAccessCheck)
   QUICK_ENTRY_POINT_INFO(pInvokePolymorphic)
   QUICK_ENTRY_POINT_INFO(pTestSuspend)
+  QUICK_ENTRY_POINT_INFO(pCompileOptimized)
   QUICK_ENTRY_POINT_INFO(pDeliverException)
   QUICK_ENTRY_POINT_INFO(pThrowArrayBounds)
   QUICK_ENTRY_POINT_INFO(pThrowDivZero)
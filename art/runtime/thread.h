@@ -93,6 +93,7 @@ class SingleStepControl;
 class StackedShadowFrameRecord;
 class Thread;
 class ThreadList;
+class TraceSampleRing;
 
 // Thread priorities. These must match the Thread.MIN_PRIORITY,
 // Thread.NORM_PRIORITY, and Thread.MAX_PRIORITY constants.
@@ -904,6 +905,16 @@ class Thread {
     can_call_into_java_ = can_call_into_java;
   }
 
+  // The class table read epoch of a lock free class table lookup in progress, 0 if none. Only
+  // written by this thread, see ClassTable::AdvanceReadEpoch.
+  uint64_t GetClassTableReadEpoch() const {
+    return class_table_read_epoch_.LoadSequentiallyConsistent();
+  }
+
+  void SetClassTableReadEpoch(uint64_t epoch) {
+    class_table_read_epoch_.StoreRelease(epoch);
+  }
+
   // Activates single step control for debugging. The thread takes the
   // ownership of the given SingleStepControl*. It is deleted by a call
   // to DeactivateSingleStepControl or upon thread destruction.
@@ -973,14 +984,14 @@ class Thread {
     return tlsPtr_.instrumentation_stack;
   }
 
-  std::vector<ArtMethod*>* GetStackTraceSample() const {
+  TraceSampleRing* GetTraceSampleRing() const {
     DCHECK(!IsAotCompiler());
-    return tlsPtr_.deps_or_stack_trace_sample.stack_trace_sample;
+    return tlsPtr_.deps_or_stack_trace_sample.trace_sample_ring;
   }
 
-  void SetStackTraceSample(std::vector<ArtMethod*>* sample) {
+  void SetTraceSampleRing(TraceSampleRing* ring) {
     DCHECK(!IsAotCompiler());
-    tlsPtr_.deps_or_stack_trace_sample.stack_trace_sample = sample;
+    tlsPtr_.deps_or_stack_trace_sample.trace_sample_ring = ring;
   }
 
   verifier::VerifierDeps* GetVerifierDeps() const {
@@ -1518,10 +1529,10 @@ class Thread {
     union DepsOrStackTraceSample {
       DepsOrStackTraceSample() {
         verifier_deps = nullptr;
-        stack_trace_sample = nullptr;
+        trace_sample_ring = nullptr;
       }
-      // Pointer to previous stack trace captured by sampling profiler.
-      std::vector<ArtMethod*>* stack_trace_sample;
+      // Stack samples of this thread captured by the sampling profiler.
+      TraceSampleRing* trace_sample_ring;
       // When doing AOT verification, per-thread VerifierDeps.
       verifier::VerifierDeps* verifier_deps;
     } deps_or_stack_trace_sample;
@@ -1656,6 +1667,9 @@ class Thread {
   // By default this is true.
   bool can_call_into_java_;
 
+  // Read epoch of the lock free class table lookup in progress, 0 if none.
+  Atomic<uint64_t> class_table_read_epoch_;
+
   friend class Dbg;  // For SetStateUnsafe.
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
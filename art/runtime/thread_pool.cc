@@ -21,6 +21,8 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 
+#include <algorithm>
+
 #include "android-base/stringprintf.h"
 
 #include "base/bit_utils.h"
@@ -103,7 +105,16 @@ void* ThreadPoolWorker::Callback(void* arg) {
 
 void ThreadPool::AddTask(Thread* self, Task* task) {
   MutexLock mu(self, task_queue_lock_);
-  tasks_.push_back(task);
+  const int32_t priority = task->GetPriority();
+  if (tasks_.empty() || tasks_.back()->GetPriority() >= priority) {
+    tasks_.push_back(task);
+  } else {
+    auto it = std::upper_bound(tasks_.begin(),
+                               tasks_.end(),
+                               priority,
+                               [](int32_t p, const Task* t) { return p > t->GetPriority(); });
+    tasks_.insert(it, task);
+  }
   // If we have any waiters, signal one.
   if (started_ && waiting_count_ != 0) {
     task_queue_condition_.Signal(self);
@@ -38,6 +38,12 @@ class Task : public Closure {
  public:
   // Called after Closure::Run has been called.
   virtual void Finalize() { }
+
+  // Queued tasks with a higher priority are run first, tasks of equal priority in the order
+  // they were added.
+  virtual int32_t GetPriority() const {
+    return 0;
+  }
 };
 
 class SelfDeletingTask : public Task {
@@ -99,7 +105,8 @@ class ThreadPool {
   void StopWorkers(Thread* self) REQUIRES(!task_queue_lock_);
 
   // Add a new task, the first available started worker will process it. Does not delete the task
-  // after running it, it is the caller's responsibility.
+  // after running it, it is the caller's responsibility. The task is queued behind all tasks with
+  // the same or a higher priority.
   void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
 
   // Remove all tasks in the queue.
@@ -157,6 +164,7 @@ class ThreadPool {
   volatile bool shutting_down_ GUARDED_BY(task_queue_lock_);
   // How many worker threads are waiting on the condition.
   volatile size_t waiting_count_ GUARDED_BY(task_queue_lock_);
+  // Sorted by decreasing priority.
   std::deque<Task*> tasks_ GUARDED_BY(task_queue_lock_);
   // TODO: make this immutable/const?
   std::vector<ThreadPoolWorker*> threads_;
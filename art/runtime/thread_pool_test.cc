@@ -17,6 +17,7 @@
 #include "thread_pool.h"
 
 #include <string>
+#include <vector>
 
 #include "atomic.h"
 #include "common_runtime_test.h"
@@ -160,6 +161,45 @@ TEST_F(ThreadPoolTest, RecursiveTest) {
   EXPECT_EQ((1 << depth) - 1, count.LoadSequentiallyConsistent());
 }
 
+class PriorityTask : public Task {
+ public:
+  PriorityTask(std::vector<int32_t>* order, int32_t priority, int32_t id)
+      : order_(order), priority_(priority), id_(id) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) {
+    order_->push_back(id_);
+  }
+
+  void Finalize() {
+    delete this;
+  }
+
+  int32_t GetPriority() const {
+    return priority_;
+  }
+
+ private:
+  std::vector<int32_t>* const order_;
+  const int32_t priority_;
+  const int32_t id_;
+};
+
+// Test that queued tasks run by decreasing priority, and in order within a priority.
+TEST_F(ThreadPoolTest, PriorityTest) {
+  Thread* self = Thread::Current();
+  ThreadPool thread_pool("Thread pool test thread pool", 1);
+  std::vector<int32_t> order;
+  thread_pool.AddTask(self, new PriorityTask(&order, 0, 0));
+  thread_pool.AddTask(self, new PriorityTask(&order, 2, 1));
+  thread_pool.AddTask(self, new PriorityTask(&order, 1, 2));
+  thread_pool.AddTask(self, new PriorityTask(&order, 0, 3));
+  thread_pool.AddTask(self, new PriorityTask(&order, 2, 4));
+  thread_pool.AddTask(self, new PriorityTask(&order, 1, 5));
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, false, false);
+  EXPECT_EQ(std::vector<int32_t>({1, 4, 2, 5, 0, 3}), order);
+}
+
 class PeerTask : public Task {
  public:
   PeerTask() {}
@@ -19,9 +19,13 @@
 #include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <queue>
+
 #include "android-base/stringprintf.h"
 
 #include "art_method-inl.h"
+#include "barrier.h"
 #include "base/casts.h"
 #include "base/enums.h"
 #include "base/stl_util.h"
@@ -34,7 +38,9 @@
 #include "dex_file-inl.h"
 #include "gc/scoped_gc_critical_section.h"
 #include "instrumentation.h"
+#include "java_vm_ext.h"
 #include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
 #include "mirror/dex_cache-inl.h"
 #include "mirror/object_array-inl.h"
 #include "mirror/object-inl.h"
@@ -58,9 +64,9 @@ static constexpr uint8_t kOpTraceSummary = 3U;
 
 class BuildStackTraceVisitor : public StackVisitor {
  public:
-  explicit BuildStackTraceVisitor(Thread* thread)
+  BuildStackTraceVisitor(Thread* thread, std::vector<ArtMethod*>* method_trace)
       : StackVisitor(thread, nullptr, StackVisitor::StackWalkKind::kIncludeInlinedFrames),
-        method_trace_(Trace::AllocStackTrace()) {}
+        method_trace_(method_trace) {}
 
   bool VisitFrame() REQUIRES_SHARED(Locks::mutator_lock_) {
     ArtMethod* m = GetMethod();
@@ -71,11 +77,6 @@ class BuildStackTraceVisitor : public StackVisitor {
     return true;
   }
 
-  // Returns a stack trace where the topmost frame corresponds with the first element of the vector.
-  std::vector<ArtMethod*>* GetStackTrace() const {
-    return method_trace_;
-  }
-
  private:
   std::vector<ArtMethod*>* const method_trace_;
 
@@ -94,7 +95,6 @@ TraceClockSource Trace::default_clock_source_ = kDefaultTraceClockSource;
 
 Trace* volatile Trace::the_trace_ = nullptr;
 pthread_t Trace::sampling_pthread_ = 0U;
-std::unique_ptr<std::vector<ArtMethod*>> Trace::temp_stack_trace_;
 
 // The key identifying the tracer to update instrumentation.
 static constexpr const char* kTracerInstrumentationKey = "Tracer";
@@ -130,14 +130,40 @@ uint32_t Trace::EncodeTraceMethodAndAction(ArtMethod* method, TraceAction action
   return tmid;
 }
 
-std::vector<ArtMethod*>* Trace::AllocStackTrace() {
-  return (temp_stack_trace_.get() != nullptr)  ? temp_stack_trace_.release() :
-      new std::vector<ArtMethod*>();
+TraceSampleRing::TraceSampleRing(pid_t tid, size_t capacity)
+    : tid_(tid),
+      capacity_(capacity),
+      words_(new uint64_t[capacity]),
+      tail_(0u),
+      head_(0u),
+      num_overwritten_samples_(0u),
+      has_merged_sample_(false) {
+  static_assert(IsPowerOfTwo(kMinCapacity), "kMinCapacity must be a power of two");
+  static_assert(kSampleHeaderSize + kMaxSampleFrames <= kMinCapacity,
+                "kMinCapacity must fit a sample of kMaxSampleFrames frames");
+  DCHECK(IsPowerOfTwo(capacity));
+  DCHECK_GE(capacity, kMinCapacity);
 }
 
-void Trace::FreeStackTrace(std::vector<ArtMethod*>* stack_trace) {
-  stack_trace->clear();
-  temp_stack_trace_.reset(stack_trace);
+void TraceSampleRing::AppendSample(uint32_t thread_clock_diff, uint32_t wall_clock_diff) {
+  if (frames_.size() > kMaxSampleFrames) {
+    frames_.erase(frames_.begin(), frames_.end() - kMaxSampleFrames);
+  }
+  size_t size = kSampleHeaderSize + frames_.size();
+  DCHECK_LE(size, capacity_);
+  size_t head = head_.LoadRelaxed();
+  size_t tail = tail_.LoadRelaxed();
+  while (head - tail + size > capacity_) {
+    tail = NextSample(tail);
+    ++num_overwritten_samples_;
+  }
+  tail_.StoreRelease(tail);
+  Set(head, frames_.size());
+  Set(head + 1, (static_cast<uint64_t>(thread_clock_diff) << 32) | wall_clock_diff);
+  for (size_t i = 0; i != frames_.size(); ++i) {
+    Set(head + kSampleHeaderSize + i, reinterpret_cast<uintptr_t>(frames_[i]));
+  }
+  head_.StoreRelease(head + size);
 }
 
 void Trace::SetDefaultClockSource(TraceClockSource clock_source) {
@@ -225,59 +251,244 @@ static void Append8LE(uint8_t* buf, uint64_t val) {
   *buf++ = static_cast<uint8_t>(val >> 56);
 }
 
-static void GetSample(Thread* thread, void* arg) REQUIRES_SHARED(Locks::mutator_lock_) {
-  BuildStackTraceVisitor build_trace_visitor(thread);
-  build_trace_visitor.WalkStack();
-  std::vector<ArtMethod*>* stack_trace = build_trace_visitor.GetStackTrace();
-  Trace* the_trace = reinterpret_cast<Trace*>(arg);
-  the_trace->CompareAndUpdateStackTrace(thread, stack_trace);
-}
+// Takes a stack sample of each thread that reaches the checkpoint. The sampled threads only
+// walk their own stack, other threads keep running.
+class SampleCheckpoint FINAL : public Closure {
+ public:
+  explicit SampleCheckpoint(Trace* trace) : barrier_(0), trace_(trace) {}
+
+  void Run(Thread* thread) OVERRIDE {
+    // The checkpoint is only requested from runnable threads, which run it themselves.
+    Thread* self = Thread::Current();
+    DCHECK_EQ(thread, self);
+    ScopedObjectAccess soa(self);
+    trace_->RecordSample(thread);
+    barrier_.Pass(self);
+  }
+
+  void WaitForThreadsToRunThroughCheckpoint(size_t threads_running_checkpoint) {
+    Thread* self = Thread::Current();
+    ScopedThreadStateChange tsc(self, kWaitingForCheckPointsToRun);
+    barrier_.Increment(self, threads_running_checkpoint);
+  }
 
-static void ClearThreadStackTraceAndClockBase(Thread* thread, void* arg ATTRIBUTE_UNUSED) {
+ private:
+  // The barrier to be passed through and for the requestor to wait upon.
+  Barrier barrier_;
+  Trace* const trace_;
+
+  DISALLOW_COPY_AND_ASSIGN(SampleCheckpoint);
+};
+
+static void ClearThreadSampleRingAndClockBase(Thread* thread, void* arg ATTRIBUTE_UNUSED) {
   thread->SetTraceClockBase(0);
-  std::vector<ArtMethod*>* stack_trace = thread->GetStackTraceSample();
-  thread->SetStackTraceSample(nullptr);
-  delete stack_trace;
-}
-
-void Trace::CompareAndUpdateStackTrace(Thread* thread,
-                                       std::vector<ArtMethod*>* stack_trace) {
-  CHECK_EQ(pthread_self(), sampling_pthread_);
-  std::vector<ArtMethod*>* old_stack_trace = thread->GetStackTraceSample();
-  // Update the thread's stack trace sample.
-  thread->SetStackTraceSample(stack_trace);
-  // Read timer clocks to use for all events in this trace.
+  TraceSampleRing* ring = thread->GetTraceSampleRing();
+  thread->SetTraceSampleRing(nullptr);
+  delete ring;
+}
+
+static void GetThreadSampleRing(Thread* thread, void* arg) {
+  TraceSampleRing* ring = thread->GetTraceSampleRing();
+  if (ring != nullptr) {
+    std::string name;
+    thread->GetThreadName(name);
+    ring->SetThreadName(name);
+    reinterpret_cast<std::vector<TraceSampleRing*>*>(arg)->push_back(ring);
+  }
+}
+
+static void TakeThreadSampleRing(Thread* thread, void* arg) {
+  TraceSampleRing* ring = thread->GetTraceSampleRing();
+  if (ring != nullptr) {
+    std::string name;
+    thread->GetThreadName(name);
+    ring->SetThreadName(name);
+    thread->SetTraceSampleRing(nullptr);
+    auto* rings = reinterpret_cast<std::vector<std::unique_ptr<TraceSampleRing>>*>(arg);
+    rings->emplace_back(ring);
+  }
+}
+
+void Trace::RecordSample(Thread* thread) {
+  TraceSampleRing* ring = thread->GetTraceSampleRing();
+  if (ring == nullptr) {
+    ring = new TraceSampleRing(thread->GetTid(), sample_ring_capacity_);
+    thread->SetTraceSampleRing(ring);
+  }
+  std::vector<ArtMethod*>* frames = ring->GetFrameBuffer();
+  frames->clear();
+  BuildStackTraceVisitor build_trace_visitor(thread, frames);
+  build_trace_visitor.WalkStack();
+  for (ArtMethod* method : *frames) {
+    // Classes of the boot class path are never unloaded.
+    ObjPtr<mirror::ClassLoader> class_loader = method->GetDeclaringClass()->GetClassLoader();
+    if (class_loader != nullptr && ring->AddClassTable(class_loader->GetClassTable())) {
+      PinClassLoader(thread, class_loader);
+    }
+  }
   uint32_t thread_clock_diff = 0;
   uint32_t wall_clock_diff = 0;
   ReadClocks(thread, &thread_clock_diff, &wall_clock_diff);
+  if (!UseWallClock()) {
+    // The wall clock orders the samples of different threads when they are merged.
+    wall_clock_diff = MicroTime() - start_time_;
+  }
+  ring->AppendSample(thread_clock_diff, wall_clock_diff);
+}
+
+void Trace::PinClassLoader(Thread* self, ObjPtr<mirror::ClassLoader> class_loader) {
+  {
+    MutexLock mu(self, *unique_methods_lock_);
+    if (!pinned_class_tables_.insert(class_loader->GetClassTable()).second) {
+      // Already pinned from another thread.
+      return;
+    }
+  }
+  jobject global_ref = Runtime::Current()->GetJavaVM()->AddGlobalRef(self, class_loader);
+  MutexLock mu(self, *unique_methods_lock_);
+  pinned_class_loaders_.push_back(global_ref);
+}
+
+void Trace::UnpinClassLoaders(Thread* self) {
+  std::vector<jobject> pinned_class_loaders;
+  {
+    MutexLock mu(self, *unique_methods_lock_);
+    pinned_class_loaders.swap(pinned_class_loaders_);
+    pinned_class_tables_.clear();
+  }
+  JavaVMExt* vm = Runtime::Current()->GetJavaVM();
+  for (jobject global_ref : pinned_class_loaders) {
+    vm->DeleteGlobalRef(self, global_ref);
+  }
+}
+
+void Trace::LogStackTraceDiff(pid_t tid,
+                              const std::vector<ArtMethod*>* old_stack_trace,
+                              const std::vector<ArtMethod*>& stack_trace,
+                              uint32_t thread_clock_diff,
+                              uint32_t wall_clock_diff) {
   if (old_stack_trace == nullptr) {
     // If there's no previous stack trace sample for this thread, log an entry event for all
     // methods in the trace.
-    for (auto rit = stack_trace->rbegin(); rit != stack_trace->rend(); ++rit) {
-      LogMethodTraceEvent(thread, *rit, instrumentation::Instrumentation::kMethodEntered,
-                          thread_clock_diff, wall_clock_diff);
+    for (auto rit = stack_trace.rbegin(); rit != stack_trace.rend(); ++rit) {
+      LogTraceRecord(tid, nullptr, *rit, kTraceMethodEnter, thread_clock_diff, wall_clock_diff);
     }
   } else {
     // If there's a previous stack trace for this thread, diff the traces and emit entry and exit
     // events accordingly.
     auto old_rit = old_stack_trace->rbegin();
-    auto rit = stack_trace->rbegin();
+    auto rit = stack_trace.rbegin();
     // Iterate bottom-up over both traces until there's a difference between them.
-    while (old_rit != old_stack_trace->rend() && rit != stack_trace->rend() && *old_rit == *rit) {
+    while (old_rit != old_stack_trace->rend() && rit != stack_trace.rend() && *old_rit == *rit) {
       old_rit++;
       rit++;
     }
     // Iterate top-down over the old trace until the point where they differ, emitting exit events.
     for (auto old_it = old_stack_trace->begin(); old_it != old_rit.base(); ++old_it) {
-      LogMethodTraceEvent(thread, *old_it, instrumentation::Instrumentation::kMethodExited,
-                          thread_clock_diff, wall_clock_diff);
+      LogTraceRecord(tid, nullptr, *old_it, kTraceMethodExit, thread_clock_diff, wall_clock_diff);
     }
     // Iterate bottom-up over the new trace from the point where they differ, emitting entry events.
-    for (; rit != stack_trace->rend(); ++rit) {
-      LogMethodTraceEvent(thread, *rit, instrumentation::Instrumentation::kMethodEntered,
-                          thread_clock_diff, wall_clock_diff);
+    for (; rit != stack_trace.rend(); ++rit) {
+      LogTraceRecord(tid, nullptr, *rit, kTraceMethodEnter, thread_clock_diff, wall_clock_diff);
+    }
+  }
+}
+
+void Trace::MergeSampleRings() {
+  Thread* self = Thread::Current();
+  std::vector<std::unique_ptr<TraceSampleRing>> rings = std::move(exited_sample_rings_);
+  {
+    MutexLock mu(self, *Locks::thread_list_lock_);
+    Runtime::Current()->GetThreadList()->ForEach(TakeThreadSampleRing, &rings);
+  }
+  std::vector<TraceSampleRing*> ring_pointers;
+  size_t num_dropped_samples = 0u;
+  for (const std::unique_ptr<TraceSampleRing>& ring : rings) {
+    ring_pointers.push_back(ring.get());
+    num_dropped_samples += ring->GetNumberOfOverwrittenSamples();
+  }
+  WriteSamples(ring_pointers);
+  if (num_dropped_samples != 0u) {
+    overflow_ = true;
+    LOG(WARNING) << "Method trace sampling dropped " << num_dropped_samples
+                 << " samples, increase the trace buffer size to keep them";
+  }
+}
+
+void Trace::DrainSampleRings() {
+  DCHECK(trace_output_mode_ == TraceOutputMode::kStreaming);
+  Thread* self = Thread::Current();
+  std::vector<TraceSampleRing*> rings;
+  {
+    // Holding the trace lock keeps exiting threads from moving their ring between the two lists.
+    MutexLock mu(self, *Locks::trace_lock_);
+    for (const std::unique_ptr<TraceSampleRing>& ring : exited_sample_rings_) {
+      rings.push_back(ring.get());
     }
-    FreeStackTrace(old_stack_trace);
+    MutexLock mu2(self, *Locks::thread_list_lock_);
+    Runtime::Current()->GetThreadList()->ForEach(GetThreadSampleRing, &rings);
+  }
+  // The rings are only freed when tracing stops, after the sampling thread exits.
+  if (std::none_of(rings.begin(),
+                   rings.end(),
+                   [](TraceSampleRing* ring) { return ring->IsHalfFull(); })) {
+    return;
+  }
+  // All rings are drained together, so that later samples of any thread come after these.
+  WriteSamples(rings);
+}
+
+void Trace::WriteSamples(const std::vector<TraceSampleRing*>& rings) {
+  Thread* self = Thread::Current();
+  if (trace_output_mode_ == TraceOutputMode::kStreaming) {
+    // Name the sampled threads before their first record.
+    MutexLock mu(self, *streaming_lock_);
+    for (TraceSampleRing* ring : rings) {
+      if (RegisterThread(ring->GetTid())) {
+        WriteThreadName(ring->GetTid(), ring->GetThreadName());
+      }
+    }
+  }
+
+  // Replay the samples of all threads in wall clock order, each thread diffing its samples
+  // against its previous one.
+  struct SampleCursor {
+    TraceSampleRing* ring;
+    size_t pos;
+    size_t end;
+  };
+  std::vector<SampleCursor> cursors;
+  using QueueEntry = std::pair<uint32_t, size_t>;  // Wall clock diff and cursor index.
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+  for (TraceSampleRing* ring : rings) {
+    if (ring->Begin() != ring->End()) {
+      queue.emplace(ring->GetWallClockDiff(ring->Begin()), cursors.size());
+      cursors.push_back(SampleCursor { ring, ring->Begin(), ring->End() });
+    }
+  }
+  std::vector<ArtMethod*> stack_trace;
+  while (!queue.empty()) {
+    size_t index = queue.top().second;
+    queue.pop();
+    SampleCursor& cursor = cursors[index];
+    TraceSampleRing* ring = cursor.ring;
+    stack_trace.clear();
+    for (size_t i = 0, e = ring->GetNumberOfFrames(cursor.pos); i != e; ++i) {
+      stack_trace.push_back(ring->GetFrame(cursor.pos, i));
+    }
+    LogStackTraceDiff(ring->GetTid(),
+                      ring->GetLastMergedSample(),
+                      stack_trace,
+                      ring->GetThreadClockDiff(cursor.pos),
+                      ring->GetWallClockDiff(cursor.pos));
+    ring->SetLastMergedSample(&stack_trace);
+    cursor.pos = ring->NextSample(cursor.pos);
+    if (cursor.pos != cursor.end) {
+      queue.emplace(ring->GetWallClockDiff(cursor.pos), index);
+    }
+  }
+  for (const SampleCursor& cursor : cursors) {
+    cursor.ring->Consume(cursor.end);
   }
 }
 
@@ -300,10 +511,19 @@ void* Trace::RunSamplingThread(void* arg) {
         break;
       }
     }
-    {
-      ScopedSuspendAll ssa(__FUNCTION__);
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(GetSample, the_trace);
+    // Runnable threads sample their own stack. The stacks of suspended threads do not change,
+    // so they are not sampled until they run again.
+    SampleCheckpoint checkpoint(the_trace);
+    size_t threads_running_checkpoint =
+        runtime->GetThreadList()->RunCheckpointOnRunnableThreads(&checkpoint);
+    if (threads_running_checkpoint != 0) {
+      checkpoint.WaitForThreadsToRunThroughCheckpoint(threads_running_checkpoint);
+    }
+    if (the_trace->trace_output_mode_ == TraceOutputMode::kStreaming) {
+      // No thread appends to its ring until the next checkpoint. Write the samples out before
+      // the rings fill up and overwrite them.
+      ScopedObjectAccess soa(self);
+      the_trace->DrainSampleRings();
     }
   }
 
@@ -412,6 +632,16 @@ void Trace::StopTracing(bool finish_tracing, bool flush_file) {
     sampling_pthread_ = 0U;
   }
 
+  if (the_trace != nullptr && the_trace->trace_mode_ == TraceMode::kSampling) {
+    // No samples are taken after the sampling thread exits. Merge them before suspending all
+    // threads, as this takes time proportional to the number of samples.
+    if (finish_tracing) {
+      ScopedObjectAccess soa(self);
+      the_trace->MergeSampleRings();
+    }
+    the_trace->UnpinClassLoaders(self);
+  }
+
   {
     gc::ScopedGCCriticalSection gcs(self,
                                     gc::kGcCauseInstrumentation,
@@ -425,7 +655,7 @@ void Trace::StopTracing(bool finish_tracing, bool flush_file) {
 
       if (the_trace->trace_mode_ == TraceMode::kSampling) {
         MutexLock mu(self, *Locks::thread_list_lock_);
-        runtime->GetThreadList()->ForEach(ClearThreadStackTraceAndClockBase, nullptr);
+        runtime->GetThreadList()->ForEach(ClearThreadSampleRingAndClockBase, nullptr);
       } else {
         runtime->GetInstrumentation()->DisableMethodTracing(kTracerInstrumentationKey);
         runtime->GetInstrumentation()->RemoveListener(
@@ -509,10 +739,8 @@ void Trace::Pause() {
     ScopedSuspendAll ssa(__FUNCTION__);
     stop_alloc_counting = (the_trace->flags_ & Trace::kTraceCountAllocs) != 0;
 
-    if (the_trace->trace_mode_ == TraceMode::kSampling) {
-      MutexLock mu(self, *Locks::thread_list_lock_);
-      runtime->GetThreadList()->ForEach(ClearThreadStackTraceAndClockBase, nullptr);
-    } else {
+    // The sample rings are kept, the samples taken after Resume() extend the same trace.
+    if (the_trace->trace_mode_ != TraceMode::kSampling) {
       runtime->GetInstrumentation()->DisableMethodTracing(kTracerInstrumentationKey);
       runtime->GetInstrumentation()->RemoveListener(
           the_trace,
@@ -589,6 +817,14 @@ TracingMode Trace::GetMethodTracingMode() {
 
 static constexpr size_t kMinBufSize = 18U;  // Trace header is up to 18B.
 
+// The samples of one thread cannot turn into more records than fit in the trace buffer, so
+// the sample ring of a thread is at most as large as the buffer. The pages of a ring are only
+// touched as samples are appended.
+static size_t GetSampleRingCapacity(size_t buffer_size) {
+  size_t capacity = std::max(buffer_size / sizeof(uint64_t), TraceSampleRing::kMinCapacity);
+  return HighestOneBitValue(capacity);
+}
+
 Trace::Trace(File* trace_file, const char* trace_name, size_t buffer_size, int flags,
              TraceOutputMode output_mode, TraceMode trace_mode)
     : trace_file_(trace_file),
@@ -596,6 +832,7 @@ Trace::Trace(File* trace_file, const char* trace_name, size_t buffer_size, int f
       flags_(flags), trace_output_mode_(output_mode), trace_mode_(trace_mode),
       clock_source_(default_clock_source_),
       buffer_size_(std::max(kMinBufSize, buffer_size)),
+      sample_ring_capacity_(GetSampleRingCapacity(buffer_size_)),
       start_time_(MicroTime()), clock_overhead_ns_(GetClockOverheadNanoSeconds()), cur_offset_(0),
       overflow_(false), interval_us_(0), streaming_lock_(nullptr),
       unique_methods_lock_(new Mutex("unique methods lock", kTracingUniqueMethodsLock)) {
@@ -849,8 +1086,7 @@ bool Trace::RegisterMethod(ArtMethod* method) {
   return false;
 }
 
-bool Trace::RegisterThread(Thread* thread) {
-  pid_t tid = thread->GetTid();
+bool Trace::RegisterThread(pid_t tid) {
   CHECK_LT(0U, static_cast<uint32_t>(tid));
   CHECK_LT(static_cast<uint32_t>(tid), kMaxThreadIdNumber);
 
@@ -861,6 +1097,16 @@ bool Trace::RegisterThread(Thread* thread) {
   return false;
 }
 
+void Trace::WriteThreadName(pid_t tid, const std::string& thread_name) {
+  uint8_t buf[7];
+  Append2LE(buf, 0);
+  buf[2] = kOpNewThread;
+  Append2LE(buf + 3, static_cast<uint16_t>(tid));
+  Append2LE(buf + 5, static_cast<uint16_t>(thread_name.length()));
+  WriteToBuf(buf, sizeof(buf));
+  WriteToBuf(reinterpret_cast<const uint8_t*>(thread_name.c_str()), thread_name.length());
+}
+
 std::string Trace::GetMethodLine(ArtMethod* method) {
   method = method->GetInterfaceMethodIfProxy(kRuntimePointerSize);
   return StringPrintf("%#x\t%s\t%s\t%s\t%s\n", (EncodeTraceMethod(method) << TraceActionBits),
@@ -905,6 +1151,25 @@ void Trace::FlushBuf() {
 void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
                                 instrumentation::Instrumentation::InstrumentationEvent event,
                                 uint32_t thread_clock_diff, uint32_t wall_clock_diff) {
+  TraceAction action = kTraceMethodEnter;
+  switch (event) {
+    case instrumentation::Instrumentation::kMethodEntered:
+      action = kTraceMethodEnter;
+      break;
+    case instrumentation::Instrumentation::kMethodExited:
+      action = kTraceMethodExit;
+      break;
+    case instrumentation::Instrumentation::kMethodUnwind:
+      action = kTraceUnroll;
+      break;
+    default:
+      UNIMPLEMENTED(FATAL) << "Unexpected event: " << event;
+  }
+  LogTraceRecord(thread->GetTid(), thread, method, action, thread_clock_diff, wall_clock_diff);
+}
+
+void Trace::LogTraceRecord(pid_t tid, Thread* thread, ArtMethod* method, TraceAction action,
+                           uint32_t thread_clock_diff, uint32_t wall_clock_diff) {
   // Ensure we always use the non-obsolete version of the method so that entry/exit events have the
   // same pointer value.
   method = method->GetNonObsoleteMethod();
@@ -924,21 +1189,6 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
     } while (!cur_offset_.CompareExchangeWeakSequentiallyConsistent(old_offset, new_offset));
   }
 
-  TraceAction action = kTraceMethodEnter;
-  switch (event) {
-    case instrumentation::Instrumentation::kMethodEntered:
-      action = kTraceMethodEnter;
-      break;
-    case instrumentation::Instrumentation::kMethodExited:
-      action = kTraceMethodExit;
-      break;
-    case instrumentation::Instrumentation::kMethodUnwind:
-      action = kTraceUnroll;
-      break;
-    default:
-      UNIMPLEMENTED(FATAL) << "Unexpected event: " << event;
-  }
-
   uint32_t method_value = EncodeTraceMethodAndAction(method, action);
 
   // Write data
@@ -951,7 +1201,7 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
     ptr = buf_.get() + old_offset;
   }
 
-  Append2LE(ptr, thread->GetTid());
+  Append2LE(ptr, tid);
   Append4LE(ptr + 2, method_value);
   ptr += 6;
 
@@ -976,17 +1226,12 @@ void Trace::LogMethodTraceEvent(Thread* thread, ArtMethod* method,
       WriteToBuf(buf2, sizeof(buf2));
       WriteToBuf(reinterpret_cast<const uint8_t*>(method_line.c_str()), method_line.length());
     }
-    if (RegisterThread(thread)) {
+    if (RegisterThread(tid)) {
       // It might be better to postpone this. Threads might not have received names...
+      DCHECK(thread != nullptr);
       std::string thread_name;
       thread->GetThreadName(thread_name);
-      uint8_t buf2[7];
-      Append2LE(buf2, 0);
-      buf2[2] = kOpNewThread;
-      Append2LE(buf2 + 3, static_cast<uint16_t>(thread->GetTid()));
-      Append2LE(buf2 + 5, static_cast<uint16_t>(thread_name.length()));
-      WriteToBuf(buf2, sizeof(buf2));
-      WriteToBuf(reinterpret_cast<const uint8_t*>(thread_name.c_str()), thread_name.length());
+      WriteThreadName(tid, thread_name);
     }
     WriteToBuf(stack_buf, sizeof(stack_buf));
   }
@@ -1036,6 +1281,16 @@ void Trace::StoreExitingThreadInfo(Thread* thread) {
     // The same thread/tid may be used multiple times. As SafeMap::Put does not allow to override
     // a previous mapping, use SafeMap::Overwrite.
     the_trace_->exited_threads_.Overwrite(thread->GetTid(), name);
+    TraceSampleRing* ring = thread->GetTraceSampleRing();
+    if (ring != nullptr) {
+      // A ring drained while the thread was alive is already named, and the sampling thread
+      // may be reading that name.
+      if (ring->GetThreadName().empty()) {
+        ring->SetThreadName(name);
+      }
+      thread->SetTraceSampleRing(nullptr);
+      the_trace_->exited_sample_rings_.emplace_back(ring);
+    }
   }
 }
 
@@ -30,14 +30,21 @@
 #include "base/macros.h"
 #include "globals.h"
 #include "instrumentation.h"
+#include "jni.h"
 #include "os.h"
 #include "safe_map.h"
 
 namespace art {
 
+namespace mirror {
+class ClassLoader;
+}  // namespace mirror
+
 class ArtField;
 class ArtMethod;
+class ClassTable;
 class DexFile;
+template<class MirrorType> class ObjPtr;
 class Thread;
 
 using DexIndexBitSet = std::bitset<65536>;
@@ -93,6 +100,144 @@ enum TraceAction {
     kTraceMethodActionMask = 0x03,  // two bits
 };
 
+// Stack samples of one thread, taken by the sampling profiler. Only the sampled thread appends
+// to its ring, from a checkpoint, so appending needs neither locks nor atomic read-modify-write
+// operations. When the ring is full, the oldest samples are overwritten and counted as dropped.
+// The rings of all threads are merged into trace records when tracing finishes. In streaming
+// mode, the sampling thread also merges them between two checkpoints once a ring is half full,
+// so that samples are only dropped if a thread fills half of its ring in one sampling interval.
+//
+// Sample format, in 64-bit words:
+//     number of frames
+//     thread cpu time delta << 32 | wall time delta since start, in usec
+//     ArtMethod* of each frame, innermost first
+class TraceSampleRing {
+ public:
+  // The smallest capacity that fits a sample of the deepest stack.
+  static constexpr size_t kMinCapacity = 512u;
+
+  // The capacity is in 64-bit words and must be a power of two, at least kMinCapacity.
+  TraceSampleRing(pid_t tid, size_t capacity);
+
+  pid_t GetTid() const {
+    return tid_;
+  }
+
+  const std::string& GetThreadName() const {
+    return thread_name_;
+  }
+
+  void SetThreadName(const std::string& thread_name) {
+    thread_name_ = thread_name;
+  }
+
+  // Scratch space to collect the frames of the next sample.
+  std::vector<ArtMethod*>* GetFrameBuffer() {
+    return &frames_;
+  }
+
+  // Returns whether no earlier sample of this ring had a method of `class_table`.
+  bool AddClassTable(const ClassTable* class_table) {
+    return class_tables_.insert(class_table).second;
+  }
+
+  // Append a sample of the frames in the frame buffer. Called by the owning thread only.
+  void AppendSample(uint32_t thread_clock_diff, uint32_t wall_clock_diff);
+
+  // Positions of the oldest sample and past the newest sample.
+  size_t Begin() const {
+    return tail_.LoadAcquire();
+  }
+
+  size_t End() const {
+    return head_.LoadAcquire();
+  }
+
+  size_t NextSample(size_t pos) const {
+    return pos + kSampleHeaderSize + GetNumberOfFrames(pos);
+  }
+
+  size_t GetNumberOfFrames(size_t pos) const {
+    return static_cast<size_t>(At(pos));
+  }
+
+  uint32_t GetThreadClockDiff(size_t pos) const {
+    return static_cast<uint32_t>(At(pos + 1) >> 32);
+  }
+
+  uint32_t GetWallClockDiff(size_t pos) const {
+    return static_cast<uint32_t>(At(pos + 1));
+  }
+
+  ArtMethod* GetFrame(size_t pos, size_t frame_index) const {
+    return reinterpret_cast<ArtMethod*>(static_cast<uintptr_t>(At(pos + 2 + frame_index)));
+  }
+
+  // Drop the samples before `pos`. Called only while the owning thread cannot append: between
+  // two sampling checkpoints, or after the thread exited.
+  void Consume(size_t pos) {
+    tail_.StoreRelease(pos);
+  }
+
+  bool IsHalfFull() const {
+    return End() - Begin() > capacity_ / 2u;
+  }
+
+  size_t GetNumberOfOverwrittenSamples() const {
+    return num_overwritten_samples_;
+  }
+
+  // The frames of the last merged sample, which the next merged sample is diffed against, or
+  // null if no sample was merged yet. Only used by the merging thread.
+  const std::vector<ArtMethod*>* GetLastMergedSample() const {
+    return has_merged_sample_ ? &last_merged_frames_ : nullptr;
+  }
+
+  // Make `frames` the last merged sample. The previous one is swapped into `frames`.
+  void SetLastMergedSample(std::vector<ArtMethod*>* frames) {
+    last_merged_frames_.swap(*frames);
+    has_merged_sample_ = true;
+  }
+
+ private:
+  static constexpr size_t kSampleHeaderSize = 2u;
+
+  // Deeper stacks keep only their outermost frames, so that consecutive samples still share
+  // their common callers.
+  static constexpr size_t kMaxSampleFrames = 256u;
+
+  uint64_t At(size_t pos) const {
+    return words_[pos & (capacity_ - 1u)];
+  }
+
+  void Set(size_t pos, uint64_t value) {
+    words_[pos & (capacity_ - 1u)] = value;
+  }
+
+  const pid_t tid_;
+  std::string thread_name_;
+
+  const size_t capacity_;
+  std::unique_ptr<uint64_t[]> words_;
+
+  // Positions of the oldest sample and past the newest sample. They only grow, the word at a
+  // position is words_[pos & (capacity_ - 1)].
+  Atomic<size_t> tail_;
+  Atomic<size_t> head_;
+
+  size_t num_overwritten_samples_;
+
+  std::vector<ArtMethod*> frames_;
+
+  bool has_merged_sample_;
+  std::vector<ArtMethod*> last_merged_frames_;
+
+  // Class tables of the class loaders of the sampled methods.
+  std::set<const ClassTable*> class_tables_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceSampleRing);
+};
+
 class Trace FINAL : public instrumentation::InstrumentationListener {
  public:
   enum TraceFlag {
@@ -136,8 +281,9 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   void MeasureClockOverhead();
   uint32_t GetClockOverheadNanoSeconds();
 
-  void CompareAndUpdateStackTrace(Thread* thread, std::vector<ArtMethod*>* stack_trace)
-      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
+  // Append a sample of the stack of `thread` to its sample ring. Called by `thread` itself.
+  void RecordSample(Thread* thread)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_);
 
   // InstrumentationListener implementation.
   void MethodEntered(Thread* thread, mirror::Object* this_object,
@@ -174,11 +320,7 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
                                 uint32_t dex_pc,
                                 ArtMethod* callee)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_) OVERRIDE;
-  // Reuse an old stack trace if it exists, otherwise allocate a new one.
-  static std::vector<ArtMethod*>* AllocStackTrace();
-  // Clear and store an old stack trace for later use.
-  static void FreeStackTrace(std::vector<ArtMethod*>* stack_trace);
-  // Save id and name of a thread before it exits.
+  // Save id, name and stack samples of a thread before it exits.
   static void StoreExitingThreadInfo(Thread* thread);
 
   static TraceOutputMode GetOutputMode() REQUIRES(!Locks::trace_lock_);
@@ -212,6 +354,46 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
                            uint32_t thread_clock_diff, uint32_t wall_clock_diff)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
 
+  // Write a trace record. In streaming mode, `thread` is used to name a thread seen for the
+  // first time and can be null only if the thread `tid` was already registered.
+  void LogTraceRecord(pid_t tid, Thread* thread, ArtMethod* method, TraceAction action,
+                      uint32_t thread_clock_diff, uint32_t wall_clock_diff)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
+
+  // Write the entry and exit records that turn the stack `old_stack_trace` (null if there was
+  // no previous sample) into `stack_trace`, both innermost frame first.
+  void LogStackTraceDiff(pid_t tid,
+                         const std::vector<ArtMethod*>* old_stack_trace,
+                         const std::vector<ArtMethod*>& stack_trace,
+                         uint32_t thread_clock_diff,
+                         uint32_t wall_clock_diff)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
+
+  // Merge the sample rings of all threads, in wall clock order, into trace records, and free
+  // them. Called when tracing finishes.
+  void MergeSampleRings()
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::thread_list_lock_, !*unique_methods_lock_, !*streaming_lock_);
+
+  // In streaming mode, merge the samples taken so far into trace records if a sample ring is
+  // half full. Called by the sampling thread between two checkpoints.
+  void DrainSampleRings()
+      REQUIRES_SHARED(Locks::mutator_lock_)
+      REQUIRES(!Locks::trace_lock_,
+               !Locks::thread_list_lock_,
+               !*unique_methods_lock_,
+               !*streaming_lock_);
+
+  // Merge the samples of `rings`, in wall clock order, into trace records and consume them.
+  void WriteSamples(const std::vector<TraceSampleRing*>& rings)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_, !*streaming_lock_);
+
+  // Keep `class_loader` from being unloaded until UnpinClassLoaders(), so that the methods in
+  // the sample rings stay valid until they are merged.
+  void PinClassLoader(Thread* self, ObjPtr<mirror::ClassLoader> class_loader)
+      REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(!*unique_methods_lock_);
+  void UnpinClassLoaders(Thread* self) REQUIRES(!*unique_methods_lock_);
+
   // Methods to output traced methods and threads.
   void GetVisitedMethods(size_t end_offset, std::set<ArtMethod*>* visited_methods)
       REQUIRES(!*unique_methods_lock_);
@@ -223,7 +405,9 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   // is newly discovered.
   bool RegisterMethod(ArtMethod* method)
       REQUIRES_SHARED(Locks::mutator_lock_) REQUIRES(streaming_lock_);
-  bool RegisterThread(Thread* thread)
+  bool RegisterThread(pid_t tid)
+      REQUIRES(streaming_lock_);
+  void WriteThreadName(pid_t tid, const std::string& thread_name)
       REQUIRES(streaming_lock_);
 
   // Copy a temporary buffer to the main buffer. Used for streaming. Exposed here for lock
@@ -253,9 +437,6 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   // Sampling thread, non-zero when sampling.
   static pthread_t sampling_pthread_;
 
-  // Used to remember an unused stack trace to avoid re-allocation during sampling.
-  static std::unique_ptr<std::vector<ArtMethod*>> temp_stack_trace_;
-
   // File to write trace data out to, null if direct to ddms.
   std::unique_ptr<File> trace_file_;
 
@@ -276,6 +457,9 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   // Size of buf_.
   const size_t buffer_size_;
 
+  // Capacity of the sample ring of each sampled thread, in 64-bit words.
+  const size_t sample_ring_capacity_;
+
   // Time trace was created.
   const uint64_t start_time_;
 
@@ -294,6 +478,10 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   // Sampling profiler sampling interval.
   int interval_us_;
 
+  // Sample rings of the threads that exited while sampling. Guarded by Locks::trace_lock_ while
+  // tracing.
+  std::vector<std::unique_ptr<TraceSampleRing>> exited_sample_rings_;
+
   // Streaming mode data.
   std::string streaming_file_name_;
   Mutex* streaming_lock_;
@@ -306,6 +494,11 @@ class Trace FINAL : public instrumentation::InstrumentationListener {
   std::unordered_map<ArtMethod*, uint32_t> art_method_id_map_ GUARDED_BY(unique_methods_lock_);
   std::vector<ArtMethod*> unique_methods_ GUARDED_BY(unique_methods_lock_);
 
+  // Global references to the class loaders pinned by PinClassLoader(), and their class tables,
+  // which identify the class loaders without being moved by the GC.
+  std::set<const ClassTable*> pinned_class_tables_ GUARDED_BY(unique_methods_lock_);
+  std::vector<jobject> pinned_class_loaders_ GUARDED_BY(unique_methods_lock_);
+
   DISALLOW_COPY_AND_ASSIGN(Trace);
 };
 
@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "background_verifier.h"
+
+#include <vector>
+
+#include "atomic.h"
+#include "base/logging.h"
+#include "base/systrace.h"
+#include "base/unix_file/fd_file.h"
+#include "class_linker.h"
+#include "dex_file-inl.h"
+#include "handle_scope-inl.h"
+#include "java_vm_ext.h"
+#include "jit/profile_compilation_info.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "os.h"
+#include "runtime.h"
+#include "scoped_thread_state_change-inl.h"
+#include "thread-inl.h"
+#include "thread_pool.h"
+#include "utf.h"
+
+namespace art {
+namespace verifier {
+
+// Number of classes verified by one task.
+static constexpr size_t kClassesPerTask = 16u;
+
+// Task priorities. Dex files are ordered before the verification of any class, so that the
+// classes in the profile of all dex files are verified before the other classes.
+static constexpr int32_t kDexFilePriority = 2;
+static constexpr int32_t kProfileClassesPriority = 1;
+static constexpr int32_t kOtherClassesPriority = 0;
+
+// A dex file being verified, shared by the tasks verifying its classes.
+struct DexFileVerification {
+  const DexFile* dex_file;
+  // Global reference to the class loader, which also keeps the dex file alive.
+  jobject class_loader;
+  // Number of tasks left, the last one deletes the verification.
+  AtomicInteger num_pending_tasks;
+};
+
+// Releases the global reference to the class loader and deletes `verification`.
+static void DeleteVerification(Thread* self, DexFileVerification* verification) {
+  Runtime::Current()->GetJavaVM()->DeleteGlobalRef(self, verification->class_loader);
+  delete verification;
+}
+
+class BackgroundVerifier::VerifyTask FINAL : public SelfDeletingTask {
+ public:
+  VerifyTask(BackgroundVerifier* verifier,
+             DexFileVerification* verification,
+             std::vector<uint16_t>&& class_def_indexes,
+             int32_t priority)
+      : verifier_(verifier),
+        verification_(verification),
+        class_def_indexes_(std::move(class_def_indexes)),
+        priority_(priority) {}
+
+  void Run(Thread* self) OVERRIDE {
+    // Pool threads never run class loader code: when the runtime does not find a type itself,
+    // ClassLinker::FindClass() throws the pre-allocated NoClassDefFoundError instead of calling
+    // ClassLoader.loadClass(), and the verifier records a soft failure for the unresolved type.
+    DCHECK(!self->CanCallIntoJava());
+    ScopedObjectAccess soa(self);
+    const DexFile& dex_file = *verification_->dex_file;
+    ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+    StackHandleScope<2> hs(self);
+    Handle<mirror::ClassLoader> class_loader =
+        hs.NewHandle(soa.Decode<mirror::ClassLoader>(verification_->class_loader));
+    MutableHandle<mirror::Class> klass = hs.NewHandle<mirror::Class>(nullptr);
+    for (uint16_t class_def_index : class_def_indexes_) {
+      if (verifier_->IsShuttingDown()) {
+        // Only release the verification, the classes are verified on first use.
+        break;
+      }
+      const char* descriptor = dex_file.GetClassDescriptor(dex_file.GetClassDef(class_def_index));
+      klass.Assign(class_linker->LookupClass(self, descriptor, class_loader.Get()));
+      if (klass == nullptr) {
+        // The class is loaded only if the runtime understands the whole class loader chain.
+        // The verifier resolves types through the same chain, so a type the runtime does not
+        // find is missing for the Java side too, and the soft failure is what the application
+        // thread would have computed. Other class loaders are left to verification on first use.
+        ObjPtr<mirror::Class> result = nullptr;
+        size_t hash = ComputeModifiedUtf8Hash(descriptor);
+        if (!class_linker->FindClassInBaseDexClassLoader(
+                soa, self, descriptor, hash, class_loader, &result)) {
+          break;
+        }
+        if (result == nullptr) {
+          continue;
+        }
+        klass.Assign(result);
+      }
+      // Skip classes defined by another dex file, classes still being loaded by another thread
+      // and classes already verified, by this pool or by the thread that first used them.
+      if (&klass->GetDexFile() != &dex_file ||
+          !klass->IsResolved() ||
+          klass->IsVerified() ||
+          klass->IsErroneous()) {
+        continue;
+      }
+      class_linker->VerifyClass(self, klass);
+      // A failure is recorded in the class status, and reported when the class is used.
+      self->ClearException();
+    }
+    if (verification_->num_pending_tasks.FetchAndSubSequentiallyConsistent(1) == 1) {
+      DeleteVerification(self, verification_);
+    }
+  }
+
+  int32_t GetPriority() const OVERRIDE {
+    return priority_;
+  }
+
+ private:
+  BackgroundVerifier* const verifier_;
+  DexFileVerification* const verification_;
+  const std::vector<uint16_t> class_def_indexes_;
+  const int32_t priority_;
+
+  DISALLOW_COPY_AND_ASSIGN(VerifyTask);
+};
+
+// Orders the classes of a dex file, the classes in the profile first, and queues their
+// verification.
+class BackgroundVerifier::DexFileTask FINAL : public SelfDeletingTask {
+ public:
+  DexFileTask(BackgroundVerifier* verifier, DexFileVerification* verification)
+      : verifier_(verifier), verification_(verification) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedTrace trace(__PRETTY_FUNCTION__);
+    if (verifier_->IsShuttingDown()) {
+      ScopedObjectAccess soa(self);
+      DeleteVerification(self, verification_);
+      return;
+    }
+    const DexFile& dex_file = *verification_->dex_file;
+    std::vector<uint16_t> profile_classes;
+    std::vector<uint16_t> other_classes;
+    {
+      MutexLock mu(self, verifier_->lock_);
+      const ProfileCompilationInfo* profile = verifier_->GetProfile();
+      for (uint32_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+        const DexFile::ClassDef& class_def = dex_file.GetClassDef(i);
+        if (profile != nullptr && profile->ContainsClass(dex_file, class_def.class_idx_)) {
+          profile_classes.push_back(i);
+        } else if (verifier_->verify_all_classes_) {
+          other_classes.push_back(i);
+        }
+      }
+    }
+    VLOG(verifier) << "Background verification of " << dex_file.GetLocation() << ": "
+                   << profile_classes.size() << " profile classes, "
+                   << other_classes.size() << " other classes";
+
+    size_t num_tasks = RoundUp(profile_classes.size(), kClassesPerTask) / kClassesPerTask +
+        RoundUp(other_classes.size(), kClassesPerTask) / kClassesPerTask;
+    if (num_tasks == 0u) {
+      ScopedObjectAccess soa(self);
+      DeleteVerification(self, verification_);
+      return;
+    }
+    // Set the count before adding any task, a task may finish before the others are added.
+    verification_->num_pending_tasks.StoreRelaxed(num_tasks);
+    AddTasks(self, profile_classes, kProfileClassesPriority);
+    AddTasks(self, other_classes, kOtherClassesPriority);
+  }
+
+  int32_t GetPriority() const OVERRIDE {
+    return kDexFilePriority;
+  }
+
+ private:
+  void AddTasks(Thread* self, const std::vector<uint16_t>& class_def_indexes, int32_t priority) {
+    for (size_t begin = 0; begin < class_def_indexes.size(); begin += kClassesPerTask) {
+      size_t end = std::min(begin + kClassesPerTask, class_def_indexes.size());
+      std::vector<uint16_t> task_indexes(class_def_indexes.begin() + begin,
+                                         class_def_indexes.begin() + end);
+      verifier_->thread_pool_->AddTask(
+          self, new VerifyTask(verifier_, verification_, std::move(task_indexes), priority));
+    }
+  }
+
+  BackgroundVerifier* const verifier_;
+  DexFileVerification* const verification_;
+
+  DISALLOW_COPY_AND_ASSIGN(DexFileTask);
+};
+
+BackgroundVerifier::BackgroundVerifier(size_t num_threads, bool verify_all_classes)
+    : thread_pool_(new ThreadPool("Background verification thread pool", num_threads)),
+      verify_all_classes_(verify_all_classes),
+      shutting_down_(false),
+      lock_("background verifier lock"),
+      profile_loaded_(false) {
+  DCHECK_NE(num_threads, 0u);
+  thread_pool_->StartWorkers(Thread::Current());
+}
+
+BackgroundVerifier::~BackgroundVerifier() {
+  Thread* self = Thread::Current();
+  // Let the workers drain the queue. Once shutting down, the tasks verify nothing and only
+  // release their dex file verification, the last one also the global reference to the class
+  // loader.
+  shutting_down_.StoreRelaxed(true);
+  thread_pool_->Wait(self, false, false);
+  thread_pool_->StopWorkers(self);
+}
+
+void BackgroundVerifier::SetProfileFilename(const std::string& profile_filename) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (profile_filename != profile_filename_) {
+    profile_filename_ = profile_filename;
+    profile_.reset();
+    profile_loaded_ = false;
+  }
+}
+
+const ProfileCompilationInfo* BackgroundVerifier::GetProfile() {
+  if (!profile_loaded_ && !profile_filename_.empty()) {
+    profile_loaded_ = true;
+    // Open the profile read-only, it may be locked by the profile saver.
+    std::unique_ptr<File> file(OS::OpenFileForReading(profile_filename_.c_str()));
+    if (file != nullptr) {
+      std::unique_ptr<ProfileCompilationInfo> profile(new ProfileCompilationInfo());
+      if (profile->Load(file->Fd())) {
+        profile_ = std::move(profile);
+      } else {
+        LOG(WARNING) << "Could not load profile " << profile_filename_
+                     << " for background verification";
+      }
+    }
+  }
+  return profile_.get();
+}
+
+void BackgroundVerifier::AddDexFile(Thread* self,
+                                    const DexFile& dex_file,
+                                    ObjPtr<mirror::ClassLoader> class_loader) {
+  DCHECK(class_loader != nullptr);
+  DexFileVerification* verification = new DexFileVerification();
+  verification->dex_file = &dex_file;
+  verification->class_loader = Runtime::Current()->GetJavaVM()->AddGlobalRef(self, class_loader);
+  thread_pool_->AddTask(self, new DexFileTask(this, verification));
+}
+
+void BackgroundVerifier::Wait(Thread* self) {
+  thread_pool_->Wait(self, false, false);
+}
+
+}  // namespace verifier
+}  // namespace art
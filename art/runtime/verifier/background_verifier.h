@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_VERIFIER_BACKGROUND_VERIFIER_H_
+#define ART_RUNTIME_VERIFIER_BACKGROUND_VERIFIER_H_
+
+#include <memory>
+#include <string>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "obj_ptr.h"
+
+namespace art {
+
+class DexFile;
+class ProfileCompilationInfo;
+class Thread;
+class ThreadPool;
+
+namespace mirror {
+class ClassLoader;
+}  // namespace mirror
+
+namespace verifier {
+
+// Verifies the classes of application dex files on a pool of background threads, so that they
+// are usually verified by the time they are first initialized. Only the classes the profile of
+// the application lists, i.e. the classes resolved during previous startups, are verified,
+// unless `verify_all_classes` is set.
+//
+// A class is loaded and linked to be verified, which costs the memory of its mirror::Class, its
+// methods, fields and dex cache entries whether or not the application ever uses it. Verifying
+// all classes therefore loads every class of every application dex file; it is meant for
+// applications that end up using most of their classes.
+//
+// The result is published through the status of the class. ClassLinker::VerifyClass() finds
+// the class verified, or waits for the background thread that is verifying it.
+class BackgroundVerifier {
+ public:
+  BackgroundVerifier(size_t num_threads, bool verify_all_classes);
+  ~BackgroundVerifier();
+
+  // Use the profile to order the verification of the dex files added from now on.
+  void SetProfileFilename(const std::string& profile_filename) REQUIRES(!lock_);
+
+  // Verify the classes of `dex_file`, which was registered with `class_loader`.
+  void AddDexFile(Thread* self, const DexFile& dex_file, ObjPtr<mirror::ClassLoader> class_loader)
+      REQUIRES_SHARED(Locks::mutator_lock_);
+
+  // Wait until the classes of all the added dex files have been verified. The caller must not
+  // hold the mutator lock, the background threads need it to verify classes.
+  void Wait(Thread* self);
+
+ private:
+  class DexFileTask;
+  class VerifyTask;
+
+  bool IsShuttingDown() const {
+    return shutting_down_.LoadRelaxed();
+  }
+
+  // Returns the profile, or null if there is none. Loads the profile on first use.
+  const ProfileCompilationInfo* GetProfile() REQUIRES(lock_);
+
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // Whether the classes that are not in the profile are verified too, after the profile classes.
+  const bool verify_all_classes_;
+
+  // Set by the destructor, the tasks left in the queue then only release their resources.
+  Atomic<bool> shutting_down_;
+
+  Mutex lock_;
+  std::string profile_filename_ GUARDED_BY(lock_);
+  std::unique_ptr<ProfileCompilationInfo> profile_ GUARDED_BY(lock_);
+  bool profile_loaded_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundVerifier);
+};
+
+}  // namespace verifier
+}  // namespace art
+
+#endif  // ART_RUNTIME_VERIFIER_BACKGROUND_VERIFIER_H_
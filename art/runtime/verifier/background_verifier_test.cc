@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "background_verifier.h"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "class_linker-inl.h"
+#include "common_runtime_test.h"
+#include "dex_file-inl.h"
+#include "dex_cache_resolved_classes.h"
+#include "handle_scope-inl.h"
+#include "jit/profile_compilation_info.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "scoped_thread_state_change-inl.h"
+
+namespace art {
+namespace verifier {
+
+class BackgroundVerifierTest : public CommonRuntimeTest {
+ protected:
+  // Verify the classes of the "Nested" dex file in the background, and wait for the pool.
+  void VerifyNested(BackgroundVerifier* background_verifier) {
+    Thread* self = Thread::Current();
+    {
+      ScopedObjectAccess soa(self);
+      jclass_loader_ = LoadDex("Nested");
+      dex_files_ = GetDexFiles(jclass_loader_);
+      ASSERT_EQ(dex_files_.size(), 1u);
+      background_verifier->AddDexFile(self,
+                                      *dex_files_[0],
+                                      soa.Decode<mirror::ClassLoader>(jclass_loader_));
+    }
+    ScopedThreadSuspension sts(self, kNative);
+    background_verifier->Wait(self);
+  }
+
+  // Returns the class of class def `class_def_index`, or null if it was not loaded. The class
+  // is looked up, so that the test does not load it.
+  ObjPtr<mirror::Class> LookupNestedClass(uint16_t class_def_index)
+      REQUIRES_SHARED(Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    const DexFile& dex_file = *dex_files_[0];
+    const char* descriptor = dex_file.GetClassDescriptor(dex_file.GetClassDef(class_def_index));
+    return class_linker_->LookupClass(
+        self, descriptor, self->DecodeJObject(jclass_loader_)->AsClassLoader());
+  }
+
+  jobject jclass_loader_;
+  std::vector<const DexFile*> dex_files_;
+};
+
+TEST_F(BackgroundVerifierTest, VerifiesAllClasses) {
+  BackgroundVerifier background_verifier(/* num_threads */ 2u, /* verify_all_classes */ true);
+  VerifyNested(&background_verifier);
+
+  ScopedObjectAccess soa(Thread::Current());
+  for (size_t i = 0; i != dex_files_[0]->NumClassDefs(); ++i) {
+    // The classes were loaded and verified by the pool.
+    ObjPtr<mirror::Class> klass = LookupNestedClass(i);
+    ASSERT_TRUE(klass != nullptr) << i;
+    EXPECT_TRUE(klass->IsVerified()) << klass->PrettyDescriptor();
+  }
+}
+
+TEST_F(BackgroundVerifierTest, WithoutProfileLoadsNoClass) {
+  BackgroundVerifier background_verifier(/* num_threads */ 2u, /* verify_all_classes */ false);
+  VerifyNested(&background_verifier);
+
+  ScopedObjectAccess soa(Thread::Current());
+  for (size_t i = 0; i != dex_files_[0]->NumClassDefs(); ++i) {
+    EXPECT_TRUE(LookupNestedClass(i) == nullptr) << i;
+  }
+}
+
+TEST_F(BackgroundVerifierTest, VerifiesProfileClasses) {
+  // The profile lists the first class of the dex file. Its dex location and checksum are those
+  // of the dex file LoadDex() opens.
+  std::set<DexCacheResolvedClasses> resolved_classes;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Nested"));
+    ASSERT_GT(dex_file->NumClassDefs(), 1u);
+    DexCacheResolvedClasses classes(dex_file->GetLocation(),
+                                    dex_file->GetBaseLocation(),
+                                    dex_file->GetLocationChecksum());
+    classes.AddClass(dex_file->GetClassDef(0).class_idx_);
+    resolved_classes.insert(classes);
+  }
+  ProfileCompilationInfo profile;
+  ASSERT_TRUE(profile.AddMethodsAndClasses(std::vector<ProfileMethodInfo>(), resolved_classes));
+  ScratchFile profile_file;
+  ASSERT_TRUE(profile.Save(profile_file.GetFd()));
+  ASSERT_EQ(profile_file.GetFile()->Flush(), 0);
+
+  BackgroundVerifier background_verifier(/* num_threads */ 2u, /* verify_all_classes */ false);
+  background_verifier.SetProfileFilename(profile_file.GetFilename());
+  VerifyNested(&background_verifier);
+
+  // Only the profile class was loaded and verified.
+  ScopedObjectAccess soa(Thread::Current());
+  ObjPtr<mirror::Class> klass = LookupNestedClass(0);
+  ASSERT_TRUE(klass != nullptr);
+  EXPECT_TRUE(klass->IsVerified()) << klass->PrettyDescriptor();
+  for (size_t i = 1; i != dex_files_[0]->NumClassDefs(); ++i) {
+    EXPECT_TRUE(LookupNestedClass(i) == nullptr) << i;
+  }
+}
+
+TEST_F(BackgroundVerifierTest, DestroyWithPendingTasks) {
+  Thread* self = Thread::Current();
+  std::unique_ptr<BackgroundVerifier> background_verifier(
+      new BackgroundVerifier(/* num_threads */ 1u, /* verify_all_classes */ true));
+  {
+    ScopedObjectAccess soa(self);
+    jobject jclass_loader = LoadDex("Nested");
+    std::vector<const DexFile*> dex_files = GetDexFiles(jclass_loader);
+    ASSERT_EQ(dex_files.size(), 1u);
+    background_verifier->AddDexFile(self,
+                                    *dex_files[0],
+                                    soa.Decode<mirror::ClassLoader>(jclass_loader));
+  }
+  // The destructor drains the queue without verifying, the tasks only release their resources.
+  ScopedThreadSuspension sts(self, kNative);
+  background_verifier.reset();
+}
+
+}  // namespace verifier
+}  // namespace art
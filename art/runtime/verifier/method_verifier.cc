@@ -91,6 +91,12 @@ void PcToRegisterLineTable::Init(RegisterTrackingMode mode, InstructionFlags* fl
       case kTrackRegsBranches:
         interesting = flags[i].IsBranchTarget();
         break;
+      case kTrackRegsBranchesAndCheckCasts:
+        interesting = flags[i].IsBranchTarget() ||
+            (flags[i].IsOpcode() &&
+             Instruction::At(verifier->CodeItem()->insns_ + i)->Opcode() ==
+                 Instruction::CHECK_CAST);
+        break;
       default:
         break;
     }
@@ -395,6 +401,9 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethod(Thread* self,
                           need_precise_constants,
                           false /* verify to dump */,
                           true /* allow_thread_suspension */);
+  // Only the compiler looks at the register lines once the method is verified.
+  verifier.register_tracking_mode_ =
+      (callbacks != nullptr) ? kTrackRegsBranchesAndCheckCasts : kTrackRegsBranches;
   if (verifier.Verify()) {
     // Verification completed, however failures may be pending that didn't cause the verification
     // to hard fail.
@@ -584,6 +593,7 @@ MethodVerifier::MethodVerifier(Thread* self,
       has_virtual_or_interface_invokes_(false),
       verify_to_dump_(verify_to_dump),
       allow_thread_suspension_(allow_thread_suspension),
+      register_tracking_mode_(kTrackCompilerInterestPoints),
       is_constructor_(false),
       link_(nullptr) {
   self->PushVerifier(this);
@@ -1616,7 +1626,7 @@ bool MethodVerifier::VerifyCodeFlow() {
   uint32_t insns_size = code_item_->insns_size_in_code_units_;
 
   /* Create and initialize table holding register status */
-  reg_table_.Init(kTrackCompilerInterestPoints,
+  reg_table_.Init(register_tracking_mode_,
                   insn_flags_.get(),
                   insns_size,
                   registers_size,
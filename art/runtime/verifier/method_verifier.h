@@ -52,9 +52,11 @@ class RegType;
 
 // We don't need to store the register data for many instructions, because we either only need
 // it at branch points (for verification) or GC points and branches (for verification +
-// type-precise register analysis).
+// type-precise register analysis). The compiler only queries the register data at check-casts
+// of a method it verifies, to elide the casts that always succeed.
 enum RegisterTrackingMode {
   kTrackRegsBranches,
+  kTrackRegsBranchesAndCheckCasts,
   kTrackCompilerInterestPoints,
   kTrackRegsAll,
 };
@@ -789,6 +791,11 @@ class MethodVerifier {
   // FindLocksAtDexPC, resulting in deadlocks.
   const bool allow_thread_suspension_;
 
+  // The instructions at which the register lines are kept. Every register line is copied and
+  // merged on each visit of its instruction, so VerifyMethod() only keeps the lines that are
+  // needed after verification.
+  RegisterTrackingMode register_tracking_mode_;
+
   // Whether the method seems to be a constructor. Note that this field exists as we can't trust
   // the flags in the dex file. Some older code does not mark methods named "<init>" and "<clinit>"
   // correctly.
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for SIMD reductions.
+ */
+public class Main {
+
+  /// CHECK-START: int Main.reductionInt(int[]) loop_optimization (before)
+  /// CHECK-DAG: <<Cons0:i\d+>>  IntConstant 0                 loop:none
+  /// CHECK-DAG: <<Cons1:i\d+>>  IntConstant 1                 loop:none
+  /// CHECK-DAG: <<Phi1:i\d+>>   Phi [<<Cons0>>,{{i\d+}}]      loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Phi2:i\d+>>   Phi [<<Cons0>>,{{i\d+}}]      loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Get:i\d+>>    ArrayGet [{{l\d+}},<<Phi1>>]  loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 Add [<<Phi2>>,<<Get>>]        loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 Add [<<Phi1>>,<<Cons1>>]      loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START-ARM64: int Main.reductionInt(int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Cons0:i\d+>>  IntConstant 0                 loop:none
+  /// CHECK-DAG: <<Cons4:i\d+>>  IntConstant 4                 loop:none
+  /// CHECK-DAG: <<Set:d\d+>>    VecSetScalars [<<Cons0>>]     loop:none
+  /// CHECK-DAG: <<Phi1:i\d+>>   Phi [<<Cons0>>,{{i\d+}}]      loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Phi2:d\d+>>   Phi [<<Set>>,{{d\d+}}]        loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>>   VecLoad [{{l\d+}},<<Phi1>>]   loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 VecAdd [<<Phi2>>,<<Load>>]    loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 Add [<<Phi1>>,<<Cons4>>]      loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>    VecReduce [<<Phi2>>] kind:sum loop:none
+  /// CHECK-DAG:                 VecExtractScalar [<<Red>>]    loop:none
+  private static int reductionInt(int[] x) {
+    int sum = 0;
+    for (int i = 0; i < x.length; i++) {
+      sum += x[i];
+    }
+    return sum;
+  }
+
+  /// CHECK-START-ARM64: int Main.reductionIntMinus(int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Cons0:i\d+>>  IntConstant 0                 loop:none
+  /// CHECK-DAG: <<Set:d\d+>>    VecSetScalars [<<Cons0>>]     loop:none
+  /// CHECK-DAG: <<Phi2:d\d+>>   Phi [<<Set>>,{{d\d+}}]        loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>>   VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 VecSub [<<Phi2>>,<<Load>>]    loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>    VecReduce [<<Phi2>>] kind:sum loop:none
+  /// CHECK-DAG:                 VecExtractScalar [<<Red>>]    loop:none
+  private static int reductionIntMinus(int[] x) {
+    int sum = 0;
+    for (int i = 0; i < x.length; i++) {
+      sum -= x[i];
+    }
+    return sum;
+  }
+
+  /// CHECK-START-ARM64: int Main.reductionMinInt(int[]) loop_optimization (after)
+  /// CHECK-DAG: <<ConsM:i\d+>>  IntConstant 2147483647        loop:none
+  /// CHECK-DAG: <<Rep:d\d+>>    VecReplicateScalar [<<ConsM>>] loop:none
+  /// CHECK-DAG: <<Phi2:d\d+>>   Phi [<<Rep>>,{{d\d+}}]        loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>>   VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 VecMin [<<Phi2>>,<<Load>>]    loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>    VecReduce [<<Phi2>>] kind:min loop:none
+  /// CHECK-DAG:                 VecExtractScalar [<<Red>>]    loop:none
+  private static int reductionMinInt(int[] x) {
+    int min = Integer.MAX_VALUE;
+    for (int i = 0; i < x.length; i++) {
+      min = Math.min(min, x[i]);
+    }
+    return min;
+  }
+
+  /// CHECK-START-ARM64: int Main.reductionMaxInt(int[]) loop_optimization (after)
+  /// CHECK-DAG: <<ConsM:i\d+>>  IntConstant -2147483648       loop:none
+  /// CHECK-DAG: <<Rep:d\d+>>    VecReplicateScalar [<<ConsM>>] loop:none
+  /// CHECK-DAG: <<Phi2:d\d+>>   Phi [<<Rep>>,{{d\d+}}]        loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>>   VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 VecMax [<<Phi2>>,<<Load>>]    loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>    VecReduce [<<Phi2>>] kind:max loop:none
+  /// CHECK-DAG:                 VecExtractScalar [<<Red>>]    loop:none
+  private static int reductionMaxInt(int[] x) {
+    int max = Integer.MIN_VALUE;
+    for (int i = 0; i < x.length; i++) {
+      max = Math.max(max, x[i]);
+    }
+    return max;
+  }
+
+  /// CHECK-START-ARM64: long Main.reductionLong(long[]) loop_optimization (after)
+  /// CHECK-DAG: <<Cons0:j\d+>>  LongConstant 0                loop:none
+  /// CHECK-DAG: <<Set:d\d+>>    VecSetScalars [<<Cons0>>]     loop:none
+  /// CHECK-DAG: <<Phi2:d\d+>>   Phi [<<Set>>,{{d\d+}}]        loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>>   VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 VecAdd [<<Phi2>>,<<Load>>]    loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>    VecReduce [<<Phi2>>] kind:sum loop:none
+  /// CHECK-DAG:                 VecExtractScalar [<<Red>>]    loop:none
+  private static long reductionLong(long[] x) {
+    long sum = 0;
+    for (int i = 0; i < x.length; i++) {
+      sum += x[i];
+    }
+    return sum;
+  }
+
+  // Reassociating a floating-point sum changes its rounding, so it is never vectorized.
+  //
+  /// CHECK-START: float Main.reductionFloat(float[]) loop_optimization (after)
+  /// CHECK-NOT: VecReduce
+  private static float reductionFloat(float[] x) {
+    float sum = 0;
+    for (int i = 0; i < x.length; i++) {
+      sum += x[i];
+    }
+    return sum;
+  }
+
+  /// CHECK-START-ARM64: float Main.reductionMinFloat(float[]) loop_optimization (after)
+  /// CHECK-DAG: <<Phi2:d\d+>>   Phi                           loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Load:d\d+>>   VecLoad                       loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:                 VecMin [<<Phi2>>,<<Load>>]    loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Red:d\d+>>    VecReduce [<<Phi2>>] kind:min loop:none
+  /// CHECK-DAG:                 VecExtractScalar [<<Red>>]    loop:none
+  private static float reductionMinFloat(float[] x) {
+    float min = Float.POSITIVE_INFINITY;
+    for (int i = 0; i < x.length; i++) {
+      min = Math.min(min, x[i]);
+    }
+    return min;
+  }
+
+  //
+  // Test driver.
+  //
+
+  public static void main(String[] args) {
+    // Test various lengths, with and without a scalar cleanup loop.
+    for (int n = 0; n < 40; n++) {
+      int[] xi = new int[n];
+      long[] xl = new long[n];
+      float[] xf = new float[n];
+      int sum = 0;
+      int min = Integer.MAX_VALUE;
+      int max = Integer.MIN_VALUE;
+      float minf = Float.POSITIVE_INFINITY;
+      for (int i = 0; i < n; i++) {
+        int v = (i * 7919) % 101 - 50;
+        xi[i] = v;
+        xl[i] = v * 0x100000001L;
+        xf[i] = v * 0.25f;
+        sum += v;
+        min = Math.min(min, v);
+        max = Math.max(max, v);
+        minf = Math.min(minf, v * 0.25f);
+      }
+      expectEquals(sum, reductionInt(xi));
+      expectEquals(-sum, reductionIntMinus(xi));
+      expectEquals(min, reductionMinInt(xi));
+      expectEquals(max, reductionMaxInt(xi));
+      expectEquals(sum * 0x100000001L, reductionLong(xl));
+      expectEquals(sum * 0.25f, reductionFloat(xf));
+      expectEquals(minf, reductionMinFloat(xf));
+    }
+
+    // Wrap around, and extreme values.
+    int[] xi = { Integer.MAX_VALUE, 1, 2, 3, 4, 5, 6, 7, Integer.MIN_VALUE };
+    expectEquals(27, reductionInt(xi));
+    expectEquals(Integer.MIN_VALUE, reductionMinInt(xi));
+    expectEquals(Integer.MAX_VALUE, reductionMaxInt(xi));
+
+    // Math.min semantics of NaN and signed zeros.
+    float[] xf = { 1.0f, 0.0f, -0.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f };
+    expectEquals(-0.0f, reductionMinFloat(xf));
+    xf[5] = Float.NaN;
+    expectEquals(Float.NaN, reductionMinFloat(xf));
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(long expected, long result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(float expected, float result) {
+    // Compare bits, to tell -0.0f from 0.0f and to match NaN.
+    if (Float.floatToIntBits(expected) != Float.floatToIntBits(result)) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
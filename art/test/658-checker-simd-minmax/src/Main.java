@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Tests for MIN/MAX vectorization.
+ */
+public class Main {
+
+  /// CHECK-START: void Main.doitMin(int[], int[], int[]) loop_optimization (before)
+  /// CHECK-DAG: <<Get1:i\d+>> ArrayGet                              loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Get2:i\d+>> ArrayGet                              loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Min:i\d+>>  InvokeStaticOrDirect [<<Get1>>,<<Get2>>] intrinsic:MathMinIntInt loop:<<Loop>> outer_loop:none
+  /// CHECK-DAG:               ArraySet [{{l\d+}},{{i\d+}},<<Min>>]  loop:<<Loop>>      outer_loop:none
+  //
+  /// CHECK-START-ARM64: void Main.doitMin(int[], int[], int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Get1:d\d+>> VecLoad                               loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Get2:d\d+>> VecLoad                               loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Min:d\d+>>  VecMin [<<Get1>>,<<Get2>>]            loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               VecStore [{{l\d+}},{{i\d+}},<<Min>>]  loop:<<Loop>>      outer_loop:none
+  private static void doitMin(int[] x, int[] y, int[] z) {
+    int min = Math.min(x.length, Math.min(y.length, z.length));
+    for (int i = 0; i < min; i++) {
+      x[i] = Math.min(y[i], z[i]);
+    }
+  }
+
+  /// CHECK-START-ARM64: void Main.doitMax(int[], int[], int[]) loop_optimization (after)
+  /// CHECK-DAG: <<Get1:d\d+>> VecLoad                               loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Get2:d\d+>> VecLoad                               loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Max:d\d+>>  VecMax [<<Get1>>,<<Get2>>]            loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               VecStore [{{l\d+}},{{i\d+}},<<Max>>]  loop:<<Loop>>      outer_loop:none
+  private static void doitMax(int[] x, int[] y, int[] z) {
+    int min = Math.min(x.length, Math.min(y.length, z.length));
+    for (int i = 0; i < min; i++) {
+      x[i] = Math.max(y[i], z[i]);
+    }
+  }
+
+  /// CHECK-START-ARM64: void Main.doitMinFloat(float[], float[], float[]) loop_optimization (after)
+  /// CHECK-DAG: <<Get1:d\d+>> VecLoad                               loop:<<Loop:B\d+>> outer_loop:none
+  /// CHECK-DAG: <<Get2:d\d+>> VecLoad                               loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG: <<Min:d\d+>>  VecMin [<<Get1>>,<<Get2>>]            loop:<<Loop>>      outer_loop:none
+  /// CHECK-DAG:               VecStore [{{l\d+}},{{i\d+}},<<Min>>]  loop:<<Loop>>      outer_loop:none
+  private static void doitMinFloat(float[] x, float[] y, float[] z) {
+    int min = Math.min(x.length, Math.min(y.length, z.length));
+    for (int i = 0; i < min; i++) {
+      x[i] = Math.min(y[i], z[i]);
+    }
+  }
+
+  // The lanes of a char array are unsigned, there is no vector min/max for them.
+  //
+  /// CHECK-START: void Main.doitMinChar(char[], char[], char[]) loop_optimization (after)
+  /// CHECK-NOT: VecMin
+  private static void doitMinChar(char[] x, char[] y, char[] z) {
+    int min = Math.min(x.length, Math.min(y.length, z.length));
+    for (int i = 0; i < min; i++) {
+      x[i] = (char) Math.min(y[i], z[i]);
+    }
+  }
+
+  // Math.max of long is not vectorized.
+  //
+  /// CHECK-START: void Main.doitMaxLong(long[], long[], long[]) loop_optimization (after)
+  /// CHECK-NOT: VecMax
+  private static void doitMaxLong(long[] x, long[] y, long[] z) {
+    int min = Math.min(x.length, Math.min(y.length, z.length));
+    for (int i = 0; i < min; i++) {
+      x[i] = Math.max(y[i], z[i]);
+    }
+  }
+
+  //
+  // Test driver.
+  //
+
+  public static void main(String[] args) {
+    int[] interesting = {
+      0, 1, -1, 2, -2, 1000, -1000, Integer.MAX_VALUE, Integer.MIN_VALUE,
+      Integer.MAX_VALUE - 1, Integer.MIN_VALUE + 1
+    };
+    int n = interesting.length * interesting.length;
+    int[] xi = new int[n];
+    int[] yi = new int[n];
+    int[] zi = new int[n];
+    long[] xl = new long[n];
+    long[] yl = new long[n];
+    long[] zl = new long[n];
+    char[] xc = new char[n];
+    char[] yc = new char[n];
+    char[] zc = new char[n];
+    for (int i = 0, k = 0; i < interesting.length; i++) {
+      for (int j = 0; j < interesting.length; j++, k++) {
+        yi[k] = interesting[i];
+        zi[k] = interesting[j];
+        yl[k] = interesting[i] * 0x100000001L;
+        zl[k] = interesting[j] * 0x100000001L;
+        yc[k] = (char) interesting[i];
+        zc[k] = (char) interesting[j];
+      }
+    }
+    doitMin(xi, yi, zi);
+    for (int i = 0; i < n; i++) {
+      expectEquals(Math.min(yi[i], zi[i]), xi[i]);
+    }
+    doitMax(xi, yi, zi);
+    for (int i = 0; i < n; i++) {
+      expectEquals(Math.max(yi[i], zi[i]), xi[i]);
+    }
+    doitMaxLong(xl, yl, zl);
+    for (int i = 0; i < n; i++) {
+      expectEquals(Math.max(yl[i], zl[i]), xl[i]);
+    }
+    doitMinChar(xc, yc, zc);
+    for (int i = 0; i < n; i++) {
+      expectEquals((char) Math.min(yc[i], zc[i]), xc[i]);
+    }
+
+    float[] interestingf = {
+      0.0f, -0.0f, 1.0f, -1.0f, Float.NaN, Float.MIN_VALUE, Float.MAX_VALUE,
+      Float.POSITIVE_INFINITY, Float.NEGATIVE_INFINITY
+    };
+    int nf = interestingf.length * interestingf.length;
+    float[] xf = new float[nf];
+    float[] yf = new float[nf];
+    float[] zf = new float[nf];
+    for (int i = 0, k = 0; i < interestingf.length; i++) {
+      for (int j = 0; j < interestingf.length; j++, k++) {
+        yf[k] = interestingf[i];
+        zf[k] = interestingf[j];
+      }
+    }
+    doitMinFloat(xf, yf, zf);
+    for (int i = 0; i < nf; i++) {
+      expectEquals(Math.min(yf[i], zf[i]), xf[i]);
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(long expected, long result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+
+  private static void expectEquals(float expected, float result) {
+    // Compare bits, to tell -0.0f from 0.0f and to match NaN.
+    if (Float.floatToIntBits(expected) != Float.floatToIntBits(result)) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class A {
+  int f;
+  int g;
+}
+
+/**
+ * Tests for hoisting loads that the loop's side effects may write, but whose heap
+ * location is not written by any store of the loop.
+ */
+public class Main {
+
+  /// CHECK-START: void Main.otherFieldStore(A, int) licm (before)
+  /// CHECK-DAG: InstanceFieldGet field_name:A.f loop:{{B\d+}}
+  /// CHECK-DAG: InstanceFieldGet field_name:A.g loop:{{B\d+}}
+  /// CHECK-DAG: InstanceFieldSet field_name:A.g loop:{{B\d+}}
+  //
+  /// CHECK-START: void Main.otherFieldStore(A, int) licm (after)
+  /// CHECK-DAG: InstanceFieldGet field_name:A.f loop:none
+  /// CHECK-DAG: InstanceFieldGet field_name:A.g loop:{{B\d+}}
+  /// CHECK-DAG: InstanceFieldSet field_name:A.g loop:{{B\d+}}
+  private static void otherFieldStore(A a, int n) {
+    for (int i = 0; i < n; i++) {
+      a.g += a.f;
+    }
+  }
+
+  // The store to `b.f` may write `a.f`.
+  //
+  /// CHECK-START: void Main.sameFieldOtherObject(A, A, int) licm (after)
+  /// CHECK-DAG: InstanceFieldGet field_name:A.f loop:<<Loop:B\d+>>
+  /// CHECK-DAG: InstanceFieldSet field_name:A.f loop:<<Loop>>
+  private static void sameFieldOtherObject(A a, A b, int n) {
+    for (int i = 0; i < n; i++) {
+      b.f += a.f;
+    }
+  }
+
+  // The invoke may write any heap location.
+  //
+  /// CHECK-START: void Main.otherFieldStoreAndInvoke(A, int) licm (after)
+  /// CHECK-DAG: InstanceFieldGet field_name:A.f loop:<<Loop:B\d+>>
+  /// CHECK-DAG: InvokeStaticOrDirect loop:<<Loop>>
+  private static void otherFieldStoreAndInvoke(A a, int n) {
+    for (int i = 0; i < n; i++) {
+      a.g += a.f;
+      $noinline$clobber(a);
+    }
+  }
+
+  private static void $noinline$clobber(A a) {
+    if (doThrow) {
+      throw new Error();
+    }
+    a.f++;
+  }
+
+  static boolean doThrow = false;
+
+  //
+  // Test driver.
+  //
+
+  public static void main(String[] args) {
+    A a = new A();
+    a.f = 3;
+    otherFieldStore(a, 10);
+    expectEquals(3, a.f);
+    expectEquals(30, a.g);
+
+    // Aliased objects.
+    a.f = 1;
+    sameFieldOtherObject(a, a, 10);
+    expectEquals(1024, a.f);
+    A b = new A();
+    b.f = 5;
+    sameFieldOtherObject(a, b, 4);
+    expectEquals(1024, a.f);
+    expectEquals(5 + 4 * 1024, b.f);
+
+    a.f = 1;
+    a.g = 0;
+    otherFieldStoreAndInvoke(a, 4);
+    expectEquals(5, a.f);
+    expectEquals(1 + 2 + 3 + 4, a.g);
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class A {
+  int f;
+  Object o;
+}
+
+/**
+ * Tests for loads after a merge whose heap location has a different known value in
+ * each predecessor.
+ */
+public class Main {
+
+  /// CHECK-START: int Main.storesInBothBranches(A, boolean) load_store_elimination (before)
+  /// CHECK-DAG: InstanceFieldGet field_name:A.f
+  //
+  /// CHECK-START: int Main.storesInBothBranches(A, boolean) load_store_elimination (after)
+  /// CHECK-NOT: InstanceFieldGet
+  //
+  /// CHECK-START: int Main.storesInBothBranches(A, boolean) load_store_elimination (after)
+  /// CHECK-DAG: <<Phi:i\d+>> Phi [{{i\d+}},{{i\d+}}]
+  /// CHECK-DAG:              Return [<<Phi>>]
+  private static int storesInBothBranches(A a, boolean b) {
+    if (b) {
+      a.f = 1;
+    } else {
+      a.f = 2;
+    }
+    return a.f;
+  }
+
+  /// CHECK-START: int Main.loadAndStore(A, boolean) load_store_elimination (before)
+  /// CHECK-DAG: InstanceFieldGet field_name:A.f
+  /// CHECK-DAG: InstanceFieldGet field_name:A.f
+  //
+  /// CHECK-START: int Main.loadAndStore(A, boolean) load_store_elimination (after)
+  /// CHECK:     InstanceFieldGet field_name:A.f
+  /// CHECK-NOT: InstanceFieldGet field_name:A.f
+  private static int loadAndStore(A a, boolean b) {
+    int x;
+    if (b) {
+      x = a.f;
+    } else {
+      a.f = 3;
+      x = 4;
+    }
+    return a.f + x;
+  }
+
+  // The value is only known in one predecessor, so the load is kept.
+  //
+  /// CHECK-START: int Main.storeInOneBranch(A, boolean) load_store_elimination (after)
+  /// CHECK-DAG: InstanceFieldGet field_name:A.f
+  private static int storeInOneBranch(A a, boolean b) {
+    if (b) {
+      a.f = 5;
+    }
+    return a.f;
+  }
+
+  // References are not merged.
+  //
+  /// CHECK-START: java.lang.Object Main.referenceStores(A, boolean, java.lang.Object, java.lang.Object) load_store_elimination (after)
+  /// CHECK-DAG: InstanceFieldGet field_name:A.o
+  private static Object referenceStores(A a, boolean b, Object x, Object y) {
+    if (b) {
+      a.o = x;
+    } else {
+      a.o = y;
+    }
+    return a.o;
+  }
+
+  //
+  // Test driver.
+  //
+
+  public static void main(String[] args) {
+    A a = new A();
+    expectEquals(1, storesInBothBranches(a, true));
+    expectEquals(2, storesInBothBranches(a, false));
+    expectEquals(2, a.f);
+
+    a.f = 6;
+    expectEquals(12, loadAndStore(a, true));
+    expectEquals(7, loadAndStore(a, false));
+    expectEquals(3, a.f);
+
+    expectEquals(3, storeInOneBranch(a, false));
+    expectEquals(5, storeInOneBranch(a, true));
+
+    Object x = new Object();
+    Object y = new Object();
+    if (referenceStores(a, true, x, y) != x || referenceStores(a, false, x, y) != y) {
+      throw new Error("Wrong reference loaded");
+    }
+
+    System.out.println("passed");
+  }
+
+  private static void expectEquals(int expected, int result) {
+    if (expected != result) {
+      throw new Error("Expected: " + expected + ", found: " + result);
+    }
+  }
+}
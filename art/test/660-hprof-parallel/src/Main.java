@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.io.BufferedInputStream;
+import java.io.DataInputStream;
+import java.io.EOFException;
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.lang.reflect.Method;
+import java.nio.ByteBuffer;
+import java.util.HashMap;
+import java.util.HashSet;
+
+public class Main {
+  static class Node {
+    Node next;
+    int value;
+    String name;
+  }
+
+  private static final int NUM_NODES = 50000;
+
+  // Keeps the nodes live during the dump.
+  private static Node head;
+
+  public static void main(String[] args) throws Exception {
+    // Enough objects for the heap to be split in several parts, dumped by different threads.
+    for (int i = 0; i < NUM_NODES; ++i) {
+      Node node = new Node();
+      node.next = head;
+      node.value = i;
+      node.name = "node" + i;
+      head = node;
+    }
+
+    File file = File.createTempFile("660-hprof-parallel", ".hprof");
+    try {
+      Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+      Method dumpHprofData = vmDebug.getDeclaredMethod("dumpHprofData", String.class);
+      dumpHprofData.invoke(null, file.getAbsolutePath());
+
+      HprofChecker checker = new HprofChecker();
+      checker.check(file);
+      if (checker.numberOfNodes != NUM_NODES) {
+        throw new Error("Expected " + NUM_NODES + " nodes, found " + checker.numberOfNodes);
+      }
+    } finally {
+      file.delete();
+    }
+
+    System.out.println("passed");
+  }
+
+  // Parses a heap dump, checking that each string and class record precedes the records that
+  // refer to it and that each object is dumped once.
+  static class HprofChecker {
+    private static final int TAG_STRING = 0x01;
+    private static final int TAG_LOAD_CLASS = 0x02;
+    private static final int TAG_HEAP_DUMP = 0x0c;
+    private static final int TAG_HEAP_DUMP_SEGMENT = 0x1c;
+    private static final int TAG_HEAP_DUMP_END = 0x2c;
+
+    private static final int BASIC_OBJECT = 2;
+
+    private int idSize;
+    private final HashMap<Long, String> strings = new HashMap<Long, String>();
+    private final HashMap<Long, String> classNames = new HashMap<Long, String>();
+    private final HashSet<Long> dumpedObjects = new HashSet<Long>();
+    int numberOfNodes;
+
+    void check(File file) throws IOException {
+      DataInputStream in =
+          new DataInputStream(new BufferedInputStream(new FileInputStream(file)));
+      try {
+        // Header: format name, size of identifiers and time stamp.
+        while (in.readByte() != 0) {
+        }
+        idSize = in.readInt();
+        if (idSize != 4 && idSize != 8) {
+          throw new Error("Unexpected identifier size " + idSize);
+        }
+        in.readLong();
+
+        while (true) {
+          int tag;
+          try {
+            tag = in.readUnsignedByte();
+          } catch (EOFException e) {
+            throw new Error("Missing HEAP DUMP END record");
+          }
+          in.readInt();  // Time.
+          byte[] body = new byte[in.readInt()];
+          in.readFully(body);
+          ByteBuffer buffer = ByteBuffer.wrap(body);
+          switch (tag) {
+            case TAG_STRING: {
+              long id = readId(buffer);
+              strings.put(id, new String(body, idSize, body.length - idSize, "UTF-8"));
+              break;
+            }
+            case TAG_LOAD_CLASS: {
+              buffer.getInt();  // Class serial number.
+              long classId = readId(buffer);
+              buffer.getInt();  // Stack trace serial number.
+              classNames.put(classId, getString(readId(buffer)));
+              break;
+            }
+            case TAG_HEAP_DUMP:
+            case TAG_HEAP_DUMP_SEGMENT:
+              while (buffer.hasRemaining()) {
+                checkHeapDumpRecord(buffer);
+              }
+              break;
+            case TAG_HEAP_DUMP_END:
+              return;
+            default:
+              break;
+          }
+        }
+      } finally {
+        in.close();
+      }
+    }
+
+    private void checkHeapDumpRecord(ByteBuffer buffer) {
+      int tag = buffer.get() & 0xff;
+      switch (tag) {
+        case 0xff:  // ROOT UNKNOWN
+        case 0x05:  // ROOT STICKY CLASS
+        case 0x07:  // ROOT MONITOR USED
+        case 0x89:  // ROOT INTERNED STRING
+        case 0x8b:  // ROOT DEBUGGER
+        case 0x8d:  // ROOT VM INTERNAL
+          readId(buffer);
+          break;
+        case 0x01:  // ROOT JNI GLOBAL
+          readId(buffer);
+          readId(buffer);
+          break;
+        case 0x02:  // ROOT JNI LOCAL
+        case 0x03:  // ROOT JAVA FRAME
+        case 0x08:  // ROOT THREAD OBJECT
+        case 0x8e:  // ROOT JNI MONITOR
+          readId(buffer);
+          buffer.getInt();
+          buffer.getInt();
+          break;
+        case 0x04:  // ROOT NATIVE STACK
+        case 0x06:  // ROOT THREAD BLOCK
+          readId(buffer);
+          buffer.getInt();
+          break;
+        case 0x20: {  // CLASS DUMP
+          long classId = readId(buffer);
+          getClassName(classId);
+          addDumpedObject(classId);
+          buffer.getInt();  // Stack trace serial number.
+          long superClassId = readId(buffer);
+          if (superClassId != 0) {
+            getClassName(superClassId);
+          }
+          for (int i = 0; i < 5; ++i) {
+            readId(buffer);  // Class loader, signers, protection domain, reserved, reserved.
+          }
+          buffer.getInt();  // Instance size.
+          int constantPoolSize = buffer.getShort() & 0xffff;
+          for (int i = 0; i < constantPoolSize; ++i) {
+            buffer.getShort();
+            skipValue(buffer, buffer.get());
+          }
+          int numberOfStaticFields = buffer.getShort() & 0xffff;
+          for (int i = 0; i < numberOfStaticFields; ++i) {
+            getString(readId(buffer));
+            skipValue(buffer, buffer.get());
+          }
+          int numberOfInstanceFields = buffer.getShort() & 0xffff;
+          for (int i = 0; i < numberOfInstanceFields; ++i) {
+            getString(readId(buffer));
+            buffer.get();
+          }
+          break;
+        }
+        case 0x21: {  // INSTANCE DUMP
+          addDumpedObject(readId(buffer));
+          buffer.getInt();  // Stack trace serial number.
+          String className = getClassName(readId(buffer));
+          if (className.equals("Main$Node")) {
+            ++numberOfNodes;
+          }
+          skip(buffer, buffer.getInt());
+          break;
+        }
+        case 0x22: {  // OBJECT ARRAY DUMP
+          addDumpedObject(readId(buffer));
+          buffer.getInt();  // Stack trace serial number.
+          int length = buffer.getInt();
+          getClassName(readId(buffer));
+          skip(buffer, length * idSize);
+          break;
+        }
+        case 0x23: {  // PRIMITIVE ARRAY DUMP
+          addDumpedObject(readId(buffer));
+          buffer.getInt();  // Stack trace serial number.
+          int length = buffer.getInt();
+          skip(buffer, length * getValueSize(buffer.get()));
+          break;
+        }
+        case 0xc3:  // PRIMITIVE ARRAY NODATA DUMP
+          readId(buffer);
+          buffer.getInt();
+          buffer.getInt();
+          buffer.get();
+          break;
+        case 0xfe:  // HEAP DUMP INFO
+          buffer.getInt();  // Heap type.
+          getString(readId(buffer));
+          break;
+        default:
+          throw new Error("Unexpected heap dump record tag " + tag);
+      }
+    }
+
+    private long readId(ByteBuffer buffer) {
+      return (idSize == 4) ? (buffer.getInt() & 0xffffffffL) : buffer.getLong();
+    }
+
+    private String getString(long id) {
+      String string = strings.get(id);
+      if (string == null) {
+        throw new Error("String " + id + " used before its STRING record");
+      }
+      return string;
+    }
+
+    private String getClassName(long classId) {
+      String className = classNames.get(classId);
+      if (className == null) {
+        throw new Error("Class " + classId + " used before its LOAD CLASS record");
+      }
+      return className;
+    }
+
+    private void addDumpedObject(long id) {
+      if (!dumpedObjects.add(id)) {
+        throw new Error("Object " + id + " dumped twice");
+      }
+    }
+
+    private int getValueSize(byte type) {
+      switch (type) {
+        case BASIC_OBJECT: return idSize;
+        case 4: return 1;  // boolean
+        case 5: return 2;  // char
+        case 6: return 4;  // float
+        case 7: return 8;  // double
+        case 8: return 1;  // byte
+        case 9: return 2;  // short
+        case 10: return 4;  // int
+        case 11: return 8;  // long
+        default: throw new Error("Unexpected basic type " + type);
+      }
+    }
+
+    private void skipValue(ByteBuffer buffer, byte type) {
+      skip(buffer, getValueSize(type));
+    }
+
+    private static void skip(ByteBuffer buffer, int length) {
+      buffer.position(buffer.position() + length);
+    }
+  }
+}
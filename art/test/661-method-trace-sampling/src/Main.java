@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.io.DataInputStream;
+import java.io.File;
+import java.io.FileDescriptor;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.lang.reflect.Method;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.HashMap;
+
+public class Main {
+  private static final int SAMPLING_INTERVAL_US = 100;
+  private static final long BUSY_LOOP_MS = 300;
+
+  public static void main(String[] args) throws Exception {
+    // Sample rings are sized after the buffer. A large buffer keeps all samples of a trace
+    // written when tracing stops.
+    testSampling(/* streaming */ false, /* buffer size */ 1024 * 1024);
+    // The smallest rings fill up after a few dozen samples of the busy loop, so the streamed
+    // trace only keeps all of them if the rings are drained while sampling.
+    testSampling(/* streaming */ true, /* buffer size */ 4 * 1024);
+    System.out.println("passed");
+  }
+
+  private static void testSampling(boolean streaming, int bufferSize) throws Exception {
+    Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+    Method startMethodTracing = vmDebug.getDeclaredMethod("startMethodTracing",
+        String.class, FileDescriptor.class, Integer.TYPE, Integer.TYPE, Boolean.TYPE,
+        Integer.TYPE, Boolean.TYPE);
+    Method stopMethodTracing = vmDebug.getDeclaredMethod("stopMethodTracing");
+
+    File file = File.createTempFile("661-method-trace-sampling", ".trace");
+    try {
+      FileOutputStream out = new FileOutputStream(file);
+      try {
+        startMethodTracing.invoke(null, file.getPath(), out.getFD(), bufferSize, 0,
+            /* samplingEnabled */ true, SAMPLING_INTERVAL_US, streaming);
+        try {
+          busyLoop();
+        } finally {
+          stopMethodTracing.invoke(null);
+        }
+      } finally {
+        out.close();
+      }
+
+      TraceChecker checker = new TraceChecker(streaming);
+      checker.check(readFile(file));
+      String mode = streaming ? "streaming" : "file";
+      if (checker.busyLoopEntries == 0) {
+        throw new Error(mode + ": no sample of Main.busyLoop");
+      }
+      if (!checker.summary.contains("data-file-overflow=false")) {
+        throw new Error(mode + ": samples were dropped\n" + checker.summary);
+      }
+    } finally {
+      file.delete();
+    }
+  }
+
+  static int result;
+
+  private static void busyLoop() {
+    long end = System.nanoTime() + BUSY_LOOP_MS * 1000000L;
+    int x = 0;
+    while (System.nanoTime() < end) {
+      x = $noinline$spin(x);
+    }
+    result = x;
+  }
+
+  private static int $noinline$spin(int x) {
+    for (int i = 0; i < 1000; ++i) {
+      x = x * 31 + i;
+    }
+    return x;
+  }
+
+  private static byte[] readFile(File file) throws IOException {
+    byte[] data = new byte[(int) file.length()];
+    DataInputStream in = new DataInputStream(new FileInputStream(file));
+    try {
+      in.readFully(data);
+    } finally {
+      in.close();
+    }
+    return data;
+  }
+
+  // Parses a sampled method trace, checking that the records of each thread are well nested
+  // method entries and exits of known methods, in wall clock order.
+  static class TraceChecker {
+    private static final int MAGIC = 0x574f4c53;
+    private static final int HEADER_LENGTH = 32;
+
+    private static final int ACTION_MASK = 0x03;
+    private static final int ACTION_ENTER = 0x00;
+    private static final int ACTION_EXIT = 0x01;
+
+    private static final int OP_NEW_METHOD = 1;
+    private static final int OP_NEW_THREAD = 2;
+    private static final int OP_TRACE_SUMMARY = 3;
+
+    private final boolean streaming;
+    private final HashMap<Integer, String> methods = new HashMap<Integer, String>();
+    private final HashMap<Integer, ArrayList<Integer>> stacks =
+        new HashMap<Integer, ArrayList<Integer>>();
+    private final HashMap<Integer, Long> lastWallClocks = new HashMap<Integer, Long>();
+    private int recordSize;
+    String summary = "";
+    int busyLoopEntries;
+
+    TraceChecker(boolean streaming) {
+      this.streaming = streaming;
+    }
+
+    void check(byte[] data) throws IOException {
+      ByteBuffer buffer = ByteBuffer.wrap(data).order(ByteOrder.LITTLE_ENDIAN);
+      if (!streaming) {
+        // The summary, with the method list, precedes the records.
+        int end = indexOf(data, "*end\n") + "*end\n".length();
+        summary = new String(data, 0, end, "UTF-8");
+        parseMethods(summary);
+        buffer.position(end);
+      }
+      int start = buffer.position();
+      if (buffer.getInt() != MAGIC) {
+        throw new Error("Bad magic");
+      }
+      buffer.getShort();  // Version.
+      if (buffer.getShort() != HEADER_LENGTH) {
+        throw new Error("Bad header length");
+      }
+      buffer.getLong();  // Start time.
+      recordSize = buffer.getShort();
+      if (recordSize == 0) {
+        recordSize = 10;  // Version 2, single clock.
+      }
+      buffer.position(start + HEADER_LENGTH);
+
+      while (buffer.hasRemaining()) {
+        int tid = buffer.getShort() & 0xffff;
+        if (streaming && tid == 0) {
+          int op = buffer.get();
+          if (op == OP_NEW_METHOD) {
+            parseMethods(readString(buffer, buffer.getShort() & 0xffff));
+          } else if (op == OP_NEW_THREAD) {
+            buffer.getShort();  // Thread id.
+            readString(buffer, buffer.getShort() & 0xffff);
+          } else if (op == OP_TRACE_SUMMARY) {
+            summary = readString(buffer, buffer.getInt());
+            return;
+          } else {
+            throw new Error("Unknown op " + op);
+          }
+          continue;
+        }
+        int recordStart = buffer.position() - 2;
+        checkRecord(tid, buffer.getInt(), buffer, recordStart);
+        buffer.position(recordStart + recordSize);
+      }
+      if (streaming) {
+        throw new Error("Missing trace summary");
+      }
+    }
+
+    private void checkRecord(int tid, int methodValue, ByteBuffer buffer, int recordStart) {
+      int method = methodValue & ~ACTION_MASK;
+      String name = methods.get(method);
+      if (name == null) {
+        throw new Error("Record of unknown method 0x" + Integer.toHexString(method));
+      }
+      ArrayList<Integer> stack = stacks.get(tid);
+      if (stack == null) {
+        stack = new ArrayList<Integer>();
+        stacks.put(tid, stack);
+      }
+      int action = methodValue & ACTION_MASK;
+      if (action == ACTION_ENTER) {
+        stack.add(method);
+        if (name.equals("Main.busyLoop")) {
+          ++busyLoopEntries;
+        }
+      } else if (action == ACTION_EXIT) {
+        if (stack.isEmpty() || stack.remove(stack.size() - 1) != method) {
+          throw new Error("Exit of " + name + " that is not the innermost method");
+        }
+      } else {
+        throw new Error("Unexpected action " + action + " for " + name);
+      }
+      if (recordSize == 14) {
+        // Dual clock, the wall clock follows the thread clock.
+        long wallClock = buffer.getInt(recordStart + 10) & 0xffffffffL;
+        Long lastWallClock = lastWallClocks.put(tid, wallClock);
+        if (lastWallClock != null && wallClock < lastWallClock) {
+          throw new Error("Records of thread " + tid + " out of wall clock order");
+        }
+      }
+    }
+
+    // Adds the methods of lines "<id>\t<class>\t<name>\t<signature>\t<source file>".
+    private void parseMethods(String text) {
+      boolean inMethods = streaming;
+      for (String line : text.split("\n")) {
+        if (line.startsWith("*")) {
+          inMethods = line.equals("*methods");
+        } else if (inMethods && line.contains("\t")) {
+          // The id is printed with %#x, which gives "0" rather than "0x0" for the first method.
+          String[] fields = line.split("\t");
+          methods.put(Long.decode(fields[0]).intValue(), fields[1] + "." + fields[2]);
+        }
+      }
+    }
+
+    private static String readString(ByteBuffer buffer, int length) throws IOException {
+      byte[] bytes = new byte[length];
+      buffer.get(bytes);
+      return new String(bytes, "UTF-8");
+    }
+
+    private static int indexOf(byte[] data, String marker) throws IOException {
+      byte[] bytes = marker.getBytes("UTF-8");
+      for (int i = 0; i + bytes.length <= data.length; ++i) {
+        int j = 0;
+        while (j < bytes.length && data[i + j] == bytes[j]) {
+          ++j;
+        }
+        if (j == bytes.length) {
+          return i;
+        }
+      }
+      throw new Error("Missing " + marker);
+    }
+  }
+}
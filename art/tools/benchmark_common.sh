@@ -0,0 +1,78 @@
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Helpers shared by the host benchmark scripts in this directory, which source this file with
+#   source "$(dirname "$0")/benchmark_common.sh"
+#
+# Sourcing it creates $out_dir, a scratch directory removed when the script exits.
+
+out_dir=$(mktemp -d)
+trap 'rm -rf "$out_dir"' EXIT
+
+# Exits unless the binary exists. Usage: require_binary <name> <path> <variable setting it>
+require_binary() {
+  if [ ! -x "$2" ]; then
+    echo "Cannot find $1 at $2, set $3 or ANDROID_HOST_OUT."
+    exit 1
+  fi
+}
+
+# Sets $dex2oat and $boot_image from DEX2OAT and BOOT_IMAGE, or from ANDROID_HOST_OUT.
+setup_dex2oat() {
+  dex2oat=${DEX2OAT:-${ANDROID_HOST_OUT}/bin/dex2oat}
+  boot_image=${BOOT_IMAGE:-${ANDROID_HOST_OUT}/framework/core.art}
+  require_binary dex2oat "$dex2oat" DEX2OAT
+}
+
+# Sets the array $inputs to the arguments before "--", with the dex, apk and jar files in
+# directories, and the array $extra_flags to the arguments after it.
+# Usage: collect_inputs "$@"
+collect_inputs() {
+  inputs=()
+  while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    if [ -d "$1" ]; then
+      while IFS= read -r -d '' file; do
+        inputs+=("$file")
+      done < <(find "$1" \( -name '*.dex' -o -name '*.apk' -o -name '*.jar' \) -print0 | sort -z)
+    else
+      inputs+=("$1")
+    fi
+    shift
+  done
+  [ "$1" == "--" ] && shift
+  extra_flags=("$@")
+}
+
+# Compiles one input for x86-64 into $out_dir with the given extra dex2oat arguments, logging to
+# $out_dir/log. Sets $wall, $user and $sys to the times of the run, in seconds. Exits with the
+# end of the log if dex2oat fails.
+# Usage: run_dex2oat <input> [dex2oat arguments]...
+run_dex2oat() {
+  local input=$1
+  shift
+  /usr/bin/time -f "%e %U %S" -o "$out_dir/time" "$dex2oat" \
+      --runtime-arg -Xms64m --runtime-arg -Xmx512m \
+      --boot-image="$boot_image" \
+      --dex-file="$input" \
+      --oat-file="$out_dir/out.odex" \
+      --instruction-set=x86_64 \
+      "$@" > "$out_dir/log" 2>&1
+  if [ $? -ne 0 ]; then
+    echo "dex2oat failed on $input with $*, see below."
+    tail -n 20 "$out_dir/log"
+    exit 1
+  fi
+  # GNU time prints "<wall> <user> <sys>" on the last line of its output file.
+  read wall user sys < <(tail -n 1 "$out_dir/time")
+}
@@ -0,0 +1,53 @@
+#!/bin/bash
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Compiles one dex file with dex2oat -j1 through -jN on the host and reports the wall time and
+# how busy the N cores were, (user + sys) / (wall * N). A utilization well below 100% at high -j
+# means the workers wait on each other, typically on the last classes of the dex file.
+#
+# Usage: dex2oat_scaling.sh <dex or apk> [max threads] [runs per thread count]
+#
+# Extra dex2oat arguments can be passed in DEX2OAT_FLAGS, the dex2oat binary in DEX2OAT.
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <dex or apk> [max threads] [runs per thread count]"
+  exit 1
+fi
+
+input=$1
+max_threads=${2:-$(nproc)}
+runs=${3:-3}
+
+source "$(dirname "$0")/benchmark_common.sh"
+
+setup_dex2oat
+
+printf "%8s %12s %12s %12s\n" "threads" "wall (s)" "cpu (s)" "utilization"
+for ((threads = 1; threads <= max_threads; threads++)); do
+  best_wall=""
+  best_cpu=""
+  for ((run = 0; run < runs; run++)); do
+    run_dex2oat "$input" -j"$threads" $DEX2OAT_FLAGS
+    cpu=$(echo "$user + $sys" | bc)
+    # Keep the fastest run, the others are more likely to have been disturbed.
+    if [ -z "$best_wall" ] || [ "$(echo "$wall < $best_wall" | bc)" -eq 1 ]; then
+      best_wall=$wall
+      best_cpu=$cpu
+    fi
+  done
+  utilization=$(echo "scale=1; 100 * $best_cpu / ($best_wall * $threads)" | bc)
+  printf "%8d %12s %12s %11s%%\n" "$threads" "$best_wall" "$best_cpu" "$utilization"
+done
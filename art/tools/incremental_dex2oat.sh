@@ -0,0 +1,68 @@
+#!/bin/bash
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Measures what dex2oat --input-oat saves on the host. Compiles <old input>, then compiles
+# <new input> twice: from scratch, and with the first oat file as --input-oat. Reports both wall
+# times, how many of the methods to compile were self-contained (the only ones --input-oat can
+# reuse) and how many were reused. Without <new input>, <old input> is recompiled unchanged,
+# which gives the upper bound of the reuse.
+#
+# Usage: incremental_dex2oat.sh <old dex or apk> [new dex or apk] [-- extra dex2oat flags]
+#
+# The dex2oat binary can be given in DEX2OAT.
+
+if [ $# -lt 1 ] || [ "$1" == "--" ]; then
+  echo "Usage: $0 <old dex or apk> [new dex or apk] [-- extra dex2oat flags]"
+  exit 1
+fi
+
+old_input=$1
+shift
+new_input=$old_input
+if [ $# -gt 0 ] && [ "$1" != "--" ]; then
+  new_input=$1
+  shift
+fi
+[ "$1" == "--" ] && shift
+extra_flags=("$@")
+
+source "$(dirname "$0")/benchmark_common.sh"
+
+setup_dex2oat
+
+run_dex2oat "$old_input" "${extra_flags[@]}"
+mv "$out_dir/out.odex" "$out_dir/input.odex"
+
+run_dex2oat "$new_input" "${extra_flags[@]}"
+full_wall=$wall
+
+run_dex2oat "$new_input" --input-oat="$out_dir/input.odex" "${extra_flags[@]}"
+incremental_wall=$wall
+if grep -q "Ignoring --input-oat" "$out_dir/log"; then
+  grep "Ignoring --input-oat" "$out_dir/log"
+  exit 1
+fi
+
+# dex2oat logs "Reused the code of <reused> methods from <file>, <self-contained> of the
+# <methods> methods to compile were self-contained".
+pattern='.*Reused the code of \([0-9]*\) methods from .*, \([0-9]*\) of the \([0-9]*\) methods.*'
+read reused self_contained methods < <(sed -n "s/$pattern/\1 \2 \3/p" "$out_dir/log")
+
+printf "%-24s %s\n" "full compile (s)" "$full_wall"
+printf "%-24s %s\n" "with --input-oat (s)" "$incremental_wall"
+printf "%-24s %s\n" "methods to compile" "$methods"
+printf "%-24s %s\n" "self-contained" "$self_contained"
+printf "%-24s %s\n" "reused" "$reused"
@@ -0,0 +1,81 @@
+#!/bin/bash
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Compares the JIT with and without the baseline tier (-Xjitbaseline) on one program. Reports
+# the time of the first iteration (startup), the number of iterations until the iteration time
+# settles within 5% of the steady state (warmup), and the steady state iteration time itself.
+#
+# The program must print one line per iteration of its workload, "iteration <n> <time in ns>",
+# for example by timing the body of a loop in main with System.nanoTime(). The steady state is
+# the median of the last quarter of the iterations.
+#
+# Usage: jit_warmup.sh <dex or jar> <main class> [runs per configuration]
+#
+# Extra runtime arguments can be passed in DALVIKVM_FLAGS, the dalvikvm binary in DALVIKVM.
+
+if [ $# -lt 2 ]; then
+  echo "Usage: $0 <dex or jar> <main class> [runs per configuration]"
+  exit 1
+fi
+
+input=$1
+main_class=$2
+runs=${3:-3}
+dalvikvm=${DALVIKVM:-${ANDROID_HOST_OUT}/bin/dalvikvm64}
+
+source "$(dirname "$0")/benchmark_common.sh"
+
+require_binary dalvikvm "$dalvikvm" DALVIKVM
+
+# Prints "<first iteration us> <iterations to warm up> <steady state us>" for one run.
+summarize() {
+  local times count steady
+  times=$(awk '$1 == "iteration" { print $3 }' "$1")
+  count=$(echo "$times" | grep -c .)
+  if [ "$count" -eq 0 ]; then
+    return 1
+  fi
+  steady=$(echo "$times" | tail -n $((count / 4 + 1)) | sort -n | \
+      awk '{ t[NR] = $1 } END { print t[int((NR + 1) / 2)] }')
+  # The warmup ends at the first iteration after which all iterations stay within 5%.
+  echo "$times" | awk -v steady="$steady" '
+      { t[NR - 1] = $1 }
+      END {
+        warm = NR
+        for (i = NR - 1; i >= 0 && t[i] <= steady * 1.05; i--) { warm = i }
+        printf "%.1f %d %.1f\n", t[0] / 1000, warm, steady / 1000
+      }'
+}
+
+printf "%10s %16s %16s %16s\n" "baseline" "first iter (us)" "warmup (iters)" "steady (us)"
+for baseline in false true; do
+  for ((run = 0; run < runs; run++)); do
+    "$dalvikvm" \
+      -Xusejit:true \
+      -Xjitbaseline:$baseline \
+      $DALVIKVM_FLAGS \
+      -cp "$input" "$main_class" > "$out_dir/out" 2>&1
+    if [ $? -ne 0 ]; then
+      echo "dalvikvm failed with -Xjitbaseline:$baseline"
+      exit 1
+    fi
+    if ! read first warm steady < <(summarize "$out_dir/out"); then
+      echo "$main_class printed no \"iteration <n> <ns>\" lines"
+      exit 1
+    fi
+    printf "%10s %16s %16s %16s\n" "$baseline" "$first" "$warm" "$steady"
+  done
+done
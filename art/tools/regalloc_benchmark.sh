@@ -0,0 +1,74 @@
+#!/bin/bash
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Compiles a corpus of dex files on the host with each register allocation strategy and reports,
+# per strategy, the spill stores (of registers and of constants), reloads and rematerialized
+# constants inserted by the register allocator, the number of methods allocated with graph
+# coloring and the compile time (user + sys of a single threaded dex2oat). The compile time
+# comes from a run without --dump-stats. The counts come from a second run with --dump-stats,
+# which release builds only log with -verbose:compiler.
+#
+# Usage: regalloc_benchmark.sh <dex, apk or directory of them>... [-- extra dex2oat flags]
+#
+# A profile can be passed with -- --profile-file=<file> to see the effect of the adaptive
+# strategy on the hot methods of an app. The dex2oat binary can be set in DEX2OAT.
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <dex, apk or directory of them>... [-- extra dex2oat flags]"
+  exit 1
+fi
+
+source "$(dirname "$0")/benchmark_common.sh"
+
+collect_inputs "$@"
+setup_dex2oat
+strategies=${STRATEGIES:-"linear-scan graph-color adaptive"}
+
+# Compile one input with one strategy, extra arguments are passed to dex2oat.
+compile() {
+  local input=$1 strategy=$2
+  shift 2
+  run_dex2oat "$input" \
+      --compiler-filter=speed \
+      --register-allocation-strategy="$strategy" \
+      -j1 \
+      "$@" \
+      "${extra_flags[@]}"
+}
+
+# Sum the value of a --dump-stats counter over a dex2oat log.
+stat() {
+  sed -n "s/.*\] $1: \([0-9]*\)$/\1/p" "$2" | awk '{ sum += $1 } END { print sum + 0 }'
+}
+
+printf "%-12s %10s %10s %12s %10s %12s %12s %10s\n" \
+    "strategy" "methods" "spills" "const-spills" "reloads" "remat" "graph-color" "cpu (s)"
+for strategy in $strategies; do
+  methods=0 spills=0 const_spills=0 reloads=0 remat=0 graph_color=0 cpu=0
+  for input in "${inputs[@]}"; do
+    compile "$input" "$strategy"
+    cpu=$(echo "$cpu + $user + $sys" | bc)
+    compile "$input" "$strategy" --dump-stats --runtime-arg -verbose:compiler
+    methods=$((methods + $(stat Compiled "$out_dir/log")))
+    spills=$((spills + $(stat RegisterAllocatorSpill "$out_dir/log")))
+    const_spills=$((const_spills + $(stat RegisterAllocatorConstantSpill "$out_dir/log")))
+    reloads=$((reloads + $(stat RegisterAllocatorReload "$out_dir/log")))
+    remat=$((remat + $(stat RegisterAllocatorRematerialization "$out_dir/log")))
+    graph_color=$((graph_color + $(stat GraphColorRegisterAllocation "$out_dir/log")))
+  done
+  printf "%-12s %10d %10d %12d %10d %12d %12d %10s\n" \
+      "$strategy" "$methods" "$spills" "$const_spills" "$reloads" "$remat" "$graph_color" "$cpu"
+done
@@ -0,0 +1,59 @@
+#!/bin/bash
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Verifies a corpus of dex files on the host and reports, per input, the verification throughput
+# (KiB of input per second of user + sys time of a single threaded dex2oat) and the peak arena
+# usage, which is the "arena alloc" reported by dex2oat. With a single thread the peak arena
+# usage is the arena usage of the method verifier on the largest method of the input.
+#
+# Usage: verifier_benchmark.sh <dex, apk or directory of them>... [-- extra dex2oat flags]
+#
+# Each input is verified REPEAT times (3 by default) and the fastest run is kept. The dex2oat
+# binary can be set in DEX2OAT.
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <dex, apk or directory of them>... [-- extra dex2oat flags]"
+  exit 1
+fi
+
+source "$(dirname "$0")/benchmark_common.sh"
+
+collect_inputs "$@"
+setup_dex2oat
+repeat=${REPEAT:-3}
+
+printf "%-40s %10s %10s %12s %14s\n" "input" "size (KiB)" "cpu (s)" "KiB/s" "peak arena (B)"
+total_size=0 total_cpu=0 max_arena=0
+for input in "${inputs[@]}"; do
+  size=$(( $(stat -c %s "$input") / 1024 ))
+  best_cpu="" arena=0
+  for ((i = 0; i < repeat; i++)); do
+    run_dex2oat "$input" --compiler-filter=verify -j1 "${extra_flags[@]}"
+    cpu=$(echo "$user + $sys" | bc)
+    if [ -z "$best_cpu" ] || [ "$(echo "$cpu < $best_cpu" | bc)" -eq 1 ]; then
+      best_cpu=$cpu
+    fi
+    arena=$(sed -n 's/.*arena alloc=[^(]*(\([0-9]*\)B).*/\1/p' "$out_dir/log" | tail -n 1)
+  done
+  arena=${arena:-0}
+  printf "%-40s %10d %10s %12s %14d\n" "$(basename "$input")" "$size" "$best_cpu" \
+      "$(echo "scale=1; $size / ($best_cpu + 0.001)" | bc)" "$arena"
+  total_size=$((total_size + size))
+  total_cpu=$(echo "$total_cpu + $best_cpu" | bc)
+  [ "$arena" -gt "$max_arena" ] && max_arena=$arena
+done
+printf "%-40s %10d %10s %12s %14d\n" "total" "$total_size" "$total_cpu" \
+    "$(echo "scale=1; $total_size / ($total_cpu + 0.001)" | bc)" "$max_arena"
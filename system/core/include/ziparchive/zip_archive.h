@@ -128,6 +128,19 @@ int32_t OpenArchive(const char* fileName, ZipArchiveHandle* handle);
 int32_t OpenArchiveFd(const int fd, const char* debugFileName,
                       ZipArchiveHandle *handle, bool assume_ownership = true);
 
+/*
+ * Like OpenArchive, but consults the central directory index persisted at
+ * indexFileName to skip parsing the central directory. The index is only
+ * used if it was written for this exact archive (same length, modification
+ * time and central directory CRC), otherwise the archive is parsed as usual
+ * and the index is (re)written for the next open. Failing to write the
+ * index does not fail the open.
+ *
+ * Returns 0 on success, and negative values on failure.
+ */
+int32_t OpenArchiveWithIndex(const char* fileName, const char* indexFileName,
+                             ZipArchiveHandle* handle);
+
 int32_t OpenArchiveFromMemory(void* address, size_t length, const char* debugFileName,
                               ZipArchiveHandle *handle);
 /*
@@ -211,6 +224,33 @@ int32_t ExtractEntryToFile(ZipArchiveHandle handle, ZipEntry* entry, int fd);
 int32_t ExtractToMemory(ZipArchiveHandle handle, ZipEntry* entry,
                         uint8_t* begin, uint32_t size);
 
+/*
+ * A single entry to extract with ExtractEntries. To extract to a file,
+ * as with ExtractEntryToFile, set |fd|. To extract to memory, as with
+ * ExtractToMemory, set |fd| to -1 and supply |begin| and |size|. The
+ * outcome for the entry is returned in |result|.
+ */
+struct ZipExtractRequest {
+  ZipEntry* entry;
+  int fd;
+  uint8_t* begin;
+  uint32_t size;
+  int32_t result;
+};
+
+/*
+ * Extract |num_requests| entries, spread over up to |num_threads| threads
+ * (the calling thread included). Stored entries are not staged through an
+ * intermediate buffer: they are read directly into memory, or sent from
+ * file to file where the platform supports it. Every request must have a
+ * distinct destination.
+ *
+ * Returns 0 if all entries were extracted, otherwise the result of the
+ * first failed request.
+ */
+int32_t ExtractEntries(ZipArchiveHandle handle, ZipExtractRequest* requests,
+                       size_t num_requests, size_t num_threads);
+
 int GetFileDescriptor(const ZipArchiveHandle handle);
 
 const char* ErrorCodeString(int32_t error_code);
@@ -27,15 +27,25 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <vector>
+#if !defined(_WIN32)
+#include <thread>
+#endif
 
 #include <android-base/file.h>
 #include <android-base/logging.h>
 #include <android-base/macros.h>  // TEMP_FAILURE_RETRY may or may not be in unistd
 #include <android-base/memory.h>
+#include <android-base/unique_fd.h>
 #include <log/log.h>
 #include <utils/Compat.h>
 #include <utils/FileMap.h>
@@ -354,6 +364,8 @@ static int32_t MapCentralDirectory(const char* debug_file_name, ZipArchive* arch
   return result;
 }
 
+static int32_t CheckFirstLocalFileHeader(ZipArchive* archive);
+
 /*
  * Parses the Zip archive's Central Directory.  Allocates and populates the
  * hash table.
@@ -442,6 +454,19 @@ static int32_t ParseZipArchive(ZipArchive* archive) {
     }
   }
 
+  if (CheckFirstLocalFileHeader(archive) != 0) {
+    return -1;
+  }
+
+  ALOGV("+++ zip good scan %" PRIu16 " entries", num_entries);
+
+  return 0;
+}
+
+/*
+ * Sanity check the local file header at the start of the archive.
+ */
+static int32_t CheckFirstLocalFileHeader(ZipArchive* archive) {
   uint32_t lfh_start_bytes;
   if (!archive->mapped_zip.ReadAtOffset(reinterpret_cast<uint8_t*>(&lfh_start_bytes),
                                         sizeof(uint32_t), 0)) {
@@ -457,22 +482,225 @@ static int32_t ParseZipArchive(ZipArchive* archive) {
     return -1;
   }
 
-  ALOGV("+++ zip good scan %" PRIu16 " entries", num_entries);
-
   return 0;
 }
 
+/*
+ * The central directory index sidecar file.
+ *
+ * A persisted copy of the hash table built by ParseZipArchive, so that an
+ * archive can be opened without hashing and validating every central
+ * directory record. Slots hold the offset of the entry name within the
+ * central directory, which makes the file position independent and usable
+ * straight from a read-only mapping. The index is only trusted when the
+ * archive length, modification time and a CRC of the central directory
+ * all match the values recorded when it was written.
+ */
+struct ZipIndexHeader {
+  static const uint32_t kMagic = 0x5844495a;  // "ZIDX"
+  static const uint32_t kVersion = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint64_t file_length;
+  int64_t mtime;
+  uint32_t cd_offset;
+  uint32_t cd_size;
+  uint32_t cd_crc32;
+  uint32_t num_entries;
+  uint32_t hash_table_size;
+  uint32_t reserved;
+} __attribute__((packed));
+
+struct ZipIndexSlot {
+  // Offset of the entry name from the start of the central directory,
+  // plus one. Zero marks an empty slot.
+  uint32_t name_offset;
+  uint16_t name_length;
+  uint16_t reserved;
+} __attribute__((packed));
+
+static bool GetArchiveMtime(const ZipArchive* archive, int64_t* mtime) {
+  struct stat sb;
+  if (!archive->mapped_zip.HasFd() ||
+      fstat(archive->mapped_zip.GetFileDescriptor(), &sb) == -1) {
+    return false;
+  }
+  *mtime = sb.st_mtime;
+  return true;
+}
+
+static uint32_t CentralDirectoryCrc(const ZipArchive* archive) {
+  const uint8_t* cd_ptr = archive->central_directory.GetBasePtr();
+  const size_t cd_length = archive->central_directory.GetMapLength();
+  return crc32(crc32(0L, Z_NULL, 0), cd_ptr, cd_length);
+}
+
+/*
+ * Populate the hash table from the index at |index_file_name|. Returns
+ * false if there is no index, or it does not describe this archive.
+ */
+static bool LoadZipIndex(ZipArchive* archive, const char* index_file_name) {
+  int64_t mtime;
+  if (!GetArchiveMtime(archive, &mtime)) {
+    return false;
+  }
+
+  android::base::unique_fd fd(open(index_file_name, O_RDONLY | O_BINARY));
+  if (fd == -1) {
+    return false;
+  }
+  const off64_t index_length = lseek64(fd, 0, SEEK_END);
+  if (index_length < static_cast<off64_t>(sizeof(ZipIndexHeader))) {
+    return false;
+  }
+
+  android::FileMap index_map;
+  if (!index_map.create(index_file_name, fd, 0, index_length, true /* read only */)) {
+    return false;
+  }
+  const ZipIndexHeader* header =
+      reinterpret_cast<const ZipIndexHeader*>(index_map.getDataPtr());
+  const uint8_t* const cd_ptr = archive->central_directory.GetBasePtr();
+  const size_t cd_length = archive->central_directory.GetMapLength();
+  const uint32_t hash_table_size = RoundUpPower2(1 + (archive->num_entries * 4) / 3);
+
+  if (header->magic != ZipIndexHeader::kMagic ||
+      header->version != ZipIndexHeader::kVersion ||
+      header->file_length != static_cast<uint64_t>(archive->mapped_zip.GetFileLength()) ||
+      header->mtime != mtime ||
+      header->cd_offset != archive->directory_offset ||
+      header->cd_size != cd_length ||
+      header->num_entries != archive->num_entries ||
+      header->hash_table_size != hash_table_size ||
+      index_length != static_cast<off64_t>(sizeof(ZipIndexHeader) +
+                                           hash_table_size * sizeof(ZipIndexSlot))) {
+    ALOGV("Zip: stale index %s", index_file_name);
+    return false;
+  }
+  if (header->cd_crc32 != CentralDirectoryCrc(archive)) {
+    ALOGV("Zip: index %s central directory crc mismatch", index_file_name);
+    return false;
+  }
+
+  ZipString* hash_table = reinterpret_cast<ZipString*>(calloc(hash_table_size,
+      sizeof(ZipString)));
+  if (hash_table == nullptr) {
+    return false;
+  }
+
+  // The central directory matched when the index was written, still check
+  // every slot points at the name of a record so a corrupt index can only
+  // cost us a lookup miss.
+  const ZipIndexSlot* slots = reinterpret_cast<const ZipIndexSlot*>(header + 1);
+  uint32_t found = 0;
+  for (uint32_t i = 0; i < hash_table_size; ++i) {
+    const uint32_t name_offset = slots[i].name_offset;
+    if (name_offset == 0) {
+      continue;
+    }
+    if (name_offset - 1 < sizeof(CentralDirectoryRecord) ||
+        name_offset - 1 + slots[i].name_length > cd_length) {
+      free(hash_table);
+      return false;
+    }
+    const uint8_t* name = cd_ptr + name_offset - 1;
+    const CentralDirectoryRecord* cdr =
+        reinterpret_cast<const CentralDirectoryRecord*>(name - sizeof(CentralDirectoryRecord));
+    if (cdr->record_signature != CentralDirectoryRecord::kSignature ||
+        cdr->file_name_length != slots[i].name_length) {
+      free(hash_table);
+      return false;
+    }
+    hash_table[i].name = name;
+    hash_table[i].name_length = slots[i].name_length;
+    ++found;
+  }
+  if (found != archive->num_entries) {
+    free(hash_table);
+    return false;
+  }
+
+  archive->hash_table_size = hash_table_size;
+  archive->hash_table = hash_table;
+  return true;
+}
+
+/*
+ * Persist the hash table of a freshly parsed archive. Best effort, any
+ * failure leaves the archive to be parsed again on the next open.
+ */
+static void WriteZipIndex(const ZipArchive* archive, const char* index_file_name) {
+  int64_t mtime;
+  if (!GetArchiveMtime(archive, &mtime)) {
+    return;
+  }
+
+  ZipIndexHeader header = {};
+  header.magic = ZipIndexHeader::kMagic;
+  header.version = ZipIndexHeader::kVersion;
+  header.file_length = archive->mapped_zip.GetFileLength();
+  header.mtime = mtime;
+  header.cd_offset = archive->directory_offset;
+  header.cd_size = archive->central_directory.GetMapLength();
+  header.cd_crc32 = CentralDirectoryCrc(archive);
+  header.num_entries = archive->num_entries;
+  header.hash_table_size = archive->hash_table_size;
+
+  const uint8_t* const cd_ptr = archive->central_directory.GetBasePtr();
+  std::vector<ZipIndexSlot> slots(archive->hash_table_size);
+  for (uint32_t i = 0; i < archive->hash_table_size; ++i) {
+    const ZipString& entry = archive->hash_table[i];
+    if (entry.name != nullptr) {
+      slots[i].name_offset = static_cast<uint32_t>(entry.name - cd_ptr) + 1;
+      slots[i].name_length = entry.name_length;
+    }
+  }
+
+  // Write aside and rename, concurrent readers see an old or a new index.
+  const std::string tmp_file_name = std::string(index_file_name) + ".tmp";
+  android::base::unique_fd fd(open(tmp_file_name.c_str(),
+                                   O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644));
+  if (fd == -1) {
+    ALOGW("Zip: unable to create index %s: %s", tmp_file_name.c_str(), strerror(errno));
+    return;
+  }
+  if (!android::base::WriteFully(fd, &header, sizeof(header)) ||
+      !android::base::WriteFully(fd, slots.data(), slots.size() * sizeof(ZipIndexSlot))) {
+    ALOGW("Zip: unable to write index %s: %s", tmp_file_name.c_str(), strerror(errno));
+    unlink(tmp_file_name.c_str());
+    return;
+  }
+  fd.reset();
+  if (rename(tmp_file_name.c_str(), index_file_name) == -1) {
+    ALOGW("Zip: unable to rename index %s: %s", index_file_name, strerror(errno));
+    unlink(tmp_file_name.c_str());
+  }
+}
+
 static int32_t OpenArchiveInternal(ZipArchive* archive,
-                                   const char* debug_file_name) {
+                                   const char* debug_file_name,
+                                   const char* index_file_name = nullptr) {
   int32_t result = -1;
   if ((result = MapCentralDirectory(debug_file_name, archive)) != 0) {
     return result;
   }
 
+  if (index_file_name != nullptr && LoadZipIndex(archive, index_file_name)) {
+    if (CheckFirstLocalFileHeader(archive) != 0) {
+      return -1;
+    }
+    return 0;
+  }
+
   if ((result = ParseZipArchive(archive))) {
     return result;
   }
 
+  if (index_file_name != nullptr) {
+    WriteZipIndex(archive, index_file_name);
+  }
+
   return 0;
 }
 
@@ -496,6 +724,20 @@ int32_t OpenArchive(const char* fileName, ZipArchiveHandle* handle) {
   return OpenArchiveInternal(archive, fileName);
 }
 
+int32_t OpenArchiveWithIndex(const char* fileName, const char* indexFileName,
+                             ZipArchiveHandle* handle) {
+  const int fd = open(fileName, O_RDONLY | O_BINARY, 0);
+  ZipArchive* archive = new ZipArchive(fd, true);
+  *handle = archive;
+
+  if (fd < 0) {
+    ALOGW("Unable to open '%s': %s", fileName, strerror(errno));
+    return kIoError;
+  }
+
+  return OpenArchiveInternal(archive, fileName, indexFileName);
+}
+
 int32_t OpenArchiveFromMemory(void* address, size_t length, const char* debug_file_name,
                               ZipArchiveHandle *handle) {
   ZipArchive* archive = new ZipArchive(address, length);
@@ -514,8 +756,11 @@ void CloseArchive(ZipArchiveHandle handle) {
 
 static int32_t UpdateEntryFromDataDescriptor(MappedZipFile& mapped_zip,
                                              ZipEntry *entry) {
+  // The descriptor immediately follows the entry data.
+  const off64_t dd_offset = entry->offset + ((entry->method == kCompressStored) ?
+      entry->uncompressed_length : entry->compressed_length);
   uint8_t ddBuf[sizeof(DataDescriptor) + sizeof(DataDescriptor::kOptSignature)];
-  if (!mapped_zip.ReadData(ddBuf, sizeof(ddBuf))) {
+  if (!mapped_zip.ReadAtOffset(ddBuf, sizeof(ddBuf), dd_offset)) {
     return kIoError;
   }
 
@@ -895,6 +1140,56 @@ class FileWriter : public Writer {
 
     return result;
   }
+
+  // Appends |length| bytes read from |in_fd| at |offset| without staging
+  // them in a user space buffer where the kernel supports it.
+  bool AppendFromFile(int in_fd, off64_t offset, size_t length) {
+    if (total_bytes_written_ + length > declared_length_) {
+      ALOGW("Zip: Unexpected size " ZD " (declared) vs " ZD " (actual)",
+            declared_length_, total_bytes_written_ + length);
+      return false;
+    }
+
+#if defined(__linux__)
+    while (length > 0) {
+      const ssize_t sent = TEMP_FAILURE_RETRY(sendfile64(fd_, in_fd, &offset, length));
+      if (sent <= 0) {
+        if (sent == -1 && (errno == EINVAL || errno == ENOSYS)) {
+          break;  // Not supported between these files, copy the rest.
+        }
+        ALOGW("Zip: unable to send " ZD " bytes to file: %s", length,
+              (sent == 0) ? "unexpected end of file" : strerror(errno));
+        return false;
+      }
+      total_bytes_written_ += sent;
+      length -= sent;
+    }
+#endif  // __linux__
+
+    const size_t kBufSize = 32768;
+    std::vector<uint8_t> buf(std::min(length, kBufSize));
+    while (length > 0) {
+      const size_t block_size = std::min(length, kBufSize);
+#if !defined(_WIN32)
+      if (static_cast<size_t>(TEMP_FAILURE_RETRY(pread64(in_fd, buf.data(), block_size,
+                                                         offset))) != block_size) {
+#else
+      if (lseek64(in_fd, offset, SEEK_SET) != offset ||
+          !android::base::ReadFully(in_fd, buf.data(), block_size)) {
+#endif
+        ALOGW("Zip: unable to read " ZD " bytes at %" PRId64 ": %s", block_size,
+              static_cast<int64_t>(offset), strerror(errno));
+        return false;
+      }
+      if (!Append(buf.data(), block_size)) {
+        return false;
+      }
+      offset += block_size;
+      length -= block_size;
+    }
+    return true;
+  }
+
  private:
   FileWriter(const int fd, const size_t declared_length) :
       Writer(),
@@ -918,6 +1213,7 @@ static inline int zlib_inflateInit2(z_stream* stream, int window_bits) {
 
 static int32_t InflateEntryToWriter(MappedZipFile& mapped_zip, const ZipEntry* entry,
                                     Writer* writer, uint64_t* crc_out) {
+  off64_t data_offset = entry->offset;
   const size_t kBufSize = 32768;
   std::vector<uint8_t> read_buf(kBufSize);
   std::vector<uint8_t> write_buf(kBufSize);
@@ -966,12 +1262,13 @@ static int32_t InflateEntryToWriter(MappedZipFile& mapped_zip, const ZipEntry* e
     /* read as much as we can */
     if (zstream.avail_in == 0) {
       const size_t getSize = (compressed_length > kBufSize) ? kBufSize : compressed_length;
-      if (!mapped_zip.ReadData(read_buf.data(), getSize)) {
+      if (!mapped_zip.ReadAtOffset(read_buf.data(), getSize, data_offset)) {
         ALOGW("Zip: inflate read failed, getSize = %zu: %s", getSize, strerror(errno));
         return kIoError;
       }
 
       compressed_length -= getSize;
+      data_offset += getSize;
 
       zstream.next_in = &read_buf[0];
       zstream.avail_in = getSize;
@@ -1020,6 +1317,7 @@ static int32_t CopyEntryToWriter(MappedZipFile& mapped_zip, const ZipEntry* entr
   std::vector<uint8_t> buf(kBufSize);
 
   const uint32_t length = entry->uncompressed_length;
+  const off64_t data_offset = entry->offset;
   uint32_t count = 0;
   uint64_t crc = 0;
   while (count < length) {
@@ -1028,7 +1326,7 @@ static int32_t CopyEntryToWriter(MappedZipFile& mapped_zip, const ZipEntry* entr
     // Safe conversion because kBufSize is narrow enough for a 32 bit signed
     // value.
     const size_t block_size = (remaining > kBufSize) ? kBufSize : remaining;
-    if (!mapped_zip.ReadData(buf.data(), block_size)) {
+    if (!mapped_zip.ReadAtOffset(buf.data(), block_size, data_offset + count)) {
       ALOGW("CopyFileToFile: copy read failed, block_size = %zu: %s", block_size, strerror(errno));
       return kIoError;
     }
@@ -1049,12 +1347,6 @@ int32_t ExtractToWriter(ZipArchiveHandle handle,
                         ZipEntry* entry, Writer* writer) {
   ZipArchive* archive = reinterpret_cast<ZipArchive*>(handle);
   const uint16_t method = entry->method;
-  off64_t data_offset = entry->offset;
-
-  if (!archive->mapped_zip.SeekToOffset(data_offset)) {
-    ALOGW("Zip: lseek to data at %" PRId64 " failed", static_cast<int64_t>(data_offset));
-    return kIoError;
-  }
 
   // this should default to kUnknownCompressionMethod.
   int32_t return_value = -1;
@@ -1098,6 +1390,84 @@ int32_t ExtractEntryToFile(ZipArchiveHandle handle,
   return ExtractToWriter(handle, entry, writer.get());
 }
 
+// Stored entries skip the Writer and its bounce buffer: they are read
+// straight into the destination buffer, or sent file to file.
+static int32_t ExtractStoredEntry(ZipArchive* archive, ZipExtractRequest* request) {
+  ZipEntry* entry = request->entry;
+  MappedZipFile& mapped_zip = archive->mapped_zip;
+
+  if (request->fd == -1) {
+    if (entry->uncompressed_length > request->size) {
+      ALOGW("Zip: Unexpected size %" PRIu32 " (declared) vs %" PRIu32 " (actual)",
+            request->size, entry->uncompressed_length);
+      return kIoError;
+    }
+    if (!mapped_zip.ReadAtOffset(request->begin, entry->uncompressed_length, entry->offset)) {
+      return kIoError;
+    }
+  } else {
+    std::unique_ptr<FileWriter> writer(FileWriter::Create(request->fd, entry));
+    if (writer.get() == nullptr) {
+      return kIoError;
+    }
+    if (!writer->AppendFromFile(mapped_zip.GetFileDescriptor(), entry->offset,
+                                entry->uncompressed_length)) {
+      return kIoError;
+    }
+  }
+
+  if (entry->has_data_descriptor) {
+    return UpdateEntryFromDataDescriptor(mapped_zip, entry);
+  }
+  return 0;
+}
+
+static int32_t ExtractRequest(ZipArchiveHandle handle, ZipExtractRequest* request) {
+  ZipArchive* archive = reinterpret_cast<ZipArchive*>(handle);
+  if (request->entry->method == kCompressStored &&
+      (request->fd == -1 || archive->mapped_zip.HasFd())) {
+    return ExtractStoredEntry(archive, request);
+  }
+  if (request->fd == -1) {
+    return ExtractToMemory(handle, request->entry, request->begin, request->size);
+  }
+  return ExtractEntryToFile(handle, request->entry, request->fd);
+}
+
+int32_t ExtractEntries(ZipArchiveHandle handle, ZipExtractRequest* requests,
+                       size_t num_requests, size_t num_threads) {
+  // All reads are positional, so entries can be extracted concurrently
+  // as long as no two requests share a destination.
+  std::atomic<size_t> next_request(0);
+  auto worker = [&]() {
+    size_t i;
+    while ((i = next_request.fetch_add(1, std::memory_order_relaxed)) < num_requests) {
+      requests[i].result = ExtractRequest(handle, &requests[i]);
+    }
+  };
+
+#if !defined(_WIN32)
+  num_threads = std::min(num_threads, num_requests);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+#else
+  worker();
+#endif
+
+  for (size_t i = 0; i < num_requests; ++i) {
+    if (requests[i].result != 0) {
+      return requests[i].result;
+    }
+  }
+  return 0;
+}
+
 const char* ErrorCodeString(int32_t error_code) {
   if (error_code > kErrorMessageLowerBound && error_code < kErrorMessageUpperBound) {
     return kErrorMessages[error_code * -1];
@@ -1217,6 +1587,16 @@ bool MappedZipFile::ReadAtOffset(uint8_t* buf, size_t len, off64_t off) {
     return true;
   }
 #endif
+  if (!has_fd_) {
+    // Leaves read_pos_ alone so concurrent positional reads are safe.
+    if (off < 0 || static_cast<uint64_t>(off) + len > static_cast<uint64_t>(data_length_)) {
+      ALOGE("Zip: invalid read of " ZD " bytes at offset %" PRId64 ", data length: %" PRId64 "\n",
+            len, off, data_length_);
+      return false;
+    }
+    memcpy(buf, static_cast<uint8_t*>(base_ptr_) + off, len);
+    return true;
+  }
   if (!SeekToOffset(off)) {
     return false;
   }
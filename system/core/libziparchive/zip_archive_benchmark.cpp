@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include <android-base/logging.h>
+#include <android-base/test_utils.h>
+#include <benchmark/benchmark.h>
+#include <ziparchive/zip_archive.h>
+#include <ziparchive/zip_writer.h>
+
+static std::unique_ptr<TemporaryFile> CreateZip(int num_entries) {
+  std::unique_ptr<TemporaryFile> result(new TemporaryFile);
+  FILE* fp = fdopen(dup(result->fd), "w");
+  CHECK(fp != nullptr);
+
+  ZipWriter writer(fp);
+  for (int i = 0; i < num_entries; ++i) {
+    const std::string name = "res/drawable/entry_" + std::to_string(i) + ".png";
+    CHECK_EQ(0, writer.StartEntry(name.c_str(), 0));
+    CHECK_EQ(0, writer.WriteBytes(name.data(), name.size()));
+    CHECK_EQ(0, writer.FinishEntry());
+  }
+  CHECK_EQ(0, writer.Finish());
+  fclose(fp);
+  return result;
+}
+
+static void BM_OpenArchive(benchmark::State& state) {
+  std::unique_ptr<TemporaryFile> zip = CreateZip(state.range(0));
+  while (state.KeepRunning()) {
+    ZipArchiveHandle handle;
+    CHECK_EQ(0, OpenArchive(zip->path, &handle));
+    CloseArchive(handle);
+  }
+}
+BENCHMARK(BM_OpenArchive)->Arg(1000)->Arg(10000)->Arg(50000);
+
+// Every open parses the central directory and writes the index.
+static void BM_OpenArchiveWithIndex_Cold(benchmark::State& state) {
+  std::unique_ptr<TemporaryFile> zip = CreateZip(state.range(0));
+  const std::string index = std::string(zip->path) + ".idx";
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    unlink(index.c_str());
+    state.ResumeTiming();
+    ZipArchiveHandle handle;
+    CHECK_EQ(0, OpenArchiveWithIndex(zip->path, index.c_str(), &handle));
+    CloseArchive(handle);
+  }
+  unlink(index.c_str());
+}
+BENCHMARK(BM_OpenArchiveWithIndex_Cold)->Arg(1000)->Arg(10000)->Arg(50000);
+
+static void BM_OpenArchiveWithIndex_Warm(benchmark::State& state) {
+  std::unique_ptr<TemporaryFile> zip = CreateZip(state.range(0));
+  const std::string index = std::string(zip->path) + ".idx";
+  ZipArchiveHandle handle;
+  CHECK_EQ(0, OpenArchiveWithIndex(zip->path, index.c_str(), &handle));
+  CloseArchive(handle);
+  while (state.KeepRunning()) {
+    CHECK_EQ(0, OpenArchiveWithIndex(zip->path, index.c_str(), &handle));
+    CloseArchive(handle);
+  }
+  unlink(index.c_str());
+}
+BENCHMARK(BM_OpenArchiveWithIndex_Warm)->Arg(1000)->Arg(10000)->Arg(50000);
+
+BENCHMARK_MAIN();
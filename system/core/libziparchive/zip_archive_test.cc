@@ -296,6 +296,59 @@ TEST(ziparchive, FindEntry) {
   CloseArchive(handle);
 }
 
+static void AssertIndexedArchive(const std::string& zip_file, const std::string& index_file) {
+  ZipArchiveHandle handle;
+  ASSERT_EQ(0, OpenArchiveWithIndex(zip_file.c_str(), index_file.c_str(), &handle));
+
+  ZipEntry data;
+  ZipString name;
+  SetZipString(&name, kATxtName);
+  ASSERT_EQ(0, FindEntry(handle, name, &data));
+  ASSERT_EQ(63, data.offset);
+  ASSERT_EQ(0x950821c5, data.crc32);
+
+  SetZipString(&name, "b/d.txt");
+  ASSERT_EQ(0, FindEntry(handle, name, &data));
+
+  SetZipString(&name, kNonexistentTxtName);
+  ASSERT_LT(FindEntry(handle, name, &data), 0);
+
+  CloseArchive(handle);
+}
+
+TEST(ziparchive, OpenWithIndex) {
+  TemporaryDir tmp_dir;
+  const std::string zip_file = test_data_dir + "/" + kValidZip;
+  const std::string index_file = std::string(tmp_dir.path) + "/valid.zip.idx";
+
+  // No index yet, the archive is parsed and the index written.
+  AssertIndexedArchive(zip_file, index_file);
+  std::string index;
+  ASSERT_TRUE(android::base::ReadFileToString(index_file, &index));
+  ASSERT_FALSE(index.empty());
+
+  // Served from the index.
+  AssertIndexedArchive(zip_file, index_file);
+  std::string reread;
+  ASSERT_TRUE(android::base::ReadFileToString(index_file, &reread));
+  ASSERT_EQ(index, reread);
+
+  // An index written for another archive is ignored and replaced.
+  ZipArchiveHandle handle;
+  const std::string large_zip_file = test_data_dir + "/" + kLargeZip;
+  ASSERT_EQ(0, OpenArchiveWithIndex(large_zip_file.c_str(), index_file.c_str(), &handle));
+  CloseArchive(handle);
+  ASSERT_TRUE(android::base::ReadFileToString(index_file, &reread));
+  ASSERT_NE(index, reread);
+  AssertIndexedArchive(zip_file, index_file);
+
+  // A corrupt index is ignored too.
+  ASSERT_TRUE(android::base::ReadFileToString(index_file, &index));
+  index[index.size() - 8] ^= 0xff;
+  ASSERT_TRUE(android::base::WriteStringToFile(index, index_file));
+  AssertIndexedArchive(zip_file, index_file);
+}
+
 TEST(ziparchive, TestInvalidDeclaredLength) {
   ZipArchiveHandle handle;
   ASSERT_EQ(0, OpenArchiveWrapper("declaredlength.zip", &handle));
@@ -508,6 +561,68 @@ TEST(ziparchive, ExtractToFile) {
 }
 
 #if !defined(_WIN32)
+static void AssertFileContents(int fd, const std::vector<uint8_t>& contents) {
+  std::vector<uint8_t> read_buffer(contents.size());
+  ASSERT_EQ(0, lseek64(fd, 0, SEEK_SET));
+  ASSERT_TRUE(android::base::ReadFully(fd, read_buffer.data(), read_buffer.size()));
+  ASSERT_EQ(contents, read_buffer);
+  ASSERT_EQ(static_cast<off64_t>(contents.size()), lseek64(fd, 0, SEEK_END));
+}
+
+TEST(ziparchive, ExtractEntries) {
+  ZipArchiveHandle handle;
+  ASSERT_EQ(0, OpenArchiveWrapper(kValidZip, &handle));
+
+  // a.txt is deflated, b.txt is stored, each goes once to memory and
+  // once to a file.
+  ZipEntry a_entries[2];
+  ZipEntry b_entries[2];
+  ZipString name;
+  SetZipString(&name, kATxtName);
+  ASSERT_EQ(0, FindEntry(handle, name, &a_entries[0]));
+  a_entries[1] = a_entries[0];
+  SetZipString(&name, kBTxtName);
+  ASSERT_EQ(0, FindEntry(handle, name, &b_entries[0]));
+  ASSERT_EQ(kCompressStored, b_entries[0].method);
+  b_entries[1] = b_entries[0];
+
+  std::vector<uint8_t> a_buffer(kATxtContents.size());
+  std::vector<uint8_t> b_buffer(kBTxtContents.size());
+  TemporaryFile a_file;
+  TemporaryFile b_file;
+  ZipExtractRequest requests[] = {
+    { &a_entries[0], -1, a_buffer.data(), static_cast<uint32_t>(a_buffer.size()), -1 },
+    { &b_entries[0], -1, b_buffer.data(), static_cast<uint32_t>(b_buffer.size()), -1 },
+    { &a_entries[1], a_file.fd, nullptr, 0, -1 },
+    { &b_entries[1], b_file.fd, nullptr, 0, -1 },
+  };
+  const size_t num_requests = sizeof(requests) / sizeof(requests[0]);
+
+  for (size_t num_threads : { 1, 4 }) {
+    ASSERT_EQ(0, ExtractEntries(handle, requests, num_requests, num_threads));
+    for (const ZipExtractRequest& request : requests) {
+      ASSERT_EQ(0, request.result);
+    }
+    ASSERT_EQ(kATxtContents, a_buffer);
+    ASSERT_EQ(kBTxtContents, b_buffer);
+    AssertFileContents(a_file.fd, kATxtContents);
+    AssertFileContents(b_file.fd, kBTxtContents);
+
+    ASSERT_EQ(0, ftruncate(a_file.fd, 0));
+    ASSERT_EQ(0, ftruncate(b_file.fd, 0));
+    ASSERT_EQ(0, lseek64(a_file.fd, 0, SEEK_SET));
+    ASSERT_EQ(0, lseek64(b_file.fd, 0, SEEK_SET));
+  }
+
+  // A buffer too small for a stored entry fails just that request.
+  requests[1].size = b_buffer.size() - 1;
+  ASSERT_NE(0, ExtractEntries(handle, requests, 2, 2));
+  ASSERT_EQ(0, requests[0].result);
+  ASSERT_NE(0, requests[1].result);
+
+  CloseArchive(handle);
+}
+
 TEST(ziparchive, OpenFromMemory) {
   const std::string zip_path = test_data_dir + "/" + kUpdateZip;
   android::base::unique_fd fd(open(zip_path.c_str(), O_RDONLY | O_BINARY));
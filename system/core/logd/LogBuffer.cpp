@@ -26,6 +26,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <memory>
 #include <unordered_map>
 
 #include <cutils/properties.h>
@@ -72,6 +73,9 @@ void LogBuffer::init() {
         // as the act of mounting /data would trigger persist.logd.timestamp to
         // be corrected. 1/30 corner case YMMV.
         //
+        // Sealed chunks are compressed and are not fixed up, with
+        // persist.logd.chunked set the readers will see the discontinuity.
+        //
         pthread_mutex_lock(&mLogElementsLock);
         LogBufferElementCollection::iterator it = mLogElements.begin();
         while ((it != mLogElements.end())) {
@@ -87,6 +91,7 @@ void LogBuffer::init() {
             }
             ++it;
         }
+        mIndex.rebuild(mLogElements);
         pthread_mutex_unlock(&mLogElementsLock);
     }
 
@@ -110,7 +115,15 @@ void LogBuffer::init() {
 }
 
 LogBuffer::LogBuffer(LastLogTimes* times)
-    : monotonic(android_log_clockid() == CLOCK_MONOTONIC), mTimes(*times) {
+    : LogBuffer(times, __android_logger_property_get_bool(
+                           "logd.chunked",
+                           BOOL_DEFAULT_FALSE | BOOL_DEFAULT_FLAG_PERSIST)) {
+}
+
+LogBuffer::LogBuffer(LastLogTimes* times, bool chunked)
+    : mChunked(chunked),
+      monotonic(android_log_clockid() == CLOCK_MONOTONIC),
+      mTimes(*times) {
     pthread_mutex_init(&mLogElementsLock, nullptr);
 
     log_id_for_each(i) {
@@ -190,6 +203,25 @@ static enum match_type identical(LogBufferElement* elem,
     return SAME;
 }
 
+// Check the tag against the log.tag properties, mLogElementsLock need not
+// be held.
+bool LogBuffer::isLoggable(const LogBufferElement* elem) {
+    log_id_t log_id = elem->getLogId();
+    if (log_id == LOG_ID_SECURITY) {
+        return true;
+    }
+    int prio = ANDROID_LOG_INFO;
+    const char* tag = nullptr;
+    if (log_id == LOG_ID_EVENTS) {
+        tag = tagToName(elem->getTag());
+    } else {
+        const char* msg = elem->getMsg();
+        prio = *msg;
+        tag = msg + 1;
+    }
+    return __android_log_is_loggable(prio, tag, ANDROID_LOG_VERBOSE);
+}
+
 int LogBuffer::log(log_id_t log_id, log_time realtime, uid_t uid, pid_t pid,
                    pid_t tid, const char* msg, unsigned short len) {
     if ((log_id >= LOG_ID_MAX) || (log_id < 0)) {
@@ -198,27 +230,61 @@ int LogBuffer::log(log_id_t log_id, log_time realtime, uid_t uid, pid_t pid,
 
     LogBufferElement* elem =
         new LogBufferElement(log_id, realtime, uid, pid, tid, msg, len);
-    if (log_id != LOG_ID_SECURITY) {
-        int prio = ANDROID_LOG_INFO;
-        const char* tag = nullptr;
-        if (log_id == LOG_ID_EVENTS) {
-            tag = tagToName(elem->getTag());
-        } else {
-            prio = *msg;
-            tag = msg + 1;
-        }
-        if (!__android_log_is_loggable(prio, tag, ANDROID_LOG_VERBOSE)) {
+    if (!isLoggable(elem)) {
+        // Log traffic received to total
+        pthread_mutex_lock(&mLogElementsLock);
+        stats.add(elem);
+        stats.subtract(elem);
+        pthread_mutex_unlock(&mLogElementsLock);
+        delete elem;
+        return -EACCES;
+    }
+
+    pthread_mutex_lock(&mLogElementsLock);
+    logLocked(elem);
+    pthread_mutex_unlock(&mLogElementsLock);
+
+    return len;
+}
+
+// Insert a batch of staged elements (see LogQueue) under a single
+// acquisition of mLogElementsLock, takes ownership of all of them.
+// Returns the number of elements that passed the loggable filter.
+size_t LogBuffer::log(LogBufferElement* const* elems, size_t count) {
+    // filter outside the lock, results fit in the batch bitmap
+    static constexpr size_t maxBatch = 64;
+    if (count > maxBatch) {
+        size_t ret = log(elems, maxBatch);
+        return ret + log(elems + maxBatch, count - maxBatch);
+    }
+    uint64_t loggable = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (isLoggable(elems[i])) loggable |= 1ULL << i;
+    }
+
+    size_t ret = 0;
+    pthread_mutex_lock(&mLogElementsLock);
+    for (size_t i = 0; i < count; ++i) {
+        LogBufferElement* elem = elems[i];
+        if (!(loggable & (1ULL << i))) {
             // Log traffic received to total
-            pthread_mutex_lock(&mLogElementsLock);
             stats.add(elem);
             stats.subtract(elem);
-            pthread_mutex_unlock(&mLogElementsLock);
             delete elem;
-            return -EACCES;
+            continue;
         }
+        logLocked(elem);
+        ++ret;
     }
+    pthread_mutex_unlock(&mLogElementsLock);
 
-    pthread_mutex_lock(&mLogElementsLock);
+    return ret;
+}
+
+// assumes mLogElementsLock held, owns elem, runs the identical message
+// (chatty) filter before handing elem, or its stand-ins, to log().
+void LogBuffer::logLocked(LogBufferElement* elem) {
+    log_id_t log_id = elem->getLogId();
     LogBufferElement* currentLast = lastLoggedElements[log_id];
     if (currentLast) {
         LogBufferElement* dropped = droppedElements[log_id];
@@ -319,16 +385,14 @@ int LogBuffer::log(log_id_t log_id, log_time realtime, uid_t uid, pid_t pid,
                     // check for overflow
                     if (total >= UINT32_MAX) {
                         log(currentLast);
-                        pthread_mutex_unlock(&mLogElementsLock);
-                        return len;
+                        return;
                     }
                     stats.add(currentLast);
                     stats.subtract(currentLast);
                     delete currentLast;
                     swab = total;
                     event->payload.data = htole32(swab);
-                    pthread_mutex_unlock(&mLogElementsLock);
-                    return len;
+                    return;
                 }
                 if (count == USHRT_MAX) {
                     log(dropped);
@@ -345,8 +409,7 @@ int LogBuffer::log(log_id_t log_id, log_time realtime, uid_t uid, pid_t pid,
             }
             droppedElements[log_id] = currentLast;
             lastLoggedElements[log_id] = elem;
-            pthread_mutex_unlock(&mLogElementsLock);
-            return len;
+            return;
         }
         if (dropped) {         // State 1 or 2
             if (count) {       // State 2
@@ -363,13 +426,20 @@ int LogBuffer::log(log_id_t log_id, log_time realtime, uid_t uid, pid_t pid,
     lastLoggedElements[log_id] = new LogBufferElement(*elem);
 
     log(elem);
-    pthread_mutex_unlock(&mLogElementsLock);
-
-    return len;
 }
 
 // assumes mLogElementsLock held, owns elem, will look after garbage collection
 void LogBuffer::log(LogBufferElement* elem) {
+    if (mChunked) {
+        // Serialized copy is all that we keep, no in-place time sorting
+        log_id_t id = elem->getLogId();
+        mChunks.log(elem);
+        stats.add(elem);
+        delete elem;
+        maybePrune(id);
+        return;
+    }
+
     // cap on how far back we will sort in-place, otherwise append
     static uint32_t too_far_back = 5;  // five seconds
     // Insert elements in time sorted order if possible
@@ -384,6 +454,7 @@ void LogBuffer::log(LogBufferElement* elem) {
                         (elem->getLogId() != LOG_ID_KERNEL) &&
                         ((*it)->getLogId() != LOG_ID_KERNEL))) {
         mLogElements.push_back(elem);
+        mIndex.append(--mLogElements.end());
     } else {
         log_time end = log_time::EPOCH;
         bool end_set = false;
@@ -433,6 +504,13 @@ void LogBuffer::log(LogBufferElement* elem) {
 //
 // mLogElementsLock must be held when this function is called.
 void LogBuffer::maybePrune(log_id_t id) {
+    if (mChunked) {
+        if (mChunks.sizes(id) > log_buffer_size(id)) {
+            pruneChunks(id, false, AID_ROOT);
+        }
+        return;
+    }
+
     size_t sizes = stats.sizes(id);
     unsigned long maxSize = log_buffer_size(id);
     if (sizes > maxSize) {
@@ -494,6 +572,7 @@ LogBufferElementCollection::iterator LogBuffer::erase(
                   ? element->getTag()
                   : element->getUid();
 #endif
+    mIndex.erase(it);
     it = mLogElements.erase(it);
     if (doSetLast) {
         log_id_for_each(i) {
@@ -658,6 +737,10 @@ class LogBufferElementLast {
 // mLogElementsLock must be held when this function is called.
 //
 bool LogBuffer::prune(log_id_t id, unsigned long pruneRows, uid_t caller_uid) {
+    if (mChunked) {
+        return pruneChunks(id, pruneRows == ULONG_MAX, caller_uid);
+    }
+
     LogTimeEntry* oldest = nullptr;
     bool busy = false;
     bool clearAll = pruneRows == ULONG_MAX;
@@ -1012,6 +1095,88 @@ bool LogBuffer::prune(log_id_t id, unsigned long pruneRows, uid_t caller_uid) {
     return (pruneRows > 0) && busy;
 }
 
+// prune whole chunks of type "id" from the oldest end of the ring.
+//
+// Chunks are the unit of expiration: there is no worst offender or
+// white/black list pruning, and chatty entries are only created by the
+// identical message filter in log(). A chunk is kept as long as it holds
+// content at or past the reader region lock, or has a reader attached.
+// The active chunk is only dropped to clear the buffer. Unprivileged clear
+// rewrites the chunks without the caller's entries.
+//
+// mLogElementsLock must be held when this function is called.
+bool LogBuffer::pruneChunks(log_id_t id, bool clearAll, uid_t caller_uid) {
+    LogTimeEntry* oldest = nullptr;
+    bool busy = false;
+
+    LogTimeEntry::lock();
+
+    // Region locked?
+    LastLogTimes::iterator times = mTimes.begin();
+    while (times != mTimes.end()) {
+        LogTimeEntry* entry = (*times);
+        if (entry->owned_Locked() && entry->isWatching(id) &&
+            (!oldest || (oldest->mStart > entry->mStart) ||
+             ((oldest->mStart == entry->mStart) &&
+              (entry->mTimeout.tv_sec || entry->mTimeout.tv_nsec)))) {
+            oldest = entry;
+        }
+        times++;
+    }
+    log_time watermark(log_time::tv_sec_max, log_time::tv_nsec_max);
+    if (oldest) watermark = oldest->mStart - pruneMargin;
+
+    auto subtract = [this, id](const LogChunkEntry* entry) {
+        stats.subtract(id, entry);
+    };
+
+    LogChunkCollection& chunks = mChunks.chunks(id);
+
+    if (__predict_false(caller_uid != AID_ROOT)) {  // unlikely
+        for (LogChunk& chunk : chunks) {
+            if (chunk.readerRefs()) {
+                busy = true;
+                if (oldest) oldest->triggerReader_Locked();
+                break;
+            }
+            mChunks.removeUid(id, chunk, caller_uid, subtract);
+        }
+        LogTimeEntry::unlock();
+        return busy;
+    }
+
+    while (!chunks.empty() &&
+           (clearAll || (mChunks.sizes(id) > log_buffer_size(id)))) {
+        LogChunk& chunk = chunks.front();
+        if (!clearAll && !chunk.sealed()) {
+            break;
+        }
+
+        if (chunk.readerRefs() ||
+            (oldest && (watermark <= chunk.highestTime()))) {
+            busy = true;
+            if (!oldest) {
+                break;
+            }
+            if (mChunks.sizes(id) > (2 * log_buffer_size(id))) {
+                // kick a misbehaving log reader client off the island
+                oldest->release_Locked();
+            } else if (oldest->mTimeout.tv_sec || oldest->mTimeout.tv_nsec) {
+                oldest->triggerReader_Locked();
+            } else {
+                oldest->triggerSkip_Locked(id, chunk.entries());
+            }
+            break;
+        }
+
+        mChunks.eraseOldest(id, subtract);
+    }
+
+    LogTimeEntry::unlock();
+
+    return busy;
+}
+
 // clear all rows of type "id" from the buffer.
 bool LogBuffer::clear(log_id_t id, uid_t uid) {
     bool busy = true;
@@ -1057,7 +1222,7 @@ bool LogBuffer::clear(log_id_t id, uid_t uid) {
 // get the used space associated with "id".
 unsigned long LogBuffer::getSizeUsed(log_id_t id) {
     pthread_mutex_lock(&mLogElementsLock);
-    size_t retval = stats.sizes(id);
+    size_t retval = mChunked ? mChunks.sizes(id) : stats.sizes(id);
     pthread_mutex_unlock(&mLogElementsLock);
     return retval;
 }
@@ -1070,6 +1235,7 @@ int LogBuffer::setSize(log_id_t id, unsigned long size) {
     }
     pthread_mutex_lock(&mLogElementsLock);
     log_buffer_size(id) = size;
+    mChunks.setBufferSize(id, size);
     pthread_mutex_unlock(&mLogElementsLock);
     return 0;
 }
@@ -1086,7 +1252,13 @@ log_time LogBuffer::flushTo(SocketClient* reader, const log_time& start,
                             pid_t* lastTid, bool privileged, bool security,
                             int (*filter)(const LogBufferElement* element,
                                           void* arg),
-                            void* arg) {
+                            void* arg, uint64_t* sequence,
+                            unsigned int logMask) {
+    if (mChunked) {
+        return flushToChunks(reader, start, lastTid, privileged, security,
+                             filter, arg, sequence, logMask);
+    }
+
     LogBufferElementCollection::iterator it;
     uid_t uid = reader->getUid();
 
@@ -1099,23 +1271,48 @@ log_time LogBuffer::flushTo(SocketClient* reader, const log_time& start,
         // 3 second limit to continue search for out-of-order entries.
         log_time min = start - pruneMargin;
 
-        // Cap to 300 iterations we look back for out-of-order entries.
-        size_t count = 300;
+        if (start < mIndex.newest()) {
+            // Not near the end, the newest index entry is at most an index
+            // interval back. Start deep in the list from the index instead,
+            // out-of-order margin included, entries before start are
+            // skipped below.
+            bool hit = mIndex.seek(min, it);
+            if (!hit) it = mLogElements.begin();
+            stats.indexSeek(hit);
+        } else {
+            // Cap to 300 elements we look back for out-of-order entries.
+            size_t count = 300;
+
+            // Client wants to start from some specified time. Chances are
+            // we are better off starting from the end of the time sorted
+            // list.
+            LogBufferElementCollection::iterator last;
+            bool found = false;
+            for (last = it = mLogElements.end(); it != mLogElements.begin();
+                 /* do nothing */) {
+                --it;
+                LogBufferElement* element = *it;
+                if (element->getRealTime() > start) {
+                    last = it;
+                } else if (element->getRealTime() < min) {
+                    found = true;
+                    break;
+                }
+                if (!--count) {
+                    break;
+                }
+            }
+            if (it == mLogElements.begin()) {
+                found = true;  // searched it all
+            }
+            it = last;
 
-        // Client wants to start from some specified time. Chances are
-        // we are better off starting from the end of the time sorted list.
-        LogBufferElementCollection::iterator last;
-        for (last = it = mLogElements.end(); it != mLogElements.begin();
-             /* do nothing */) {
-            --it;
-            LogBufferElement* element = *it;
-            if (element->getRealTime() > start) {
-                last = it;
-            } else if (!--count || (element->getRealTime() < min)) {
-                break;
+            // Elements added out of order behind the newest index entry,
+            // fall back to it.
+            if (!found && mIndex.seek(min, last)) {
+                it = last;
             }
         }
-        it = last;
     }
 
     log_time max = start;
@@ -1188,6 +1385,107 @@ log_time LogBuffer::flushTo(SocketClient* reader, const log_time& start,
     return max;
 }
 
+// Merge the per log id chunk rings in time order.
+log_time LogBuffer::flushToChunks(SocketClient* reader, const log_time& start,
+                                  pid_t* lastTid, bool privileged,
+                                  bool security,
+                                  int (*filter)(const LogBufferElement* element,
+                                                void* arg),
+                                  void* arg, uint64_t* sequence,
+                                  unsigned int logMask) {
+    uid_t uid = reader->getUid();
+    // Only ids in logMask get a cursor, an attached cursor pins its chunk
+    // for as long as the reader takes to drain the socket.
+    LogChunkCursor cursors[LOG_ID_MAX];
+    // Resuming by sequence, entries are stored in arrival order and one
+    // may land behind the reader in time, but never in sequence.
+    bool bySequence[LOG_ID_MAX] = {};
+
+    pthread_mutex_lock(&mLogElementsLock);
+
+    log_id_for_each(i) {
+        if ((!security && (i == LOG_ID_SECURITY)) || !(logMask & (1 << i))) {
+            continue;
+        }
+        if (sequence && sequence[i]) {
+            bySequence[i] = true;
+            cursors[i].seek(mChunks.chunks(i), sequence[i]);
+        } else {
+            cursors[i].seek(mChunks.chunks(i), start);
+        }
+    }
+
+    log_time max = start;
+
+    for (;;) {
+        const LogChunkEntry* entry = nullptr;
+        log_id_t id = LOG_ID_MAX;
+        log_id_for_each(i) {
+            const LogChunkEntry* candidate = cursors[i].peek();
+            if (candidate &&
+                (!entry || (candidate->getRealTime() < entry->getRealTime()))) {
+                entry = candidate;
+                id = i;
+            }
+        }
+        if (!entry) {
+            break;
+        }
+
+        if ((!privileged && (entry->mUid != uid)) ||
+            (!bySequence[id] && (entry->getRealTime() <= start))) {
+            cursors[id].next();
+            continue;
+        }
+
+        std::unique_ptr<LogBufferElement> element(entry->toElement(id));
+        cursors[id].next();
+
+        // NB: calling out to another object with mLogElementsLock held (safe)
+        if (filter) {
+            int ret = (*filter)(element.get(), arg);
+            if (ret == false) {
+                continue;
+            }
+            if (ret != true) {
+                break;
+            }
+        }
+
+        bool sameTid = false;
+        if (lastTid) {
+            sameTid = lastTid[id] == element->getTid();
+            // See flushTo() for the chatty source differentiation.
+            lastTid[id] =
+                (element->getDropped() && !sameTid) ? 0 : element->getTid();
+        }
+
+        pthread_mutex_unlock(&mLogElementsLock);
+
+        // cursor reader references keep the chunks in place
+        max = element->flushTo(reader, this, privileged, sameTid);
+
+        pthread_mutex_lock(&mLogElementsLock);
+
+        if (max == element->FLUSH_ERROR) {
+            break;
+        }
+    }
+
+    log_id_for_each(i) {
+        if (sequence && (security || (i != LOG_ID_SECURITY)) &&
+            (logMask & (1 << i))) {
+            // everything up to the cursor has been seen
+            const LogChunkEntry* entry = cursors[i].peek();
+            sequence[i] = entry ? entry->mSequence : mChunks.sequence(i);
+        }
+        cursors[i].detach();
+    }
+    pthread_mutex_unlock(&mLogElementsLock);
+
+    return max;
+}
+
 std::string LogBuffer::formatStatistics(uid_t uid, pid_t pid,
                                         unsigned int logMask) {
     pthread_mutex_lock(&mLogElementsLock);
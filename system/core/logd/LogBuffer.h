@@ -27,6 +27,8 @@
 #include <sysutils/SocketClient.h>
 
 #include "LogBufferElement.h"
+#include "LogBufferIndex.h"
+#include "LogChunkStore.h"
 #include "LogStatistics.h"
 #include "LogTags.h"
 #include "LogTimes.h"
@@ -72,11 +74,15 @@ static bool isMonotonic(const log_time& mono) {
 }
 }
 
-typedef std::list<LogBufferElement*> LogBufferElementCollection;
-
 class LogBuffer {
     LogBufferElementCollection mLogElements;
     pthread_mutex_t mLogElementsLock;
+    // sparse time index into mLogElements for flushTo()
+    LogBufferIndex mIndex;
+
+    // persist.logd.chunked: entries live in mChunks instead of mLogElements
+    const bool mChunked;
+    LogChunkStore mChunks;
 
     LogStatistics stats;
 
@@ -102,11 +108,15 @@ class LogBuffer {
     LogBufferElement* lastLoggedElements[LOG_ID_MAX];
     LogBufferElement* droppedElements[LOG_ID_MAX];
     void log(LogBufferElement* elem);
+    void logLocked(LogBufferElement* elem);
+    bool isLoggable(const LogBufferElement* elem);
 
    public:
     LastLogTimes& mTimes;
 
     explicit LogBuffer(LastLogTimes* times);
+    // chunked overrides persist.logd.chunked, for testing
+    LogBuffer(LastLogTimes* times, bool chunked);
     ~LogBuffer();
     void init();
     bool isMonotonic() {
@@ -115,15 +125,24 @@ class LogBuffer {
 
     int log(log_id_t log_id, log_time realtime, uid_t uid, pid_t pid, pid_t tid,
             const char* msg, unsigned short len);
+    // batched insertion of staged elements, takes ownership
+    size_t log(LogBufferElement* const* elems, size_t count);
     // lastTid is an optional context to help detect if the last previous
     // valid message was from the same source so we can differentiate chatty
-    // filter types (identical or expired)
+    // filter types (identical or expired). sequence is an optional per log
+    // id resume position, zero until known, which the chunked store uses in
+    // preference to start so that entries stored after the last one flushed
+    // but timestamped before it are not skipped. logMask limits the log ids
+    // the chunked store positions the reader in, so that a slow reader does
+    // not hold on to chunks of buffers it is not reading.
     log_time flushTo(SocketClient* writer, const log_time& start,
                      pid_t* lastTid,  // &lastTid[LOG_ID_MAX] or nullptr
                      bool privileged, bool security,
                      int (*filter)(const LogBufferElement* element,
                                    void* arg) = nullptr,
-                     void* arg = nullptr);
+                     void* arg = nullptr,
+                     uint64_t* sequence = nullptr,  // &sequence[LOG_ID_MAX]
+                     unsigned int logMask = -1);
 
     bool clear(log_id_t id, uid_t uid = AID_ROOT);
     unsigned long getSize(log_id_t id);
@@ -178,6 +197,13 @@ class LogBuffer {
 
     void maybePrune(log_id_t id);
     bool prune(log_id_t id, unsigned long pruneRows, uid_t uid = AID_ROOT);
+    bool pruneChunks(log_id_t id, bool clearAll, uid_t uid);
+    log_time flushToChunks(SocketClient* writer, const log_time& start,
+                           pid_t* lastTid, bool privileged, bool security,
+                           int (*filter)(const LogBufferElement* element,
+                                         void* arg),
+                           void* arg, uint64_t* sequence,
+                           unsigned int logMask);
     LogBufferElementCollection::iterator erase(
         LogBufferElementCollection::iterator it, bool coalesce = false);
 };
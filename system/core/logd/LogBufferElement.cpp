@@ -49,6 +49,19 @@ LogBufferElement::LogBufferElement(log_id_t log_id, log_time realtime,
                : 0;
 }
 
+LogBufferElement::LogBufferElement(log_id_t log_id, log_time realtime,
+                                   uid_t uid, pid_t pid, pid_t tid,
+                                   uint32_t tag, unsigned short dropped)
+    : mTag(tag),
+      mUid(uid),
+      mPid(pid),
+      mTid(tid),
+      mRealTime(realtime),
+      mMsg(NULL),
+      mDropped(dropped),
+      mLogId(log_id) {
+}
+
 LogBufferElement::LogBufferElement(const LogBufferElement& elem)
     : mTag(elem.mTag),
       mUid(elem.mUid),
@@ -57,6 +57,9 @@ class LogBufferElement {
    public:
     LogBufferElement(log_id_t log_id, log_time realtime, uid_t uid, pid_t pid,
                      pid_t tid, const char* msg, unsigned short len);
+    // chatty entry standing in for dropped content
+    LogBufferElement(log_id_t log_id, log_time realtime, uid_t uid, pid_t pid,
+                     pid_t tid, uint32_t tag, unsigned short dropped);
     LogBufferElement(const LogBufferElement& elem);
     virtual ~LogBufferElement();
 
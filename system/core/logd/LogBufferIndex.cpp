@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include <private/android_logger.h>
+
+#include "LogBufferIndex.h"
+
+void LogBufferIndex::append(LogBufferElementCollection::iterator it) {
+    if (mCountdown) {
+        --mCountdown;
+        return;
+    }
+    log_time realtime = (*it)->getRealTime();
+    if (!mEntries.empty() && (realtime < mEntries.back().realtime)) {
+        return;  // out of order, try again with the next one
+    }
+    mEntries.push_back({ realtime, it });
+    mCountdown = interval - 1;
+}
+
+void LogBufferIndex::erase(LogBufferElementCollection::iterator it) {
+    log_time realtime = (*it)->getRealTime();
+    // Pruning is from the oldest end, check there first
+    if (!mEntries.empty() && (mEntries.front().it == it)) {
+        mEntries.pop_front();
+        return;
+    }
+    auto found = std::lower_bound(
+        mEntries.begin(), mEntries.end(), realtime,
+        [](const Entry& entry, const log_time& t) { return entry.realtime < t; });
+    for (; (found != mEntries.end()) && (found->realtime == realtime);
+         ++found) {
+        if (found->it == it) {
+            mEntries.erase(found);
+            return;
+        }
+    }
+}
+
+bool LogBufferIndex::seek(const log_time& start,
+                          LogBufferElementCollection::iterator& it) const {
+    auto found = std::upper_bound(
+        mEntries.begin(), mEntries.end(), start,
+        [](const log_time& t, const Entry& entry) { return t < entry.realtime; });
+    if (found == mEntries.begin()) {
+        return false;
+    }
+    --found;
+    it = found->it;
+    return true;
+}
+
+void LogBufferIndex::rebuild(LogBufferElementCollection& elements) {
+    mEntries.clear();
+    mCountdown = 0;
+    for (auto it = elements.begin(); it != elements.end(); ++it) {
+        append(it);
+    }
+}
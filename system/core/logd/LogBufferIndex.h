@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOGD_LOG_BUFFER_INDEX_H__
+#define _LOGD_LOG_BUFFER_INDEX_H__
+
+#include <deque>
+#include <list>
+
+#include <log/log.h>
+
+#include "LogBufferElement.h"
+
+typedef std::list<LogBufferElement*> LogBufferElementCollection;
+
+// Sparse time index over a LogBufferElementCollection, one entry per
+// interval elements appended at the end of the list. Entries are kept in
+// both list and timestamp order, elements inserted out of order are never
+// indexed, so readers can binary search for a starting point instead of
+// walking the list.
+//
+// All methods must be called with LogBuffer::mLogElementsLock held.
+class LogBufferIndex {
+    struct Entry {
+        log_time realtime;
+        LogBufferElementCollection::iterator it;
+    };
+    std::deque<Entry> mEntries;
+    size_t mCountdown;
+
+   public:
+    static constexpr size_t interval = 64;
+
+    LogBufferIndex() : mCountdown(0) {
+    }
+
+    // it was just appended to the end of the list
+    void append(LogBufferElementCollection::iterator it);
+    // it is about to be erased from the list
+    void erase(LogBufferElementCollection::iterator it);
+    // Latest indexed position at or before start, false if none.
+    bool seek(const log_time& start,
+              LogBufferElementCollection::iterator& it) const;
+
+    void rebuild(LogBufferElementCollection& elements);
+
+    // Time of the newest indexed element, EPOCH if there is none.
+    log_time newest() const {
+        return mEntries.empty() ? log_time::EPOCH : mEntries.back().realtime;
+    }
+
+    size_t size() const {
+        return mEntries.size();
+    }
+};
+
+#endif  // _LOGD_LOG_BUFFER_INDEX_H__
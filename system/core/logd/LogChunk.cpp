@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <private/android_logger.h>
+#include <zlib.h>
+
+#include "LogBufferElement.h"
+#include "LogChunk.h"
+#include "LogUtils.h"
+
+LogBufferElement* LogChunkEntry::toElement(log_id_t id) const {
+    if (!mMsgLen) {
+        return new LogBufferElement(id, getRealTime(), mUid, mPid, mTid, mTag,
+                                    mDropped);
+    }
+    return new LogBufferElement(id, getRealTime(), mUid, mPid, mTid, getMsg(),
+                                mMsgLen);
+}
+
+LogChunk::LogChunk(size_t capacity, uint64_t sequence)
+    : mCapacity(capacity),
+      mContents(new uint8_t[capacity]),
+      mWriteOffset(0),
+      mCompressedLen(0),
+      mLowestSequence(sequence),
+      mHighestSequence(sequence),
+      mHighestTime(log_time::EPOCH),
+      mEntries(0),
+      mSealed(false),
+      mReaderRefs(0) {
+}
+
+void LogChunk::log(uint64_t sequence, const LogBufferElement* element) {
+    unsigned short len = element->getMsgLen();
+    LogChunkEntry* entry =
+        reinterpret_cast<LogChunkEntry*>(mContents.get() + mWriteOffset);
+
+    log_time realtime = element->getRealTime();
+    entry->mSequence = sequence;
+    entry->mSec = realtime.tv_sec;
+    entry->mNsec = realtime.tv_nsec;
+    entry->mUid = element->getUid();
+    entry->mPid = element->getPid();
+    entry->mTid = element->getTid();
+    entry->mTag = element->getTag();
+    entry->mMsgLen = len;
+    entry->mDropped = element->getDropped();
+    if (len) {
+        memcpy(entry + 1, element->getMsg(), len);
+    }
+    mWriteOffset += entry->totalLen();
+
+    if (!mEntries) mLowestSequence = sequence;
+    mHighestSequence = sequence;
+    if (mHighestTime < realtime) mHighestTime = realtime;
+    ++mEntries;
+}
+
+void LogChunk::seal() {
+    if (mSealed) return;
+    mSealed = true;
+
+    uLongf len = compressBound(mWriteOffset);
+    std::unique_ptr<uint8_t[]> compressed(new uint8_t[len]);
+    if (compress2(compressed.get(), &len, mContents.get(), mWriteOffset,
+                  Z_BEST_SPEED) != Z_OK) {
+        // Keep the raw contents, uncompressed is better than lost.
+        android::prdebug("LogChunk: compression failed, chunk kept raw");
+        return;
+    }
+    // Trim to the compressed size, this is what we are after.
+    mCompressed.reset(new uint8_t[len]);
+    memcpy(mCompressed.get(), compressed.get(), len);
+    mCompressedLen = len;
+
+    if (!mReaderRefs) mContents.reset();
+}
+
+bool LogChunk::decompress() {
+    if (mContents) return true;
+
+    std::unique_ptr<uint8_t[]> contents(new uint8_t[mWriteOffset]);
+    uLongf len = mWriteOffset;
+    if ((uncompress(contents.get(), &len, mCompressed.get(), mCompressedLen) !=
+         Z_OK) ||
+        (len != mWriteOffset)) {
+        android::prdebug("LogChunk: corrupt chunk sequence %" PRIu64,
+                         mLowestSequence);
+        return false;
+    }
+    mContents = std::move(contents);
+    return true;
+}
+
+void LogChunk::incReaderRef() {
+    if (!mReaderRefs++ && mSealed) {
+        decompress();
+    }
+}
+
+void LogChunk::decReaderRef() {
+    if (!--mReaderRefs && mCompressed) {
+        mContents.reset();
+    }
+}
+
+size_t LogChunk::removeUid(
+    uid_t uid, const std::function<void(const LogChunkEntry*)>& removed) {
+    if (!mEntries || !decompress()) return 0;
+
+    std::unique_ptr<uint8_t[]> contents(new uint8_t[mCapacity]);
+    size_t writeOffset = 0;
+    size_t count = 0;
+    size_t entries = mEntries;
+    mEntries = 0;
+    for (size_t offset = 0; offset < mWriteOffset;) {
+        const LogChunkEntry* entry = entryAt(offset);
+        offset += entry->totalLen();
+        if (entry->mUid == uid) {
+            removed(entry);
+            ++count;
+            continue;
+        }
+        memcpy(contents.get() + writeOffset, entry, entry->totalLen());
+        writeOffset += entry->totalLen();
+        ++mEntries;
+    }
+    if (!count) {
+        mEntries = entries;
+        if (mCompressed) mContents.reset();
+        return 0;
+    }
+
+    mContents = std::move(contents);
+    mWriteOffset = writeOffset;
+    if (mEntries) {
+        mLowestSequence = entryAt(0)->mSequence;
+    }
+    if (mSealed) {
+        mSealed = false;
+        mCompressed.reset();
+        mCompressedLen = 0;
+        seal();
+    }
+    return count;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOGD_LOG_CHUNK_H__
+#define _LOGD_LOG_CHUNK_H__
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+#include <functional>
+#include <list>
+#include <memory>
+
+#include <private/android_logger.h>
+
+class LogBufferElement;
+
+// A serialized log entry as it is laid out inside of a LogChunk. The message
+// payload of mMsgLen bytes immediately follows the header. Entries that
+// represent a chatty (dropped) summary carry no payload.
+struct LogChunkEntry {
+    uint64_t mSequence;
+    uint32_t mSec;
+    uint32_t mNsec;
+    uint32_t mUid;
+    uint32_t mPid;
+    uint32_t mTid;
+    uint32_t mTag;
+    uint16_t mMsgLen;
+    uint16_t mDropped;
+
+    log_time getRealTime() const {
+        return log_time(mSec, mNsec);
+    }
+    // LogBufferElement compatible accessors for LogStatistics
+    uid_t getUid() const {
+        return mUid;
+    }
+    pid_t getPid() const {
+        return mPid;
+    }
+    pid_t getTid() const {
+        return mTid;
+    }
+    uint32_t getTag() const {
+        return mTag;
+    }
+    unsigned short getMsgLen() const {
+        return mMsgLen;
+    }
+    unsigned short getDropped() const {
+        return mMsgLen ? 0 : mDropped;
+    }
+    const char* getMsg() const {
+        return reinterpret_cast<const char*>(this + 1);
+    }
+    size_t totalLen() const {
+        return sizeof(*this) + mMsgLen;
+    }
+
+    // caller owns the returned element
+    LogBufferElement* toElement(log_id_t id) const;
+} __packed;
+
+// A fixed capacity, contiguous run of serialized entries for one log id.
+// Once full the chunk is sealed, its contents compressed and the raw
+// buffer released. Readers take a reference to keep (or make) the contents
+// available in decompressed form while they iterate.
+//
+// All methods must be called with LogBuffer::mLogElementsLock held.
+class LogChunk {
+    const size_t mCapacity;
+    std::unique_ptr<uint8_t[]> mContents;
+    size_t mWriteOffset;
+
+    std::unique_ptr<uint8_t[]> mCompressed;
+    size_t mCompressedLen;
+
+    uint64_t mLowestSequence;
+    uint64_t mHighestSequence;
+    log_time mHighestTime;
+    size_t mEntries;
+    bool mSealed;
+    unsigned int mReaderRefs;
+
+    bool decompress();
+
+   public:
+    LogChunk(size_t capacity, uint64_t sequence);
+
+    LogChunk(const LogChunk&) = delete;
+    LogChunk& operator=(const LogChunk&) = delete;
+
+    bool canLog(size_t len) const {
+        return !mSealed && ((mWriteOffset + sizeof(LogChunkEntry) + len) <=
+                            mCapacity);
+    }
+    // Serialize element at the write offset, caller checks canLog() first.
+    void log(uint64_t sequence, const LogBufferElement* element);
+    void seal();
+
+    void incReaderRef();
+    void decReaderRef();
+    unsigned int readerRefs() const {
+        return mReaderRefs;
+    }
+
+    // Entry at offset, valid only while a reader reference is held.
+    const LogChunkEntry* entryAt(size_t offset) const {
+        if (!mContents || (offset >= mWriteOffset)) return nullptr;
+        return reinterpret_cast<const LogChunkEntry*>(mContents.get() +
+                                                      offset);
+    }
+    size_t writeOffset() const {
+        return mWriteOffset;
+    }
+
+    // Rewrite the chunk without the entries of uid, reporting each removed
+    // entry to the callback. Must not be called with readers attached.
+    size_t removeUid(uid_t uid,
+                     const std::function<void(const LogChunkEntry*)>& removed);
+
+    bool sealed() const {
+        return mSealed;
+    }
+    bool empty() const {
+        return mEntries == 0;
+    }
+    size_t entries() const {
+        return mEntries;
+    }
+    uint64_t lowestSequence() const {
+        return mLowestSequence;
+    }
+    uint64_t highestSequence() const {
+        return mHighestSequence;
+    }
+    log_time highestTime() const {
+        return mHighestTime;
+    }
+    // Memory held on behalf of the ring, transient reader copies excluded.
+    size_t physicalSize() const {
+        return mCompressed ? mCompressedLen : mCapacity;
+    }
+};
+
+typedef std::list<LogChunk> LogChunkCollection;
+
+#endif  // _LOGD_LOG_CHUNK_H__
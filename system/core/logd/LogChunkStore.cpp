@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <private/android_logger.h>
+
+#include "LogBufferElement.h"
+#include "LogChunkStore.h"
+#include "LogStatistics.h"
+
+LogChunkStore::LogChunkStore() {
+    log_id_for_each(i) {
+        mSequence[i] = 1;
+        mSizes[i] = 0;
+        mChunkSize[i] = minChunkSize;
+    }
+}
+
+void LogChunkStore::setBufferSize(log_id_t id, unsigned long size) {
+    size_t chunkSize = size / 4;
+    mChunkSize[id] = (chunkSize < minChunkSize) ? minChunkSize : chunkSize;
+}
+
+uint64_t LogChunkStore::log(const LogBufferElement* element) {
+    log_id_t id = element->getLogId();
+    LogChunkCollection& chunks = mChunks[id];
+    size_t len = element->getMsgLen();
+
+    if (chunks.empty() || !chunks.back().canLog(len)) {
+        if (!chunks.empty()) {
+            LogChunk& full = chunks.back();
+            mSizes[id] -= full.physicalSize();
+            full.seal();
+            mSizes[id] += full.physicalSize();
+        }
+        size_t capacity = mChunkSize[id];
+        if (capacity < (sizeof(LogChunkEntry) + len)) {
+            capacity = sizeof(LogChunkEntry) + len;
+        }
+        chunks.emplace_back(capacity, mSequence[id]);
+        mSizes[id] += chunks.back().physicalSize();
+    }
+
+    uint64_t sequence = mSequence[id]++;
+    chunks.back().log(sequence, element);
+    return sequence;
+}
+
+void LogChunkStore::eraseOldest(
+    log_id_t id, const std::function<void(const LogChunkEntry*)>& erased) {
+    LogChunkCollection& chunks = mChunks[id];
+    if (chunks.empty()) return;
+
+    LogChunk& chunk = chunks.front();
+    chunk.incReaderRef();
+    for (size_t offset = 0;;) {
+        const LogChunkEntry* entry = chunk.entryAt(offset);
+        if (!entry) break;
+        erased(entry);
+        offset += entry->totalLen();
+    }
+    chunk.decReaderRef();
+
+    mSizes[id] -= chunk.physicalSize();
+    chunks.pop_front();
+}
+
+size_t LogChunkStore::removeUid(
+    log_id_t id, LogChunk& chunk, uid_t uid,
+    const std::function<void(const LogChunkEntry*)>& erased) {
+    mSizes[id] -= chunk.physicalSize();
+    size_t count = chunk.removeUid(uid, erased);
+    mSizes[id] += chunk.physicalSize();
+    return count;
+}
+
+void LogChunkCursor::attach(LogChunkCollection::iterator chunk) {
+    mChunk = chunk;
+    mOffset = 0;
+    mAttached = mChunk != mChunks->end();
+    if (mAttached) mChunk->incReaderRef();
+}
+
+void LogChunkCursor::detach() {
+    if (mAttached) mChunk->decReaderRef();
+    mAttached = false;
+}
+
+void LogChunkCursor::seek(LogChunkCollection& chunks, const log_time& start) {
+    detach();
+    mChunks = &chunks;
+
+    LogChunkCollection::iterator it = chunks.begin();
+    if (start != log_time::EPOCH) {
+        while ((it != chunks.end()) && (it->highestTime() <= start)) {
+            ++it;
+        }
+    }
+    attach(it);
+
+    // skip leading content the reader has already seen
+    const LogChunkEntry* entry;
+    while ((start != log_time::EPOCH) && (entry = peek()) &&
+           (entry->getRealTime() <= start)) {
+        next();
+    }
+}
+
+void LogChunkCursor::seek(LogChunkCollection& chunks, uint64_t sequence) {
+    detach();
+    mChunks = &chunks;
+
+    LogChunkCollection::iterator it = chunks.begin();
+    while ((it != chunks.end()) && (it->highestSequence() < sequence)) {
+        ++it;
+    }
+    attach(it);
+
+    const LogChunkEntry* entry;
+    while ((entry = peek()) && (entry->mSequence < sequence)) {
+        next();
+    }
+}
+
+const LogChunkEntry* LogChunkCursor::peek() {
+    while (mAttached) {
+        const LogChunkEntry* entry = mChunk->entryAt(mOffset);
+        if (entry) return entry;
+
+        // Active chunk exhausted, the reader will come back for more.
+        if (!mChunk->sealed()) return nullptr;
+
+        LogChunkCollection::iterator following = mChunk;
+        ++following;
+        detach();
+        attach(following);
+    }
+    return nullptr;
+}
+
+void LogChunkCursor::next() {
+    const LogChunkEntry* entry = peek();
+    if (entry) mOffset += entry->totalLen();
+}
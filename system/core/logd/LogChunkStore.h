@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOGD_LOG_CHUNK_STORE_H__
+#define _LOGD_LOG_CHUNK_STORE_H__
+
+#include <sys/types.h>
+
+#include <functional>
+
+#include <log/log.h>
+
+#include "LogChunk.h"
+
+class LogBufferElement;
+
+// Ring of LogChunks per log id, the chunked alternative to the
+// LogBufferElementCollection. Memory is accounted by the physical size of
+// the chunks, so compressed history does not count against the buffer
+// size at its logical size. Entries are numbered by a per log id sequence.
+//
+// All methods must be called with LogBuffer::mLogElementsLock held.
+class LogChunkStore {
+    LogChunkCollection mChunks[LOG_ID_MAX];
+    uint64_t mSequence[LOG_ID_MAX];
+    size_t mSizes[LOG_ID_MAX];
+    size_t mChunkSize[LOG_ID_MAX];
+
+   public:
+    static constexpr size_t minChunkSize = 4096;
+
+    LogChunkStore();
+
+    // Chunks are sized as a quarter of the log buffer size
+    void setBufferSize(log_id_t id, unsigned long size);
+
+    // Serialize a copy of element, returns its sequence number.
+    uint64_t log(const LogBufferElement* element);
+
+    LogChunkCollection& chunks(log_id_t id) {
+        return mChunks[id];
+    }
+    size_t sizes(log_id_t id) const {
+        return mSizes[id];
+    }
+    uint64_t sequence(log_id_t id) const {
+        return mSequence[id];
+    }
+
+    // Drop the oldest chunk of id, reporting each of its entries.
+    void eraseOldest(log_id_t id,
+                     const std::function<void(const LogChunkEntry*)>& erased);
+    // Remove the entries of uid from chunk, reporting each of them.
+    size_t removeUid(log_id_t id, LogChunk& chunk, uid_t uid,
+                     const std::function<void(const LogChunkEntry*)>& erased);
+};
+
+// A reader position in a LogChunkCollection. While attached it holds a
+// reader reference on the current chunk, which keeps the chunk from being
+// erased or rewritten and its contents decompressed. Must only be used,
+// and detached, with LogBuffer::mLogElementsLock held.
+class LogChunkCursor {
+    LogChunkCollection* mChunks;
+    LogChunkCollection::iterator mChunk;
+    size_t mOffset;
+    bool mAttached;
+
+    void attach(LogChunkCollection::iterator chunk);
+
+   public:
+    LogChunkCursor() : mChunks(nullptr), mOffset(0), mAttached(false) {
+    }
+
+    // Position at the first chunk holding content newer than start.
+    void seek(LogChunkCollection& chunks, const log_time& start);
+    // Position at the entry numbered sequence, or the oldest one following
+    // it if it has been pruned.
+    void seek(LogChunkCollection& chunks, uint64_t sequence);
+    // Current entry, nullptr when there is nothing more to read.
+    const LogChunkEntry* peek();
+    void next();
+    void detach();
+};
+
+#endif  // _LOGD_LOG_CHUNK_STORE_H__
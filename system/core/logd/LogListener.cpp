@@ -15,6 +15,7 @@
  */
 
 #include <limits.h>
+#include <pthread.h>
 #include <sys/cdefs.h>
 #include <sys/prctl.h>
 #include <sys/socket.h>
@@ -31,7 +32,52 @@
 #include "LogUtils.h"
 
 LogListener::LogListener(LogBuffer* buf, LogReader* reader)
-    : SocketListener(getLogSocket(), false), logbuf(buf), reader(reader) {
+    : SocketListener(getLogSocket(), false),
+      logbuf(buf),
+      reader(reader),
+      queue(nullptr) {
+    if (!__android_logger_property_get_bool(
+            "logd.staging", BOOL_DEFAULT_FALSE | BOOL_DEFAULT_FLAG_PERSIST)) {
+        return;
+    }
+
+    queue = new LogQueue(queueCapacity);
+    pthread_attr_t attr;
+    if (!pthread_attr_init(&attr)) {
+        if (!pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED)) {
+            pthread_t thread;
+            if (!pthread_create(&thread, &attr, mergeThreadStart, this)) {
+                pthread_attr_destroy(&attr);
+                return;
+            }
+        }
+        pthread_attr_destroy(&attr);
+    }
+    // No merge thread, log synchronously
+    delete queue;
+    queue = nullptr;
+}
+
+void* LogListener::mergeThreadStart(void* me) {
+    prctl(PR_SET_NAME, "logd.merge");
+    static_cast<LogListener*>(me)->merge();
+    return nullptr;
+}
+
+// Drain the staging queue in batches, each batch takes the LogBuffer lock
+// once and notifies the readers once.
+void LogListener::merge() {
+    LogBufferElement* elements[mergeBatch];
+    for (;;) {
+        size_t count = queue->pop(elements, mergeBatch);
+        if (!count) {
+            queue->wait();
+            continue;
+        }
+        if (logbuf->log(elements, count)) {
+            reader->notifyNewLog();
+        }
+    }
 }
 
 bool LogListener::onDataAvailable(SocketClient* cli) {
@@ -101,11 +147,25 @@ bool LogListener::onDataAvailable(SocketClient* cli) {
 
     // NB: hdr.msg_flags & MSG_TRUNC is not tested, silently passing a
     // truncated message to the logs.
+    unsigned short len =
+        ((size_t)n <= USHRT_MAX) ? (unsigned short)n : USHRT_MAX;
+
+    if (queue) {
+        LogBufferElement* elem =
+            new LogBufferElement((log_id_t)header->id, header->realtime,
+                                 cred->uid, cred->pid, header->tid, msg, len);
+        // Merge thread fell behind, wait for it rather than insert out of
+        // band: the chunked store keeps arrival order, so this entry would
+        // land ahead of those still staged. Meanwhile datagrams back up in
+        // the socket, as they do without staging.
+        while (!queue->push(elem)) {
+            queue->waitForSpace();
+        }
+        return true;
+    }
 
     if (logbuf->log((log_id_t)header->id, header->realtime, cred->uid,
-                    cred->pid, header->tid, msg,
-                    ((size_t)n <= USHRT_MAX) ? (unsigned short)n : USHRT_MAX) >=
-        0) {
+                    cred->pid, header->tid, msg, len) >= 0) {
         reader->notifyNewLog();
     }
 
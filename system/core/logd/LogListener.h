@@ -18,12 +18,16 @@
 #define _LOGD_LOG_LISTENER_H__
 
 #include <sysutils/SocketListener.h>
+#include "LogQueue.h"
 #include "LogReader.h"
 
 class LogListener : public SocketListener {
     LogBuffer* logbuf;
     LogReader* reader;
 
+    // persist.logd.staging: hand entries to the merge thread
+    LogQueue* queue;
+
    public:
     LogListener(LogBuffer* buf, LogReader* reader);
 
@@ -31,7 +35,12 @@ class LogListener : public SocketListener {
     virtual bool onDataAvailable(SocketClient* cli);
 
    private:
+    static const size_t queueCapacity = 1024;
+    static const size_t mergeBatch = 64;
+
     static int getLogSocket();
+    static void* mergeThreadStart(void* me);
+    void merge();
 };
 
 #endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+
+#include "LogQueue.h"
+
+static size_t roundUpPowerOfTwo(size_t value) {
+    size_t ret = 1;
+    while (ret < value) ret <<= 1;
+    return ret;
+}
+
+LogQueue::LogQueue(size_t capacity)
+    : mMask(roundUpPowerOfTwo(capacity) - 1),
+      mSlots(new Slot[mMask + 1]),
+      mEnqueuePos(0),
+      mDequeuePos(0),
+      mSleeping(false),
+      mProducerSleeping(false) {
+    for (size_t i = 0; i <= mMask; ++i) {
+        mSlots[i].sequence.store(i, std::memory_order_relaxed);
+        mSlots[i].element = nullptr;
+    }
+    sem_init(&mWakeup, 0, 0);
+    sem_init(&mSpace, 0, 0);
+}
+
+LogQueue::~LogQueue() {
+    sem_destroy(&mSpace);
+    sem_destroy(&mWakeup);
+}
+
+bool LogQueue::push(LogBufferElement* element) {
+    if (full()) {
+        return false;  // the consumer has yet to drain this slot
+    }
+    Slot* slot = &mSlots[mEnqueuePos & mMask];
+    slot->element = element;
+    slot->sequence.store(mEnqueuePos + 1, std::memory_order_release);
+    ++mEnqueuePos;
+
+    // Pairs with the fence in wait(), either the consumer sees our slot
+    // or we see it is (about to go) asleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mSleeping.load(std::memory_order_relaxed) &&
+        mSleeping.exchange(false, std::memory_order_acq_rel)) {
+        sem_post(&mWakeup);
+    }
+    return true;
+}
+
+size_t LogQueue::pop(LogBufferElement** elements, size_t max) {
+    size_t count = 0;
+    while (count < max) {
+        Slot& slot = mSlots[mDequeuePos & mMask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != (mDequeuePos + 1)) {
+            break;  // empty, or producer still filling in the slot
+        }
+        elements[count++] = slot.element;
+        slot.sequence.store(mDequeuePos + mMask + 1, std::memory_order_release);
+        ++mDequeuePos;
+    }
+    if (count) {
+        // Pairs with the fence in waitForSpace().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (mProducerSleeping.load(std::memory_order_relaxed) &&
+            mProducerSleeping.exchange(false, std::memory_order_acq_rel)) {
+            sem_post(&mSpace);
+        }
+    }
+    return count;
+}
+
+bool LogQueue::empty() const {
+    const Slot& slot = mSlots[mDequeuePos & mMask];
+    return slot.sequence.load(std::memory_order_acquire) != (mDequeuePos + 1);
+}
+
+void LogQueue::wait() {
+    mSleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!empty()) {
+        // A racing producer may still post, costing one spurious wakeup.
+        mSleeping.store(false, std::memory_order_relaxed);
+        return;
+    }
+    while (sem_wait(&mWakeup) && (errno == EINTR)) {
+    }
+}
+
+bool LogQueue::full() const {
+    const Slot& slot = mSlots[mEnqueuePos & mMask];
+    return slot.sequence.load(std::memory_order_acquire) != mEnqueuePos;
+}
+
+void LogQueue::waitForSpace() {
+    mProducerSleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!full()) {
+        // A racing consumer may still post, costing one spurious wakeup.
+        mProducerSleeping.store(false, std::memory_order_relaxed);
+        return;
+    }
+    while (sem_wait(&mSpace) && (errno == EINTR)) {
+    }
+}
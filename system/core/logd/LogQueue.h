@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LOGD_LOG_QUEUE_H__
+#define _LOGD_LOG_QUEUE_H__
+
+#include <semaphore.h>
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+
+class LogBufferElement;
+
+// Bounded, lock-free single-producer single-consumer queue of elements
+// staged between the logdw socket thread and LogBuffer insertion. logdw is
+// a single datagram socket served by one SocketListener thread, concurrent
+// writers are already serialized by the kernel on its receive queue; what
+// the queue removes is that thread waiting on LogBuffer's lock while
+// readers and pruning hold it, so the socket keeps draining. The consumer
+// drains in batches so that LogBuffer's lock is taken once per batch
+// instead of once per entry.
+//
+// Each slot carries a sequence number telling whether it is free to fill
+// or ready to drain, the two positions are private to their thread. Either
+// side sleeps on a semaphore when there is nothing it can do, the other
+// side posts it only when it sees the sleeper flag set.
+class LogQueue {
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogBufferElement* element;
+    };
+
+    const size_t mMask;
+    std::unique_ptr<Slot[]> mSlots;
+
+    size_t mEnqueuePos;
+    // keep the consumer position off the producer's cacheline
+    char mPadding[64] __attribute__((unused));
+    size_t mDequeuePos;
+    std::atomic<bool> mSleeping;
+    sem_t mWakeup;
+    std::atomic<bool> mProducerSleeping;
+    sem_t mSpace;
+
+    bool full() const;
+
+   public:
+    // capacity is rounded up to a power of two
+    explicit LogQueue(size_t capacity);
+    ~LogQueue();
+
+    LogQueue(const LogQueue&) = delete;
+    LogQueue& operator=(const LogQueue&) = delete;
+
+    // Single producer, takes ownership of element on success, fails if the
+    // queue is full.
+    bool push(LogBufferElement* element);
+    // Single producer, block until there is a free slot to push to.
+    void waitForSpace();
+
+    // Single consumer, returns up to max elements in push order.
+    size_t pop(LogBufferElement** elements, size_t max);
+    // Single consumer, block until there is something to pop.
+    void wait();
+
+    bool empty() const;
+};
+
+#endif  // _LOGD_LOG_QUEUE_H__
@@ -184,7 +184,8 @@ bool LogReader::onDataAvailable(SocketClient* cli) {
 
         logbuf().flushTo(cli, sequence, nullptr, FlushCommand::hasReadLogs(cli),
                          FlushCommand::hasSecurityLogs(cli),
-                         logFindStart.callback, &logFindStart);
+                         logFindStart.callback, &logFindStart, nullptr,
+                         logMask);
 
         if (!logFindStart.found()) {
             doSocketDelete(cli);
@@ -29,7 +29,8 @@
 
 size_t LogStatistics::SizesTotal;
 
-LogStatistics::LogStatistics() : enable(false) {
+LogStatistics::LogStatistics()
+    : enable(false), mIndexHits(0), mIndexMisses(0) {
     log_id_for_each(id) {
         mSizes[id] = 0;
         mElements[id] = 0;
@@ -115,8 +116,8 @@ void LogStatistics::add(LogBufferElement* element) {
     }
 }
 
-void LogStatistics::subtract(LogBufferElement* element) {
-    log_id_t log_id = element->getLogId();
+template <typename TElement>
+void LogStatistics::subtractElement(log_id_t log_id, const TElement* element) {
     unsigned short size = element->getMsgLen();
     mSizes[log_id] -= size;
     --mElements[log_id];
@@ -150,6 +151,16 @@ void LogStatistics::subtract(LogBufferElement* element) {
     }
 }
 
+void LogStatistics::subtract(LogBufferElement* element) {
+    subtractElement(element->getLogId(), element);
+}
+
+// Without a LogBufferElement round trip, the chunk store expires entries
+// in bulk.
+void LogStatistics::subtract(log_id_t log_id, const LogChunkEntry* entry) {
+    subtractElement(log_id, entry);
+}
+
 // Atomically set an entry to drop
 // entry->setDropped(1) must follow this call, caller should do this explicitly.
 void LogStatistics::drop(LogBufferElement* element) {
@@ -553,6 +564,11 @@ std::string LogStatistics::format(uid_t uid, pid_t pid,
     if (spaces < 0) spaces = 0;
     output += android::base::StringPrintf("%*s%zu", spaces, "", totalSize);
 
+    if (mIndexHits || mIndexMisses) {
+        output += android::base::StringPrintf(
+            "\nIndex seeks: %zu hits, %zu misses", mIndexHits, mIndexMisses);
+    }
+
     // Report on Chattiest
 
     std::string name;
@@ -31,6 +31,7 @@
 #include <private/android_filesystem_config.h>
 
 #include "LogBufferElement.h"
+#include "LogChunk.h"
 #include "LogUtils.h"
 
 #define log_id_for_each(i) \
@@ -131,7 +132,8 @@ class LogHashtable {
         return it;
     }
 
-    void subtract(TKey key, LogBufferElement* element) {
+    template <typename TElement>
+    void subtract(TKey key, const TElement* element) {
         iterator it = map.find(key);
         if ((it != map.end()) && it->second.subtract(element)) {
             map.erase(it);
@@ -208,7 +210,8 @@ struct EntryBase {
     inline void add(LogBufferElement* element) {
         size += element->getMsgLen();
     }
-    inline bool subtract(LogBufferElement* element) {
+    template <typename TElement>
+    inline bool subtract(const TElement* element) {
         size -= element->getMsgLen();
         return !size;
     }
@@ -251,7 +254,8 @@ struct EntryBaseDropped : public EntryBase {
         dropped += element->getDropped();
         EntryBase::add(element);
     }
-    inline bool subtract(LogBufferElement* element) {
+    template <typename TElement>
+    inline bool subtract(const TElement* element) {
         dropped -= element->getDropped();
         return EntryBase::subtract(element) && !dropped;
     }
@@ -522,6 +526,9 @@ class LogStatistics {
     size_t mElementsTotal[LOG_ID_MAX];
     static size_t SizesTotal;
     bool enable;
+    // LogBufferIndex use by readers starting away from the end
+    size_t mIndexHits;
+    size_t mIndexMisses;
 
     // uid to size list
     typedef LogHashtable<uid_t, UidEntry> uidTable_t;
@@ -546,6 +553,10 @@ class LogStatistics {
     // security tag list
     tagTable_t securityTagTable;
 
+    // shared by LogBufferElement and LogChunkEntry removal
+    template <typename TElement>
+    void subtractElement(log_id_t log_id, const TElement* element);
+
     size_t sizeOf() const {
         size_t size = sizeof(*this) + pidTable.sizeOf() + tidTable.sizeOf() +
                       tagTable.sizeOf() + securityTagTable.sizeOf() +
@@ -578,8 +589,13 @@ class LogStatistics {
 
     void add(LogBufferElement* entry);
     void subtract(LogBufferElement* entry);
+    // entry expired from the chunk store, see LogChunkStore
+    void subtract(log_id_t log_id, const LogChunkEntry* entry);
     // entry->setDropped(1) must follow this call
     void drop(LogBufferElement* entry);
+    void indexSeek(bool hit) {
+        ++(hit ? mIndexHits : mIndexMisses);
+    }
     // Correct for coalescing two entries referencing dropped content
     void erase(LogBufferElement* element) {
         log_id_t log_id = element->getLogId();
@@ -49,6 +49,7 @@ LogTimeEntry::LogTimeEntry(LogReader& reader, SocketClient* client,
     mTimeout.tv_sec = timeout / NS_PER_SEC;
     mTimeout.tv_nsec = timeout % NS_PER_SEC;
     memset(mLastTid, 0, sizeof(mLastTid));
+    memset(mSequence, 0, sizeof(mSequence));
     pthread_cond_init(&threadTriggeredCondition, nullptr);
     cleanSkip_Locked();
 }
@@ -154,11 +155,12 @@ void* LogTimeEntry::threadStart(void* obj) {
 
         if (me->mTail) {
             logbuf.flushTo(client, start, nullptr, privileged, security,
-                           FilterFirstPass, me);
+                           FilterFirstPass, me, nullptr, me->mLogMask);
             me->leadingDropped = true;
         }
         start = logbuf.flushTo(client, start, me->mLastTid, privileged,
-                               security, FilterSecondPass, me);
+                               security, FilterSecondPass, me, me->mSequence,
+                               me->mLogMask);
 
         lock();
 
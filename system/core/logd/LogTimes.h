@@ -45,6 +45,7 @@ class LogTimeEntry {
     const pid_t mPid;
     unsigned int skipAhead[LOG_ID_MAX];
     pid_t mLastTid[LOG_ID_MAX];
+    uint64_t mSequence[LOG_ID_MAX];  // chunked store resume position
     unsigned long mCount;
     unsigned long mTail;
     unsigned long mIndex;
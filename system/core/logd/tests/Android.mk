@@ -23,6 +23,27 @@ LOCAL_PATH := $(call my-dir)
 test_module_prefix := logd-
 test_tags := tests
 
+benchmark_c_flags := \
+    -Ibionic/tests \
+    -I$(LOCAL_PATH)/../../liblog/tests \
+    -Wall -Wextra \
+    -Werror \
+    -fno-builtin \
+
+benchmark_src_files := \
+    ../../liblog/tests/benchmark_main.cpp \
+    logd_benchmark.cpp
+
+# Build benchmarks for the device. Run with:
+#   adb shell logd-benchmarks
+include $(CLEAR_VARS)
+LOCAL_MODULE := $(test_module_prefix)benchmarks
+LOCAL_MODULE_TAGS := $(test_tags)
+LOCAL_CFLAGS += $(benchmark_c_flags)
+LOCAL_SHARED_LIBRARIES += liblog libm libbase
+LOCAL_SRC_FILES := $(benchmark_src_files)
+include $(BUILD_NATIVE_TEST)
+
 # -----------------------------------------------------------------------------
 # Unit tests.
 # -----------------------------------------------------------------------------
@@ -38,6 +59,7 @@ test_c_flags := \
     $(event_flag)
 
 test_src_files := \
+    logd_chunk_test.cpp \
     logd_test.cpp
 
 # Build tests for the logger. Run with:
@@ -46,6 +68,8 @@ include $(CLEAR_VARS)
 LOCAL_MODULE := $(test_module_prefix)unit-tests
 LOCAL_MODULE_TAGS := $(test_tags)
 LOCAL_CFLAGS += $(test_c_flags)
-LOCAL_SHARED_LIBRARIES := libbase libcutils liblog libselinux
+LOCAL_STATIC_LIBRARIES := liblogd
+LOCAL_SHARED_LIBRARIES := libbase libcutils liblog libselinux libsysutils \
+    libpackagelistparser libcap libz
 LOCAL_SRC_FILES := $(test_src_files)
 include $(BUILD_NATIVE_TEST)
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include <log/log.h>
+
+#include "benchmark.h"
+
+static const char ingest_tag[] = "BM_log_ingest";
+static const char ingest_end[] = "end";
+static const int alarm_time = 3;
+
+static uint64_t nanotime() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<uint64_t>(t.tv_sec) * 1000000000ULL + t.tv_nsec;
+}
+
+static void write_end() {
+  __android_log_write(ANDROID_LOG_INFO, ingest_tag, ingest_end);
+}
+
+static void caught_ingest(int /*signum*/) {
+  write_end();
+}
+
+struct writer_arg {
+  int iters;
+  int index;
+  std::atomic<int>* running;
+  std::vector<uint64_t> latency;
+};
+
+static void* writer_thread(void* obj) {
+  writer_arg* arg = static_cast<writer_arg*>(obj);
+  arg->latency.reserve(arg->iters);
+  for (int i = 0; i < arg->iters; ++i) {
+    uint64_t start = nanotime();
+    __android_log_print(ANDROID_LOG_INFO, ingest_tag, "writer %d line %d",
+                        arg->index, i);
+    arg->latency.push_back(nanotime() - start);
+  }
+  // last one out tells the reader
+  if (arg->running->fetch_sub(1) == 1) write_end();
+  return nullptr;
+}
+
+static uint64_t percentile(const std::vector<uint64_t>& sorted, unsigned p) {
+  if (sorted.empty()) return 0;
+  return sorted[(sorted.size() - 1) * p / 100];
+}
+
+/*
+ *	Measure logd ingestion: lines/sec from the first write until logd has
+ * made the last one available to a reader, with several concurrent
+ * writers. Lines logd could not take in are counted as lost, liblog drops
+ * them when the logdw socket is full. Also report the writer side latency
+ * distribution, which is dominated by how quickly logd drains the logdw
+ * socket. Compare with and without persist.logd.staging and
+ * persist.logd.chunked set.
+ */
+static void log_ingest(int iters, int threads) {
+  pid_t pid = getpid();
+  struct logger_list* logger_list =
+      android_logger_list_open(LOG_ID_MAIN, ANDROID_LOG_RDONLY, 0, pid);
+  if (!logger_list) {
+    fprintf(stderr, "Unable to open main log: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<writer_arg> args(threads);
+  std::vector<pthread_t> ids(threads);
+  std::atomic<int> running(threads);
+  int per_thread = (iters + threads - 1) / threads;
+
+  signal(SIGALRM, caught_ingest);
+  alarm(alarm_time);
+
+  StartBenchmarkTiming();
+  uint64_t start = nanotime();
+  for (int t = 0; t < threads; ++t) {
+    args[t].iters = per_thread;
+    args[t].index = t;
+    args[t].running = &running;
+    pthread_create(&ids[t], nullptr, writer_thread, &args[t]);
+  }
+
+  // The lines of this pid arrive in the order logd stored them.
+  uint64_t received = 0;
+  for (;;) {
+    log_msg log_msg;
+    int ret = android_logger_list_read(logger_list, &log_msg);
+    alarm(alarm_time);
+    if (ret <= 0) break;
+
+    const char* msg = log_msg.msg();
+    if (!msg || (log_msg.entry.len < (1 + sizeof(ingest_tag)))) continue;
+    if (strcmp(msg + 1, ingest_tag)) continue;
+    if (!strcmp(msg + 1 + sizeof(ingest_tag), ingest_end)) break;
+    ++received;
+  }
+  uint64_t elapsed = nanotime() - start;
+  StopBenchmarkTiming();
+
+  signal(SIGALRM, SIG_DFL);
+  alarm(0);
+
+  for (int t = 0; t < threads; ++t) {
+    pthread_join(ids[t], nullptr);
+  }
+  android_logger_list_free(logger_list);
+
+  std::vector<uint64_t> all;
+  for (auto& arg : args) {
+    all.insert(all.end(), arg.latency.begin(), arg.latency.end());
+  }
+  std::sort(all.begin(), all.end());
+
+  uint64_t sent = static_cast<uint64_t>(per_thread) * threads;
+  fprintf(stderr,
+          "%d writers: %" PRIu64 " lines/sec ingested, %" PRIu64
+          " of %" PRIu64 " lost, latency p50 %" PRIu64 "ns p90 %" PRIu64
+          "ns p99 %" PRIu64 "ns max %" PRIu64 "ns\n",
+          threads, elapsed ? (received * 1000000000ULL / elapsed) : 0,
+          (sent > received) ? (sent - received) : 0, sent,
+          percentile(all, 50), percentile(all, 90), percentile(all, 99),
+          all.empty() ? 0 : all.back());
+}
+
+static void BM_log_ingest_1(int iters) {
+  log_ingest(iters, 1);
+}
+BENCHMARK(BM_log_ingest_1);
+
+static void BM_log_ingest_4(int iters) {
+  log_ingest(iters, 4);
+}
+BENCHMARK(BM_log_ingest_4);
+
+static void BM_log_ingest_16(int iters) {
+  log_ingest(iters, 16);
+}
+BENCHMARK(BM_log_ingest_16);
+
+static void BM_log_ingest_64(int iters) {
+  log_ingest(iters, 64);
+}
+BENCHMARK(BM_log_ingest_64);
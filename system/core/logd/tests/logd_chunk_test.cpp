@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+// log_time::EPOCH is only declared with the private logger header first
+#include <private/android_logger.h>
+
+#include <android-base/stringprintf.h>
+#include <gtest/gtest.h>
+#include <log/log.h>
+#include <sysutils/SocketClient.h>
+
+#include "../LogBuffer.h"
+#include "../LogBufferElement.h"
+#include "../LogChunk.h"
+#include "../LogChunkStore.h"
+#include "../LogTimes.h"
+#include "../LogUtils.h"
+
+// Furnished in logd's main.cpp, which is not linked into the tests.
+char* android::uidToName(uid_t) {
+    return nullptr;
+}
+
+void android::prdebug(const char*, ...) {
+}
+
+// A main buffer payload: priority, tag and message, each NUL terminated.
+static std::string payload(int i) {
+    std::string msg(1, ANDROID_LOG_INFO);
+    msg += "chunk_test";
+    msg += '\0';
+    msg += android::base::StringPrintf("line %d", i);
+    msg += '\0';
+    return msg;
+}
+
+static LogBufferElement* element(int i, uid_t uid = 1000) {
+    std::string msg = payload(i);
+    return new LogBufferElement(LOG_ID_MAIN, log_time(1000 + i, 0), uid, 1,
+                                1, msg.data(), msg.size());
+}
+
+static size_t log_lines(LogChunkStore& store, int first, int count,
+                        uid_t uid = 1000) {
+    for (int i = first; i < (first + count); ++i) {
+        std::unique_ptr<LogBufferElement> elem(element(i, uid));
+        store.log(elem.get());
+    }
+    return store.chunks(LOG_ID_MAIN).size();
+}
+
+TEST(logd_chunk, seal_round_trip) {
+    LogChunk chunk(LogChunkStore::minChunkSize, 1);
+    int count = 0;
+    for (;;) {
+        std::unique_ptr<LogBufferElement> elem(element(count));
+        if (!chunk.canLog(elem->getMsgLen())) break;
+        chunk.log(count + 1, elem.get());
+        ++count;
+    }
+    ASSERT_LT(0, count);
+    EXPECT_EQ(static_cast<size_t>(count), chunk.entries());
+    EXPECT_EQ(1U, chunk.lowestSequence());
+    EXPECT_EQ(static_cast<uint64_t>(count), chunk.highestSequence());
+    EXPECT_EQ(log_time(1000 + count - 1, 0), chunk.highestTime());
+
+    chunk.seal();
+    EXPECT_TRUE(chunk.sealed());
+    EXPECT_FALSE(chunk.canLog(0));
+    // repetitive content, compression must pay off
+    EXPECT_GT(LogChunkStore::minChunkSize, chunk.physicalSize());
+    // contents are only available to readers
+    EXPECT_TRUE(chunk.entryAt(0) == nullptr);
+
+    chunk.incReaderRef();
+    size_t offset = 0;
+    for (int i = 0; i < count; ++i) {
+        const LogChunkEntry* entry = chunk.entryAt(offset);
+        ASSERT_TRUE(entry != nullptr);
+        std::string msg = payload(i);
+        EXPECT_EQ(static_cast<uint64_t>(i + 1), entry->mSequence);
+        EXPECT_EQ(log_time(1000 + i, 0), entry->getRealTime());
+        ASSERT_EQ(msg.size(), entry->getMsgLen());
+        EXPECT_EQ(0, memcmp(msg.data(), entry->getMsg(), msg.size()));
+        offset += entry->totalLen();
+    }
+    EXPECT_TRUE(chunk.entryAt(offset) == nullptr);
+    chunk.decReaderRef();
+    EXPECT_TRUE(chunk.entryAt(0) == nullptr);
+}
+
+TEST(logd_chunk, store_sequence) {
+    LogChunkStore store;
+    store.setBufferSize(LOG_ID_MAIN, 4 * LogChunkStore::minChunkSize);
+
+    static const int lines = 1000;
+    size_t chunks = log_lines(store, 0, lines);
+    ASSERT_LT(1U, chunks);
+    EXPECT_EQ(static_cast<uint64_t>(lines + 1), store.sequence(LOG_ID_MAIN));
+
+    size_t entries = 0;
+    uint64_t sequence = 1;
+    for (LogChunk& chunk : store.chunks(LOG_ID_MAIN)) {
+        EXPECT_EQ(sequence, chunk.lowestSequence());
+        sequence = chunk.highestSequence() + 1;
+        entries += chunk.entries();
+        // all but the active chunk are sealed
+        EXPECT_EQ(&chunk != &store.chunks(LOG_ID_MAIN).back(), chunk.sealed());
+    }
+    EXPECT_EQ(static_cast<size_t>(lines), entries);
+    // accounted at the physical, compressed, size
+    EXPECT_GT(chunks * LogChunkStore::minChunkSize,
+              store.sizes(LOG_ID_MAIN));
+}
+
+TEST(logd_chunk, cursor_seek) {
+    LogChunkStore store;
+    static const int lines = 1000;
+    ASSERT_LT(1U, log_lines(store, 0, lines));
+    LogChunkCollection& chunks = store.chunks(LOG_ID_MAIN);
+
+    LogChunkCursor cursor;
+    cursor.seek(chunks, log_time::EPOCH);
+    const LogChunkEntry* entry = cursor.peek();
+    ASSERT_TRUE(entry != nullptr);
+    EXPECT_EQ(1U, entry->mSequence);
+
+    // first entry newer than start
+    cursor.seek(chunks, log_time(1000 + 500, 0));
+    ASSERT_TRUE((entry = cursor.peek()) != nullptr);
+    EXPECT_EQ(log_time(1000 + 501, 0), entry->getRealTime());
+
+    cursor.seek(chunks, static_cast<uint64_t>(750));
+    ASSERT_TRUE((entry = cursor.peek()) != nullptr);
+    EXPECT_EQ(750U, entry->mSequence);
+
+    // walk across the chunk boundaries to the end
+    int count = 0;
+    while ((entry = cursor.peek())) {
+        EXPECT_EQ(static_cast<uint64_t>(750 + count), entry->mSequence);
+        cursor.next();
+        ++count;
+    }
+    EXPECT_EQ(lines - 750 + 1, count);
+
+    // nothing is lost when the writer appends behind an exhausted cursor
+    log_lines(store, lines, 1);
+    ASSERT_TRUE((entry = cursor.peek()) != nullptr);
+    EXPECT_EQ(static_cast<uint64_t>(lines + 1), entry->mSequence);
+    cursor.detach();
+}
+
+TEST(logd_chunk, cursor_pins_chunk) {
+    LogChunkStore store;
+    ASSERT_LT(1U, log_lines(store, 0, 1000));
+    LogChunkCollection& chunks = store.chunks(LOG_ID_MAIN);
+    LogChunk& oldest = chunks.front();
+
+    LogChunkCursor cursor;
+    cursor.seek(chunks, log_time::EPOCH);
+    EXPECT_EQ(1U, oldest.readerRefs());
+    // readable although sealed
+    EXPECT_TRUE(oldest.entryAt(0) != nullptr);
+
+    // moving past the chunk releases it
+    cursor.seek(chunks, oldest.highestSequence() + 1);
+    EXPECT_EQ(0U, oldest.readerRefs());
+    EXPECT_TRUE(oldest.entryAt(0) == nullptr);
+
+    cursor.detach();
+    for (LogChunk& chunk : chunks) {
+        EXPECT_EQ(0U, chunk.readerRefs());
+    }
+}
+
+TEST(logd_chunk, erase_oldest) {
+    LogChunkStore store;
+    ASSERT_LT(2U, log_lines(store, 0, 1000));
+    LogChunkCollection& chunks = store.chunks(LOG_ID_MAIN);
+    size_t chunkEntries = chunks.front().entries();
+    uint64_t following = chunks.front().highestSequence() + 1;
+    size_t sizes = store.sizes(LOG_ID_MAIN);
+    size_t physical = chunks.front().physicalSize();
+
+    size_t erased = 0;
+    uint64_t sequence = 1;
+    store.eraseOldest(LOG_ID_MAIN, [&](const LogChunkEntry* entry) {
+        EXPECT_EQ(sequence++, entry->mSequence);
+        ++erased;
+    });
+    EXPECT_EQ(chunkEntries, erased);
+    EXPECT_EQ(sizes - physical, store.sizes(LOG_ID_MAIN));
+
+    // resuming inside the pruned range picks up the oldest remaining entry
+    LogChunkCursor cursor;
+    cursor.seek(chunks, static_cast<uint64_t>(1));
+    const LogChunkEntry* entry = cursor.peek();
+    ASSERT_TRUE(entry != nullptr);
+    EXPECT_EQ(following, entry->mSequence);
+    cursor.detach();
+}
+
+TEST(logd_chunk, remove_uid) {
+    LogChunkStore store;
+    for (int i = 0; i < 1000; ++i) {
+        log_lines(store, i, 1, (i & 1) ? 1001 : 1000);
+    }
+    LogChunkCollection& chunks = store.chunks(LOG_ID_MAIN);
+    LogChunk& oldest = chunks.front();
+    ASSERT_TRUE(oldest.sealed());
+    size_t entries = oldest.entries();
+
+    size_t removed = 0;
+    size_t count = store.removeUid(LOG_ID_MAIN, oldest, 1001,
+                                   [&](const LogChunkEntry* entry) {
+                                       EXPECT_EQ(1001U, entry->mUid);
+                                       ++removed;
+                                   });
+    EXPECT_EQ(removed, count);
+    EXPECT_EQ(entries, count + oldest.entries());
+    EXPECT_TRUE(oldest.sealed());
+
+    LogChunkCursor cursor;
+    cursor.seek(chunks, log_time::EPOCH);
+    for (size_t i = 0; i < oldest.entries(); ++i) {
+        const LogChunkEntry* entry = cursor.peek();
+        ASSERT_TRUE(entry != nullptr);
+        EXPECT_EQ(1000U, entry->mUid);
+        cursor.next();
+    }
+    cursor.detach();
+}
+
+// Chunked mode LogBuffer, the flushTo() filter sees every candidate entry.
+struct FlushState {
+    size_t count[LOG_ID_MAX];
+};
+
+static int count_filter(const LogBufferElement* element, void* arg) {
+    FlushState* state = reinterpret_cast<FlushState*>(arg);
+    ++state->count[element->getLogId()];
+    return false;
+}
+
+TEST(logd_chunk, flushTo_log_mask) {
+    LastLogTimes times;
+    LogBuffer logbuf(&times, true);
+
+    static const int lines = 100;
+    for (int i = 0; i < lines; ++i) {
+        std::string msg = payload(i);
+        ASSERT_LT(0, logbuf.log(LOG_ID_MAIN, log_time(1000 + i, 0), 1000, 1, 1,
+                                msg.data(), msg.size()));
+        ASSERT_LT(0, logbuf.log(LOG_ID_SYSTEM, log_time(1000 + i, 1), 1000, 1,
+                                1, msg.data(), msg.size()));
+    }
+
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    SocketClient client(fds[0], false);
+
+    FlushState state = {};
+    uint64_t sequence[LOG_ID_MAX] = {};
+    logbuf.flushTo(&client, log_time::EPOCH, nullptr, true, false,
+                   count_filter, &state, sequence, 1 << LOG_ID_MAIN);
+    EXPECT_EQ(static_cast<size_t>(lines), state.count[LOG_ID_MAIN]);
+    EXPECT_EQ(0U, state.count[LOG_ID_SYSTEM]);
+    // resume position only advanced for the buffers read
+    EXPECT_EQ(static_cast<uint64_t>(lines + 1), sequence[LOG_ID_MAIN]);
+    EXPECT_EQ(0U, sequence[LOG_ID_SYSTEM]);
+
+    // resuming by sequence only sees new entries
+    std::string msg = payload(lines);
+    ASSERT_LT(0, logbuf.log(LOG_ID_MAIN, log_time(999, 0), 1000, 1, 1,
+                            msg.data(), msg.size()));
+    memset(&state, 0, sizeof(state));
+    logbuf.flushTo(&client, log_time(1000 + lines, 0), nullptr, true, false,
+                   count_filter, &state, sequence,
+                   (1 << LOG_ID_MAIN) | (1 << LOG_ID_SYSTEM));
+    EXPECT_EQ(1U, state.count[LOG_ID_MAIN]);
+    EXPECT_EQ(0U, state.count[LOG_ID_SYSTEM]);
+
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -32,6 +32,7 @@
 #include <gtest/gtest.h>
 #include <log/log.h>
 #include <private/android_filesystem_config.h>
+#include <private/android_logger.h>
 #ifdef __ANDROID__
 #include <selinux/selinux.h>
 #endif
@@ -206,6 +207,66 @@ TEST(logd, statistics) {
     delete[] buf;
 }
 
+// Sum of index hits and misses in the statistics, the number of readers
+// that started deep in the buffer.
+static size_t index_seeks() {
+    size_t len;
+    char* buf;
+
+    alloc_statistics(&buf, &len);
+    if (!buf) return 0;
+
+    size_t hits = 0, misses = 0;
+    const char* cp = strstr(buf, "\nIndex seeks: ");
+    if (cp) sscanf(cp, "\nIndex seeks: %zu hits, %zu misses", &hits, &misses);
+    delete[] buf;
+    return hits + misses;
+}
+
+TEST(logd, flushTo_index_seek) {
+#ifdef __ANDROID__
+    if (__android_logger_property_get_bool(
+            "logd.chunked", BOOL_DEFAULT_FALSE | BOOL_DEFAULT_FLAG_PERSIST)) {
+        GTEST_LOG_(INFO) << "Chunked store does not use the index\n";
+        return;
+    }
+
+    pid_t pid = getpid();
+    log_time start(android_log_clockid());
+
+    // Several index intervals, and more than the 300 entries flushTo()
+    // looks back from the end.
+    static const int lines = 1000;
+    for (int i = 0; i < lines; ++i) {
+        __android_log_print(ANDROID_LOG_INFO, "logd.index_seek", "line %d",
+                            i);
+    }
+    usleep(100000);
+
+    size_t seeks = index_seeks();
+
+    struct logger_list* logger_list;
+    ASSERT_TRUE(NULL != (logger_list = android_logger_list_alloc_time(
+                             ANDROID_LOG_RDONLY | ANDROID_LOG_NONBLOCK,
+                             start, pid)));
+    ASSERT_TRUE(NULL != android_logger_open(logger_list, LOG_ID_MAIN));
+
+    int count = 0;
+    log_msg log_msg;
+    while (android_logger_list_read(logger_list, &log_msg) > 0) {
+        if ((log_msg.entry.pid == pid) && (log_msg.id() == LOG_ID_MAIN)) {
+            ++count;
+        }
+    }
+    android_logger_list_free(logger_list);
+
+    EXPECT_EQ(lines, count);
+    EXPECT_LT(seeks, index_seeks());
+#else
+    GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
 static void caught_signal(int /* signum */) {
 }
 